@@ -28,6 +28,12 @@ else
   npm ci
   npm run build
 fi
+if command -v brotli > /dev/null; then
+  echo "Compressing webui ..."
+  # the daemon serves the .br files to the clients accepting them
+  find dist -type f \( -name "*.html" -o -name "*.js" -o -name "*.css" -o -name "*.svg" \) \
+    -exec brotli --force --keep --best {} \;
+fi
 cd ..
 
 cd daemon
@@ -0,0 +1,167 @@
+//
+//  admission_control.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _ADMISSION_CONTROL_HPP_
+#define _ADMISSION_CONTROL_HPP_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/*
+ * Admission control of the HTTP requests.
+ * Requests are split in lanes, every lane runs at most the configured
+ * number of requests at a time and queues at most queue_max requests.
+ * When the queue is full or the wait expires the request is shed, so a
+ * lane can only hold a bounded number of server threads and slow control
+ * calls cannot starve the monitoring reads.
+ */
+class AdmissionControl {
+ public:
+  enum Lane { control = 0, read, stream, lanes_num };
+
+  /* max time a request waits in the lane queue */
+  constexpr static uint32_t queue_wait_max = 10;  // sec
+
+  struct LaneConfig {
+    uint16_t workers{1};
+    uint16_t queue_max{0};
+  };
+
+  struct LaneStats {
+    uint64_t admitted{0};
+    uint64_t shed{0};     /* rejected with the queue full */
+    uint64_t timeouts{0}; /* rejected after waiting queue_wait_max */
+    uint16_t running{0};
+    uint16_t queued{0};
+    uint16_t max_running{0};
+    uint16_t max_queued{0};
+    uint64_t max_wait_us{0};
+  };
+
+  /* the request runs in the lane until the ticket is destroyed */
+  using Ticket = std::shared_ptr<void>;
+
+  explicit AdmissionControl(const std::array<LaneConfig, lanes_num>& config) {
+    for (size_t lane = 0; lane < lanes_num; lane++) {
+      lanes_[lane].config = config[lane];
+    }
+  }
+  AdmissionControl(const AdmissionControl&) = delete;
+  AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+  /* admit the request to the lane, returns nullptr if it is shed */
+  Ticket admit(Lane lane) {
+    using namespace std::chrono;
+    auto& l = lanes_[lane];
+    std::unique_lock lock(mutex_);
+    if (l.stats.running >= l.config.workers) {
+      if (l.stats.queued >= l.config.queue_max || !running_) {
+        l.stats.shed++;
+        return nullptr;
+      }
+      if (++l.stats.queued > l.stats.max_queued) {
+        l.stats.max_queued = l.stats.queued;
+      }
+      auto start = steady_clock::now();
+      bool admitted =
+          l.cv.wait_for(lock, seconds(queue_wait_max), [this, &l]() {
+            return l.stats.running < l.config.workers || !running_;
+          });
+      l.stats.queued--;
+      l.stats.max_wait_us = std::max<uint64_t>(
+          l.stats.max_wait_us,
+          duration_cast<microseconds>(steady_clock::now() - start).count());
+      if (!admitted || !running_) {
+        l.stats.timeouts++;
+        return nullptr;
+      }
+    }
+    if (++l.stats.running > l.stats.max_running) {
+      l.stats.max_running = l.stats.running;
+    }
+    l.stats.admitted++;
+    return Ticket(static_cast<void*>(this),
+                  [this, lane](void*) { release(lane); });
+  }
+
+  LaneStats get_stats(Lane lane) const {
+    std::lock_guard lock(mutex_);
+    return lanes_[lane].stats;
+  }
+
+  const LaneConfig& get_config(Lane lane) const { return lanes_[lane].config; }
+
+  /* max number of requests running or queued in all the lanes */
+  size_t get_capacity() const {
+    size_t capacity = 0;
+    for (const auto& l : lanes_) {
+      capacity += l.config.workers + l.config.queue_max;
+    }
+    return capacity;
+  }
+
+  static const char* get_lane_name(Lane lane) {
+    switch (lane) {
+      case control:
+        return "control";
+      case read:
+        return "read";
+      case stream:
+        return "stream";
+      default:
+        return "";
+    }
+  }
+
+  /* shed the queued and the new requests */
+  void terminate() {
+    {
+      std::lock_guard lock(mutex_);
+      running_ = false;
+    }
+    for (auto& l : lanes_) {
+      l.cv.notify_all();
+    }
+  }
+
+ private:
+  void release(Lane lane) {
+    {
+      std::lock_guard lock(mutex_);
+      lanes_[lane].stats.running--;
+    }
+    lanes_[lane].cv.notify_one();
+  }
+
+  struct LaneState {
+    LaneConfig config;
+    LaneStats stats;
+    std::condition_variable cv;
+  };
+  std::array<LaneState, lanes_num> lanes_;
+  bool running_{true};
+  mutable std::mutex mutex_;
+};
+
+#endif
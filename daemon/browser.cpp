@@ -18,7 +18,10 @@
 //
 
 #include <boost/algorithm/string.hpp>
+#include <cstdio>
+#include <fstream>
 
+#include "json.hpp"
 #include "browser.hpp"
 
 using namespace boost::algorithm;
@@ -36,81 +39,208 @@ std::shared_ptr<Browser> Browser::create(std::shared_ptr<Config> config) {
   return ptr;
 }
 
-std::list<RemoteSource> Browser::get_remote_sources(
+Browser::RemoteSourcesSnapshot Browser::get_remote_sources(
     const std::string& _source) const {
-  std::list<RemoteSource> sources_list;
-  std::shared_lock sources_lock(sources_mutex_);
-  // return list of remote sources ordered by name
-  for (const auto& source : sources_.get<name_tag>()) {
-    if (boost::iequals(source.source, _source) ||
-        boost::iequals("all", _source)) {
-      sources_list.push_back(source);
+  RemoteSourcesSnapshot snapshot;
+  {
+    std::shared_lock sources_lock(sources_mutex_);
+    std::lock_guard snapshot_lock(snapshot_mutex_);
+    if (!snapshot_ || snapshot_seq_ != seq_ ||
+        snapshot_update_ != last_update_) {
+      // return list of remote sources ordered by name
+      const auto& name_idx = sources_.get<name_tag>();
+      snapshot_ = std::make_shared<const std::list<RemoteSource>>(
+          name_idx.begin(), name_idx.end());
+      snapshot_seq_ = seq_;
+      snapshot_update_ = last_update_;
+    }
+    snapshot = snapshot_;
+  }
+  if (boost::iequals("all", _source)) {
+    return snapshot;
+  }
+  // copies only share the SDP and the interned strings
+  auto sources_list = std::make_shared<std::list<RemoteSource>>();
+  for (const auto& source : *snapshot) {
+    if (boost::iequals(source.source.str(), _source)) {
+      sources_list->push_back(source);
     }
   }
   return sources_list;
 }
 
+RemoteSourcesDelta Browser::get_remote_sources_since(
+    uint64_t since,
+    const std::string& _source) const {
+  RemoteSourcesDelta delta;
+  std::shared_lock sources_lock(sources_mutex_);
+  delta.seq = seq_;
+  auto match = [&_source](const InternedString& source) {
+    return boost::iequals(source.str(), _source) ||
+           boost::iequals("all", _source);
+  };
+  if (since < removed_min_seq_ || since > seq_) {
+    // removals are no longer available, return the full list
+    delta.full = true;
+    sources_lock.unlock();
+    delta.sources = *get_remote_sources(_source);
+    return delta;
+  }
+  // sources changed after since in change order
+  auto& seq_idx = sources_.get<seq_tag>();
+  for (auto it = seq_idx.upper_bound(since); it != seq_idx.end(); ++it) {
+    if (match(it->source)) {
+      delta.sources.push_back(*it);
+    }
+  }
+  for (auto it = removed_.rbegin(); it != removed_.rend() && it->seq > since;
+       ++it) {
+    if (match(it->source)) {
+      delta.removed.push_front(it->id);
+    }
+  }
+  return delta;
+}
+
+uint64_t Browser::get_seq() const {
+  std::shared_lock sources_lock(sources_mutex_);
+  return seq_;
+}
+
+std::pair<uint64_t, uint32_t> Browser::get_version() const {
+  std::shared_lock sources_lock(sources_mutex_);
+  return {seq_, last_update_};
+}
+
+bool Browser::wait_for_changes(uint64_t since,
+                               std::chrono::milliseconds timeout) const {
+  std::shared_lock sources_lock(sources_mutex_);
+  return sources_cv_.wait_for(sources_lock, timeout, [this, since]() {
+    return seq_ > since || !running_;
+  });
+}
+
+void Browser::on_remove(const RemoteSource& source) {
+  removed_.push_back({++seq_, source.id, source.source});
+  if (removed_.size() > removed_max) {
+    removed_min_seq_ = removed_.front().seq;
+    removed_.pop_front();
+  }
+}
+
+void Browser::add_update_observer(const UpdateObserver& cb) {
+  std::lock_guard observers_lock(observers_mutex_);
+  update_observers_.push_back(cb);
+}
+
+void Browser::on_update() const {
+  sources_cv_.notify_all();
+  std::lock_guard observers_lock(observers_mutex_);
+  for (const auto& cb : update_observers_) {
+    cb();
+  }
+}
+
+bool Browser::process_sap(const SAP::Message& msg) {
+  BOOST_LOG_TRIVIAL(debug) << "browser:: received SAP message for sap:"
+                           << msg.addr << "-" << msg.msg_id_hash;
+  auto& key_idx = sources_.get<sap_key_tag>();
+  auto it = key_idx.find(get_sap_key(msg.addr, msg.msg_id_hash));
+  if (it == key_idx.end()) {
+    // Source is not in the map
+    if (msg.is_announce) {
+      // annoucement, add new source
+      RemoteSource source{"sap:" + std::to_string(msg.addr) + "-" +
+                              std::to_string(msg.msg_id_hash),
+                          "SAP",
+                          ip::address_v4(ntohl(msg.addr)).to_string(),
+                          sdp_get_subject(msg.sdp),
+                          {},
+                          std::make_shared<RemoteSdp>(msg.sdp),
+                          last_update_,
+                          config_->get_sap_interval()};
+      source.sap_key = get_sap_key(msg.addr, msg.msg_id_hash);
+      source.sdp_crc = crc16(reinterpret_cast<const uint8_t*>(msg.sdp.data()),
+                             msg.sdp.length());
+      source.seq = ++seq_;
+      sources_.insert(std::move(source));
+      return true;
+    }
+    return false;
+  }
+
+  // Source is already in the map
+  if (!msg.is_announce) {
+    BOOST_LOG_TRIVIAL(info) << "browser:: removing SAP source " << it->id
+                            << " name " << it->name;
+    // deletion, remove entry
+    on_remove(*it);
+    key_idx.erase(it);
+    return true;
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "browser:: refreshing SAP source " << it->id;
+  // annoucement, the SDP is parsed again only if it changed
+  auto crc = crc16(reinterpret_cast<const uint8_t*>(msg.sdp.data()),
+                   msg.sdp.length());
+  bool changed =
+      (crc != it->sdp_crc || msg.sdp.length() != it->sdp->text.length());
+  if (it->stale) {
+    BOOST_LOG_TRIVIAL(info) << "browser:: SAP source " << it->id
+                            << " revalidated";
+  }
+  bool updated = changed || it->stale;
+  if (updated || (last_update_ - it->last_seen) != 0) {
+    // a refresh alone is not a change, last_seen is not tracked
+    auto seq = updated ? ++seq_ : it->seq;
+    key_idx.modify(it, [&](RemoteSource& source) {
+      source.seq = seq;
+      if (changed) {
+        BOOST_LOG_TRIVIAL(info)
+            << "browser:: SAP source " << source.id << " SDP changed";
+        source.name = sdp_get_subject(msg.sdp);
+        source.sdp = std::make_shared<RemoteSdp>(msg.sdp);
+        source.sdp_crc = crc;
+      }
+      if (source.stale) {
+        // keep the cached announce period
+        source.stale = false;
+        source.last_seen = last_update_;
+        source.last_seen_timepoint = steady_clock::now();
+      } else if ((last_update_ - source.last_seen) != 0) {
+        // update last seen and announce period
+        source.announce_period = last_update_ - source.last_seen;
+        source.last_seen = last_update_;
+        source.last_seen_timepoint = steady_clock::now();
+      }
+    });
+  }
+  return updated;
+}
+
 bool Browser::worker() {
   sap_.set_multicast_interface(config_->get_ip_addr_str());
   // Join SAP muticast address
   igmp_.join(config_->get_ip_addr_str(), config_->get_sap_mcast_addr());
   auto sap_timepoint = steady_clock::now();
   int sap_interval = 10;
-  auto mdns_timepoint = steady_clock::now();
-  int mdns_interval = 10;
+  auto cache_timepoint = steady_clock::now();
 
+  std::vector<SAP::Message> messages;
   while (running_) {
-    bool is_announce;
-    uint16_t msg_id_hash;
-    uint32_t addr;
-    std::string sdp;
-
-    if (sap_.receive(is_announce, msg_id_hash, addr, sdp)) {
-      std::stringstream ss;
-      ss << "sap:" << addr << "-" << msg_id_hash;
-      std::string id(ss.str());
-      BOOST_LOG_TRIVIAL(debug) << "browser:: received SAP message for " << id;
-
+    auto count = sap_.receive(messages);
+    if (count > 0) {
+      bool changed = false;
       std::unique_lock sources_lock(sources_mutex_);
       last_update_ =
           duration_cast<second_t>(steady_clock::now() - startup_).count();
+      for (size_t i = 0; i < count; i++) {
+        changed |= process_sap(messages[i]);
+      }
+      sources_lock.unlock();
 
-      auto it = sources_.get<id_tag>().find(id);
-      if (it == sources_.end()) {
-        // Source is not in the map
-        if (is_announce) {
-          // annoucement, add new source
-          sources_.insert({id,
-                           "SAP",
-                           ip::address_v4(ntohl(addr)).to_string(),
-                           sdp_get_subject(sdp),
-                           {},
-                           sdp_get_origin(sdp),
-                           sdp,
-                           last_update_,
-                           config_->get_sap_interval()});
-        }
-      } else {
-        // Source is already in the map
-        if (is_announce) {
-          BOOST_LOG_TRIVIAL(debug)
-              << "browser:: refreshing SAP source " << it->id;
-          // annoucement, update last seen and announce period
-          last_update_ =
-              duration_cast<second_t>(steady_clock::now() - startup_).count();
-          auto upd_source{*it};
-          if ((last_update_ - upd_source.last_seen) != 0) {
-            upd_source.announce_period = last_update_ - upd_source.last_seen;
-            upd_source.last_seen = last_update_;
-            upd_source.last_seen_timepoint = steady_clock::now();
-            sources_.replace(it, upd_source);
-          }
-        } else {
-          BOOST_LOG_TRIVIAL(info) << "browser:: removing SAP source " << it->id
-                                  << " name " << it->name;
-          // deletion, remove entry
-          sources_.erase(it);
-        }
+      if (changed) {
+        on_update();
       }
     }
 
@@ -122,27 +252,50 @@ bool Browser::worker() {
       auto offset =
           duration_cast<second_t>(steady_clock::now() - startup_).count();
 
+      bool changed = false;
       std::unique_lock sources_lock(sources_mutex_);
       for (auto it = sources_.begin(); it != sources_.end();) {
-        if (it->source == "SAP" &&
-            (offset - it->last_seen) > (it->announce_period * 10)) {
+        // the age comes from the timepoint, a cached source keeps its age
+        // across restarts, an unknown period is the SAP default one
+        auto age = duration_cast<second_t>(sap_timepoint -
+                                           it->last_seen_timepoint)
+                       .count();
+        auto period =
+            it->announce_period ? it->announce_period : SAP::min_interval;
+        if (it->source == "SAP" && age > period * 10) {
           // remove from remote SAP sources
           BOOST_LOG_TRIVIAL(info)
               << "browser:: SAP source " << it->id << " timeout";
+          on_remove(*it);
           it = sources_.erase(it);
           last_update_ =
               duration_cast<second_t>(steady_clock::now() - startup_).count();
+          changed = true;
+        } else if (it->source == "mDNS" && it->stale &&
+                   offset > mdns_stale_timeout) {
+          BOOST_LOG_TRIVIAL(info)
+              << "browser:: cached RTSP source " << it->id << " not found";
+          on_remove(*it);
+          it = sources_.erase(it);
+          changed = true;
         } else {
           it++;
         }
       }
+      sources_lock.unlock();
+
+      if (changed) {
+        on_update();
+      }
     }
 
-    // check if it's time to process the mDNS RTSP sources
-    if ((duration_cast<second_t>(steady_clock::now() - mdns_timepoint)
-             .count()) > mdns_interval) {
-      mdns_timepoint = steady_clock::now();
-      process_results();
+    // save the cache if the sources changed
+    if (duration_cast<second_t>(steady_clock::now() - cache_timepoint)
+            .count() > cache_save_interval) {
+      cache_timepoint = steady_clock::now();
+      if (get_seq() != cache_seq_) {
+        save_cache();
+      }
     }
   }
 
@@ -164,13 +317,21 @@ void Browser::on_change_rtsp_source(const std::string& name,
       BOOST_LOG_TRIVIAL(info) << "browser:: updating RTSP source " << s.id
                               << " name " << name << " domain " << domain;
       auto upd_source{*it};
+      if (upd_source.id != s.id) {
+        // the old id is no longer valid
+        on_remove(upd_source);
+      }
+      upd_source.seq = ++seq_;
       upd_source.id = s.id;
       upd_source.address = s.address;
-      upd_source.origin = sdp_get_origin(s.sdp);
-      upd_source.sdp = s.sdp;
+      upd_source.port = s.port;
+      upd_source.sdp = std::make_shared<RemoteSdp>(s.sdp);
       upd_source.last_seen = last_update_;
       upd_source.last_seen_timepoint = steady_clock::now();
+      upd_source.stale = false;
       sources_.get<name_tag>().replace(it, upd_source);
+      sources_lock.unlock();
+      on_update();
       return;
     }
     ++rng.first;
@@ -178,8 +339,13 @@ void Browser::on_change_rtsp_source(const std::string& name,
   /* entry not found -> add */
   BOOST_LOG_TRIVIAL(info) << "browser:: adding RTSP source " << s.id << " name "
                           << name << " domain " << domain;
-  sources_.insert({s.id, s.source, s.address, name, domain,
-                   sdp_get_origin(s.sdp), s.sdp, last_update_, 0});
+  RemoteSource source{s.id, s.source, s.address, name, domain,
+                      std::make_shared<RemoteSdp>(s.sdp), last_update_, 0};
+  source.seq = ++seq_;
+  source.port = s.port;
+  sources_.insert(std::move(source));
+  sources_lock.unlock();
+  on_update();
 }
 
 void Browser::on_remove_rtsp_source(const std::string& name,
@@ -193,20 +359,118 @@ void Browser::on_remove_rtsp_source(const std::string& name,
       BOOST_LOG_TRIVIAL(info)
           << "browser:: removing RTSP source " << it->id << " name " << it->name
           << " domain " << it->domain;
+      on_remove(*it);
       name_idx.erase(it);
       last_update_ =
           duration_cast<second_t>(steady_clock::now() - startup_).count();
+      sources_lock.unlock();
+      on_update();
       break;
     }
     ++rng.first;
   }
 }
 
+bool Browser::load_cache() {
+  if (config_->get_browser_cache_file().empty()) {
+    return true;
+  }
+
+  std::ifstream jsonstream(config_->get_browser_cache_file());
+  if (!jsonstream) {
+    BOOST_LOG_TRIVIAL(info) << "browser:: no cache file "
+                            << config_->get_browser_cache_file();
+    return false;
+  }
+
+  std::list<RemoteSource> sources_list;
+  try {
+    json_to_remote_sources_cache(jsonstream, sources_list);
+  } catch (const std::exception& e) {
+    BOOST_LOG_TRIVIAL(error)
+        << "browser:: cannot parse cache file " << e.what();
+    return false;
+  }
+
+  std::unique_lock sources_lock(sources_mutex_);
+  for (auto& source : sources_list) {
+    if (source.source == "SAP" && !source.sap_key) {
+      continue;
+    }
+    // cached sources are stale until they get announced again
+    source.stale = true;
+    // last_seen counts from the startup, older sources are at 0
+    source.last_seen = std::max<int64_t>(
+        duration_cast<second_t>(source.last_seen_timepoint - startup_).count(),
+        0);
+    source.seq = ++seq_;
+    source.sdp_crc =
+        crc16(reinterpret_cast<const uint8_t*>(source.sdp->text.data()),
+              source.sdp->text.length());
+    sources_.insert(std::move(source));
+  }
+  cache_seq_ = seq_;
+  BOOST_LOG_TRIVIAL(info) << "browser:: loaded " << sources_.size()
+                          << " remote sources from cache";
+  return true;
+}
+
+void Browser::describe_cached_sources() {
+  std::shared_lock sources_lock(sources_mutex_);
+  for (const auto& source : sources_) {
+    if (source.source == "mDNS" && source.stale && !source.port.empty()) {
+      BOOST_LOG_TRIVIAL(info) << "browser:: describing cached RTSP source "
+                              << source.id << " name " << source.name;
+      describe_rtsp_source(source.name, source.domain, source.address,
+                           source.port);
+    }
+  }
+}
+
+bool Browser::save_cache() {
+  if (config_->get_browser_cache_file().empty()) {
+    return true;
+  }
+
+  auto seq = get_seq();
+  auto sources = get_remote_sources();
+  // write to a temporary file and replace the cache
+  auto tmp_file = config_->get_browser_cache_file() + ".tmp";
+  {
+    std::ofstream jsonstream(tmp_file);
+    if (!jsonstream) {
+      BOOST_LOG_TRIVIAL(error)
+          << "browser:: cannot save to cache file " << tmp_file;
+      return false;
+    }
+    jsonstream << remote_sources_cache_to_json(*sources);
+    if (!jsonstream) {
+      BOOST_LOG_TRIVIAL(error)
+          << "browser:: cannot save to cache file " << tmp_file;
+      return false;
+    }
+  }
+  if (std::rename(tmp_file.c_str(),
+                  config_->get_browser_cache_file().c_str())) {
+    BOOST_LOG_TRIVIAL(error) << "browser:: cannot save to cache file "
+                             << config_->get_browser_cache_file();
+    return false;
+  }
+  cache_seq_ = seq;
+  BOOST_LOG_TRIVIAL(debug) << "browser:: cache file saved with "
+                           << sources->size() << " remote sources";
+  return true;
+}
+
 bool Browser::init() {
   if (!running_) {
+    load_cache();
     /* init mDNS client */
-    if (config_->get_mdns_enabled() && !MDNSClient::init()) {
-      return false;
+    if (config_->get_mdns_enabled()) {
+      if (!MDNSClient::init()) {
+        return false;
+      }
+      describe_cached_sources();
     }
     running_ = true;
     res_ = std::async(std::launch::async, &Browser::worker, this);
@@ -217,9 +481,15 @@ bool Browser::init() {
 
 bool Browser::terminate() {
   if (running_) {
-    running_ = false;
+    {
+      std::unique_lock sources_lock(sources_mutex_);
+      running_ = false;
+    }
+    /* wake up the threads waiting for changes */
+    sources_cv_.notify_all();
     /* wait for worker to exit */
     res_.get();
+    save_cache();
     /* terminate mDNS client */
     if (config_->get_mdns_enabled()) {
       MDNSClient::terminate();
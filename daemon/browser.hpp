@@ -26,13 +26,18 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <future>
+#include <functional>
 #include <list>
+#include <mutex>
 #include <shared_mutex>
 #include <thread>
 
 #include "config.hpp"
 #include "igmp.hpp"
+#include "interned_string.hpp"
 #include "mdns_client.hpp"
 #include "sap.hpp"
 #include "utils.hpp"
@@ -40,21 +45,48 @@
 using namespace boost::multi_index;
 using namespace std::chrono;
 
+/* SDP of a remote source, shared by all the copies of the source */
+struct RemoteSdp {
+  explicit RemoteSdp(const std::string& sdp)
+      : text(sdp), origin(sdp_get_origin(sdp)) {}
+  const std::string text;
+  const SDPOrigin origin;
+};
+
 struct RemoteSource {
   std::string id;
-  std::string source;
-  std::string address;
+  InternedString source;
+  InternedString address;
   std::string name;
-  std::string domain; /* mDNS only */
-  SDPOrigin origin;
-  std::string sdp;
+  InternedString domain; /* mDNS only */
+  std::shared_ptr<const RemoteSdp> sdp;
   uint32_t last_seen{0};       /* seconds from daemon startup */
   uint32_t announce_period{0}; /* period between annoucements */
   time_point<steady_clock> last_seen_timepoint{steady_clock::now()};
+  uint64_t sap_key{0};  /* SAP only, see Browser::get_sap_key() */
+  uint16_t sdp_crc{0};  /* SAP only */
+  uint64_t seq{0};      /* change sequence of the last add or update */
+  bool stale{false};    /* loaded from cache, not announced yet */
+  std::string port;     /* mDNS only, RTSP port to describe it again */
+};
+
+/* changes of the remote sources after a given change sequence */
+struct RemoteSourcesDelta {
+  uint64_t seq{0};   /* current change sequence */
+  bool full{false};  /* sources is the full list, removed is empty */
+  std::list<RemoteSource> sources; /* sources added or updated */
+  std::list<std::string> removed;  /* ids of the sources removed */
 };
 
 class Browser : public MDNSClient {
  public:
+  /* removed sources remembered to build the deltas */
+  constexpr static size_t removed_max = 4096;
+  /* min interval between two saves of the cache file */
+  constexpr static uint32_t cache_save_interval = 10;  // sec
+  /* cached mDNS sources not resolved again are removed after this time */
+  constexpr static uint32_t mdns_stale_timeout = 120;  // sec
+
   static std::shared_ptr<Browser> create(std::shared_ptr<Config> config);
   Browser() = delete;
   Browser(const Browser&) = delete;
@@ -64,14 +96,47 @@ class Browser : public MDNSClient {
   bool terminate() override;
   uint32_t get_last_update_ts() const { return last_update_; }
 
-  std::list<RemoteSource> get_remote_sources(
+  /* remote sources ordered by name, the list is shared and never modified */
+  using RemoteSourcesSnapshot = std::shared_ptr<const std::list<RemoteSource>>;
+  RemoteSourcesSnapshot get_remote_sources(
+      const std::string& source = "all") const;
+
+  /* sources added, updated and removed after change sequence since */
+  RemoteSourcesDelta get_remote_sources_since(
+      uint64_t since,
       const std::string& source = "all") const;
+  uint64_t get_seq() const;
+  /* version of the remote sources list, it changes with the sources and
+   * with their refresh, read it before the list */
+  std::pair<uint64_t /* seq */, uint32_t /* last update */> get_version()
+      const;
+  /* wait until the change sequence moves past since or timeout expires,
+   * returns false on timeout */
+  bool wait_for_changes(uint64_t since,
+                        std::chrono::milliseconds timeout) const;
+
+  /* called from the browser threads when a remote source changes */
+  using UpdateObserver = std::function<void()>;
+  void add_update_observer(const UpdateObserver& cb);
 
  protected:
   // singleton, use create() to build
   explicit Browser(std::shared_ptr<Config> config) : MDNSClient(config){};
 
   bool worker();
+  void on_update() const;
+  /* called with sources_mutex_ held */
+  void on_remove(const RemoteSource& source);
+  bool load_cache();
+  bool save_cache();
+  /* describe the cached mDNS sources again instead of waiting for mDNS */
+  void describe_cached_sources();
+  /* called with sources_mutex_ held, returns true if sources changed */
+  bool process_sap(const SAP::Message& msg);
+  /* (addr, msg_id_hash) packed in a key that is never 0 */
+  static uint64_t get_sap_key(uint32_t addr, uint16_t msg_id_hash) {
+    return (uint64_t{1} << 48) | (uint64_t{addr} << 16) | msg_id_hash;
+  }
 
   void on_change_rtsp_source(const std::string& name,
                              const std::string& domain,
@@ -92,17 +157,50 @@ class Browser : public MDNSClient {
   using by_name = ordered_non_unique<
       tag<name_tag>,
       member<RemoteSource, std::string, &RemoteSource::name>>;
+  struct sap_key_tag {};
+  using by_sap_key = hashed_non_unique<
+      tag<sap_key_tag>,
+      member<RemoteSource, uint64_t, &RemoteSource::sap_key>>;
+  struct seq_tag {};
+  using by_seq =
+      ordered_non_unique<tag<seq_tag>,
+                         member<RemoteSource, uint64_t, &RemoteSource::seq>>;
   using sources_t =
-      multi_index_container<RemoteSource, indexed_by<by_id, by_name>>;
+      multi_index_container<RemoteSource,
+                            indexed_by<by_id, by_name, by_sap_key, by_seq>>;
 
   sources_t sources_;
   mutable std::shared_mutex sources_mutex_;
+  mutable std::condition_variable_any sources_cv_;
+
+  /* change sequence, incremented on every add, update and remove */
+  uint64_t seq_{0};
+  struct RemovedSource {
+    uint64_t seq;
+    std::string id;
+    InternedString source;
+  };
+  std::deque<RemovedSource> removed_;
+  /* deltas since a sequence lower than this cannot be built */
+  uint64_t removed_min_seq_{0};
+
+  /* snapshot of all the sources, rebuilt after a change or a refresh */
+  mutable RemoteSourcesSnapshot snapshot_;
+  mutable uint64_t snapshot_seq_{0};
+  mutable uint32_t snapshot_update_{0};
+  mutable std::mutex snapshot_mutex_;
+
+  /* change sequence of the last cache save */
+  uint64_t cache_seq_{0};
 
   SAP sap_{config_->get_sap_mcast_addr()};
   IGMP igmp_;
   std::chrono::time_point<std::chrono::steady_clock> startup_{
       std::chrono::steady_clock::now()};
   uint32_t last_update_{0}; /* seconds from daemon startup */
+
+  std::list<UpdateObserver> update_observers_;
+  mutable std::mutex observers_mutex_;
 };
 
 #endif
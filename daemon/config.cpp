@@ -70,6 +70,18 @@ std::shared_ptr<Config> Config::parse(const std::string& filename,
     config.max_tic_frame_size_ = 1024;
   if (config.sample_rate_ == 0)
     config.sample_rate_ = 48000;
+  if (config.rtsp_threads_ < 1 || config.rtsp_threads_ > 16)
+    config.rtsp_threads_ = 2;
+  if (config.http_control_threads_ < 1 || config.http_control_threads_ > 64)
+    config.http_control_threads_ = 2;
+  if (config.http_control_queue_ > 256)
+    config.http_control_queue_ = 8;
+  if (config.http_read_threads_ < 1 || config.http_read_threads_ > 64)
+    config.http_read_threads_ = 4;
+  if (config.http_read_queue_ > 256)
+    config.http_read_queue_ = 16;
+  if (config.http_stream_threads_ < 1 || config.http_stream_threads_ > 64)
+    config.http_stream_threads_ = 16;
   if (config.streamer_channels_ < 2 || config.streamer_channels_ > 16)
     config.streamer_channels_ = 8;
   if (config.streamer_file_duration_ < 1 || config.streamer_file_duration_ > 4)
@@ -168,13 +180,21 @@ bool Config::save(const Config& config) {
     daemon_restart_ =
         driver_restart_ || get_http_port() != config.get_http_port() ||
         get_rtsp_port() != config.get_rtsp_port() ||
+        get_rtsp_threads() != config.get_rtsp_threads() ||
         get_http_base_dir() != config.get_http_base_dir() ||
+        get_http_unix_socket() != config.get_http_unix_socket() ||
+        get_http_control_threads() != config.get_http_control_threads() ||
+        get_http_control_queue() != config.get_http_control_queue() ||
+        get_http_read_threads() != config.get_http_read_threads() ||
+        get_http_read_queue() != config.get_http_read_queue() ||
+        get_http_stream_threads() != config.get_http_stream_threads() ||
         get_rtp_mcast_base() != config.get_rtp_mcast_base() ||
         get_rtp_mcast_base_sec() != config.get_rtp_mcast_base_sec() ||
         get_sap_mcast_addr() != config.get_sap_mcast_addr() ||
         get_rtp_port() != config.get_rtp_port() ||
         get_rtp_port_sec() != config.get_rtp_port_sec() ||
         get_status_file() != config.get_status_file() ||
+        get_browser_cache_file() != config.get_browser_cache_file() ||
         get_mdns_enabled() != config.get_mdns_enabled() ||
         get_custom_node_id() != config.get_custom_node_id() ||
         get_streamer_channels() != config.get_streamer_channels() ||
@@ -189,8 +209,12 @@ bool Config::save(const Config& config) {
         get_nmos_node_port() != config.get_nmos_node_port() ||
         get_nmos_label() != config.get_nmos_label();
 
-    if (!daemon_restart_)
+    if (!daemon_restart_) {
+      auto version = version_;
       *this = config;
+      version_ = version;
+    }
+    version_++;
 
     BOOST_LOG_TRIVIAL(info) << "Config:: file saved";
   } else {
@@ -215,7 +239,7 @@ bool Config::get_streamer_enabled() const {
 }
 
 bool Config::get_mdns_enabled() const {
-#ifndef _USE_AVAHI_
+#if !defined(_USE_AVAHI_) && !defined(_USE_MDNS_BUILTIN_)
   return false;
 #endif
   return mdns_enabled_;
@@ -26,6 +26,10 @@
 
 class Config {
  public:
+  /* SAP bandwidth limits below the minimum fall back to the RFC 2974 one */
+  constexpr static uint32_t sap_bandwidth_limit_min = 80;
+  constexpr static uint32_t sap_bandwidth_limit_default = 4000;
+
   /* save new config to json file */
   bool save(const Config& config);
   /* build config from json file */
@@ -36,7 +40,16 @@ class Config {
   const std::string& get_http_addr_str() const { return http_addr_str_; };
   uint16_t get_http_port() const { return http_port_; };
   uint16_t get_rtsp_port() const { return rtsp_port_; };
+  uint8_t get_rtsp_threads() const { return rtsp_threads_; };
   const std::string& get_http_base_dir() const { return http_base_dir_; };
+  const std::string& get_http_unix_socket() const {
+    return http_unix_socket_;
+  };
+  uint16_t get_http_control_threads() const { return http_control_threads_; };
+  uint16_t get_http_control_queue() const { return http_control_queue_; };
+  uint16_t get_http_read_threads() const { return http_read_threads_; };
+  uint16_t get_http_read_queue() const { return http_read_queue_; };
+  uint16_t get_http_stream_threads() const { return http_stream_threads_; };
   uint8_t get_streamer_files_num() const { return streamer_files_num_; };
   uint16_t get_streamer_file_duration() const {
     return streamer_file_duration_;
@@ -61,9 +74,14 @@ class Config {
   uint8_t get_ptp_domain() const { return ptp_domain_; };
   uint8_t get_ptp_dscp() const { return ptp_dscp_; };
   uint16_t get_sap_interval() const { return sap_interval_; };
+  bool get_sap_compression() const { return sap_compression_; };
+  uint32_t get_sap_bandwidth_limit() const { return sap_bandwidth_limit_; };
   const std::string& get_syslog_proto() const { return syslog_proto_; };
   const std::string& get_syslog_server() const { return syslog_server_; };
   const std::string& get_status_file() const { return status_file_; };
+  const std::string& get_browser_cache_file() const {
+    return browser_cache_file_;
+  };
   const std::string& get_interface_name() const { return interface_name_; };
   const std::string& get_interface_name(uint8_t idx) const {
     static const std::string empty = "";
@@ -88,6 +106,8 @@ class Config {
   int get_interface_idx() const { return interface_idx_; };
   bool get_daemon_restart() const { return daemon_restart_; };
   bool get_driver_restart() const { return driver_restart_; };
+  /* incremented every time a new config is saved */
+  uint64_t get_version() const { return version_; };
   bool get_mdns_enabled() const;
   const std::string& get_ptp_status_script() const {
     return ptp_status_script_;
@@ -98,6 +118,23 @@ class Config {
   };
   void set_http_port(uint16_t http_port) { http_port_ = http_port; };
   void set_rtsp_port(uint16_t rtsp_port) { rtsp_port_ = rtsp_port; };
+  void set_http_unix_socket(std::string_view http_unix_socket) {
+    http_unix_socket_ = http_unix_socket;
+  };
+  void set_http_control_threads(uint16_t threads) {
+    http_control_threads_ = threads;
+  };
+  void set_http_control_queue(uint16_t queue) { http_control_queue_ = queue; };
+  void set_http_read_threads(uint16_t threads) {
+    http_read_threads_ = threads;
+  };
+  void set_http_read_queue(uint16_t queue) { http_read_queue_ = queue; };
+  void set_http_stream_threads(uint16_t threads) {
+    http_stream_threads_ = threads;
+  };
+  void set_rtsp_threads(uint8_t rtsp_threads) {
+    rtsp_threads_ = rtsp_threads;
+  };
   void set_http_base_dir(std::string_view http_base_dir) {
     http_base_dir_ = http_base_dir;
   };
@@ -146,6 +183,14 @@ class Config {
   void set_sap_interval(uint16_t sap_interval) {
     sap_interval_ = sap_interval;
   };
+  void set_sap_compression(bool sap_compression) {
+    sap_compression_ = sap_compression;
+  };
+  void set_sap_bandwidth_limit(uint32_t sap_bandwidth_limit) {
+    sap_bandwidth_limit_ = sap_bandwidth_limit < sap_bandwidth_limit_min
+                               ? sap_bandwidth_limit_default
+                               : sap_bandwidth_limit;
+  };
   void set_syslog_proto(std::string_view syslog_proto) {
     syslog_proto_ = syslog_proto;
   };
@@ -155,6 +200,9 @@ class Config {
   void set_status_file(std::string_view status_file) {
     status_file_ = status_file;
   };
+  void set_browser_cache_file(std::string_view browser_cache_file) {
+    browser_cache_file_ = browser_cache_file;
+  };
   void set_interface_name(std::string_view interface_name) {
     interface_name_ = interface_name;
   };
@@ -187,7 +235,14 @@ class Config {
     return lhs.get_http_addr_str() != rhs.get_http_addr_str() ||
            lhs.get_http_port() != rhs.get_http_port() ||
            lhs.get_rtsp_port() != rhs.get_rtsp_port() ||
+           lhs.get_rtsp_threads() != rhs.get_rtsp_threads() ||
            lhs.get_http_base_dir() != rhs.get_http_base_dir() ||
+           lhs.get_http_unix_socket() != rhs.get_http_unix_socket() ||
+           lhs.get_http_control_threads() != rhs.get_http_control_threads() ||
+           lhs.get_http_control_queue() != rhs.get_http_control_queue() ||
+           lhs.get_http_read_threads() != rhs.get_http_read_threads() ||
+           lhs.get_http_read_queue() != rhs.get_http_read_queue() ||
+           lhs.get_http_stream_threads() != rhs.get_http_stream_threads() ||
            lhs.get_streamer_channels() != rhs.get_streamer_channels() ||
            lhs.get_streamer_files_num() != rhs.get_streamer_files_num() ||
            lhs.get_streamer_file_duration() !=
@@ -208,9 +263,12 @@ class Config {
            lhs.get_ptp_domain() != rhs.get_ptp_domain() ||
            lhs.get_ptp_dscp() != rhs.get_ptp_dscp() ||
            lhs.get_sap_interval() != rhs.get_sap_interval() ||
+           lhs.get_sap_compression() != rhs.get_sap_compression() ||
+           lhs.get_sap_bandwidth_limit() != rhs.get_sap_bandwidth_limit() ||
            lhs.get_syslog_proto() != rhs.get_syslog_proto() ||
            lhs.get_syslog_server() != rhs.get_syslog_server() ||
            lhs.get_status_file() != rhs.get_status_file() ||
+           lhs.get_browser_cache_file() != rhs.get_browser_cache_file() ||
            lhs.get_interface_name() != rhs.get_interface_name() ||
            lhs.get_mdns_enabled() != rhs.get_mdns_enabled() ||
            lhs.get_auto_sinks_update() != rhs.get_auto_sinks_update() ||
@@ -230,7 +288,14 @@ class Config {
   std::string http_addr_str_{""};
   uint16_t http_port_{8080};
   uint16_t rtsp_port_{8854};
+  uint8_t rtsp_threads_{2};
   std::string http_base_dir_{"../webui/dist"};
+  std::string http_unix_socket_{""};
+  uint16_t http_control_threads_{2};
+  uint16_t http_control_queue_{8};
+  uint16_t http_read_threads_{4};
+  uint16_t http_read_queue_{16};
+  uint16_t http_stream_threads_{16};
   uint8_t streamer_channels_{8};
   uint8_t streamer_files_num_{8};
   uint16_t streamer_file_duration_{1};
@@ -249,9 +314,12 @@ class Config {
   uint8_t ptp_domain_{0};
   uint8_t ptp_dscp_{46};
   uint16_t sap_interval_{300};
+  bool sap_compression_{false};
+  uint32_t sap_bandwidth_limit_{sap_bandwidth_limit_default}; /* bits per sec */
   std::string syslog_proto_{""};
   std::string syslog_server_{""};
   std::string status_file_{"./status.json"};
+  std::string browser_cache_file_{"./browser_cache.json"};
   std::string interface_name_{"eth0"};
   std::vector<std::string> interfaces_;
   bool mdns_enabled_{true};
@@ -278,6 +346,7 @@ class Config {
   bool driver_restart_{true};
   /* reconfig needs daemon restart */
   bool daemon_restart_{false};
+  uint64_t version_{0};
 };
 
 #endif
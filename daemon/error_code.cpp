@@ -123,6 +123,8 @@ std::string DaemonErrCategory::message(int ev) const {
       return "not enough samples buffered, retry later";
     case DaemonErrc::streamer_not_running:
       return "not running, check PTP lock";
+    case DaemonErrc::sink_sdp_pending:
+      return "SDP fetch in progress, sink added on completion";
     default:
       return "(unrecognized daemon error)";
   }
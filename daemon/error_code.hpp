@@ -56,6 +56,7 @@ enum class DaemonErrc {
   streamer_invalid_ch = 48,   // daemon streamer sink channel not captured
   streamer_retry_later = 49,  // daemon streamer not enough samples buffered
   streamer_not_running = 50,  // daemon streamer not running
+  sink_sdp_pending = 51,      // daemon sink added once its SDP is fetched
   send_invalid_size = 60,     // daemon data size too big for buffer
   send_u2k_failed = 61,       // daemon failed to send command to driver
   send_k2u_failed = 62,       // daemon failed to send event response to driver
@@ -0,0 +1,129 @@
+//
+//  event_log.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _EVENT_LOG_HPP_
+#define _EVENT_LOG_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Bounded log of the latest change events pushed to the event stream
+ * clients. Every event gets the next sequence number so a client that
+ * reconnects can resume after the last event it received, as long as the
+ * event is still in the log.
+ */
+class EventLog {
+ public:
+  constexpr static size_t events_max = 1024;
+
+  struct Event {
+    uint64_t seq;
+    std::string type;
+    std::string data;
+  };
+
+  EventLog() = default;
+  EventLog(const EventLog&) = delete;
+  EventLog& operator=(const EventLog&) = delete;
+
+  /* append the event and wake up the waiting clients */
+  uint64_t publish(const std::string& type, std::string data) {
+    uint64_t seq;
+    {
+      std::lock_guard lock(mutex_);
+      seq = ++seq_;
+      events_.push_back({seq, type, std::move(data)});
+      if (events_.size() > events_max) {
+        events_.pop_front();
+      }
+    }
+    cv_.notify_all();
+    return seq;
+  }
+
+  /* wait up to timeout for the events after sequence since and append them
+   * to events, returns false if some of them are no longer in the log */
+  bool wait(uint64_t since,
+            std::chrono::milliseconds timeout,
+            std::vector<Event>& events) const {
+    std::unique_lock lock(mutex_);
+    cv_.wait_for(lock, timeout,
+                 [this, since]() { return seq_ > since || !running_; });
+    if (since > seq_ ||
+        (!events_.empty() && events_.front().seq > since + 1)) {
+      return false;
+    }
+    // events are sorted by sequence, skip the ones already sent
+    auto it = events_.end() - (seq_ - since);
+    events.insert(events.end(), it, events_.end());
+    return true;
+  }
+
+  uint64_t get_seq() const {
+    std::lock_guard lock(mutex_);
+    return seq_;
+  }
+
+  /* a stream client connected, returns the number of subscribers */
+  size_t subscribe() {
+    std::lock_guard lock(mutex_);
+    return ++subscribers_;
+  }
+
+  /* a stream client disconnected, returns the number of subscribers */
+  size_t unsubscribe() {
+    std::lock_guard lock(mutex_);
+    return subscribers_ > 0 ? --subscribers_ : 0;
+  }
+
+  size_t get_subscribers() const {
+    std::lock_guard lock(mutex_);
+    return subscribers_;
+  }
+
+  bool is_running() const {
+    std::lock_guard lock(mutex_);
+    return running_;
+  }
+
+  /* wake up the waiting clients, wait() returns immediately after this */
+  void terminate() {
+    {
+      std::lock_guard lock(mutex_);
+      running_ = false;
+    }
+    cv_.notify_all();
+  }
+
+ private:
+  std::deque<Event> events_;
+  uint64_t seq_{0};
+  size_t subscribers_{0};
+  bool running_{true};
+  mutable std::mutex mutex_;
+  mutable std::condition_variable cv_;
+};
+
+#endif
@@ -19,11 +19,15 @@
 
 #define BOOST_BIND_GLOBAL_PLACEHOLDERS
 
+#include <boost/algorithm/string.hpp>
 #include <boost/foreach.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
+#include <cerrno>
 #include <iostream>
 #include <string>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "main.hpp"
 #include "json.hpp"
@@ -37,7 +41,9 @@ static inline void set_headers(Response& res,
   res.set_header("Access-Control-Allow-Methods",
                  "GET, POST, PUT, DELETE, OPTIONS");
   res.set_header("Access-Control-Allow-Origin", "*");
-  res.set_header("Access-Control-Allow-Headers", "x-user-id");
+  res.set_header("Access-Control-Allow-Headers",
+                 "x-user-id, If-None-Match, Last-Event-ID");
+  res.set_header("Access-Control-Expose-Headers", "ETag");
   if (!content_type.empty()) {
     res.set_header("Content-Type", content_type);
   }
@@ -79,41 +85,301 @@ static inline void set_error(int status,
   res.body = message;
 }
 
-bool HttpServer::init() {
-  /* setup http operations */
-  if (!svr_.is_valid()) {
+/* check the ETag against the If-None-Match list of entity tags */
+static bool etag_matches(const std::string& if_none_match,
+                         const std::string& etag) {
+  size_t pos = 0;
+  while (pos < if_none_match.length()) {
+    auto end = if_none_match.find(',', pos);
+    if (end == std::string::npos) {
+      end = if_none_match.length();
+    }
+    auto tag = if_none_match.substr(pos, end - pos);
+    boost::trim(tag);
+    // weak comparison, see RFC 7232 section 3.2
+    if (boost::starts_with(tag, "W/")) {
+      tag.erase(0, 2);
+    }
+    if (tag == etag || tag == "*") {
+      return true;
+    }
+    pos = end + 1;
+  }
+  return false;
+}
+
+void HttpServer::send_cached(const Request& req,
+                             Response& res,
+                             const std::string& resource,
+                             const std::string& version,
+                             const std::function<std::string()>& serialize) {
+  auto etag = "\"" + etag_prefix_ + "-" + version + "\"";
+  set_headers(res, "application/json");
+  res.set_header("ETag", etag);
+  res.set_header("Cache-Control", "no-cache");
+  std::shared_ptr<const std::string> body;
+  std::chrono::steady_clock::time_point timepoint;
+  {
+    std::lock_guard lock(cache_mutex_);
+    auto& cached = cache_[resource];
+    if (cached.etag == etag) {
+      body = cached.body;
+      timepoint = cached.timepoint;
+    }
+  }
+  /* a cached body reports its Age, so a client can tell how old the
+   * time dependent values of the body are, see remote sources */
+  auto set_age = [&res, &body, &timepoint]() {
+    if (body) {
+      res.set_header(
+          "Age", std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+                                    std::chrono::steady_clock::now() - timepoint)
+                                    .count()));
+    }
+  };
+  if (req.has_header("If-None-Match") &&
+      etag_matches(req.get_header_value("If-None-Match"), etag)) {
+    set_age();
+    res.status = 304;
+    return;
+  }
+  if (!body) {
+    body = std::make_shared<const std::string>(serialize());
+    std::lock_guard lock(cache_mutex_);
+    cache_[resource] = {etag, body, std::chrono::steady_clock::now()};
+  } else {
+    set_age();
+  }
+  res.body = *body;
+}
+
+void HttpServer::send_asset(const Request& req,
+                            Response& res,
+                            const std::string& path) {
+  auto asset = assets_.find(path);
+  if (asset == nullptr) {
+    set_error(404, "file " + path + " not found", res);
+    return;
+  }
+  auto encoding =
+      WebAssets::select(*asset, req.get_header_value("Accept-Encoding"));
+  // every variant has its own entity tag
+  auto etag = asset->etag;
+  if (encoding != WebAssets::identity) {
+    etag.insert(etag.length() - 1,
+                std::string("-") + WebAssets::get_encoding_name(encoding));
+  }
+  res.set_header("ETag", etag);
+  res.set_header("Vary", "Accept-Encoding");
+  /* hashed bundles never change, the others are revalidated */
+  res.set_header("Cache-Control", asset->immutable
+                                      ? "public, max-age=31536000, immutable"
+                                      : "no-cache");
+  if (req.has_header("If-None-Match") &&
+      etag_matches(req.get_header_value("If-None-Match"), etag)) {
+    res.status = 304;
+    return;
+  }
+  if (encoding != WebAssets::identity) {
+    res.set_header("Content-Encoding", WebAssets::get_encoding_name(encoding));
+  }
+  /* the body is written from the shared buffer without copies */
+  auto body = asset->body[encoding];
+  res.set_content_provider(
+      body->size(), asset->content_type,
+      [body](size_t offset, size_t length, DataSink& sink) {
+        return sink.write(body->data() + offset, length);
+      });
+}
+
+bool HttpServer::parse_event_id(const std::string& id, uint64_t& seq) const {
+  auto pos = id.rfind('-');
+  if (pos == std::string::npos || id.compare(0, pos, etag_prefix_)) {
     return false;
   }
+  try {
+    seq = std::stoull(id.substr(pos + 1));
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
+
+void HttpServer::write_event(std::string& out,
+                             uint64_t seq,
+                             const std::string& type,
+                             const std::string& data) const {
+  out += "id: " + etag_prefix_ + "-" + std::to_string(seq) + "\n";
+  out += "event: " + type + "\n";
+  // a data field cannot span multiple lines
+  size_t pos = 0;
+  while (pos < data.length()) {
+    auto end = data.find('\n', pos);
+    if (end == std::string::npos) {
+      end = data.length();
+    }
+    if (end > pos) {
+      out += "data: ";
+      out.append(data, pos, end - pos);
+      out += "\n";
+    }
+    pos = end + 1;
+  }
+  out += "\n";
+}
+
+void HttpServer::add_events_observers() {
+  using SourceObserverType = SessionManager::SourceObserverType;
+  using SinkObserverType = SessionManager::SinkObserverType;
+
+  session_manager_->add_ptp_status_observer(
+      [this](const std::string&) {
+        PTPStatus status;
+        session_manager_->get_ptp_status(status);
+        events_.publish("ptp", ptp_status_to_json(status));
+        return true;
+      },
+      "http_server");
+
+  for (auto [type, action] :
+       {std::make_pair(SourceObserverType::add_source, "add"),
+        std::make_pair(SourceObserverType::remove_source, "remove"),
+        std::make_pair(SourceObserverType::update_source, "update")}) {
+    session_manager_->add_source_observer(
+        type, [this, action = std::string(action)](
+                  uint16_t id, const std::string& name, const std::string&) {
+          events_.publish("source", stream_event_to_json(action, id, name));
+          return true;
+        },
+        "http_server");
+  }
+
+  for (auto [type, action] :
+       {std::make_pair(SinkObserverType::add_sink, "add"),
+        std::make_pair(SinkObserverType::remove_sink, "remove")}) {
+    session_manager_->add_sink_observer(
+        type, [this, action = std::string(action)](uint16_t id,
+                                                   const std::string& name) {
+          events_.publish("sink", stream_event_to_json(action, id, name));
+          return true;
+        },
+        "http_server");
+  }
+
+  /* the sinks status is polled only while event stream clients are
+   * connected, the poll is started by the first client */
+  session_manager_->add_sink_status_observer(
+      [this](uint16_t id, const SinkStreamStatus& status) {
+        events_.publish("sink_status", sink_status_event_to_json(id, status));
+        return true;
+      },
+      [this]() { return events_.get_subscribers() > 0; },
+      "http_server");
+
+  browser_->add_update_observer([this]() {
+    /* publish one event per change sequence, the client fetches the
+     * delta with /api/browse/sources?since= */
+    auto seq = browser_->get_seq();
+    if (browser_seq_.exchange(seq) != seq) {
+      events_.publish("browser", seq_event_to_json(seq));
+    }
+  });
+}
+
+static inline void set_shed(AdmissionControl::Lane lane, Response& res) {
+  set_error(503,
+            std::string("too many requests in lane ") +
+                AdmissionControl::get_lane_name(lane),
+            res);
+  res.set_header("Retry-After", "1");
+  /* the client reconnects, the connection doesn't hold a server thread
+   * while the lane is busy */
+  res.set_header("Connection", "close");
+}
+
+/* registers the handlers of a lane, every request is admitted to the lane
+ * before running the handler and shed with 503 if the lane is busy */
+class LaneRouter {
+ public:
+  /* the streaming handlers keep the ticket until the response is sent */
+  using StreamHandler = std::function<
+      void(const Request&, Response&, const AdmissionControl::Ticket&)>;
+
+  LaneRouter(Server& svr, AdmissionControl& admission,
+             AdmissionControl::Lane lane)
+      : svr_(svr), admission_(admission), lane_(lane) {}
+
+  void Get(const char* pattern, Server::Handler handler) {
+    svr_.Get(pattern, wrap(std::move(handler)));
+  }
+  void Get(const char* pattern, StreamHandler handler) {
+    svr_.Get(pattern, wrap(std::move(handler)));
+  }
+  void Post(const char* pattern, Server::Handler handler) {
+    svr_.Post(pattern, wrap(std::move(handler)));
+  }
+  void Put(const char* pattern, Server::Handler handler) {
+    svr_.Put(pattern, wrap(std::move(handler)));
+  }
+  void Delete(const char* pattern, Server::Handler handler) {
+    svr_.Delete(pattern, wrap(std::move(handler)));
+  }
+
+ private:
+  Server::Handler wrap(Server::Handler handler) const {
+    return wrap(StreamHandler(
+        [handler = std::move(handler)](const Request& req, Response& res,
+                                       const AdmissionControl::Ticket&) {
+          handler(req, res);
+        }));
+  }
+  Server::Handler wrap(StreamHandler handler) const {
+    return [&admission = admission_, lane = lane_,
+            handler = std::move(handler)](const Request& req, Response& res) {
+      auto ticket = admission.admit(lane);
+      if (!ticket) {
+        set_shed(lane, res);
+        return;
+      }
+      handler(req, res, ticket);
+    };
+  }
+
+  Server& svr_;
+  AdmissionControl& admission_;
+  AdmissionControl::Lane lane_;
+};
 
-  svr_.set_mount_point("/", config_->get_http_base_dir().c_str());
+void HttpServer::add_routes(Server& svr, AdmissionControl& admission) {
+  LaneRouter control(svr, admission, AdmissionControl::control);
+  LaneRouter read(svr, admission, AdmissionControl::read);
+  LaneRouter stream(svr, admission, AdmissionControl::stream);
 
-  svr_.Get("(/|/Config|/PTP|/Sources|/Sinks|/Browser)",
-           [&](const Request& req, Response& res) {
-             std::ifstream file(config_->get_http_base_dir() + "/index.html");
-             std::stringstream buffer;
-             buffer << file.rdbuf();
-             res.set_content(buffer.str(), "text/html");
+  /* the web UI routes are served by the app shell */
+  read.Get("(/|/Config|/PTP|/Sources|/Sinks|/Browser)",
+           [this](const Request& req, Response& res) {
+             send_asset(req, res, "/index.html");
            });
 
   /* allows cross-origin */
-  svr_.Options("/api/(.*?)", [&](const Request& /*req*/, Response& res) {
+  svr.Options("/api/(.*?)", [&](const Request& /*req*/, Response& res) {
     set_headers(res);
   });
 
   /* get version */
-  svr_.Get("/api/version", [&](const Request& req, Response& res) {
+  read.Get("/api/version", [&](const Request& req, Response& res) {
     set_headers(res, "application/json");
     res.body = "{ \"version\": \"" + get_version() + "\" }";
   });
 
   /* get config */
-  svr_.Get("/api/config", [&](const Request& req, Response& res) {
-    set_headers(res, "application/json");
-    res.body = config_to_json(*config_);
+  read.Get("/api/config", [&](const Request& req, Response& res) {
+    send_cached(req, res, "config", std::to_string(config_->get_version()),
+                [this]() { return config_to_json(*config_); });
   });
 
   /* set config */
-  svr_.Post("/api/config", [this](const Request& req, Response& res) {
+  control.Post("/api/config", [this](const Request& req, Response& res) {
     try {
       Config config = json_to_config(req.body, *config_);
 
@@ -151,7 +417,7 @@ bool HttpServer::init() {
   });
 
   /* get ptp status */
-  svr_.Get("/api/ptp/status", [this](const Request& req, Response& res) {
+  read.Get("/api/ptp/status", [this](const Request& req, Response& res) {
     PTPStatus status;
     session_manager_->get_ptp_status(status);
     set_headers(res, "application/json");
@@ -159,15 +425,17 @@ bool HttpServer::init() {
   });
 
   /* get ptp config */
-  svr_.Get("/api/ptp/config", [this](const Request& req, Response& res) {
-    PTPConfig ptpConfig;
-    session_manager_->get_ptp_config(ptpConfig);
-    set_headers(res, "application/json");
-    res.body = ptp_config_to_json(ptpConfig);
+  read.Get("/api/ptp/config", [this](const Request& req, Response& res) {
+    auto version = session_manager_->get_ptp_config_version();
+    send_cached(req, res, "ptp_config", std::to_string(version), [this]() {
+      PTPConfig ptpConfig;
+      session_manager_->get_ptp_config(ptpConfig);
+      return ptp_config_to_json(ptpConfig);
+    });
   });
 
   /* set ptp config */
-  svr_.Post("/api/ptp/config", [this](const Request& req, Response& res) {
+  control.Post("/api/ptp/config", [this](const Request& req, Response& res) {
     try {
       PTPConfig ptpConfig = json_to_ptp_config(req.body);
       auto ret = session_manager_->set_ptp_config(ptpConfig);
@@ -189,29 +457,34 @@ bool HttpServer::init() {
   });
 
   /* get all sources */
-  svr_.Get("/api/sources", [this](const Request& req, Response& res) {
-    auto const sources = session_manager_->get_sources();
-    set_headers(res, "application/json");
-    res.body = sources_to_json(sources);
+  read.Get("/api/sources", [this](const Request& req, Response& res) {
+    auto version = session_manager_->get_sources_version();
+    send_cached(req, res, "sources", std::to_string(version), [this]() {
+      return sources_to_json(*session_manager_->get_sources());
+    });
   });
 
   /* get all sinks */
-  svr_.Get("/api/sinks", [this](const Request& req, Response& res) {
-    auto const sinks = session_manager_->get_sinks();
-    set_headers(res, "application/json");
-    res.body = sinks_to_json(sinks);
+  read.Get("/api/sinks", [this](const Request& req, Response& res) {
+    auto version = session_manager_->get_sinks_version();
+    send_cached(req, res, "sinks", std::to_string(version), [this]() {
+      return sinks_to_json(*session_manager_->get_sinks());
+    });
   });
 
   /* get all sources and sinks */
-  svr_.Get("/api/streams", [this](const Request& req, Response& res) {
-    auto const sources = session_manager_->get_sources();
-    auto const sinks = session_manager_->get_sinks();
-    set_headers(res, "application/json");
-    res.body = streams_to_json(sources, sinks);
+  read.Get("/api/streams", [this](const Request& req, Response& res) {
+    auto version = std::to_string(session_manager_->get_sources_version()) +
+                   "." +
+                   std::to_string(session_manager_->get_sinks_version());
+    send_cached(req, res, "streams", version, [this]() {
+      return streams_to_json(*session_manager_->get_sources(),
+                             *session_manager_->get_sinks());
+    });
   });
 
   /* get a source SDP */
-  svr_.Get(
+  read.Get(
       "/api/source/sdp/([0-9]+)", [this](const Request& req, Response& res) {
         uint32_t id;
         try {
@@ -230,7 +503,7 @@ bool HttpServer::init() {
       });
 
   /* get stream status */
-  svr_.Get(
+  read.Get(
       "/api/sink/status/([0-9]+)", [this](const Request& req, Response& res) {
         uint32_t id;
         try {
@@ -251,24 +524,25 @@ bool HttpServer::init() {
       });
 
   /* add a source */
-  svr_.Put("/api/source/([0-9]+)", [this](const Request& req, Response& res) {
-    try {
-      StreamSource source = json_to_source(req.matches[1], req.body);
-      auto ret = session_manager_->add_source(source);
-      if (ret) {
-        set_error(ret, "failed to add source " + std::to_string(source.id),
-                  res);
-      } else {
-        session_manager_->save_status();
-        set_headers(res);
-      }
-    } catch (const std::runtime_error& e) {
-      set_error(400, e.what(), res);
-    }
-  });
+  control.Put(
+      "/api/source/([0-9]+)", [this](const Request& req, Response& res) {
+        try {
+          StreamSource source = json_to_source(req.matches[1], req.body);
+          auto ret = session_manager_->add_source(source);
+          if (ret) {
+            set_error(ret, "failed to add source " + std::to_string(source.id),
+                      res);
+          } else {
+            session_manager_->save_status();
+            set_headers(res);
+          }
+        } catch (const std::runtime_error& e) {
+          set_error(400, e.what(), res);
+        }
+      });
 
   /* remove a source */
-  svr_.Delete(
+  control.Delete(
       "/api/source/([0-9]+)", [this](const Request& req, Response& res) {
         uint32_t id;
         try {
@@ -287,11 +561,15 @@ bool HttpServer::init() {
       });
 
   /* add a sink */
-  svr_.Put("/api/sink/([0-9]+)", [this](const Request& req, Response& res) {
+  control.Put("/api/sink/([0-9]+)", [this](const Request& req, Response& res) {
     try {
       StreamSink sink = json_to_sink(req.matches[1], req.body);
       auto ret = session_manager_->add_sink(sink);
-      if (ret) {
+      if (ret == DaemonErrc::sink_sdp_pending) {
+        /* accepted, the sink is added once its SDP is fetched */
+        set_headers(res);
+        res.status = 202;
+      } else if (ret) {
         set_error(ret, "failed to add sink " + std::to_string(sink.id), res);
       } else {
         session_manager_->save_status();
@@ -303,35 +581,122 @@ bool HttpServer::init() {
   });
 
   /* remove a sink */
-  svr_.Delete("/api/sink/([0-9]+)", [this](const Request& req, Response& res) {
-    uint32_t id;
-    try {
-      id = std::stoi(req.matches[1]);
-    } catch (...) {
-      set_error(400, "failed to convert id", res);
-      return;
-    }
-    auto ret = session_manager_->remove_sink(id);
-    if (ret) {
-      set_error(ret, "failed to remove sink " + std::to_string(id), res);
-    } else {
-      session_manager_->save_status();
-      set_headers(res);
-    }
-  });
+  control.Delete(
+      "/api/sink/([0-9]+)", [this](const Request& req, Response& res) {
+        uint32_t id;
+        try {
+          id = std::stoi(req.matches[1]);
+        } catch (...) {
+          set_error(400, "failed to convert id", res);
+          return;
+        }
+        auto ret = session_manager_->remove_sink(id);
+        if (ret) {
+          set_error(ret, "failed to remove sink " + std::to_string(id), res);
+        } else {
+          session_manager_->save_status();
+          set_headers(res);
+        }
+      });
 
   /* get remote sources */
-  svr_.Get("/api/browse/sources/(all|mdns|sap)",
-           [this](const Request& req, Response& res) {
-             auto const sources = browser_->get_remote_sources(req.matches[1]);
-             set_headers(res, "application/json");
-             res.body = remote_sources_to_json(sources);
-           });
+  svr.Get("/api/browse/sources/(all|mdns|sap)",
+          [this, &admission](const Request& req, Response& res) {
+            /* the long-poll blocks in the stream lane */
+            auto lane = req.has_param("wait") ? AdmissionControl::stream
+                                              : AdmissionControl::read;
+            auto ticket = admission.admit(lane);
+            if (!ticket) {
+              set_shed(lane, res);
+              return;
+            }
+            if (!req.has_param("since")) {
+              /* the version changes with the sources only, the client
+               * adds the Age of the reply to their last_seen */
+              auto [seq, update] = browser_->get_version();
+              std::string source = req.matches[1];
+              send_cached(req, res, "browse/" + source,
+                          std::to_string(seq) + "." + std::to_string(update),
+                          [this, &source]() {
+                            return remote_sources_to_json(
+                                *browser_->get_remote_sources(source));
+                          });
+              return;
+            }
+            uint64_t since;
+            uint32_t wait = 0;
+            try {
+              since = std::stoull(req.get_param_value("since"));
+              if (req.has_param("wait")) {
+                wait = std::stoul(req.get_param_value("wait"));
+              }
+            } catch (...) {
+              set_error(400, "failed to convert since or wait", res);
+              return;
+            }
+            if (wait) {
+              /* long-poll, block until the sources change */
+              browser_->wait_for_changes(
+                  since, std::chrono::seconds(
+                             std::min(wait, browse_wait_max)));
+            }
+            auto const delta =
+                browser_->get_remote_sources_since(since, req.matches[1]);
+            set_headers(res, "application/json");
+            res.body = remote_sources_delta_to_json(delta);
+          });
+
+  /* get change events stream */
+  stream.Get("/api/events", [this](const Request& req, Response& res,
+                                  const AdmissionControl::Ticket& ticket) {
+    uint64_t since = events_.get_seq();
+    /* resume after the last event received by the client, if the event
+     * is unknown the client is told to reload the state */
+    bool reset = req.has_header("Last-Event-ID") &&
+                 !parse_event_id(req.get_header_value("Last-Event-ID"), since);
+    set_headers(res);
+    res.set_header("Cache-Control", "no-cache");
+    if (events_.subscribe() == 1) {
+      session_manager_->start_sink_status_poll();
+    }
+    res.set_chunked_content_provider(
+        "text/event-stream",
+        [this, since, reset](size_t offset, DataSink& sink) mutable {
+          std::string out;
+          if (offset == 0) {
+            out = "retry: " + std::to_string(events_retry) + "\n\n";
+          }
+          if (!reset && offset > 0) {
+            std::vector<EventLog::Event> events;
+            reset = !events_.wait(since, std::chrono::seconds(events_keepalive),
+                                  events);
+            if (!events_.is_running()) {
+              return false;
+            }
+            for (const auto& event : events) {
+              write_event(out, event.seq, event.type, event.data);
+              since = event.seq;
+            }
+            if (!reset && events.empty()) {
+              out = ": keepalive\n\n";
+            }
+          }
+          if (reset) {
+            /* the events since the last one received are lost */
+            since = events_.get_seq();
+            write_event(out, since, "reset", seq_event_to_json(since));
+            reset = false;
+          }
+          return sink.write(out.data(), out.size());
+        },
+        /* the client holds the stream lane until it disconnects */
+        [this, ticket](bool /* success */) { events_.unsubscribe(); });
+  });
 
   /* retrieve streamer info and position */
 #ifdef _USE_STREAMER_
-  svr_.Get("/api/streamer/info/([0-9]+)", [this](const Request& req,
-                                                 Response& res) {
+  read.Get("/api/streamer/info/([0-9]+)", [this](const Request& req,
+                                                Response& res) {
     uint32_t id;
     StreamerInfo info;
     enum class streamer_info_status {
@@ -386,52 +751,61 @@ bool HttpServer::init() {
   });
 #endif
   /* retrieve live streamer */
-  svr_.Get("/api/streamer/stream/([0-9]+)", [this](const Request& req,
-                                                   Response& res) {
+  stream.Get(
+      "/api/streamer/stream/([0-9]+)",
+      [this](const Request& req, Response& res,
+             [[maybe_unused]] const AdmissionControl::Ticket& ticket) {
 #ifdef _USE_STREAMER_
-    if (!this->config_->get_streamer_enabled()) {
-      set_error(400, "streamer not enabled", res);
-      return;
-    }
-    uint8_t sinkId;
-    try {
-      sinkId = std::stoi(req.matches[1]);
-    } catch (...) {
-      set_error(400, "failed to convert id", res);
-      return;
-    }
-    StreamSink sink;
-    auto ret = session_manager_->get_sink(sinkId, sink);
-    if (ret) {
-      set_error(ret, "failed to retrieve sink " + std::to_string(sinkId), res);
-      return;
-    }
+        if (!this->config_->get_streamer_enabled()) {
+          set_error(400, "streamer not enabled", res);
+          return;
+        }
+        uint16_t sinkId;
+        try {
+          sinkId = std::stoi(req.matches[1]);
+        } catch (...) {
+          set_error(400, "failed to convert id", res);
+          return;
+        }
+        StreamSink sink;
+        auto ret = session_manager_->get_sink(sinkId, sink);
+        if (ret) {
+          set_error(ret, "failed to retrieve sink " + std::to_string(sinkId),
+                    res);
+          return;
+        }
 
-    ret = streamer_->live_stream_init(sink, req.remote_addr, req.remote_port);
-    if (ret) {
-      set_error(ret, "failed to init streamer " + std::to_string(sinkId), res);
-      return;
-    }
+        ret = streamer_->live_stream_init(sink, req.remote_addr,
+                                          req.remote_port);
+        if (ret) {
+          set_error(ret, "failed to init streamer " + std::to_string(sinkId),
+                    res);
+          return;
+        }
 
-    res.set_content_provider("audio/aac",
-                             [&](size_t /*offset*/, DataSink& httpSync) {
-                               return streamer_->live_stream_wait(
-                                   httpSync, req.remote_addr, req.remote_port);
-                             });
+        res.set_content_provider(
+            "audio/aac",
+            [&](size_t /*offset*/, DataSink& httpSync) {
+              return streamer_->live_stream_wait(httpSync, req.remote_addr,
+                                                 req.remote_port);
+            },
+            /* the client holds the stream lane until it disconnects */
+            [ticket](bool /* success */) {});
 #else
-    set_error(400, "streamer support not compiled-in", res);
+        set_error(400, "streamer support not compiled-in", res);
 #endif
-  });
+      });
 
   /* retrieve streamer file */
-  svr_.Get("/api/streamer/stream/([0-9]+)/([0-9]+)", [this](const Request& req,
-                                                            Response& res) {
+  read.Get("/api/streamer/stream/([0-9]+)/([0-9]+)", [this](const Request& req,
+                                                           Response& res) {
 #ifdef _USE_STREAMER_
     if (!this->config_->get_streamer_enabled()) {
       set_error(400, "streamer not enabled", res);
       return;
     }
-    uint8_t sinkId, fileId;
+    uint16_t sinkId;
+    uint8_t fileId;
     try {
       sinkId = std::stoi(req.matches[1]);
       fileId = std::stoi(req.matches[2]);
@@ -462,8 +836,31 @@ bool HttpServer::init() {
 #endif
   });
 
-  svr_.set_logger([](const Request& req, const Response& res) {
-    if (res.status == 200) {
+  /* get the HTTP admission control lanes statistics */
+  read.Get("/api/http/lanes", [&admission](const Request& req, Response& res) {
+    set_headers(res, "application/json");
+    res.body = http_lanes_to_json(admission);
+  });
+
+  /* get the SAP announcements statistics */
+  read.Get("/api/sap/stats", [this](const Request& req, Response& res) {
+    set_headers(res, "application/json");
+    res.body = sap_stats_to_json(session_manager_->get_sap_stats());
+  });
+
+  /* get the session manager observers notification statistics */
+  read.Get("/api/observers", [this](const Request& req, Response& res) {
+    set_headers(res, "application/json");
+    res.body = observers_to_json(session_manager_->get_observers_stats());
+  });
+
+  /* web UI files, registered last to match the paths left */
+  read.Get("/.*", [this](const Request& req, Response& res) {
+    send_asset(req, res, req.path);
+  });
+
+  svr.set_logger([](const Request& req, const Response& res) {
+    if (res.status == 200 || res.status == 304) {
       BOOST_LOG_TRIVIAL(info) << "http_server:: " << req.method << " "
                               << req.path << " response " << res.status;
     } else {
@@ -472,6 +869,103 @@ bool HttpServer::init() {
           << res.status << " " << res.body;
     }
   });
+}
+
+std::unique_ptr<AdmissionControl> HttpServer::init_admission(
+    Server& svr) const {
+  std::array<AdmissionControl::LaneConfig, AdmissionControl::lanes_num> lanes;
+  lanes[AdmissionControl::control] = {config_->get_http_control_threads(),
+                                      config_->get_http_control_queue()};
+  lanes[AdmissionControl::read] = {config_->get_http_read_threads(),
+                                   config_->get_http_read_queue()};
+  lanes[AdmissionControl::stream] = {config_->get_http_stream_threads(), 0};
+  auto admission = std::make_unique<AdmissionControl>(lanes);
+
+  /* httplib runs every connection on a pool thread, the pool holds all the
+   * requests the lanes can admit or queue so a busy lane never takes the
+   * threads of the others. The shed requests close their connection and
+   * the idle keep-alive connections are released after keep_alive_timeout,
+   * so the connections beyond the lanes capacity only hold the spare
+   * threads for a short time */
+  size_t threads = admission->get_capacity() + spare_threads;
+  svr.new_task_queue = [threads] { return new ThreadPool(threads); };
+  svr.set_keep_alive_max_count(keep_alive_max_count);
+  svr.set_keep_alive_timeout(keep_alive_timeout);
+  BOOST_LOG_TRIVIAL(info) << "http_server:: using " << threads
+                          << " server threads";
+  return admission;
+}
+
+/* remove the unix socket left by a previous instance, any other kind of
+ * file at the path is left in place */
+static bool remove_unix_socket(const std::string& path) {
+  struct stat st;
+  if (::lstat(path.c_str(), &st) < 0) {
+    return errno == ENOENT;
+  }
+  if (!S_ISSOCK(st.st_mode)) {
+    BOOST_LOG_TRIVIAL(fatal) << "http_server:: " << path
+                             << " exists and is not a unix socket";
+    return false;
+  }
+  return ::unlink(path.c_str()) == 0;
+}
+
+bool HttpServer::init_unix_socket() {
+  const auto& path = config_->get_http_unix_socket();
+  /* local clients get their own lanes and workers, so they are served also
+   * when the TCP server threads are all busy */
+  unix_admission_ = init_admission(unix_svr_);
+  unix_svr_.set_address_family(AF_UNIX);
+  add_routes(unix_svr_, *unix_admission_);
+
+  if (!remove_unix_socket(path)) {
+    BOOST_LOG_TRIVIAL(fatal)
+        << "http_server:: cannot remove unix socket " << path;
+    return false;
+  }
+  // only the owner and the group can connect, the socket is created with
+  // these permissions so no client can connect before they apply
+  auto mask = ::umask(S_IXUSR | S_IXGRP | S_IRWXO);
+  auto bound = unix_svr_.bind_to_port(path.c_str(), 0);
+  ::umask(mask);
+  if (!bound) {
+    BOOST_LOG_TRIVIAL(fatal)
+        << "http_server:: failed to bind to unix socket " << path;
+    return false;
+  }
+  unix_socket_path_ = path;
+  BOOST_LOG_TRIVIAL(info) << "http_server:: listening on unix socket "
+                          << path;
+  unix_res_ = std::async(std::launch::async,
+                         [this]() { return unix_svr_.listen_after_bind(); });
+  return true;
+}
+
+bool HttpServer::init() {
+  /* setup http operations */
+  if (!svr_.is_valid()) {
+    return false;
+  }
+
+  admission_ = init_admission(svr_);
+
+  assets_.load(config_->get_http_base_dir());
+
+  std::stringstream ss;
+  ss << std::hex
+     << std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+  etag_prefix_ = ss.str();
+
+  add_events_observers();
+
+  add_routes(svr_, *admission_);
+
+  if (!config_->get_http_unix_socket().empty() && !init_unix_socket()) {
+    return false;
+  }
 
   std::string http_addr = config_->get_http_addr_str();
   if (http_addr.empty())
@@ -507,6 +1001,20 @@ bool HttpServer::init() {
 
 bool HttpServer::terminate() {
   BOOST_LOG_TRIVIAL(info) << "http_server: stopping ... ";
+  /* wake up the event stream clients and the queued requests */
+  events_.terminate();
+  if (admission_) {
+    admission_->terminate();
+  }
+  if (unix_admission_) {
+    unix_admission_->terminate();
+  }
   svr_.stop();
-  return res_.get();
+  auto ret = res_.get();
+  if (unix_res_.valid()) {
+    unix_svr_.stop();
+    ret &= unix_res_.get();
+    remove_unix_socket(unix_socket_path_);
+  }
+  return ret;
 }
@@ -22,9 +22,18 @@
 
 #include <httplib.h>
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "admission_control.hpp"
 #include "browser.hpp"
 #include "config.hpp"
+#include "event_log.hpp"
 #include "session_manager.hpp"
+#include "web_assets.hpp"
 
 #ifdef _USE_STREAMER_
 #include "streamer.hpp"
@@ -32,6 +41,20 @@
 
 class HttpServer {
  public:
+  /* max wait of a remote sources long-poll request */
+  constexpr static uint32_t browse_wait_max = 30;  // sec
+  /* server threads beyond the lanes capacity, they serve the idle
+   * keep-alive connections and reply to the shed requests */
+  constexpr static uint16_t spare_threads = 8;
+  /* an idle keep-alive connection holds a server thread, so the idle time
+   * and the requests served on a connection are bounded */
+  constexpr static uint16_t keep_alive_max_count = 16;
+  constexpr static uint16_t keep_alive_timeout = 2;  // sec
+  /* interval of the comments sent to an idle event stream */
+  constexpr static uint32_t events_keepalive = 15;  // sec
+  /* reconnection delay suggested to the event stream clients */
+  constexpr static uint32_t events_retry = 2000;  // msec
+
   HttpServer() = delete;
   explicit HttpServer(std::shared_ptr<SessionManager> session_manager,
                       std::shared_ptr<Browser> browser,
@@ -49,6 +72,41 @@ class HttpServer {
   bool terminate();
 
  private:
+  /* register the REST API and the web UI on the server, the requests are
+   * admitted to the lanes of the admission control */
+  void add_routes(httplib::Server& svr, AdmissionControl& admission);
+  /* admission control and thread pool of the server */
+  std::unique_ptr<AdmissionControl> init_admission(httplib::Server& svr) const;
+  /* serve the same routes on the configured unix domain socket */
+  bool init_unix_socket();
+
+  /* JSON response memoized for a resource version */
+  struct CachedResponse {
+    std::string etag;
+    std::shared_ptr<const std::string> body;
+    std::chrono::steady_clock::time_point timepoint; /* body serialized */
+  };
+  /* send the resource with the ETag of its version, 304 if the client
+   * already has it, the body is serialized only when the version changes */
+  void send_cached(const httplib::Request& req,
+                   httplib::Response& res,
+                   const std::string& resource,
+                   const std::string& version,
+                   const std::function<std::string()>& serialize);
+  /* send the web UI file from memory */
+  void send_asset(const httplib::Request& req,
+                  httplib::Response& res,
+                  const std::string& path);
+  /* register the observers publishing the change events */
+  void add_events_observers();
+  /* event id is the ETag prefix followed by the sequence, returns false if
+   * it was not generated by this instance of the daemon */
+  bool parse_event_id(const std::string& id, uint64_t& seq) const;
+  void write_event(std::string& out,
+                   uint64_t seq,
+                   const std::string& type,
+                   const std::string& data) const;
+
   std::shared_ptr<SessionManager> session_manager_;
   std::shared_ptr<Browser> browser_;
 #ifdef _USE_STREAMER_
@@ -57,6 +115,18 @@ class HttpServer {
   std::shared_ptr<Config> config_;
   httplib::Server svr_;
   std::future<bool> res_;
+  std::unique_ptr<AdmissionControl> admission_;
+  httplib::Server unix_svr_;
+  std::string unix_socket_path_; /* the socket this instance created */
+  std::future<bool> unix_res_;
+  std::unique_ptr<AdmissionControl> unix_admission_;
+  /* makes the ETags unique across daemon restarts */
+  std::string etag_prefix_;
+  std::map<std::string /* resource */, CachedResponse> cache_;
+  std::mutex cache_mutex_;
+  WebAssets assets_;
+  EventLog events_;
+  std::atomic<uint64_t> browser_seq_{0};
 };
 
 #endif
@@ -0,0 +1,77 @@
+//
+//  interned_string.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _INTERNED_STRING_HPP_
+#define _INTERNED_STRING_HPP_
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+
+/*
+ * Immutable string stored once in a process wide pool.
+ * Copies and comparisons between interned strings are pointer operations.
+ * Pooled values are never released, use it for low cardinality fields only.
+ */
+class InternedString {
+ public:
+  InternedString() : str_(&intern({})) {}
+  InternedString(const std::string& str) : str_(&intern(str)) {}
+  InternedString(const char* str) : str_(&intern(str)) {}
+
+  const std::string& str() const { return *str_; }
+  operator const std::string&() const { return *str_; }
+
+  bool operator==(const InternedString& rhs) const { return str_ == rhs.str_; }
+  bool operator!=(const InternedString& rhs) const { return str_ != rhs.str_; }
+  bool operator==(const std::string& rhs) const { return *str_ == rhs; }
+  bool operator!=(const std::string& rhs) const { return *str_ != rhs; }
+  bool operator==(const char* rhs) const { return *str_ == rhs; }
+  bool operator!=(const char* rhs) const { return *str_ != rhs; }
+
+  /* number of distinct strings in the pool */
+  static size_t pool_size() {
+    std::lock_guard lock(pool_mutex());
+    return pool().size();
+  }
+
+ private:
+  static const std::string& intern(const std::string& str) {
+    std::lock_guard lock(pool_mutex());
+    return *pool().insert(str).first;
+  }
+  static std::mutex& pool_mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+  /* the elements of an unordered_set never move */
+  static std::unordered_set<std::string>& pool() {
+    static std::unordered_set<std::string> pool;
+    return pool;
+  }
+
+  const std::string* str_;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const InternedString& str) {
+  return os << str.str();
+}
+
+#endif
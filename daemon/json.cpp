@@ -17,429 +17,703 @@
 //  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
-#define BOOST_BIND_GLOBAL_PLACEHOLDERS
-
-#include <boost/foreach.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/property_tree/ptree.hpp>
 #include <iostream>
-#include <regex>
+#include <iterator>
+#include <limits>
 #include <string>
 #include <chrono>
 
 #include "log.hpp"
 #include "utils.hpp"
 #include "json.hpp"
+#include "json_reader.hpp"
+#include "json_writer.hpp"
 
 using namespace std::chrono;
 using second_t = duration<double, std::ratio<1> >;
 
+// expected size of a serialized source, sink or remote source without SDP
+constexpr size_t json_stream_size = 512;
+
 static inline std::string remove_undesired_chars(const std::string& s) {
-  std::regex html_regex("[^ A-Za-z0-9:~.,_/=%()\\r\\n\\t\?#-]?");
-  return std::regex_replace(s, html_regex, "");
-}
-
-static std::string escape_json(const std::string& js) {
-  std::string s(remove_undesired_chars(js));
-  std::ostringstream ss;
-  for (auto c = s.cbegin(); c != s.cend(); c++) {
-    switch (*c) {
-      case '"':
-        ss << "\\\"";
-        break;
-      case '\\':
-        ss << "\\\\";
-        break;
-      case '\b':
-        ss << "\\b";
-        break;
-      case '\f':
-        ss << "\\f";
-        break;
-      case '\n':
-        ss << "\\n";
-        break;
-      case '\r':
-        ss << "\\r";
-        break;
-      case '\t':
-        ss << "\\t";
-        break;
-      default:
-        if ('\x00' <= *c && *c <= '\x1f') {
-          ss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
-             << (int)*c;
-        } else {
-          ss << *c;
-        }
-    }
-  }
-  return ss.str();
+  return JsonWriter::filter(s);
 }
 
 std::string config_to_json(const Config& config) {
-  std::stringstream ss;
-  ss << "{" << "\n  \"http_port\": " << config.get_http_port()
-     << ",\n  \"rtsp_port\": " << config.get_rtsp_port()
-     << ",\n  \"http_base_dir\": \"" << config.get_http_base_dir() << "\""
-     << ",\n  \"log_severity\": " << config.get_log_severity()
-     << ",\n  \"playout_delay\": " << config.get_playout_delay()
-     << ",\n  \"tic_frame_size_at_1fs\": " << config.get_tic_frame_size_at_1fs()
-     << ",\n  \"max_tic_frame_size\": " << config.get_max_tic_frame_size()
-     << ",\n  \"sample_rate\": " << config.get_sample_rate()
-     << ",\n  \"rtp_mcast_base\": \""
-     << escape_json(config.get_rtp_mcast_base()) << "\""
-     << ",\n  \"rtp_mcast_base_sec\": \""
-     << escape_json(config.get_rtp_mcast_base_sec()) << "\""
-     << ",\n  \"rtp_port\": " << config.get_rtp_port()
-     << ",\n  \"rtp_port_sec\": " << config.get_rtp_port_sec()
-     << ",\n  \"ptp_domain\": " << unsigned(config.get_ptp_domain())
-     << ",\n  \"ptp_dscp\": " << unsigned(config.get_ptp_dscp())
-     << ",\n  \"sap_mcast_addr\": \""
-     << escape_json(config.get_sap_mcast_addr()) << "\""
-     << ",\n  \"sap_interval\": " << config.get_sap_interval()
-     << ",\n  \"syslog_proto\": \"" << escape_json(config.get_syslog_proto())
-     << "\"" << ",\n  \"syslog_server\": \""
-     << escape_json(config.get_syslog_server()) << "\""
-     << ",\n  \"status_file\": \"" << escape_json(config.get_status_file())
-     << "\"" << ",\n  \"interface_name\": \""
-     << escape_json(config.get_interface_name()) << "\""
-     << ",\n  \"mdns_enabled\": " << std::boolalpha << config.get_mdns_enabled()
-     << ",\n  \"custom_node_id\": \""
-     << escape_json(config.get_custom_node_id()) << "\""
-     << ",\n  \"node_id\": \"" << escape_json(config.get_node_id()) << "\""
-     << ",\n  \"ptp_status_script\": \""
-     << escape_json(config.get_ptp_status_script()) << "\""
-     << ",\n  \"mac_addr\": \"" << escape_json(config.get_mac_addr_str())
-     << "\"" << ",\n  \"ip_addr\": \"" << escape_json(config.get_ip_addr_str())
-     << "\"" << ",\n  \"streamer_channels\": "
-     << unsigned(config.get_streamer_channels())
-     << ",\n  \"streamer_files_num\": "
-     << unsigned(config.get_streamer_files_num())
-     << ",\n  \"streamer_file_duration\": "
-     << unsigned(config.get_streamer_file_duration())
-     << ",\n  \"streamer_player_buffer_files_num\": "
-     << unsigned(config.get_streamer_player_buffer_files_num())
-     << ",\n  \"streamer_enabled\": " << std::boolalpha
-     << config.get_streamer_enabled()
-     << ",\n  \"auto_sinks_update\": " << std::boolalpha
-     << config.get_auto_sinks_update()
-     << ",\n  \"nmos_enabled\": " << std::boolalpha << config.get_nmos_enabled()
-     << ",\n  \"nmos_registry_address\": \""
-     << escape_json(config.get_nmos_registry_address()) << "\""
-     << ",\n  \"nmos_registry_port\": " << config.get_nmos_registry_port()
-     << ",\n  \"nmos_node_port\": " << config.get_nmos_node_port()
-     << ",\n  \"nmos_label\": \"" << escape_json(config.get_nmos_label()) << "\""
-     << "\n}\n";
-  return ss.str();
+  JsonWriter js(2048);
+  js.raw("{\n  \"http_port\": ").num(config.get_http_port())
+      .raw(",\n  \"rtsp_port\": ").num(config.get_rtsp_port())
+      .raw(",\n  \"rtsp_threads\": ").num(config.get_rtsp_threads())
+      .raw(",\n  \"http_base_dir\": ").str(config.get_http_base_dir())
+      .raw(",\n  \"http_unix_socket\": ")
+      .str(config.get_http_unix_socket())
+      .raw(",\n  \"http_control_threads\": ")
+      .num(config.get_http_control_threads())
+      .raw(",\n  \"http_control_queue\": ")
+      .num(config.get_http_control_queue())
+      .raw(",\n  \"http_read_threads\": ")
+      .num(config.get_http_read_threads())
+      .raw(",\n  \"http_read_queue\": ").num(config.get_http_read_queue())
+      .raw(",\n  \"http_stream_threads\": ")
+      .num(config.get_http_stream_threads())
+      .raw(",\n  \"log_severity\": ").num(config.get_log_severity())
+      .raw(",\n  \"playout_delay\": ").num(config.get_playout_delay())
+      .raw(",\n  \"tic_frame_size_at_1fs\": ")
+      .num(config.get_tic_frame_size_at_1fs())
+      .raw(",\n  \"max_tic_frame_size\": ")
+      .num(config.get_max_tic_frame_size())
+      .raw(",\n  \"sample_rate\": ").num(config.get_sample_rate())
+      .raw(",\n  \"rtp_mcast_base\": ").str(config.get_rtp_mcast_base())
+      .raw(",\n  \"rtp_mcast_base_sec\": ")
+      .str(config.get_rtp_mcast_base_sec())
+      .raw(",\n  \"rtp_port\": ").num(config.get_rtp_port())
+      .raw(",\n  \"rtp_port_sec\": ").num(config.get_rtp_port_sec())
+      .raw(",\n  \"ptp_domain\": ").num(config.get_ptp_domain())
+      .raw(",\n  \"ptp_dscp\": ").num(config.get_ptp_dscp())
+      .raw(",\n  \"sap_mcast_addr\": ").str(config.get_sap_mcast_addr())
+      .raw(",\n  \"sap_interval\": ").num(config.get_sap_interval())
+      .raw(",\n  \"sap_compression\": ")
+      .boolean(config.get_sap_compression())
+      .raw(",\n  \"sap_bandwidth_limit\": ")
+      .num(config.get_sap_bandwidth_limit())
+      .raw(",\n  \"syslog_proto\": ").str(config.get_syslog_proto())
+      .raw(",\n  \"syslog_server\": ").str(config.get_syslog_server())
+      .raw(",\n  \"status_file\": ").str(config.get_status_file())
+      .raw(",\n  \"browser_cache_file\": ")
+      .str(config.get_browser_cache_file())
+      .raw(",\n  \"interface_name\": ").str(config.get_interface_name())
+      .raw(",\n  \"mdns_enabled\": ").boolean(config.get_mdns_enabled())
+      .raw(",\n  \"custom_node_id\": ").str(config.get_custom_node_id())
+      .raw(",\n  \"node_id\": ").str(config.get_node_id())
+      .raw(",\n  \"ptp_status_script\": ")
+      .str(config.get_ptp_status_script())
+      .raw(",\n  \"mac_addr\": ").str(config.get_mac_addr_str())
+      .raw(",\n  \"ip_addr\": ").str(config.get_ip_addr_str())
+      .raw(",\n  \"streamer_channels\": ").num(config.get_streamer_channels())
+      .raw(",\n  \"streamer_files_num\": ")
+      .num(config.get_streamer_files_num())
+      .raw(",\n  \"streamer_file_duration\": ")
+      .num(config.get_streamer_file_duration())
+      .raw(",\n  \"streamer_player_buffer_files_num\": ")
+      .num(config.get_streamer_player_buffer_files_num())
+      .raw(",\n  \"streamer_enabled\": ")
+      .boolean(config.get_streamer_enabled())
+      .raw(",\n  \"auto_sinks_update\": ")
+      .boolean(config.get_auto_sinks_update())
+      .raw(",\n  \"nmos_enabled\": ").boolean(config.get_nmos_enabled())
+      .raw(",\n  \"nmos_registry_address\": ")
+      .str(config.get_nmos_registry_address())
+      .raw(",\n  \"nmos_registry_port\": ")
+      .num(config.get_nmos_registry_port())
+      .raw(",\n  \"nmos_node_port\": ").num(config.get_nmos_node_port())
+      .raw(",\n  \"nmos_label\": ").str(config.get_nmos_label())
+      .raw("\n}\n");
+  return js.release();
 }
 
-std::string source_to_json(const StreamSource& source) {
-  std::stringstream ss;
-  ss << "\n  {" << "\n    \"id\": " << unsigned(source.id)
-     << ",\n    \"enabled\": " << std::boolalpha << source.enabled
-     << ",\n    \"name\": \"" << escape_json(source.name) << "\""
-     << ",\n    \"io\": \"" << escape_json(source.io) << "\""
-     << ",\n    \"max_samples_per_packet\": " << source.max_samples_per_packet
-     << ",\n    \"codec\": \"" << escape_json(source.codec) << "\""
-     << ",\n    \"address\": \"" << escape_json(source.address) << "\""
-     << ",\n    \"ttl\": " << unsigned(source.ttl)
-     << ",\n    \"payload_type\": " << unsigned(source.payload_type)
-     << ",\n    \"dscp\": " << +unsigned(source.dscp)
-     << ",\n    \"refclk_ptp_traceable\": " << std::boolalpha
-     << source.refclk_ptp_traceable << ",\n    \"map\": [ ";
+template <typename T>
+static void write_map(JsonWriter& js, const T& map) {
+  js.raw(",\n    \"map\": [ ");
   int i = 0;
-  for (int value : source.map) {
+  for (int value : map) {
     if (i++ > 0)
-      ss << ", ";
-    ss << value;
+      js.raw(", ");
+    js.num(value);
   }
-  ss << " ]\n  }";
-  return ss.str();
+  js.raw(" ]\n  }");
 }
 
-std::string sink_to_json(const StreamSink& sink) {
-  std::stringstream ss;
-  ss << "\n  {" << "\n    \"id\": " << unsigned(sink.id)
-     << ",\n    \"name\": \"" << escape_json(sink.name) << "\""
-     << ",\n    \"io\": \"" << escape_json(sink.io) << "\""
-     << ",\n    \"use_sdp\": " << std::boolalpha << sink.use_sdp
-     << ",\n    \"source\": \"" << escape_json(sink.source) << "\""
-     << ",\n    \"sdp\": \"" << escape_json(sink.sdp) << "\""
-     << ",\n    \"delay\": " << sink.delay
-     << ",\n    \"ignore_refclk_gmid\": " << std::boolalpha
-     << sink.ignore_refclk_gmid << ",\n    \"map\": [ ";
-  int i = 0;
-  for (int value : sink.map) {
-    if (i++ > 0)
-      ss << ", ";
-    ss << value;
-  }
-  ss << " ]\n  }";
-  return ss.str();
+static void write_source(JsonWriter& js, const StreamSource& source) {
+  js.raw("\n  {\n    \"id\": ").num(source.id)
+      .raw(",\n    \"enabled\": ").boolean(source.enabled)
+      .raw(",\n    \"name\": ").str(source.name)
+      .raw(",\n    \"io\": ").str(source.io)
+      .raw(",\n    \"max_samples_per_packet\": ")
+      .num(source.max_samples_per_packet)
+      .raw(",\n    \"codec\": ").str(source.codec)
+      .raw(",\n    \"address\": ").str(source.address)
+      .raw(",\n    \"ttl\": ").num(source.ttl)
+      .raw(",\n    \"payload_type\": ").num(source.payload_type)
+      .raw(",\n    \"dscp\": ").num(source.dscp)
+      .raw(",\n    \"refclk_ptp_traceable\": ")
+      .boolean(source.refclk_ptp_traceable);
+  write_map(js, source.map);
 }
 
-std::string sink_status_to_json(const SinkStreamStatus& status) {
-  std::stringstream ss;
-  ss << "{";
-  ss << "\n  \"sink_flags\":\n  {" << std::boolalpha
-     << "  \n    \"rtp_seq_id_error\": " << status.is_rtp_seq_id_error
-     << ", \n    \"rtp_ssrc_error\": " << status.is_rtp_ssrc_error
-     << ", \n    \"rtp_payload_type_error\": "
-     << status.is_rtp_payload_type_error
-     << ", \n    \"rtp_sac_error\": " << status.is_rtp_sac_error
-     << ", \n    \"receiving_rtp_packet\": " << status.is_receiving_rtp_packet
-     << ", \n    \"some_muted\": " << status.is_some_muted
-     << ", \n    \"all_muted\": " << status.is_all_muted
-     << ", \n    \"muted\": " << status.is_muted << "\n  },"
-     << "\n  \"sink_min_time\": " << status.min_time << "\n}\n";
-  return ss.str();
+static void write_sink(JsonWriter& js, const StreamSink& sink) {
+  js.raw("\n  {\n    \"id\": ").num(sink.id)
+      .raw(",\n    \"name\": ").str(sink.name)
+      .raw(",\n    \"io\": ").str(sink.io)
+      .raw(",\n    \"use_sdp\": ").boolean(sink.use_sdp)
+      .raw(",\n    \"source\": ").str(sink.source)
+      .raw(",\n    \"sdp\": ").str(sink.sdp)
+      .raw(",\n    \"delay\": ").num(sink.delay)
+      .raw(",\n    \"ignore_refclk_gmid\": ")
+      .boolean(sink.ignore_refclk_gmid);
+  write_map(js, sink.map);
 }
 
-std::string ptp_config_to_json(const PTPConfig& ptp_config) {
-  std::stringstream ss;
-  ss << "{" << " \"domain\": " << unsigned(ptp_config.domain)
-     << ", \"dscp\": " << unsigned(ptp_config.dscp) << " }\n";
-  return ss.str();
-}
-
-std::string ptp_status_to_json(const PTPStatus& status) {
-  std::stringstream ss;
-  ss << "{" << " \"status\": \"" << escape_json(status.status) << "\""
-     << ", \"gmid\": \"" << escape_json(status.gmid) << "\""
-     << ", \"jitter\": " << status.jitter << " }\n";
-  return ss.str();
-}
-
-std::string sources_to_json(const std::list<StreamSource>& sources) {
+static void write_sources(JsonWriter& js,
+                          const std::list<StreamSource>& sources) {
+  js.reserve(sources.size() * json_stream_size);
   int count = 0;
-  std::stringstream ss;
-  ss << "{\n  \"sources\": [";
   for (auto const& source : sources) {
     if (count++) {
-      ss << ", ";
+      js.raw(", ");
     }
-    ss << source_to_json(source);
+    write_source(js, source);
   }
-  ss << "  ]\n}\n";
-  return ss.str();
 }
 
-std::string sinks_to_json(const std::list<StreamSink>& sinks) {
+static void write_sinks(JsonWriter& js, const std::list<StreamSink>& sinks) {
+  size_t size = 0;
+  for (auto const& sink : sinks) {
+    size += json_stream_size + sink.sdp.length();
+  }
+  js.reserve(size);
   int count = 0;
-  std::stringstream ss;
-  ss << "{\n  \"sinks\": [";
   for (auto const& sink : sinks) {
     if (count++) {
-      ss << ", ";
+      js.raw(", ");
     }
-    ss << sink_to_json(sink);
+    write_sink(js, sink);
   }
-  ss << "  ]\n}\n";
-  return ss.str();
+}
+
+std::string source_to_json(const StreamSource& source) {
+  JsonWriter js(json_stream_size);
+  write_source(js, source);
+  return js.release();
+}
+
+std::string sink_to_json(const StreamSink& sink) {
+  JsonWriter js(json_stream_size + sink.sdp.length());
+  write_sink(js, sink);
+  return js.release();
+}
+
+std::string sink_status_to_json(const SinkStreamStatus& status) {
+  JsonWriter js;
+  js.raw("{\n  \"sink_flags\":\n  {")
+      .raw("  \n    \"rtp_seq_id_error\": ")
+      .boolean(status.is_rtp_seq_id_error)
+      .raw(", \n    \"rtp_ssrc_error\": ").boolean(status.is_rtp_ssrc_error)
+      .raw(", \n    \"rtp_payload_type_error\": ")
+      .boolean(status.is_rtp_payload_type_error)
+      .raw(", \n    \"rtp_sac_error\": ").boolean(status.is_rtp_sac_error)
+      .raw(", \n    \"receiving_rtp_packet\": ")
+      .boolean(status.is_receiving_rtp_packet)
+      .raw(", \n    \"some_muted\": ").boolean(status.is_some_muted)
+      .raw(", \n    \"all_muted\": ").boolean(status.is_all_muted)
+      .raw(", \n    \"muted\": ").boolean(status.is_muted)
+      .raw("\n  },")
+      .raw("\n  \"sink_min_time\": ").num(status.min_time)
+      .raw("\n}\n");
+  return js.release();
+}
+
+std::string stream_event_to_json(const std::string& action,
+                                 uint16_t id,
+                                 const std::string& name) {
+  JsonWriter js(64 + name.length());
+  js.raw("{ \"action\": ").str(action)
+      .raw(", \"id\": ").num(id)
+      .raw(", \"name\": ").str(name)
+      .raw(" }");
+  return js.release();
+}
+
+std::string sink_status_event_to_json(uint16_t id,
+                                      const SinkStreamStatus& status) {
+  JsonWriter js;
+  js.raw("{ \"id\": ").num(id)
+      .raw(", \"sink_flags\": { \"rtp_seq_id_error\": ")
+      .boolean(status.is_rtp_seq_id_error)
+      .raw(", \"rtp_ssrc_error\": ").boolean(status.is_rtp_ssrc_error)
+      .raw(", \"rtp_payload_type_error\": ")
+      .boolean(status.is_rtp_payload_type_error)
+      .raw(", \"rtp_sac_error\": ").boolean(status.is_rtp_sac_error)
+      .raw(", \"receiving_rtp_packet\": ")
+      .boolean(status.is_receiving_rtp_packet)
+      .raw(", \"some_muted\": ").boolean(status.is_some_muted)
+      .raw(", \"all_muted\": ").boolean(status.is_all_muted)
+      .raw(", \"muted\": ").boolean(status.is_muted)
+      .raw(" }, \"sink_min_time\": ").num(status.min_time)
+      .raw(" }");
+  return js.release();
+}
+
+std::string seq_event_to_json(uint64_t seq) {
+  JsonWriter js(32);
+  js.raw("{ \"seq\": ").num(seq).raw(" }");
+  return js.release();
+}
+
+std::string ptp_config_to_json(const PTPConfig& ptp_config) {
+  JsonWriter js;
+  js.raw("{ \"domain\": ").num(ptp_config.domain)
+      .raw(", \"dscp\": ").num(ptp_config.dscp)
+      .raw(" }\n");
+  return js.release();
+}
+
+std::string ptp_status_to_json(const PTPStatus& status) {
+  JsonWriter js;
+  js.raw("{ \"status\": ").str(status.status)
+      .raw(", \"gmid\": ").str(status.gmid)
+      .raw(", \"jitter\": ").num(status.jitter)
+      .raw(" }\n");
+  return js.release();
+}
+
+std::string sources_to_json(const std::list<StreamSource>& sources) {
+  JsonWriter js;
+  js.raw("{\n  \"sources\": [");
+  write_sources(js, sources);
+  js.raw("  ]\n}\n");
+  return js.release();
+}
+
+std::string sinks_to_json(const std::list<StreamSink>& sinks) {
+  JsonWriter js;
+  js.raw("{\n  \"sinks\": [");
+  write_sinks(js, sinks);
+  js.raw("  ]\n}\n");
+  return js.release();
 }
 
 std::string streams_to_json(const std::list<StreamSource>& sources,
                             const std::list<StreamSink>& sinks) {
-  int count = 0;
-  std::stringstream ss;
-  ss << "{\n  \"sources\": [";
+  JsonWriter js;
+  js.raw("{\n  \"sources\": [");
+  write_sources(js, sources);
+  js.raw("  ],\n  \"sinks\": [");
+  write_sinks(js, sinks);
+  js.raw("  ]\n}\n");
+  return js.release();
+}
+
+static void write_remote_source(JsonWriter& js,
+                                const RemoteSource& source,
+                                const time_point<steady_clock>& now) {
+  js.raw("\n  {\n    \"source\": ").str(source.source)
+      .raw(",\n    \"id\": ").str(source.id)
+      .raw(",\n    \"name\": ").str(source.name)
+      .raw(",\n    \"domain\": ").str(source.domain)
+      .raw(",\n    \"address\": ").str(source.address)
+      .raw(",\n    \"sdp\": ").str(source.sdp->text)
+      .raw(",\n    \"last_seen\": ")
+      .num(unsigned(
+          duration_cast<second_t>(now - source.last_seen_timepoint).count()))
+      .raw(",\n    \"announce_period\": ").num(source.announce_period)
+      .raw(",\n    \"stale\": ").boolean(source.stale)
+      .raw(" \n  }");
+}
+
+static void write_remote_sources(JsonWriter& js,
+                                 const std::list<RemoteSource>& sources) {
+  size_t size = 0;
   for (auto const& source : sources) {
-    if (count++) {
-      ss << ", ";
-    }
-    ss << source_to_json(source);
+    size += json_stream_size + source.sdp->text.length();
   }
-  count = 0;
-  ss << "  ],\n  \"sinks\": [";
-  for (auto const& sink : sinks) {
+  js.reserve(size);
+  auto now = steady_clock::now();
+  int count = 0;
+  for (auto const& source : sources) {
     if (count++) {
-      ss << ", ";
+      js.raw(", ");
     }
-    ss << sink_to_json(sink);
+    write_remote_source(js, source, now);
   }
-  ss << "  ]\n}\n";
-  return ss.str();
 }
 
 std::string remote_source_to_json(const RemoteSource& source) {
-  std::stringstream ss;
-  ss << "\n  {" << "\n    \"source\": \"" << escape_json(source.source) << "\""
-     << ",\n    \"id\": \"" << escape_json(source.id) << "\""
-     << ",\n    \"name\": \"" << escape_json(source.name) << "\""
-     << ",\n    \"domain\": \"" << escape_json(source.domain) << "\""
-     << ",\n    \"address\": \"" << escape_json(source.address) << "\""
-     << ",\n    \"sdp\": \"" << escape_json(source.sdp) << "\""
-     << ",\n    \"last_seen\": "
-     << unsigned(duration_cast<second_t>(steady_clock::now() -
-                                         source.last_seen_timepoint)
-                     .count())
-     << ",\n    \"announce_period\": " << unsigned(source.announce_period)
-     << " \n  }";
-  return ss.str();
+  JsonWriter js(json_stream_size + source.sdp->text.length());
+  write_remote_source(js, source, steady_clock::now());
+  return js.release();
 }
 
 std::string remote_sources_to_json(const std::list<RemoteSource>& sources) {
+  JsonWriter js;
+  js.raw("{\n  \"remote_sources\": [");
+  write_remote_sources(js, sources);
+  js.raw("  ]\n}\n");
+  return js.release();
+}
+
+std::string remote_sources_delta_to_json(const RemoteSourcesDelta& delta) {
+  JsonWriter js;
+  js.raw("{\n  \"seq\": ").num(delta.seq)
+      .raw(",\n  \"full\": ").boolean(delta.full)
+      .raw(",\n  \"remote_sources\": [");
+  write_remote_sources(js, delta.sources);
+  js.raw("  ],\n  \"removed\": [");
+  int count = 0;
+  for (auto const& id : delta.removed) {
+    if (count++) {
+      js.raw(", ");
+    }
+    js.str(id);
+  }
+  js.raw("]\n}\n");
+  return js.release();
+}
+
+std::string remote_sources_cache_to_json(
+    const std::list<RemoteSource>& sources) {
+  // compact format, last_seen is the age of the source at save time
+  JsonWriter js;
+  js.raw("{\"saved_at\":")
+      .num(duration_cast<seconds>(system_clock::now().time_since_epoch())
+               .count())
+      .raw(",\"remote_sources\":[");
+  size_t size = 0;
+  for (auto const& source : sources) {
+    size += json_stream_size + source.sdp->text.length();
+  }
+  js.reserve(size);
+  auto now = steady_clock::now();
   int count = 0;
-  std::stringstream ss;
-  ss << "{\n  \"remote_sources\": [";
   for (auto const& source : sources) {
     if (count++) {
-      ss << ", ";
+      js.raw(",\n");
     }
-    ss << remote_source_to_json(source);
+    js.raw("{\"source\":").str(source.source)
+        .raw(",\"id\":").str(source.id)
+        .raw(",\"name\":").str(source.name)
+        .raw(",\"domain\":").str(source.domain)
+        .raw(",\"address\":").str(source.address)
+        .raw(",\"sdp\":").str(source.sdp->text)
+        .raw(",\"last_seen\":")
+        .num(unsigned(
+            duration_cast<second_t>(now - source.last_seen_timepoint)
+                .count()))
+        .raw(",\"announce_period\":").num(source.announce_period)
+        .raw(",\"sap_key\":").num(source.sap_key)
+        .raw(",\"port\":").str(source.port)
+        .raw('}');
   }
-  ss << "  ]\n}\n";
-  return ss.str();
+  js.raw("]}\n");
+  return js.release();
 }
 
 #ifdef _USE_STREAMER_
 std::string streamer_info_to_json(const StreamerInfo& info) {
-  std::stringstream ss;
-  ss << "{" << "\n   \"status\": " << unsigned(info.status)
-     << ",\n   \"file_duration\": " << unsigned(info.file_duration)
-     << ",\n   \"files_num\": " << unsigned(info.files_num)
-     << ",\n   \"player_buffer_files_num\": "
-     << unsigned(info.player_buffer_files_num)
-     << ",\n   \"start_file_id\": " << unsigned(info.start_file_id)
-     << ",\n   \"current_file_id\": " << unsigned(info.current_file_id)
-     << ",\n   \"channels\": " << unsigned(info.channels)
-     << ",\n   \"format\": \"" << info.format << "\""
-     << ",\n   \"rate\": " << unsigned(info.rate) << "\n}\n";
-  return ss.str();
+  JsonWriter js;
+  js.raw("{\n   \"status\": ").num(info.status)
+      .raw(",\n   \"file_duration\": ").num(info.file_duration)
+      .raw(",\n   \"files_num\": ").num(info.files_num)
+      .raw(",\n   \"player_buffer_files_num\": ")
+      .num(info.player_buffer_files_num)
+      .raw(",\n   \"start_file_id\": ").num(info.start_file_id)
+      .raw(",\n   \"current_file_id\": ").num(info.current_file_id)
+      .raw(",\n   \"channels\": ").num(info.channels)
+      .raw(",\n   \"format\": ").str(info.format)
+      .raw(",\n   \"rate\": ").num(info.rate)
+      .raw("\n}\n");
+  return js.release();
 }
 #endif
 
-Config json_to_config_(std::istream& js, Config& config) {
-  try {
-    boost::property_tree::ptree pt;
-    boost::property_tree::read_json(js, pt);
-
-    for (auto const& [key, val] : pt) {
-      if (key == "http_port") {
-        config.set_http_port(val.get_value<int>());
-      } else if (key == "rtsp_port") {
-        config.set_rtsp_port(val.get_value<int>());
-      } else if (key == "http_base_dir") {
-        config.set_http_base_dir(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "streamer_channels") {
-        config.set_streamer_channels(val.get_value<uint8_t>());
-      } else if (key == "streamer_files_num") {
-        config.set_streamer_files_num(val.get_value<uint8_t>());
-      } else if (key == "streamer_file_duration") {
-        config.set_streamer_file_duration(val.get_value<uint16_t>());
-      } else if (key == "streamer_player_buffer_files_num") {
-        config.set_streamer_player_buffer_files_num(val.get_value<uint8_t>());
-      } else if (key == "streamer_enabled") {
-        config.set_streamer_enabled(val.get_value<bool>());
-      } else if (key == "log_severity") {
-        config.set_log_severity(val.get_value<int>());
-      } else if (key == "interface_name") {
-        config.set_interface_name(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "playout_delay") {
-        config.set_playout_delay(val.get_value<uint32_t>());
-      } else if (key == "tic_frame_size_at_1fs") {
-        config.set_tic_frame_size_at_1fs(val.get_value<uint32_t>());
-      } else if (key == "max_tic_frame_size") {
-        config.set_max_tic_frame_size(val.get_value<uint32_t>());
-      } else if (key == "sample_rate") {
-        config.set_sample_rate(val.get_value<uint32_t>());
-      } else if (key == "rtp_mcast_base") {
-        config.set_rtp_mcast_base(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "rtp_mcast_base_sec") {
-        config.set_rtp_mcast_base_sec(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "rtp_port") {
-        config.set_rtp_port(val.get_value<uint16_t>());
-      } else if (key == "rtp_port") {
-        config.set_rtp_port(val.get_value<uint16_t>());
-      } else if (key == "rtp_port_sec") {
-        config.set_rtp_port_sec(val.get_value<uint16_t>());
-      } else if (key == "ptp_domain") {
-        config.set_ptp_domain(val.get_value<uint8_t>());
-      } else if (key == "ptp_dscp") {
-        config.set_ptp_dscp(val.get_value<uint8_t>());
-      } else if (key == "sap_mcast_addr") {
-        config.set_sap_mcast_addr(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "sap_interval") {
-        config.set_sap_interval(val.get_value<uint16_t>());
-      } else if (key == "mdns_enabled") {
-        config.set_mdns_enabled(val.get_value<bool>());
-      } else if (key == "status_file") {
-        config.set_status_file(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "syslog_proto") {
-        config.set_syslog_proto(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "syslog_server") {
-        config.set_syslog_server(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "ptp_status_script") {
-        config.set_ptp_status_script(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "custom_node_id") {
-        config.set_custom_node_id(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "auto_sinks_update") {
-        config.set_auto_sinks_update(val.get_value<bool>());
-      } else if (key == "nmos_enabled") {
-        config.set_nmos_enabled(val.get_value<bool>());
-      } else if (key == "nmos_registry_address") {
-        config.set_nmos_registry_address(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "nmos_registry_port") {
-        config.set_nmos_registry_port(val.get_value<uint16_t>());
-      } else if (key == "nmos_node_port") {
-        config.set_nmos_node_port(val.get_value<uint16_t>());
-      } else if (key == "nmos_label") {
-        config.set_nmos_label(
-            remove_undesired_chars(val.get_value<std::string>()));
-      } else if (key == "ip_addr") {
-        config.set_ip_addr_str(val.get_value<std::string>());
-      } else if (key == "mac_addr" || key == "node_id") {
-        /* ignored */
-      } else {
-        std::cerr << "Warning: unkown configuration option " << key
-                  << std::endl;
-      }
-    }
-  } catch (boost::property_tree::json_parser::json_parser_error& je) {
-    throw std::runtime_error("error parsing JSON at line " +
-                             std::to_string(je.line()) + " :" + je.message());
-  } catch (std::invalid_argument& e) {
-    throw std::runtime_error(
-        "error parsing JSON: cannot perform number conversion");
-  } catch (std::out_of_range& e) {
-    throw std::runtime_error(
-        "error parsing JSON: number conversion out of range");
-  } catch (std::exception& e) {
-    throw std::runtime_error("error parsing JSON: " + std::string(e.what()));
+std::string http_lanes_to_json(const AdmissionControl& admission) {
+  JsonWriter js;
+  js.raw("{\n  \"lanes\": [");
+  for (size_t i = 0; i < AdmissionControl::lanes_num; i++) {
+    auto lane = static_cast<AdmissionControl::Lane>(i);
+    auto const& config = admission.get_config(lane);
+    auto const stats = admission.get_stats(lane);
+    js.raw(i ? ", " : "")
+        .raw("\n    {\n      \"name\": ")
+        .str(AdmissionControl::get_lane_name(lane))
+        .raw(",\n      \"workers\": ").num(config.workers)
+        .raw(",\n      \"queue_max\": ").num(config.queue_max)
+        .raw(",\n      \"admitted\": ").num(stats.admitted)
+        .raw(",\n      \"shed\": ").num(stats.shed)
+        .raw(",\n      \"timeouts\": ").num(stats.timeouts)
+        .raw(",\n      \"running\": ").num(stats.running)
+        .raw(",\n      \"queued\": ").num(stats.queued)
+        .raw(",\n      \"max_running\": ").num(stats.max_running)
+        .raw(",\n      \"max_queued\": ").num(stats.max_queued)
+        .raw(",\n      \"max_wait_us\": ").num(stats.max_wait_us)
+        .raw("\n    }");
+  }
+  js.raw("  ]\n}\n");
+  return js.release();
+}
+
+std::string sap_stats_to_json(const SAPStats& stats) {
+  JsonWriter js;
+  js.raw("{\n  \"interval\": ").num(stats.interval)
+      .raw(",\n  \"bandwidth_limit\": ").num(stats.bandwidth_limit)
+      .raw(",\n  \"slice_budget\": ").num(stats.slice_budget)
+      .raw(",\n  \"rounds\": ").num(stats.rounds)
+      .raw(",\n  \"overruns\": ").num(stats.overruns)
+      .raw(",\n  \"packets_sent\": ").num(stats.packets_sent)
+      .raw(",\n  \"bytes_sent\": ").num(stats.bytes_sent)
+      .raw(",\n  \"last_round\": {")
+      .raw("\n    \"packets_sent\": ").num(stats.last_round.packets_sent)
+      .raw(",\n    \"bytes_sent\": ").num(stats.last_round.bytes_sent)
+      .raw(",\n    \"min_gap_us\": ").num(stats.last_round.min_gap_us)
+      .raw(",\n    \"avg_gap_us\": ").num(stats.last_round.avg_gap_us)
+      .raw(",\n    \"max_gap_us\": ").num(stats.last_round.max_gap_us)
+      .raw("\n  }\n}\n");
+  return js.release();
+}
+
+std::string observers_to_json(
+    const std::vector<ObserverQueue::Stats>& observers) {
+  JsonWriter js;
+  js.raw("{\n  \"observers\": [");
+  bool first = true;
+  for (auto const& stats : observers) {
+    js.raw(first ? "" : ", ")
+        .raw("\n    {\n      \"name\": ").str(stats.name)
+        .raw(",\n      \"posted\": ").num(stats.posted)
+        .raw(",\n      \"dispatched\": ").num(stats.dispatched)
+        .raw(",\n      \"coalesced\": ").num(stats.coalesced)
+        .raw(",\n      \"dropped\": ").num(stats.dropped)
+        .raw(",\n      \"depth\": ").num(stats.depth)
+        .raw(",\n      \"max_depth\": ").num(stats.max_depth)
+        .raw(",\n      \"max_wait_us\": ").num(stats.max_wait_us)
+        .raw(",\n      \"max_dispatch_us\": ").num(stats.max_dispatch_us)
+        .raw("\n    }");
+    first = false;
   }
+  js.raw("  ]\n}\n");
+  return js.release();
+}
+
+static std::string read_stream(std::istream& js) {
+  return std::string(std::istreambuf_iterator<char>(js),
+                     std::istreambuf_iterator<char>());
+}
+
+Config json_to_config_(const std::string& json, Config& config) {
+  JsonReader jr(json);
+  jr.object([&jr, &config](std::string_view key) {
+    if (key == "http_port") {
+      config.set_http_port(jr.get_int<int>());
+    } else if (key == "rtsp_port") {
+      config.set_rtsp_port(jr.get_int<int>());
+    } else if (key == "rtsp_threads") {
+      config.set_rtsp_threads(jr.get_int<uint8_t>());
+    } else if (key == "http_base_dir") {
+      config.set_http_base_dir(remove_undesired_chars(jr.get_string()));
+    } else if (key == "http_unix_socket") {
+      config.set_http_unix_socket(remove_undesired_chars(jr.get_string()));
+    } else if (key == "http_control_threads") {
+      config.set_http_control_threads(jr.get_int<uint16_t>());
+    } else if (key == "http_control_queue") {
+      config.set_http_control_queue(jr.get_int<uint16_t>());
+    } else if (key == "http_read_threads") {
+      config.set_http_read_threads(jr.get_int<uint16_t>());
+    } else if (key == "http_read_queue") {
+      config.set_http_read_queue(jr.get_int<uint16_t>());
+    } else if (key == "http_stream_threads") {
+      config.set_http_stream_threads(jr.get_int<uint16_t>());
+    } else if (key == "streamer_channels") {
+      config.set_streamer_channels(jr.get_int<uint8_t>());
+    } else if (key == "streamer_files_num") {
+      config.set_streamer_files_num(jr.get_int<uint8_t>());
+    } else if (key == "streamer_file_duration") {
+      config.set_streamer_file_duration(jr.get_int<uint16_t>());
+    } else if (key == "streamer_player_buffer_files_num") {
+      config.set_streamer_player_buffer_files_num(jr.get_int<uint8_t>());
+    } else if (key == "streamer_enabled") {
+      config.set_streamer_enabled(jr.get_bool());
+    } else if (key == "log_severity") {
+      config.set_log_severity(jr.get_int<int>());
+    } else if (key == "interface_name") {
+      config.set_interface_name(remove_undesired_chars(jr.get_string()));
+    } else if (key == "playout_delay") {
+      config.set_playout_delay(jr.get_int<uint32_t>());
+    } else if (key == "tic_frame_size_at_1fs") {
+      config.set_tic_frame_size_at_1fs(jr.get_int<uint32_t>());
+    } else if (key == "max_tic_frame_size") {
+      config.set_max_tic_frame_size(jr.get_int<uint32_t>());
+    } else if (key == "sample_rate") {
+      config.set_sample_rate(jr.get_int<uint32_t>());
+    } else if (key == "rtp_mcast_base") {
+      config.set_rtp_mcast_base(remove_undesired_chars(jr.get_string()));
+    } else if (key == "rtp_mcast_base_sec") {
+      config.set_rtp_mcast_base_sec(remove_undesired_chars(jr.get_string()));
+    } else if (key == "rtp_port") {
+      config.set_rtp_port(jr.get_int<uint16_t>());
+    } else if (key == "rtp_port_sec") {
+      config.set_rtp_port_sec(jr.get_int<uint16_t>());
+    } else if (key == "ptp_domain") {
+      config.set_ptp_domain(jr.get_int<uint8_t>());
+    } else if (key == "ptp_dscp") {
+      config.set_ptp_dscp(jr.get_int<uint8_t>());
+    } else if (key == "sap_mcast_addr") {
+      config.set_sap_mcast_addr(remove_undesired_chars(jr.get_string()));
+    } else if (key == "sap_interval") {
+      config.set_sap_interval(jr.get_int<uint16_t>());
+    } else if (key == "sap_compression") {
+      config.set_sap_compression(jr.get_bool());
+    } else if (key == "sap_bandwidth_limit") {
+      config.set_sap_bandwidth_limit(jr.get_int<uint32_t>());
+    } else if (key == "mdns_enabled") {
+      config.set_mdns_enabled(jr.get_bool());
+    } else if (key == "status_file") {
+      config.set_status_file(remove_undesired_chars(jr.get_string()));
+    } else if (key == "browser_cache_file") {
+      config.set_browser_cache_file(remove_undesired_chars(jr.get_string()));
+    } else if (key == "syslog_proto") {
+      config.set_syslog_proto(remove_undesired_chars(jr.get_string()));
+    } else if (key == "syslog_server") {
+      config.set_syslog_server(remove_undesired_chars(jr.get_string()));
+    } else if (key == "ptp_status_script") {
+      config.set_ptp_status_script(remove_undesired_chars(jr.get_string()));
+    } else if (key == "custom_node_id") {
+      config.set_custom_node_id(remove_undesired_chars(jr.get_string()));
+    } else if (key == "auto_sinks_update") {
+      config.set_auto_sinks_update(jr.get_bool());
+    } else if (key == "nmos_enabled") {
+      config.set_nmos_enabled(jr.get_bool());
+    } else if (key == "nmos_registry_address") {
+      config.set_nmos_registry_address(
+          remove_undesired_chars(jr.get_string()));
+    } else if (key == "nmos_registry_port") {
+      config.set_nmos_registry_port(jr.get_int<uint16_t>());
+    } else if (key == "nmos_node_port") {
+      config.set_nmos_node_port(jr.get_int<uint16_t>());
+    } else if (key == "nmos_label") {
+      config.set_nmos_label(remove_undesired_chars(jr.get_string()));
+    } else if (key == "ip_addr") {
+      config.set_ip_addr_str(jr.get_string());
+    } else if (key == "mac_addr" || key == "node_id") {
+      /* ignored */
+      jr.skip();
+    } else {
+      std::cerr << "Warning: unkown configuration option " << key
+                << std::endl;
+      jr.skip();
+    }
+  });
+  jr.end();
   return config;
 }
 
 Config json_to_config(std::istream& js, const Config& curConfig) {
-  Config config(curConfig);
-  return json_to_config_(js, config);
+  return json_to_config(read_stream(js), curConfig);
 }
 
 Config json_to_config(std::istream& js) {
-  Config config;
-  return json_to_config_(js, config);
+  return json_to_config(read_stream(js));
 }
 
 Config json_to_config(const std::string& json, const Config& curConfig) {
-  std::stringstream ss(json);
-  return json_to_config(ss, curConfig);
+  Config config(curConfig);
+  return json_to_config_(json, config);
 }
 
 Config json_to_config(const std::string& json) {
-  std::stringstream ss(json);
-  return json_to_config(ss);
+  Config config;
+  return json_to_config_(json, config);
+}
+
+static uint16_t parse_stream_id(const std::string& id) {
+  try {
+    auto stream_id = std::stoi(id);
+    if (stream_id < 0 || stream_id > std::numeric_limits<uint16_t>::max()) {
+      throw std::out_of_range("invalid id");
+    }
+    return stream_id;
+  } catch (std::invalid_argument& e) {
+    throw std::runtime_error(
+        "error parsing JSON: cannot perform number conversion");
+  } catch (std::out_of_range& e) {
+    throw std::runtime_error(
+        "error parsing JSON: number conversion out of range");
+  }
+}
+
+/* source map determite the association with
+   ALSA output channels used to playing */
+static void parse_source(JsonReader& jr, StreamSource& source, bool with_id) {
+  static constexpr std::string_view members[] = {
+      "id", "enabled", "name", "io", "max_samples_per_packet", "codec",
+      "address", "ttl", "payload_type", "dscp", "refclk_ptp_traceable",
+      "map"};
+  JsonRequiredMembers required(members);
+  if (!with_id) {
+    required.found("id");
+  }
+  jr.object([&jr, &source, &required, with_id](std::string_view key) {
+    required.found(key);
+    if (key == "id" && with_id) {
+      source.id = jr.get_int<uint16_t>();
+    } else if (key == "enabled") {
+      source.enabled = jr.get_bool();
+    } else if (key == "name") {
+      source.name = jr.get_string();
+    } else if (key == "io") {
+      source.io = jr.get_string();
+    } else if (key == "max_samples_per_packet") {
+      source.max_samples_per_packet = jr.get_int<uint32_t>();
+    } else if (key == "codec") {
+      source.codec = jr.get_string();
+    } else if (key == "address") {
+      source.address = jr.get_string();
+    } else if (key == "ttl") {
+      source.ttl = jr.get_int<uint8_t>();
+    } else if (key == "payload_type") {
+      source.payload_type = jr.get_int<uint8_t>();
+    } else if (key == "dscp") {
+      source.dscp = jr.get_int<uint8_t>();
+    } else if (key == "refclk_ptp_traceable") {
+      source.refclk_ptp_traceable = jr.get_bool();
+    } else if (key == "map") {
+      source.map.clear();
+      jr.array([&jr, &source]() {
+        source.map.emplace_back(jr.get_int<uint8_t>());
+      });
+    } else {
+      jr.skip();
+    }
+  });
+  required.check(jr);
+}
+
+/* sink map determite the association with
+   ALSA input channels used to recording */
+static void parse_sink(JsonReader& jr, StreamSink& sink, bool with_id) {
+  static constexpr std::string_view members[] = {
+      "id", "name", "io", "source", "use_sdp", "sdp", "delay",
+      "ignore_refclk_gmid", "map"};
+  JsonRequiredMembers required(members);
+  if (!with_id) {
+    required.found("id");
+  }
+  jr.object([&jr, &sink, &required, with_id](std::string_view key) {
+    required.found(key);
+    if (key == "id" && with_id) {
+      sink.id = jr.get_int<uint16_t>();
+    } else if (key == "name") {
+      sink.name = jr.get_string();
+    } else if (key == "io") {
+      sink.io = jr.get_string();
+    } else if (key == "source") {
+      sink.source = jr.get_string();
+    } else if (key == "use_sdp") {
+      sink.use_sdp = jr.get_bool();
+    } else if (key == "sdp") {
+      sink.sdp = jr.get_string();
+    } else if (key == "delay") {
+      sink.delay = jr.get_int<uint32_t>();
+    } else if (key == "ignore_refclk_gmid") {
+      sink.ignore_refclk_gmid = jr.get_bool();
+    } else if (key == "map") {
+      sink.map.clear();
+      jr.array([&jr, &sink]() {
+        sink.map.emplace_back(jr.get_int<uint8_t>());
+      });
+    } else {
+      jr.skip();
+    }
+  });
+  required.check(jr);
 }
 
 StreamSource json_to_source(const std::string& id, const std::string& json) {
@@ -457,40 +731,14 @@ StreamSource json_to_source(const std::string& id, const std::string& json) {
     "refclk_ptp_traceable": false
   */
   StreamSource source;
-  try {
-    boost::property_tree::ptree pt;
-    std::stringstream ss(json);
-    boost::property_tree::read_json(ss, pt);
-
-    source.id = std::stoi(id);
-    source.enabled = pt.get<bool>("enabled");
-    source.name = remove_undesired_chars(pt.get<std::string>("name"));
-    source.io = remove_undesired_chars(pt.get<std::string>("io"));
-    /* source map determite the association with
-       ALSA output channels used to playing */
-    BOOST_FOREACH (boost::property_tree::ptree::value_type& v,
-                   pt.get_child("map")) {
-      source.map.emplace_back(std::stoi(v.second.data()));
-    }
-    source.max_samples_per_packet = pt.get<uint32_t>("max_samples_per_packet");
-    source.codec = remove_undesired_chars(pt.get<std::string>("codec"));
-    source.address = remove_undesired_chars(pt.get<std::string>("address"));
-    source.ttl = pt.get<uint8_t>("ttl");
-    source.payload_type = pt.get<uint8_t>("payload_type");
-    source.dscp = pt.get<uint8_t>("dscp");
-    source.refclk_ptp_traceable = pt.get<bool>("refclk_ptp_traceable");
-  } catch (boost::property_tree::json_parser::json_parser_error& je) {
-    throw std::runtime_error("error parsing JSON at line " +
-                             std::to_string(je.line()) + " :" + je.message());
-  } catch (std::invalid_argument& e) {
-    throw std::runtime_error(
-        "error parsing JSON: cannot perform number conversion");
-  } catch (std::out_of_range& e) {
-    throw std::runtime_error(
-        "error parsing JSON: number conversion out of range");
-  } catch (std::exception& e) {
-    throw std::runtime_error("error parsing JSON: " + std::string(e.what()));
-  }
+  source.id = parse_stream_id(id);
+  JsonReader jr(json);
+  parse_source(jr, source, false);
+  jr.end();
+  source.name = remove_undesired_chars(source.name);
+  source.io = remove_undesired_chars(source.io);
+  source.codec = remove_undesired_chars(source.codec);
+  source.address = remove_undesired_chars(source.address);
   return source;
 }
 
@@ -506,154 +754,187 @@ StreamSink json_to_sink(const std::string& id, const std::string& json) {
     "map": [ 0, 1, 2, 3, 4, 5, 6, 7 ]
   */
   StreamSink sink;
-  try {
-    boost::property_tree::ptree pt;
-    std::stringstream ss(json);
-    boost::property_tree::read_json(ss, pt);
-
-    sink.id = std::stoi(id);
-    sink.name = remove_undesired_chars(pt.get<std::string>("name"));
-    sink.io = remove_undesired_chars(pt.get<std::string>("io"));
-    sink.source = remove_undesired_chars(pt.get<std::string>("source"));
-    sink.use_sdp = pt.get<bool>("use_sdp");
-    sink.sdp = remove_undesired_chars(pt.get<std::string>("sdp"));
-    sink.delay = pt.get<uint32_t>("delay");
-    sink.ignore_refclk_gmid = pt.get<bool>("ignore_refclk_gmid");
-    /* source map determite the association with
-       ALSA input channels used to recording */
-    BOOST_FOREACH (boost::property_tree::ptree::value_type& v,
-                   pt.get_child("map")) {
-      sink.map.emplace_back(std::stoi(v.second.data()));
-    }
-  } catch (boost::property_tree::json_parser::json_parser_error& je) {
-    throw std::runtime_error("error parsing JSON at line " +
-                             std::to_string(je.line()) + " :" + je.message());
-  } catch (std::invalid_argument& e) {
-    throw std::runtime_error(
-        "error parsing JSON: cannot perform number conversion");
-  } catch (std::out_of_range& e) {
-    throw std::runtime_error(
-        "error parsing JSON: number conversion out of range");
-  } catch (std::exception& e) {
-    throw std::runtime_error("error parsing JSON: " + std::string(e.what()));
-  }
+  sink.id = parse_stream_id(id);
+  JsonReader jr(json);
+  parse_sink(jr, sink, false);
+  jr.end();
+  sink.name = remove_undesired_chars(sink.name);
+  sink.io = remove_undesired_chars(sink.io);
+  sink.source = remove_undesired_chars(sink.source);
+  sink.sdp = remove_undesired_chars(sink.sdp);
   return sink;
 }
 
 PTPConfig json_to_ptp_config(const std::string& json) {
+  static constexpr std::string_view members[] = {"domain", "dscp"};
   PTPConfig ptpConfig;
-  try {
-    boost::property_tree::ptree pt;
-    std::stringstream ss(json);
-    boost::property_tree::read_json(ss, pt);
-
-    ptpConfig.domain = pt.get<int>("domain");
-    ptpConfig.dscp = pt.get<int>("dscp");
-  } catch (boost::property_tree::json_parser::json_parser_error& je) {
-    throw std::runtime_error("error parsing JSON at line " +
-                             std::to_string(je.line()) + " :" + je.message());
-  }
+  JsonRequiredMembers required(members);
+  JsonReader jr(json);
+  jr.object([&jr, &ptpConfig, &required](std::string_view key) {
+    required.found(key);
+    if (key == "domain") {
+      ptpConfig.domain = jr.get_int<uint8_t>();
+    } else if (key == "dscp") {
+      ptpConfig.dscp = jr.get_int<uint8_t>();
+    } else {
+      jr.skip();
+    }
+  });
+  required.check(jr);
+  jr.end();
   return ptpConfig;
 }
 
-void json_to_sources(const std::string& json,
-                     std::list<StreamSource>& sources) {
-  std::stringstream ss(json);
-  return json_to_sources(ss, sources);
-}
-
-static void parse_json_sources(boost::property_tree::ptree& pt,
+static void parse_json_sources(JsonReader& jr,
                                std::list<StreamSource>& sources) {
-  BOOST_FOREACH (auto const& v, pt.get_child("sources")) {
+  jr.array([&jr, &sources]() {
     StreamSource source;
-    source.id = v.second.get<uint8_t>("id");
-    source.enabled = v.second.get<bool>("enabled");
-    source.name = v.second.get<std::string>("name");
-    source.io = v.second.get<std::string>("io");
-    source.max_samples_per_packet =
-        v.second.get<uint32_t>("max_samples_per_packet");
-    source.codec = v.second.get<std::string>("codec");
-    source.address = v.second.get<std::string>("address");
-    source.ttl = v.second.get<uint8_t>("ttl");
-    source.payload_type = v.second.get<uint8_t>("payload_type");
-    source.dscp = v.second.get<uint8_t>("dscp");
-    source.refclk_ptp_traceable = v.second.get<bool>("refclk_ptp_traceable");
-    /* source map determite the association with
-       ALSA output channels used to playing */
-    BOOST_FOREACH (const boost::property_tree::ptree::value_type& vm,
-                   v.second.get_child("map")) {
-      source.map.emplace_back(std::stoi(vm.second.data()));
-    }
+    parse_source(jr, source, true);
     sources.emplace_back(std::move(source));
-  }
+  });
 }
 
-void json_to_sources(std::istream& js, std::list<StreamSource>& sources) {
-  try {
-    boost::property_tree::ptree pt;
-    boost::property_tree::read_json(js, pt);
-    parse_json_sources(pt, sources);
-  } catch (boost::property_tree::json_parser::json_parser_error& je) {
-    throw std::runtime_error("error parsing JSON at line " +
-                             std::to_string(je.line()) + " :" + je.message());
-  }
+static void parse_json_sinks(JsonReader& jr, std::list<StreamSink>& sinks) {
+  jr.array([&jr, &sinks]() {
+    StreamSink sink;
+    parse_sink(jr, sink, true);
+    sinks.emplace_back(std::move(sink));
+  });
 }
 
-void json_to_sinks(const std::string& json, std::list<StreamSink>& sinks) {
-  std::stringstream ss(json);
-  return json_to_sinks(ss, sinks);
+void json_to_sources(const std::string& json,
+                     std::list<StreamSource>& sources) {
+  static constexpr std::string_view members[] = {"sources"};
+  JsonRequiredMembers required(members);
+  JsonReader jr(json);
+  jr.object([&jr, &sources, &required](std::string_view key) {
+    required.found(key);
+    if (key == "sources") {
+      parse_json_sources(jr, sources);
+    } else {
+      jr.skip();
+    }
+  });
+  required.check(jr);
+  jr.end();
 }
 
-static void parse_json_sinks(boost::property_tree::ptree& pt,
-                             std::list<StreamSink>& sinks) {
-  BOOST_FOREACH (auto const& v, pt.get_child("sinks")) {
-    StreamSink sink;
-    sink.id = v.second.get<uint8_t>("id");
-    sink.name = v.second.get<std::string>("name");
-    sink.io = v.second.get<std::string>("io");
-    sink.source = v.second.get<std::string>("source");
-    sink.use_sdp = v.second.get<bool>("use_sdp");
-    sink.sdp = v.second.get<std::string>("sdp");
-    sink.delay = v.second.get<uint32_t>("delay");
-    sink.ignore_refclk_gmid = v.second.get<bool>("ignore_refclk_gmid");
-    /* source map determite the association with
-       ALSA input channels used to recording */
-    BOOST_FOREACH (const boost::property_tree::ptree::value_type& vm,
-                   v.second.get_child("map")) {
-      sink.map.emplace_back(std::stoi(vm.second.data()));
+void json_to_sources(std::istream& js, std::list<StreamSource>& sources) {
+  json_to_sources(read_stream(js), sources);
+}
+
+void json_to_sinks(const std::string& json, std::list<StreamSink>& sinks) {
+  static constexpr std::string_view members[] = {"sinks"};
+  JsonRequiredMembers required(members);
+  JsonReader jr(json);
+  jr.object([&jr, &sinks, &required](std::string_view key) {
+    required.found(key);
+    if (key == "sinks") {
+      parse_json_sinks(jr, sinks);
+    } else {
+      jr.skip();
     }
-    sinks.emplace_back(std::move(sink));
-  }
+  });
+  required.check(jr);
+  jr.end();
 }
 
 void json_to_sinks(std::istream& js, std::list<StreamSink>& sinks) {
-  try {
-    boost::property_tree::ptree pt;
-    boost::property_tree::read_json(js, pt);
-    parse_json_sinks(pt, sinks);
-  } catch (boost::property_tree::json_parser::json_parser_error& je) {
-    throw std::runtime_error("error parsing JSON at line " +
-                             std::to_string(je.line()) + " :" + je.message());
+  json_to_sinks(read_stream(js), sinks);
+}
+
+void json_to_remote_sources_cache(std::istream& js,
+                                  std::list<RemoteSource>& sources) {
+  static constexpr std::string_view members[] = {"saved_at",
+                                                 "remote_sources"};
+  static constexpr std::string_view source_members[] = {
+      "source", "id", "name", "domain", "address", "sdp", "last_seen",
+      "sap_key", "announce_period"};
+  auto json = read_stream(js);
+  JsonRequiredMembers required(members);
+  JsonReader jr(json);
+  int64_t saved_at{0};
+  // last_seen of each source, converted once saved_at is known
+  std::list<RemoteSource> parsed;
+  std::vector<uint32_t> last_seen;
+  jr.object([&](std::string_view key) {
+    required.found(key);
+    if (key == "saved_at") {
+      saved_at = jr.get_int<int64_t>();
+    } else if (key == "remote_sources") {
+      jr.array([&]() {
+        RemoteSource source;
+        JsonRequiredMembers source_required(source_members);
+        jr.object([&](std::string_view key) {
+          source_required.found(key);
+          if (key == "source") {
+            source.source = jr.get_string();
+          } else if (key == "id") {
+            source.id = jr.get_string();
+          } else if (key == "name") {
+            source.name = jr.get_string();
+          } else if (key == "domain") {
+            source.domain = jr.get_string();
+          } else if (key == "address") {
+            source.address = jr.get_string();
+          } else if (key == "sdp") {
+            source.sdp = std::make_shared<RemoteSdp>(jr.get_string());
+          } else if (key == "last_seen") {
+            last_seen.push_back(jr.get_int<uint32_t>());
+          } else if (key == "announce_period") {
+            source.announce_period = jr.get_int<uint32_t>();
+          } else if (key == "sap_key") {
+            source.sap_key = jr.get_int<uint64_t>();
+          } else if (key == "port") {
+            source.port = jr.get_string();
+          } else {
+            jr.skip();
+          }
+        });
+        source_required.check(jr);
+        parsed.emplace_back(std::move(source));
+      });
+    } else {
+      jr.skip();
+    }
+  });
+  required.check(jr);
+  jr.end();
+
+  auto now =
+      duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+  // time elapsed since the cache was saved, the clock may have moved back
+  auto elapsed = std::max<int64_t>(now - saved_at, 0);
+  auto it = last_seen.begin();
+  for (auto& source : parsed) {
+    source.last_seen_timepoint =
+        steady_clock::now() - seconds(elapsed + *it++);
   }
+  sources.splice(sources.end(), parsed);
 }
 
-void json_to_streams(const std::string& json,
+void json_to_streams(std::istream& js,
                      std::list<StreamSource>& sources,
                      std::list<StreamSink>& sinks) {
-  std::stringstream ss(json);
-  json_to_streams(ss, sources, sinks);
+  json_to_streams(read_stream(js), sources, sinks);
 }
 
-void json_to_streams(std::istream& js,
+void json_to_streams(const std::string& json,
                      std::list<StreamSource>& sources,
                      std::list<StreamSink>& sinks) {
-  try {
-    boost::property_tree::ptree pt;
-    boost::property_tree::read_json(js, pt);
-    parse_json_sources(pt, sources);
-    parse_json_sinks(pt, sinks);
-  } catch (boost::property_tree::json_parser::json_parser_error& je) {
-    throw std::runtime_error("error parsing JSON at line " +
-                             std::to_string(je.line()) + " :" + je.message());
-  }
+  static constexpr std::string_view members[] = {"sources", "sinks"};
+  JsonRequiredMembers required(members);
+  JsonReader jr(json);
+  jr.object([&jr, &sources, &sinks, &required](std::string_view key) {
+    required.found(key);
+    if (key == "sources") {
+      parse_json_sources(jr, sources);
+    } else if (key == "sinks") {
+      parse_json_sinks(jr, sinks);
+    } else {
+      jr.skip();
+    }
+  });
+  required.check(jr);
+  jr.end();
 }
@@ -22,6 +22,7 @@
 
 #include <list>
 
+#include "admission_control.hpp"
 #include "browser.hpp"
 #include "session_manager.hpp"
 
@@ -42,9 +43,23 @@ std::string streams_to_json(const std::list<StreamSource>& sources,
                             const std::list<StreamSink>& sinks);
 std::string remote_source_to_json(const RemoteSource& source);
 std::string remote_sources_to_json(const std::list<RemoteSource>& sources);
+std::string remote_sources_delta_to_json(const RemoteSourcesDelta& delta);
+std::string remote_sources_cache_to_json(
+    const std::list<RemoteSource>& sources);
 #ifdef _USE_STREAMER_
 std::string streamer_info_to_json(const StreamerInfo& info);
 #endif
+std::string http_lanes_to_json(const AdmissionControl& admission);
+std::string sap_stats_to_json(const SAPStats& stats);
+std::string observers_to_json(
+    const std::vector<ObserverQueue::Stats>& observers);
+/* events data, serialized on a single line */
+std::string stream_event_to_json(const std::string& action,
+                                 uint16_t id,
+                                 const std::string& name);
+std::string sink_status_event_to_json(uint16_t id,
+                                      const SinkStreamStatus& status);
+std::string seq_event_to_json(uint64_t seq);
 
 /* JSON deserializers */
 Config json_to_config(std::istream& jstream, const Config& curCconfig);
@@ -61,6 +76,8 @@ void json_to_sinks(const std::string& json, std::list<StreamSink>& sinks);
 void json_to_streams(std::istream& jstream,
                      std::list<StreamSource>& sources,
                      std::list<StreamSink>& sinks);
+void json_to_remote_sources_cache(std::istream& jstream,
+                                  std::list<RemoteSource>& sources);
 void json_to_streams(const std::string& json,
                      std::list<StreamSource>& sources,
                      std::list<StreamSink>& sinks);
@@ -0,0 +1,441 @@
+//
+//  json_reader.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _JSON_READER_HPP_
+#define _JSON_READER_HPP_
+
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+ * Single pass JSON reader used by the deserializers.
+ * The caller walks the document following its schema: object() and array()
+ * invoke a callback for each member or element that must read the value
+ * with one of the get_*() methods or skip() it.
+ * No tree is built, keys are returned as views of the input when they
+ * contain no escapes and only the string values read are allocated.
+ * Errors are reported as std::runtime_error with the line and column.
+ */
+class JsonReader {
+ public:
+  constexpr static int depth_max = 64;
+
+  explicit JsonReader(std::string_view json)
+      : begin_(json.data()), p_(json.data()), end_(json.data() + json.size()) {
+    // skip UTF-8 BOM
+    if (json.substr(0, 3) == "\xEF\xBB\xBF") {
+      p_ += 3;
+    }
+  }
+
+  /* parse an object calling member(key) for each member */
+  template <typename F>
+  void object(F&& member) {
+    expect('{');
+    if (skip_ws() == '}') {
+      p_++;
+      return;
+    }
+    do {
+      if (skip_ws() != '"') {
+        error("expected member name");
+      }
+      auto key = read_key();
+      expect(':');
+      member(key);
+    } while (next('}'));
+  }
+
+  /* parse an array calling element() for each element */
+  template <typename F>
+  void array(F&& element) {
+    expect('[');
+    if (skip_ws() == ']') {
+      p_++;
+      return;
+    }
+    do {
+      element();
+    } while (next(']'));
+  }
+
+  std::string get_string() {
+    if (skip_ws() != '"') {
+      error("expected string");
+    }
+    std::string res;
+    read_string(res);
+    return res;
+  }
+
+  /* integers are accepted also between quotes */
+  template <typename T>
+  T get_int() {
+    static_assert(std::is_integral_v<T>);
+    using I = std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>;
+    bool quoted = skip_ws() == '"';
+    if (quoted) {
+      p_++;
+    }
+    I value{0};
+    auto start = p_;
+    if (std::is_unsigned_v<T> && p_ < end_ && *p_ == '-') {
+      error("number out of range");
+    }
+    auto [ptr, ec] = std::from_chars(p_, end_, value);
+    if (ec == std::errc::result_out_of_range) {
+      error("number out of range");
+    }
+    if (ec != std::errc() || (ptr < end_ && (*ptr == '.' || *ptr == 'e' ||
+                                             *ptr == 'E'))) {
+      error("expected integer");
+    }
+    if (value < I(std::numeric_limits<T>::min()) ||
+        value > I(std::numeric_limits<T>::max())) {
+      p_ = start;
+      error("number out of range");
+    }
+    p_ = ptr;
+    if (quoted) {
+      if (p_ == end_ || *p_ != '"') {
+        error("expected integer");
+      }
+      p_++;
+    }
+    return T(value);
+  }
+
+  /* booleans are accepted also between quotes */
+  bool get_bool() {
+    bool quoted = skip_ws() == '"';
+    if (quoted) {
+      p_++;
+    }
+    bool value;
+    if (literal("true")) {
+      value = true;
+    } else if (literal("false")) {
+      value = false;
+    } else {
+      error("expected boolean");
+    }
+    if (quoted) {
+      if (p_ == end_ || *p_ != '"') {
+        error("expected boolean");
+      }
+      p_++;
+    }
+    return value;
+  }
+
+  /* skip the next value */
+  void skip(int depth = 0) {
+    if (depth > depth_max) {
+      error("nesting too deep");
+    }
+    switch (skip_ws()) {
+      case '{':
+        object([this, depth](std::string_view) { skip(depth + 1); });
+        break;
+      case '[':
+        array([this, depth]() { skip(depth + 1); });
+        break;
+      case '"':
+        // keep scratch_ valid, it may hold the key of the skipped value
+        skipped_.clear();
+        read_string(skipped_);
+        break;
+      case 't':
+      case 'f':
+        get_bool();
+        break;
+      case 'n':
+        if (!literal("null")) {
+          error("unexpected character");
+        }
+        break;
+      default:
+        skip_number();
+    }
+  }
+
+  /* check that nothing but white spaces follow the document */
+  void end() {
+    if (skip_ws() != 0) {
+      error("unexpected data after the document");
+    }
+  }
+
+  /* throw an error at the current position */
+  [[noreturn]] void error(const std::string& message) const {
+    int line = 1;
+    auto line_begin = begin_;
+    for (auto p = begin_; p < p_ && p < end_; p++) {
+      if (*p == '\n') {
+        line++;
+        line_begin = p + 1;
+      }
+    }
+    throw std::runtime_error("error parsing JSON at line " +
+                             std::to_string(line) + " column " +
+                             std::to_string(p_ - line_begin + 1) + ": " +
+                             message);
+  }
+
+ private:
+  /* return the next non white space character or 0 at the end */
+  char skip_ws() {
+    while (p_ < end_ &&
+           (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) {
+      p_++;
+    }
+    return p_ < end_ ? *p_ : 0;
+  }
+
+  void expect(char c) {
+    if (skip_ws() != c) {
+      error(std::string("expected '") + c + "'");
+    }
+    p_++;
+  }
+
+  /* consume a separator, return false at the closing character */
+  bool next(char close) {
+    auto c = skip_ws();
+    if (c == ',') {
+      p_++;
+      return true;
+    }
+    if (c != close) {
+      error(std::string("expected ',' or '") + close + "'");
+    }
+    p_++;
+    return false;
+  }
+
+  bool literal(std::string_view text) {
+    if (std::string_view(p_, end_ - p_).substr(0, text.size()) != text) {
+      return false;
+    }
+    p_ += text.size();
+    return true;
+  }
+
+  std::string_view read_key() {
+    auto start = p_ + 1;
+    auto p = start;
+    while (p < end_ && *p != '"' && *p != '\\' && uint8_t(*p) >= 0x20) {
+      p++;
+    }
+    if (p < end_ && *p == '"') {
+      p_ = p + 1;
+      return std::string_view(start, p - start);
+    }
+    scratch_.clear();
+    read_string(scratch_);
+    return scratch_;
+  }
+
+  /* append the unescaped string starting at the opening quote */
+  void read_string(std::string& out) {
+    p_++;
+    while (true) {
+      auto run = p_;
+      while (run < end_ && *run != '"' && *run != '\\' &&
+             uint8_t(*run) >= 0x20) {
+        run++;
+      }
+      out.append(p_, run - p_);
+      p_ = run;
+      if (p_ == end_) {
+        error("unterminated string");
+      }
+      if (*p_ == '"') {
+        p_++;
+        return;
+      }
+      if (*p_ != '\\') {
+        error("control character in string");
+      }
+      if (++p_ == end_) {
+        error("unterminated string");
+      }
+      switch (*p_++) {
+        case '"':
+          out.push_back('"');
+          break;
+        case '\\':
+          out.push_back('\\');
+          break;
+        case '/':
+          out.push_back('/');
+          break;
+        case 'b':
+          out.push_back('\b');
+          break;
+        case 'f':
+          out.push_back('\f');
+          break;
+        case 'n':
+          out.push_back('\n');
+          break;
+        case 'r':
+          out.push_back('\r');
+          break;
+        case 't':
+          out.push_back('\t');
+          break;
+        case 'u':
+          append_utf8(out, read_code_point());
+          break;
+        default:
+          p_--;
+          error("invalid escape sequence");
+      }
+    }
+  }
+
+  uint32_t read_hex4() {
+    uint32_t value{0};
+    if (end_ - p_ < 4) {
+      error("invalid unicode escape");
+    }
+    auto [ptr, ec] = std::from_chars(p_, p_ + 4, value, 16);
+    if (ec != std::errc() || ptr != p_ + 4) {
+      error("invalid unicode escape");
+    }
+    p_ += 4;
+    return value;
+  }
+
+  uint32_t read_code_point() {
+    auto cp = read_hex4();
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+      // surrogate pair
+      if (!literal("\\u")) {
+        error("invalid unicode surrogate pair");
+      }
+      auto low = read_hex4();
+      if (low < 0xDC00 || low > 0xDFFF) {
+        error("invalid unicode surrogate pair");
+      }
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+    }
+    return cp;
+  }
+
+  static void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+      out.push_back(char(cp));
+    } else if (cp < 0x800) {
+      out.push_back(char(0xC0 | (cp >> 6)));
+      out.push_back(char(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      out.push_back(char(0xE0 | (cp >> 12)));
+      out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(char(0x80 | (cp & 0x3F)));
+    } else {
+      out.push_back(char(0xF0 | (cp >> 18)));
+      out.push_back(char(0x80 | ((cp >> 12) & 0x3F)));
+      out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(char(0x80 | (cp & 0x3F)));
+    }
+  }
+
+  bool skip_digits() {
+    auto start = p_;
+    while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+      p_++;
+    }
+    return p_ > start;
+  }
+
+  /* skip a number validating the JSON number syntax */
+  void skip_number() {
+    auto start = p_;
+    if (p_ < end_ && *p_ == '-') {
+      p_++;
+    }
+    if (!skip_digits()) {
+      p_ = start;
+      error("unexpected character");
+    }
+    if (p_ < end_ && *p_ == '.') {
+      p_++;
+      if (!skip_digits()) {
+        error("invalid number");
+      }
+    }
+    if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+      p_++;
+      if (p_ < end_ && (*p_ == '+' || *p_ == '-')) {
+        p_++;
+      }
+      if (!skip_digits()) {
+        error("invalid number");
+      }
+    }
+  }
+
+  const char* begin_;
+  const char* p_;
+  const char* end_;
+  std::string scratch_;
+  std::string skipped_;
+};
+
+/* tracks the required members of an object to report the missing ones */
+class JsonRequiredMembers {
+ public:
+  template <size_t N>
+  explicit JsonRequiredMembers(const std::string_view (&names)[N])
+      : names_(names), size_(N) {
+    static_assert(N <= 64);
+  }
+
+  void found(std::string_view key) {
+    for (size_t i = 0; i < size_; i++) {
+      if (names_[i] == key) {
+        found_ |= uint64_t(1) << i;
+        return;
+      }
+    }
+  }
+
+  /* throw an error for the first missing member */
+  void check(const JsonReader& reader) const {
+    for (size_t i = 0; i < size_; i++) {
+      if (!(found_ & (uint64_t(1) << i))) {
+        reader.error("missing member " + std::string(names_[i]));
+      }
+    }
+  }
+
+ private:
+  const std::string_view* names_;
+  size_t size_;
+  uint64_t found_{0};
+};
+
+#endif
@@ -0,0 +1,141 @@
+//
+//  json_writer.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _JSON_WRITER_HPP_
+#define _JSON_WRITER_HPP_
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+enum : uint8_t { json_char_drop = 0, json_char_copy = 1 };
+
+/* JSON string character classes: drop, copy or the character to use
+ * after the backslash */
+constexpr std::array<uint8_t, 256> make_json_char_class() {
+  std::array<uint8_t, 256> table{};
+  for (int c = 'a'; c <= 'z'; c++)
+    table[c] = json_char_copy;
+  for (int c = 'A'; c <= 'Z'; c++)
+    table[c] = json_char_copy;
+  for (int c = '0'; c <= '9'; c++)
+    table[c] = json_char_copy;
+  for (auto c : " :~.,_/=%()?#-")
+    table[uint8_t(c)] = json_char_copy;
+  table[0] = json_char_drop;
+  table['\r'] = 'r';
+  table['\n'] = 'n';
+  table['\t'] = 't';
+  return table;
+}
+inline constexpr std::array<uint8_t, 256> json_char_class{
+    make_json_char_class()};
+
+/*
+ * Append-only JSON writer used by the serializers.
+ * Strings are filtered and escaped using a precomputed character class
+ * table, characters outside of the allowed set are dropped as done by
+ * filter(). The buffer can be reserved ahead with the expected size.
+ */
+class JsonWriter {
+ public:
+  explicit JsonWriter(size_t size = 256) { buf_.reserve(size); }
+
+  /* reserve space for size more bytes */
+  void reserve(size_t size) { buf_.reserve(buf_.size() + size); }
+
+  /* append the text as is */
+  JsonWriter& raw(const char* text) {
+    buf_.append(text);
+    return *this;
+  }
+  JsonWriter& raw(const std::string& text) {
+    buf_.append(text);
+    return *this;
+  }
+  JsonWriter& raw(char c) {
+    buf_.push_back(c);
+    return *this;
+  }
+
+  /* append the filtered and escaped string between quotes */
+  JsonWriter& str(const std::string& s) {
+    buf_.push_back('"');
+    escape(s.data(), s.data() + s.length());
+    buf_.push_back('"');
+    return *this;
+  }
+
+  template <typename T,
+            typename std::enable_if_t<std::is_integral_v<T> &&
+                                          !std::is_same_v<T, bool>,
+                                      int> = 0>
+  JsonWriter& num(T value) {
+    char tmp[24];
+    auto res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    buf_.append(tmp, res.ptr - tmp);
+    return *this;
+  }
+
+  JsonWriter& boolean(bool value) {
+    return value ? raw("true") : raw("false");
+  }
+
+  size_t size() const { return buf_.size(); }
+  const std::string& data() const { return buf_; }
+  std::string release() { return std::move(buf_); }
+
+  /* remove the characters not allowed in the JSON strings */
+  static std::string filter(const std::string& s) {
+    std::string res;
+    res.reserve(s.length());
+    for (auto c : s) {
+      if (json_char_class[uint8_t(c)] != json_char_drop) {
+        res.push_back(c);
+      }
+    }
+    return res;
+  }
+
+ private:
+  void escape(const char* p, const char* end) {
+    while (p < end) {
+      auto run = p;
+      while (run < end && json_char_class[uint8_t(*run)] == json_char_copy) {
+        run++;
+      }
+      buf_.append(p, run - p);
+      if (run == end) {
+        break;
+      }
+      auto cls = json_char_class[uint8_t(*run)];
+      if (cls != json_char_drop) {
+        buf_.push_back('\\');
+        buf_.push_back(cls);
+      }
+      p = run + 1;
+    }
+  }
+
+  std::string buf_;
+};
+
+#endif
@@ -264,6 +264,12 @@ int main(int argc, char* argv[]) {
       /* save session status to file */
       session_manager->save_status();
 
+      /* deliver the pending notifications while the observers are running */
+      if (!session_manager->stop_observers()) {
+        throw std::runtime_error(
+            std::string("SessionManager:: stop observers failed"));
+      }
+
 #ifdef _USE_NMOS_
       /* stop NMOS manager */
       if (config->get_nmos_enabled() && nmos_manager) {
@@ -87,22 +87,9 @@ void MDNSClient::resolve_callback(AvahiServiceResolver* r,
            (mdns.config_->get_interface_name(0) != "lo")) ||
           ((flags & AVAHI_LOOKUP_RESULT_LOCAL) &&
            (mdns.config_->get_interface_name(0) == "lo"))) {
-        std::lock_guard<std::mutex> lock{mdns.sources_res_mutex_};
-
-        /* process RTSP client in async task */
-        mdns.sources_res_.emplace_back(std::async(
-            std::launch::async,
-            [&mdns, name_ = std::forward<std::string>(name),
-             domain_ = std::forward<std::string>(domain),
-             addr_ = std::forward<std::string>(addr),
-             port_ = std::forward<std::string>(std::to_string(port))] {
-              RtspClient::process(
-                  std::bind(&MDNSClient::on_change_rtsp_source, &mdns,
-                            std::placeholders::_1, std::placeholders::_2,
-                            std::placeholders::_3),
-                  name_, domain_, std::string("/by-name/") + name_, addr_,
-                  port_);
-            }));
+        /* describe the source and wait for updates */
+        mdns.rtsp_engine_.start(name, domain, std::string("/by-name/") + name,
+                                addr, std::to_string(port));
       }
 
       break;
@@ -160,7 +147,7 @@ void MDNSClient::browse_callback(AvahiServiceBrowser* b,
       BOOST_LOG_TRIVIAL(info)
           << "mdns_client:: (Browser) REMOVE: " << "service " << name
           << " of type " << type << " in domain " << domain;
-      RtspClient::stop(name, domain);
+      mdns.rtsp_engine_.stop(name, domain);
       mdns.on_remove_rtsp_source(name, domain);
       break;
 
@@ -215,6 +202,7 @@ bool MDNSClient::init() {
     return true;
   }
 
+  rtsp_engine_.init();
 #ifdef _USE_AVAHI_
   /* allocate poll loop object */
   poll_.reset(avahi_threaded_poll_new());
@@ -237,49 +225,59 @@ bool MDNSClient::init() {
 
   (void)avahi_threaded_poll_start(poll_.get());
 #endif
-  running_ = true;
-  return true;
-}
-
-void MDNSClient::process_results() {
-#ifdef _USE_AVAHI_
-  std::lock_guard<std::mutex> lock{sources_res_mutex_};
-  /* remove all completed results and populate remote sources list */
-  sources_res_.remove_if([](auto& result) {
-    if (!result.valid()) {
-      /* if invalid future remove from the list */
-      return true;
-    }
-    auto status = result.wait_for(std::chrono::milliseconds(0));
-    if (status == std::future_status::ready) {
-      result.get();
-      /* if completed remove from the list */
-      return true;
-    }
-    /* if not completed leave in the list */
+#ifdef _USE_MDNS_BUILTIN_
+  responder_ = MDNSResponder::create(config_);
+  if (!responder_->init()) {
     return false;
-  });
+  }
+  responder_->browse(
+      "_ravenna_session._sub._rtsp._tcp",
+      [this](const std::string& name, const std::string& domain,
+             const std::string& address, uint16_t port, bool local) {
+        BOOST_LOG_TRIVIAL(debug)
+            << "mdns_client:: (Responder) service " << name << " in domain "
+            << domain << " " << address << ":" << port << " local: " << local;
+        /* same rules of the Avahi resolver, see resolve_callback() */
+        if ((!local && (config_->get_interface_name(0) != "lo")) ||
+            (local && (config_->get_interface_name(0) == "lo"))) {
+          rtsp_engine_.start(name, domain, std::string("/by-name/") + name,
+                             address, std::to_string(port));
+        }
+      },
+      [this](const std::string& name, const std::string& domain) {
+        BOOST_LOG_TRIVIAL(info) << "mdns_client:: (Responder) REMOVE: "
+                                << "service " << name << " in domain "
+                                << domain;
+        rtsp_engine_.stop(name, domain);
+        on_remove_rtsp_source(name, domain);
+      });
 #endif
+  running_ = true;
+  return true;
 }
 
 bool MDNSClient::terminate() {
   if (running_) {
     running_ = false;
-    RtspClient::stop_all();
 #ifdef _USE_AVAHI_
-    /* wait for all pending results and remove from list */
-    std::lock_guard<std::mutex> lock{sources_res_mutex_};
-    BOOST_LOG_TRIVIAL(info) << "mdns_client:: waiting for "
-                            << sources_res_.size() << " RTSP clients";
-    sources_res_.remove_if([](auto& result) {
-      if (result.valid()) {
-        result.wait();
-      }
-      return true;
-    });
-
     avahi_threaded_poll_stop(poll_.get());
 #endif
+#ifdef _USE_MDNS_BUILTIN_
+    responder_->stop_browse("_ravenna_session._sub._rtsp._tcp");
+    responder_->terminate();
+#endif
+    /* stop all the RTSP clients */
+    rtsp_engine_.terminate();
   }
   return true;
 }
+
+void MDNSClient::describe_rtsp_source(const std::string& name,
+                                      const std::string& domain,
+                                      const std::string& address,
+                                      const std::string& port) {
+  if (running_) {
+    rtsp_engine_.start(name, domain, std::string("/by-name/") + name, address,
+                       port);
+  }
+}
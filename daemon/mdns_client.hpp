@@ -36,6 +36,9 @@
 
 #include "config.hpp"
 #include "rtsp_client.hpp"
+#ifdef _USE_MDNS_BUILTIN_
+#include "mdns_responder.hpp"
+#endif
 
 class MDNSClient {
  public:
@@ -54,6 +57,11 @@ class MDNSClient {
                                      const RtspSource& source) {};
   virtual void on_remove_rtsp_source(const std::string& name,
                                      const std::string& domain) {};
+  /* describe a source without waiting for its mDNS resolution */
+  void describe_rtsp_source(const std::string& name,
+                            const std::string& domain,
+                            const std::string& address,
+                            const std::string& port);
 
 #ifdef _USE_AVAHI_
   static void resolve_callback(AvahiServiceResolver* r,
@@ -83,13 +91,16 @@ class MDNSClient {
                               void* userdata);
 #endif
 
-  void process_results();
-
   std::shared_ptr<Config> config_;
 
  private:
-  std::list<std::future<void> > sources_res_;
-  std::mutex sources_res_mutex_;
+  /* RTSP clients of the resolved sources */
+  RtspClientEngine rtsp_engine_{
+      std::bind(&MDNSClient::on_change_rtsp_source,
+                this,
+                std::placeholders::_1,
+                std::placeholders::_2,
+                std::placeholders::_3)};
 
   std::atomic_bool running_{false};
 
@@ -104,6 +115,9 @@ class MDNSClient {
   std::set<std::pair<std::string /*name*/, std::string /*domain */> >
       active_resolvers;
 #endif
+#ifdef _USE_MDNS_BUILTIN_
+  std::shared_ptr<MDNSResponder> responder_;
+#endif
 };
 
 #endif
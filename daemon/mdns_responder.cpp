@@ -0,0 +1,975 @@
+//
+//  mdns_responder.cpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/algorithm/string.hpp>
+
+#include "log.hpp"
+#include "mdns_responder.hpp"
+
+using namespace boost::asio;
+using namespace boost::asio::ip;
+
+namespace {
+
+constexpr uint16_t dns_class_in = 1;
+constexpr uint16_t dns_class_flag = 0x8000;  // cache flush or unicast
+constexpr uint16_t dns_flags_response = 0x8400;  // QR and AA
+constexpr uint16_t dns_pointer_max = 0x3FFF;
+const MDNSResponder::Name services_name{"_services", "_dns-sd", "_udp",
+                                        "local"};
+
+/* DNS packet writer with names compression, see RFC 1035 section 4.1.4 */
+class PacketWriter {
+ public:
+  PacketWriter(uint16_t id, bool response) {
+    buf_.reserve(MDNSResponder::packet_size_max);
+    u16(id);
+    u16(response ? dns_flags_response : 0);
+    buf_.append(8, '\0');
+  }
+
+  void question(const MDNSResponder::Question& q) {
+    name(q.name);
+    u16(q.type);
+    u16(dns_class_in | (q.unicast ? dns_class_flag : 0));
+    count(4)++;
+  }
+
+  /* add the record and return false if the packet size exceeded the max,
+   * in this case the record is removed and the packet can be sent */
+  bool record(const MDNSResponder::Record& rr, bool is_answer) {
+    auto size = buf_.size();
+    added_.clear();
+    name(rr.name);
+    u16(rr.type);
+    u16(dns_class_in | (rr.cache_flush ? dns_class_flag : 0));
+    u32(rr.ttl);
+    auto rdlength_pos = buf_.size();
+    u16(0);
+    switch (rr.type) {
+      case MDNSResponder::A:
+        u32(rr.address);
+        break;
+      case MDNSResponder::PTR:
+        name(rr.target);
+        break;
+      case MDNSResponder::SRV:
+        u16(0);  // priority
+        u16(0);  // weight
+        u16(rr.port);
+        name(rr.target);
+        break;
+      case MDNSResponder::TXT:
+      default:
+        /* empty TXT record, see RFC 6763 section 6.1 */
+        buf_.push_back('\0');
+        break;
+    }
+    uint16_t rdlength = buf_.size() - rdlength_pos - 2;
+    buf_[rdlength_pos] = rdlength >> 8;
+    buf_[rdlength_pos + 1] = rdlength & 0xFF;
+
+    if (buf_.size() > MDNSResponder::packet_size_max && !empty()) {
+      buf_.resize(size);
+      for (const auto& key : added_) {
+        offsets_.erase(key);
+      }
+      return false;
+    }
+    count(is_answer ? 6 : 10)++;
+    return true;
+  }
+
+  bool empty() const {
+    return !count_[0] && !count_[1] && !count_[2] && !count_[3];
+  }
+
+  std::string str() {
+    for (int i = 0; i < 4; i++) {
+      buf_[4 + i * 2] = count_[i] >> 8;
+      buf_[5 + i * 2] = count_[i] & 0xFF;
+    }
+    return buf_;
+  }
+
+ private:
+  uint16_t& count(int offset) { return count_[(offset - 4) / 2]; }
+
+  void u16(uint16_t val) {
+    buf_.push_back(val >> 8);
+    buf_.push_back(val & 0xFF);
+  }
+
+  void u32(uint32_t val) {
+    u16(val >> 16);
+    u16(val & 0xFFFF);
+  }
+
+  void name(const MDNSResponder::Name& name) {
+    for (size_t i = 0; i < name.size(); i++) {
+      /* look for the suffix already written */
+      std::string key;
+      for (size_t j = i; j < name.size(); j++) {
+        key += boost::to_lower_copy(name[j]) + '\0';
+      }
+      auto it = offsets_.find(key);
+      if (it != offsets_.end()) {
+        u16(0xC000 | it->second);
+        return;
+      }
+      if (buf_.size() <= dns_pointer_max) {
+        offsets_[key] = buf_.size();
+        added_.push_back(key);
+      }
+      auto len = std::min<size_t>(name[i].length(), 63);
+      buf_.push_back(len);
+      buf_.append(name[i], 0, len);
+    }
+    buf_.push_back('\0');
+  }
+
+  std::string buf_;
+  uint16_t count_[4]{0, 0, 0, 0};
+  std::map<std::string, uint16_t> offsets_;
+  std::vector<std::string> added_;
+};
+
+/* DNS packet reader, all the methods return false on malformed data */
+class PacketReader {
+ public:
+  PacketReader(const uint8_t* data, size_t length)
+      : data_(data), length_(length) {}
+
+  bool u16(uint16_t& val) {
+    if (pos_ + 2 > length_) {
+      return false;
+    }
+    val = (data_[pos_] << 8) | data_[pos_ + 1];
+    pos_ += 2;
+    return true;
+  }
+
+  bool u32(uint32_t& val) {
+    uint16_t hi, lo;
+    if (!u16(hi) || !u16(lo)) {
+      return false;
+    }
+    val = (uint32_t(hi) << 16) | lo;
+    return true;
+  }
+
+  bool name(MDNSResponder::Name& name) {
+    name.clear();
+    size_t pos = pos_;
+    bool jumped = false;
+    int jumps = 0;
+    while (pos < length_) {
+      uint8_t len = data_[pos];
+      if ((len & 0xC0) == 0xC0) {
+        if (pos + 1 >= length_ || ++jumps > 64) {
+          return false;
+        }
+        if (!jumped) {
+          pos_ = pos + 2;
+          jumped = true;
+        }
+        pos = ((len & 0x3F) << 8) | data_[pos + 1];
+        continue;
+      }
+      if (len == 0) {
+        if (!jumped) {
+          pos_ = pos + 1;
+        }
+        return true;
+      }
+      if (pos + 1 + len > length_) {
+        return false;
+      }
+      name.emplace_back(reinterpret_cast<const char*>(data_ + pos + 1), len);
+      pos += 1 + len;
+    }
+    return false;
+  }
+
+  bool skip(size_t length) {
+    if (pos_ + length > length_) {
+      return false;
+    }
+    pos_ += length;
+    return true;
+  }
+
+  size_t pos() const { return pos_; }
+
+ private:
+  const uint8_t* data_;
+  size_t length_;
+  size_t pos_{0};
+};
+
+bool same_rdata(const MDNSResponder::Record& lhs,
+                const MDNSResponder::Record& rhs) {
+  return lhs.type == rhs.type && lhs.port == rhs.port &&
+         lhs.address == rhs.address && lhs.target.size() == rhs.target.size() &&
+         std::equal(lhs.target.begin(), lhs.target.end(), rhs.target.begin(),
+                    [](const std::string& a, const std::string& b) {
+                      return boost::iequals(a, b);
+                    });
+}
+
+}  // namespace
+
+std::shared_ptr<MDNSResponder> MDNSResponder::create(
+    std::shared_ptr<Config> config) {
+  // no need to be thread-safe here
+  static std::weak_ptr<MDNSResponder> instance;
+  if (auto ptr = instance.lock()) {
+    return ptr;
+  }
+  auto ptr = std::shared_ptr<MDNSResponder>(new MDNSResponder(config));
+  instance = ptr;
+  return ptr;
+}
+
+std::string MDNSResponder::key(const Name& name) {
+  std::string key;
+  for (const auto& label : name) {
+    key += boost::to_lower_copy(label) + '.';
+  }
+  return key;
+}
+
+MDNSResponder::Name MDNSResponder::make_name(const std::string& name) {
+  Name labels;
+  boost::split(labels, name, boost::is_any_of("."));
+  labels.erase(std::remove(labels.begin(), labels.end(), ""), labels.end());
+  labels.push_back("local");
+  return labels;
+}
+
+std::vector<std::string> MDNSResponder::encode(const Message& msg) {
+  std::vector<std::string> packets;
+  PacketWriter writer(msg.id, msg.response);
+  for (const auto& q : msg.questions) {
+    writer.question(q);
+  }
+  for (size_t i = 0; i < msg.records.size(); i++) {
+    while (!writer.record(msg.records[i], i < msg.answers)) {
+      /* packet full, send it and continue on a new one */
+      packets.push_back(writer.str());
+      writer = PacketWriter(msg.id, msg.response);
+    }
+  }
+  if (!writer.empty()) {
+    packets.push_back(writer.str());
+  }
+  return packets;
+}
+
+bool MDNSResponder::decode(const uint8_t* data, size_t length, Message& msg) {
+  PacketReader reader(data, length);
+  uint16_t flags, qdcount, ancount, nscount, arcount;
+  if (!reader.u16(msg.id) || !reader.u16(flags) || !reader.u16(qdcount) ||
+      !reader.u16(ancount) || !reader.u16(nscount) || !reader.u16(arcount)) {
+    return false;
+  }
+  msg.response = (flags & 0x8000) != 0;
+  msg.answers = ancount;
+  for (uint16_t i = 0; i < qdcount; i++) {
+    Question q;
+    uint16_t qclass;
+    if (!reader.name(q.name) || !reader.u16(q.type) || !reader.u16(qclass)) {
+      return false;
+    }
+    q.unicast = (qclass & dns_class_flag) != 0;
+    msg.questions.push_back(std::move(q));
+  }
+  for (uint32_t i = 0; i < uint32_t(ancount + nscount + arcount); i++) {
+    Record rr;
+    uint16_t rrclass, rdlength;
+    if (!reader.name(rr.name) || !reader.u16(rr.type) ||
+        !reader.u16(rrclass) || !reader.u32(rr.ttl) ||
+        !reader.u16(rdlength)) {
+      return false;
+    }
+    rr.cache_flush = (rrclass & dns_class_flag) != 0;
+    auto end = reader.pos() + rdlength;
+    bool ok = true;
+    switch (rr.type) {
+      case A:
+        ok = rdlength == 4 && reader.u32(rr.address);
+        break;
+      case PTR:
+        ok = reader.name(rr.target);
+        break;
+      case SRV: {
+        uint16_t priority, weight;
+        ok = reader.u16(priority) && reader.u16(weight) &&
+             reader.u16(rr.port) && reader.name(rr.target);
+        break;
+      }
+      default:
+        break;
+    }
+    if (!ok || reader.pos() > end || !reader.skip(end - reader.pos())) {
+      return false;
+    }
+    msg.records.push_back(std::move(rr));
+  }
+  return true;
+}
+
+bool MDNSResponder::init() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (users_++ > 0) {
+    return true;
+  }
+
+  /* host name derived from the node id */
+  std::string host = config_->get_node_id();
+  for (auto& c : host) {
+    if (!isalnum(c)) {
+      c = '-';
+    }
+  }
+  host_ = {host, "local"};
+
+  boost::system::error_code ec;
+#if BOOST_VERSION < 108700
+  auto interface_ip = ip::address_v4::from_string(config_->get_ip_addr_str());
+  auto group = ip::address_v4::from_string(mdns_addr);
+  ip_addr_ = interface_ip.to_ulong();
+#else
+  auto interface_ip = ip::make_address(config_->get_ip_addr_str()).to_v4();
+  auto group = ip::make_address(mdns_addr).to_v4();
+  ip_addr_ = interface_ip.to_uint();
+#endif
+  mcast_endpoint_ = udp::endpoint(group, mdns_port);
+
+#if BOOST_VERSION < 106600
+  io_service_.reset();
+#else
+  io_service_.restart();
+#endif
+  socket_.open(udp::v4(), ec);
+  socket_.set_option(udp::socket::reuse_address(true), ec);
+  socket_.bind(udp::endpoint(udp::v4(), mdns_port), ec);
+  if (!ec) {
+    socket_.set_option(ip::multicast::join_group(group, interface_ip), ec);
+  }
+  if (!ec) {
+    socket_.set_option(ip::multicast::outbound_interface(interface_ip), ec);
+  }
+  if (!ec) {
+    /* we want our services on the loopback interface */
+    socket_.set_option(ip::multicast::enable_loopback(true), ec);
+  }
+  if (!ec) {
+    socket_.set_option(ip::multicast::hops(255), ec);
+  }
+  if (ec) {
+    BOOST_LOG_TRIVIAL(fatal) << "mdns_responder:: failed to setup socket on "
+                             << config_->get_ip_addr_str() << " : "
+                             << ec.message();
+    socket_.close(ec);
+    users_ = 0;
+    return false;
+  }
+
+#if BOOST_VERSION < 106600
+  work_ = std::make_unique<boost::asio::io_service::work>(io_service_);
+#else
+  work_ = std::make_unique<boost::asio::executor_work_guard<
+      boost::asio::io_context::executor_type> >(io_service_.get_executor());
+#endif
+  receive();
+  tick_timer_.expires_after(seconds(1));
+  tick_timer_.async_wait([this](const boost::system::error_code& ec) {
+    if (!ec) {
+      on_tick();
+    }
+  });
+  res_ = std::async(std::launch::async, [this]() { io_service_.run(); });
+  BOOST_LOG_TRIVIAL(info) << "mdns_responder:: started on "
+                          << config_->get_ip_addr_str() << " as "
+                          << host_[0] << ".local";
+  return true;
+}
+
+bool MDNSResponder::terminate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (users_ == 0 || --users_ > 0) {
+    return true;
+  }
+  BOOST_LOG_TRIVIAL(info) << "mdns_responder:: stopping ...";
+  boost::asio::post(io_service_, [this]() {
+    send_goodbyes();
+    boost::system::error_code ec;
+    send_timer_.cancel();
+    tick_timer_.cancel();
+    socket_.close(ec);
+    services_.clear();
+    browses_.clear();
+    srv_cache_.clear();
+    host_cache_.clear();
+    work_.reset();
+  });
+  res_.get();
+  return true;
+}
+
+bool MDNSResponder::add_service(const std::string& instance,
+                                const std::string& type,
+                                const std::vector<std::string>& subtypes,
+                                uint16_t port) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (users_ == 0) {
+    return false;
+  }
+  Service service;
+  service.instance = make_name(type);
+  service.instance.insert(service.instance.begin(), instance);
+  service.type = make_name(type);
+  for (const auto& subtype : subtypes) {
+    service.subtypes.push_back(make_name(subtype + "._sub." + type));
+  }
+  service.port = port;
+  boost::asio::post(io_service_, [this, service]() {
+    BOOST_LOG_TRIVIAL(info) << "mdns_responder:: adding service "
+                            << key(service.instance);
+    /* announce the records, the announcements of the services added
+     * within the aggregation interval are sent in the same packets */
+    std::vector<Record> records;
+    service_records(service, false, records);
+    reannounce_.insert(reannounce_.end(), records.begin(), records.end());
+    schedule_send(std::move(records), {});
+    services_[key(service.instance)] = service;
+  });
+  return true;
+}
+
+bool MDNSResponder::remove_service(const std::string& instance,
+                                   const std::string& type) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (users_ == 0) {
+    return false;
+  }
+  auto name = make_name(type);
+  name.insert(name.begin(), instance);
+  boost::asio::post(io_service_, [this, name]() {
+    auto it = services_.find(key(name));
+    if (it == services_.end()) {
+      return;
+    }
+    BOOST_LOG_TRIVIAL(info) << "mdns_responder:: removing service "
+                            << key(name);
+    std::vector<Record> records;
+    service_records(it->second, true, records);
+    services_.erase(it);
+    /* do not announce again the records of the removed service */
+    reannounce_.erase(
+        std::remove_if(reannounce_.begin(), reannounce_.end(),
+                       [&name](const Record& rr) {
+                         return key(rr.name) == key(name) ||
+                                key(rr.target) == key(name);
+                       }),
+        reannounce_.end());
+    schedule_send(std::move(records), {});
+  });
+  return true;
+}
+
+bool MDNSResponder::remove_services() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (users_ == 0) {
+    return false;
+  }
+  boost::asio::post(io_service_, [this]() {
+    send_goodbyes();
+    services_.clear();
+    reannounce_.clear();
+  });
+  return true;
+}
+
+bool MDNSResponder::browse(const std::string& type,
+                           const BrowseObserver& found_cb,
+                           const RemoveObserver& remove_cb) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (users_ == 0) {
+    return false;
+  }
+  boost::asio::post(io_service_, [this, type, found_cb, remove_cb]() {
+    BOOST_LOG_TRIVIAL(info) << "mdns_responder:: browsing " << type;
+    Browse browse;
+    browse.type = make_name(type);
+    browse.found_cb = found_cb;
+    browse.remove_cb = remove_cb;
+    browses_.push_back(std::move(browse));
+    send_query(browses_.back());
+  });
+  return true;
+}
+
+bool MDNSResponder::stop_browse(const std::string& type) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (users_ == 0) {
+    return false;
+  }
+  std::promise<void> done;
+  boost::asio::post(io_service_, [this, type, &done]() {
+    auto type_key = key(make_name(type));
+    browses_.erase(std::remove_if(browses_.begin(), browses_.end(),
+                                  [&type_key](const Browse& browse) {
+                                    return key(browse.type) == type_key;
+                                  }),
+                   browses_.end());
+    done.set_value();
+  });
+  lock.unlock();
+  /* wait for the io_service thread to drop the observers */
+  done.get_future().wait();
+  return true;
+}
+
+void MDNSResponder::receive() {
+  socket_.async_receive_from(
+      boost::asio::buffer(data_, sizeof(data_)), sender_endpoint_,
+      [this](const boost::system::error_code& ec, std::size_t length) {
+        if (ec) {
+          if (ec != boost::asio::error::operation_aborted) {
+            BOOST_LOG_TRIVIAL(error)
+                << "mdns_responder:: receive failed " << ec.message();
+          }
+          return;
+        }
+        Message msg;
+        if (decode(data_, length, msg)) {
+          on_message(msg, sender_endpoint_);
+        } else {
+          BOOST_LOG_TRIVIAL(debug) << "mdns_responder:: malformed packet from "
+                                   << sender_endpoint_;
+        }
+        receive();
+      });
+}
+
+void MDNSResponder::on_message(const Message& msg,
+                               const udp::endpoint& sender) {
+  if (msg.response) {
+    /* responses must be sent from the mDNS port, see RFC 6762 section 11 */
+    if (sender.port() == mdns_port) {
+#if BOOST_VERSION < 108700
+      on_response(msg, sender.address().to_v4().to_ulong() == ip_addr_);
+#else
+      on_response(msg, sender.address().to_v4().to_uint() == ip_addr_);
+#endif
+    }
+  } else {
+    on_query(msg, sender);
+  }
+}
+
+void MDNSResponder::service_records(const Service& service,
+                                    bool goodbye,
+                                    std::vector<Record>& records) const {
+  Record ptr;
+  ptr.type = PTR;
+  ptr.ttl = goodbye ? 0 : ttl_other;
+  ptr.target = service.instance;
+  ptr.name = service.type;
+  records.push_back(ptr);
+  for (const auto& subtype : service.subtypes) {
+    ptr.name = subtype;
+    records.push_back(ptr);
+  }
+
+  Record srv;
+  srv.name = service.instance;
+  srv.type = SRV;
+  srv.ttl = goodbye ? 0 : ttl_host;
+  srv.cache_flush = true;
+  srv.target = host_;
+  srv.port = service.port;
+  records.push_back(srv);
+
+  Record txt;
+  txt.name = service.instance;
+  txt.type = TXT;
+  txt.ttl = goodbye ? 0 : ttl_other;
+  txt.cache_flush = true;
+  records.push_back(txt);
+
+  if (!goodbye) {
+    /* the host address is shared by all the services */
+    Record a;
+    a.name = host_;
+    a.type = A;
+    a.ttl = ttl_host;
+    a.cache_flush = true;
+    a.address = ip_addr_;
+    records.push_back(a);
+  }
+}
+
+void MDNSResponder::answer(const Question& q,
+                           std::vector<Record>& answers,
+                           std::vector<Record>& additionals) const {
+  auto qkey = key(q.name);
+  bool any = (q.type == ANY);
+
+  if ((q.type == PTR || any) && qkey == key(services_name)) {
+    /* service type enumeration, see RFC 6763 section 9 */
+    std::set<std::string> types;
+    for (const auto& [ikey, service] : services_) {
+      if (types.insert(key(service.type)).second) {
+        Record ptr;
+        ptr.name = services_name;
+        ptr.type = PTR;
+        ptr.ttl = ttl_other;
+        ptr.target = service.type;
+        answers.push_back(ptr);
+      }
+    }
+    return;
+  }
+
+  for (const auto& [ikey, service] : services_) {
+    std::vector<Record> records;
+    service_records(service, false, records);
+    for (auto& rr : records) {
+      if (key(rr.name) == qkey && (rr.type == q.type || any)) {
+        answers.push_back(rr);
+        if (rr.type == PTR) {
+          /* add SRV, TXT and A, see RFC 6763 section 12.1 */
+          for (const auto& ar : records) {
+            if (ar.type != PTR) {
+              additionals.push_back(ar);
+            }
+          }
+        } else if (rr.type == SRV) {
+          additionals.push_back(records.back());
+        }
+      }
+    }
+  }
+
+  if ((q.type == A || any) && qkey == key(host_)) {
+    Record a;
+    a.name = host_;
+    a.type = A;
+    a.ttl = ttl_host;
+    a.cache_flush = true;
+    a.address = ip_addr_;
+    answers.push_back(a);
+  }
+}
+
+void MDNSResponder::on_query(const Message& msg, const udp::endpoint& sender) {
+  std::vector<Record> answers, additionals;
+  bool unicast = false;
+  for (const auto& q : msg.questions) {
+    answer(q, answers, additionals);
+    unicast |= q.unicast;
+  }
+  if (answers.empty()) {
+    return;
+  }
+
+  /* known answer suppression, see RFC 6762 section 7.1 */
+  auto known = [&msg](const Record& rr) {
+    for (size_t i = 0; i < msg.answers && i < msg.records.size(); i++) {
+      const auto& ka = msg.records[i];
+      if (ka.ttl >= rr.ttl / 2 && key(ka.name) == key(rr.name) &&
+          same_rdata(ka, rr)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  answers.erase(std::remove_if(answers.begin(), answers.end(), known),
+                answers.end());
+  if (answers.empty()) {
+    return;
+  }
+
+  if (sender.port() != mdns_port || unicast) {
+    /* legacy or unicast response, see RFC 6762 sections 5.4 and 6.7 */
+    Message resp;
+    resp.response = true;
+    bool legacy = sender.port() != mdns_port;
+    if (legacy) {
+      resp.id = msg.id;
+      resp.questions = msg.questions;
+    }
+    resp.records = answers;
+    resp.answers = answers.size();
+    resp.records.insert(resp.records.end(), additionals.begin(),
+                        additionals.end());
+    for (auto& rr : resp.records) {
+      if (legacy) {
+        rr.cache_flush = false;
+        rr.ttl = std::min<uint32_t>(rr.ttl, 10);
+      }
+    }
+    send(resp, sender);
+    return;
+  }
+
+  /* responses to multicast queries are aggregated */
+  schedule_send(std::move(answers), std::move(additionals));
+}
+
+void MDNSResponder::schedule_send(std::vector<Record>&& answers,
+                                  std::vector<Record>&& additionals) {
+  pending_answers_.insert(pending_answers_.end(), answers.begin(),
+                          answers.end());
+  pending_additionals_.insert(pending_additionals_.end(), additionals.begin(),
+                              additionals.end());
+  if (!send_scheduled_) {
+    send_scheduled_ = true;
+    send_timer_.expires_after(milliseconds(aggregation_msecs));
+    send_timer_.async_wait([this](const boost::system::error_code& ec) {
+      if (!ec) {
+        send_pending();
+      }
+    });
+  }
+}
+
+void MDNSResponder::send_pending() {
+  send_scheduled_ = false;
+
+  if (!pending_questions_.empty()) {
+    Message query;
+    query.questions.swap(pending_questions_);
+    send(query, mcast_endpoint_);
+  }
+
+  if (pending_answers_.empty()) {
+    pending_additionals_.clear();
+    return;
+  }
+  /* remove the duplicated records */
+  Message resp;
+  resp.response = true;
+  auto contains = [&resp](const Record& rr) {
+    return std::any_of(
+        resp.records.begin(), resp.records.end(), [&rr](const Record& r) {
+          return r.ttl == rr.ttl && key(r.name) == key(rr.name) &&
+                 same_rdata(r, rr);
+        });
+  };
+  for (const auto& rr : pending_answers_) {
+    if (!contains(rr)) {
+      resp.records.push_back(rr);
+    }
+  }
+  resp.answers = resp.records.size();
+  for (const auto& rr : pending_additionals_) {
+    if (!contains(rr)) {
+      resp.records.push_back(rr);
+    }
+  }
+  pending_answers_.clear();
+  pending_additionals_.clear();
+  send(resp, mcast_endpoint_);
+}
+
+void MDNSResponder::send(const Message& msg, const udp::endpoint& endpoint) {
+  for (const auto& packet : encode(msg)) {
+    boost::system::error_code ec;
+    socket_.send_to(boost::asio::buffer(packet), endpoint, 0, ec);
+    if (ec) {
+      BOOST_LOG_TRIVIAL(error) << "mdns_responder:: failed to send to "
+                               << endpoint << " : " << ec.message();
+    }
+  }
+}
+
+void MDNSResponder::send_goodbyes() {
+  if (services_.empty()) {
+    return;
+  }
+  Message resp;
+  resp.response = true;
+  for (const auto& [ikey, service] : services_) {
+    service_records(service, true, resp.records);
+  }
+  resp.answers = resp.records.size();
+  send(resp, mcast_endpoint_);
+}
+
+void MDNSResponder::send_query(Browse& browse) {
+  Message query;
+  Question q;
+  q.name = browse.type;
+  q.type = PTR;
+  query.questions.push_back(q);
+
+  /* add the known answers with more than half of the TTL remaining */
+  auto now = steady_clock::now();
+  for (const auto& [ikey, instance] : browse.instances) {
+    auto remaining = duration_cast<seconds>(instance.expiry - now).count();
+    if (remaining > ttl_other / 2) {
+      Record ptr;
+      ptr.name = browse.type;
+      ptr.type = PTR;
+      ptr.ttl = remaining;
+      ptr.target = instance.name;
+      query.records.push_back(ptr);
+    }
+  }
+  query.answers = query.records.size();
+  send(query, mcast_endpoint_);
+
+  /* query again with exponential back-off, see RFC 6762 section 5.2 */
+  browse.next_query = now + seconds(browse.interval);
+  browse.interval = std::min<uint32_t>(browse.interval * 2, query_interval_max);
+}
+
+void MDNSResponder::on_response(const Message& msg, bool local) {
+  auto now = steady_clock::now();
+  for (const auto& rr : msg.records) {
+    if (rr.type == A) {
+      if (rr.ttl == 0) {
+        host_cache_.erase(key(rr.name));
+      } else {
+        auto& entry = host_cache_[key(rr.name)];
+        entry.address = rr.address;
+        entry.local = local;
+        entry.expiry = now + seconds(rr.ttl);
+      }
+    } else if (rr.type == SRV) {
+      if (rr.ttl == 0) {
+        srv_cache_.erase(key(rr.name));
+      } else {
+        auto& entry = srv_cache_[key(rr.name)];
+        entry.target = rr.target;
+        entry.port = rr.port;
+        entry.local = local;
+        entry.expiry = now + seconds(rr.ttl);
+      }
+    }
+  }
+
+  for (auto& browse : browses_) {
+    auto type_key = key(browse.type);
+    for (const auto& rr : msg.records) {
+      if (rr.type != PTR || rr.target.empty() || key(rr.name) != type_key) {
+        continue;
+      }
+      auto ikey = key(rr.target);
+      auto it = browse.instances.find(ikey);
+      if (rr.ttl == 0) {
+        /* goodbye, see RFC 6762 section 10.1 */
+        if (it != browse.instances.end()) {
+          if (it->second.resolved) {
+            browse.remove_cb(it->second.name[0], it->second.name.back());
+          }
+          browse.instances.erase(it);
+        }
+        continue;
+      }
+      if (it == browse.instances.end()) {
+        it = browse.instances.emplace(ikey, Instance{}).first;
+        it->second.name = rr.target;
+      }
+      it->second.expiry = now + seconds(rr.ttl);
+      it->second.local = local;
+    }
+    for (auto& [ikey, instance] : browse.instances) {
+      resolve(browse, instance);
+    }
+  }
+}
+
+void MDNSResponder::resolve(Browse& browse, Instance& instance) {
+  auto now = steady_clock::now();
+  auto srv = srv_cache_.find(key(instance.name));
+  bool srv_found = srv != srv_cache_.end() && srv->second.expiry > now;
+  auto host = srv_found ? host_cache_.find(key(srv->second.target))
+                        : host_cache_.end();
+  bool host_found = host != host_cache_.end() && host->second.expiry > now;
+
+  if (!srv_found || !host_found) {
+    /* ask for the missing records at most once per second */
+    if (now - instance.last_query >= seconds(1)) {
+      instance.last_query = now;
+      Question q;
+      q.name = srv_found ? srv->second.target : instance.name;
+      q.type = srv_found ? A : SRV;
+      pending_questions_.push_back(q);
+      schedule_send({}, {});
+    }
+    return;
+  }
+
+  auto address = ip::address_v4(host->second.address).to_string();
+  auto port = srv->second.port;
+  if (!instance.resolved || instance.address != address ||
+      instance.port != port) {
+    instance.resolved = true;
+    instance.address = address;
+    instance.port = port;
+    BOOST_LOG_TRIVIAL(debug) << "mdns_responder:: resolved "
+                             << key(instance.name) << " " << address << ":"
+                             << port;
+    browse.found_cb(instance.name[0], instance.name.back(), address, port,
+                    instance.local);
+  }
+}
+
+void MDNSResponder::on_tick() {
+  auto now = steady_clock::now();
+
+  if (!reannounce_.empty()) {
+    schedule_send(std::move(reannounce_), {});
+    reannounce_.clear();
+  }
+
+  for (auto& browse : browses_) {
+    for (auto it = browse.instances.begin(); it != browse.instances.end();) {
+      if (it->second.expiry <= now) {
+        if (it->second.resolved) {
+          browse.remove_cb(it->second.name[0], it->second.name.back());
+        }
+        it = browse.instances.erase(it);
+      } else {
+        it++;
+      }
+    }
+    if (browse.next_query <= now) {
+      send_query(browse);
+    }
+  }
+
+  for (auto* cache : {&srv_cache_, &host_cache_}) {
+    for (auto it = cache->begin(); it != cache->end();) {
+      it = it->second.expiry <= now ? cache->erase(it) : std::next(it);
+    }
+  }
+
+  tick_timer_.expires_after(seconds(1));
+  tick_timer_.async_wait([this](const boost::system::error_code& ec) {
+    if (!ec) {
+      on_tick();
+    }
+  });
+}
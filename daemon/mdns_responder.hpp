@@ -0,0 +1,224 @@
+//
+//  mdns_responder.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _MDNS_RESPONDER_HPP_
+#define _MDNS_RESPONDER_HPP_
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+
+using namespace std::chrono;
+using boost::asio::ip::udp;
+
+/* Built-in mDNS responder and browser, see RFC 6762 and RFC 6763.
+ * It implements the subset used by RAVENNA: services registration with
+ * subtypes and the browsing and resolution of a service type.
+ * Responses are aggregated and sent in batches, known answers are used on
+ * both sides to suppress duplicated records and a single multicast socket
+ * is shared by the mDNS server and client.
+ */
+class MDNSResponder {
+ public:
+  constexpr static const char mdns_addr[] = "224.0.0.251";
+  constexpr static uint16_t mdns_port = 5353;
+  constexpr static uint16_t packet_size_max = 1400;     // byte
+  constexpr static uint16_t receive_size_max = 9000;    // byte
+  constexpr static uint32_t ttl_host = 120;             // sec, SRV and A
+  constexpr static uint32_t ttl_other = 4500;           // sec, PTR and TXT
+  constexpr static uint16_t aggregation_msecs = 20;     // msec
+  constexpr static uint16_t query_interval_max = 3600;  // sec
+
+  /* called when a browsed service instance is resolved or updated,
+   * local is true when the service is registered by this host */
+  using BrowseObserver = std::function<void(const std::string& name,
+                                            const std::string& domain,
+                                            const std::string& address,
+                                            uint16_t port,
+                                            bool local)>;
+  /* called when a browsed service instance is removed */
+  using RemoveObserver =
+      std::function<void(const std::string& name, const std::string& domain)>;
+
+  static std::shared_ptr<MDNSResponder> create(std::shared_ptr<Config> config);
+
+  MDNSResponder() = delete;
+  MDNSResponder(const MDNSResponder&) = delete;
+  MDNSResponder& operator=(const MDNSResponder&) = delete;
+  virtual ~MDNSResponder() { terminate(); };
+
+  /* the responder is shared, it runs until all the users terminate it */
+  bool init();
+  bool terminate();
+
+  /* register the service instance of the specified type and subtypes */
+  bool add_service(const std::string& instance,
+                   const std::string& type,
+                   const std::vector<std::string>& subtypes,
+                   uint16_t port);
+  bool remove_service(const std::string& instance, const std::string& type);
+  /* remove all the services registered sending the goodbye records */
+  bool remove_services();
+  /* browse the specified service type, e.g. _rtsp._tcp or
+   * _ravenna_session._sub._rtsp._tcp */
+  bool browse(const std::string& type,
+              const BrowseObserver& found_cb,
+              const RemoveObserver& remove_cb);
+  /* stop browsing the service type, no observers are called after return */
+  bool stop_browse(const std::string& type);
+
+  /* DNS resource record, the name is stored as a list of labels */
+  using Name = std::vector<std::string>;
+  enum RRType : uint16_t { A = 1, PTR = 12, TXT = 16, SRV = 33, ANY = 255 };
+  struct Record {
+    Name name;
+    uint16_t type{0};
+    uint32_t ttl{0};
+    bool cache_flush{false};
+    Name target;          // PTR and SRV
+    uint16_t port{0};     // SRV
+    uint32_t address{0};  // A, host byte order
+  };
+  struct Question {
+    Name name;
+    uint16_t type{0};
+    bool unicast{false};
+  };
+  struct Message {
+    uint16_t id{0};
+    bool response{false};
+    std::vector<Question> questions;
+    /* answers, authority and additional records */
+    std::vector<Record> records;
+    /* number of the records in the answer section */
+    size_t answers{0};
+  };
+
+  /* encode the message to one or more packets of at most packet_size_max */
+  static std::vector<std::string> encode(const Message& msg);
+  static bool decode(const uint8_t* data, size_t length, Message& msg);
+
+ private:
+  explicit MDNSResponder(std::shared_ptr<Config> config) : config_(config){};
+
+  struct Service {
+    Name instance;
+    Name type;
+    std::vector<Name> subtypes;
+    uint16_t port{0};
+  };
+
+  struct Instance {
+    Name name;
+    time_point<steady_clock> expiry;
+    time_point<steady_clock> last_query;
+    bool resolved{false};
+    std::string address;
+    uint16_t port{0};
+    bool local{false};
+  };
+
+  struct Browse {
+    Name type;
+    BrowseObserver found_cb;
+    RemoveObserver remove_cb;
+    std::map<std::string /* key */, Instance> instances;
+    uint32_t interval{1};  // sec
+    time_point<steady_clock> next_query;
+  };
+
+  struct CacheEntry {
+    Name target;
+    uint16_t port{0};
+    uint32_t address{0};
+    bool local{false};
+    time_point<steady_clock> expiry;
+  };
+
+  static std::string key(const Name& name);
+  static Name make_name(const std::string& name);
+
+  void receive();
+  void on_message(const Message& msg, const udp::endpoint& sender);
+  void on_query(const Message& msg, const udp::endpoint& sender);
+  void on_response(const Message& msg, bool local);
+  void answer(const Question& q,
+              std::vector<Record>& answers,
+              std::vector<Record>& additionals) const;
+  /* records of the service, with TTL 0 for goodbye */
+  void service_records(const Service& service,
+                       bool goodbye,
+                       std::vector<Record>& records) const;
+  void resolve(Browse& browse, Instance& instance);
+  void schedule_send(std::vector<Record>&& answers,
+                     std::vector<Record>&& additionals);
+  void send_pending();
+  void send(const Message& msg, const udp::endpoint& endpoint);
+  void send_query(Browse& browse);
+  void send_goodbyes();
+  void on_tick();
+
+  std::shared_ptr<Config> config_;
+  Name host_;
+  uint32_t ip_addr_{0};
+#if BOOST_VERSION < 108700
+  boost::asio::io_service io_service_;
+#else
+  boost::asio::io_context io_service_;
+#endif
+#if BOOST_VERSION < 106600
+  std::unique_ptr<boost::asio::io_service::work> work_;
+#else
+  std::unique_ptr<boost::asio::executor_work_guard<
+      boost::asio::io_context::executor_type> >
+      work_;
+#endif
+  udp::socket socket_{io_service_};
+  udp::endpoint mcast_endpoint_;
+  udp::endpoint sender_endpoint_;
+  uint8_t data_[receive_size_max];
+  boost::asio::steady_timer send_timer_{io_service_};
+  boost::asio::steady_timer tick_timer_{io_service_};
+  std::future<void> res_;
+  std::mutex mutex_;
+  int users_{0};
+
+  /* the following are accessed only by the io_service thread */
+  std::map<std::string /* instance key */, Service> services_;
+  std::vector<Browse> browses_;
+  std::map<std::string /* instance key */, CacheEntry> srv_cache_;
+  std::map<std::string /* host key */, CacheEntry> host_cache_;
+  std::vector<Record> pending_answers_;
+  std::vector<Record> pending_additionals_;
+  std::vector<Question> pending_questions_;
+  /* records announced again at the next tick, see RFC 6762 section 8.3 */
+  std::vector<Record> reannounce_;
+  bool send_scheduled_{false};
+};
+
+#endif
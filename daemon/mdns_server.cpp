@@ -221,6 +221,13 @@ bool MDNSServer::add_service(const std::string& name, const std::string& sdp) {
 
   BOOST_LOG_TRIVIAL(info) << "mdns_server:: adding service for " << ss.str();
   groups_.insert(entry_group_bimap_t::value_type(name, group.release()));
+#endif
+#ifdef _USE_MDNS_BUILTIN_
+  BOOST_LOG_TRIVIAL(info) << "mdns_server:: adding service for " << node_id_
+                          << " " << name;
+  return responder_->add_service(node_id_ + " " + name, "_rtsp._tcp",
+                                 {"_ravenna_session"},
+                                 config_->get_rtsp_port());
 #endif
   return true;
 }
@@ -247,6 +254,11 @@ bool MDNSServer::remove_service(const std::string& name) {
   avahi_entry_group_free(it->second);
   groups_.left.erase(name);
 #endif
+#ifdef _USE_MDNS_BUILTIN_
+  BOOST_LOG_TRIVIAL(info) << "mdns_server:: removing service _rtsp._tcp for "
+                          << name;
+  return responder_->remove_service(node_id_ + " " + name, "_rtsp._tcp");
+#endif
 
   return true;
 }
@@ -320,15 +332,29 @@ bool MDNSServer::init() {
 
   (void)avahi_threaded_poll_start(poll_.get());
 #endif
+#ifdef _USE_MDNS_BUILTIN_
+  responder_ = MDNSResponder::create(config_);
+  if (!responder_->init()) {
+    return false;
+  }
+  /* register ravenna services, without user defined name */
+  BOOST_LOG_TRIVIAL(info) << "mdns_server:: adding services for " << node_id_;
+  responder_->add_service(node_id_, "_http._tcp", {"_ravenna"},
+                          config_->get_http_port());
+  responder_->add_service(node_id_, "_rtsp._tcp", {"_ravenna"},
+                          config_->get_rtsp_port());
+#endif
 
   session_manager_->add_source_observer(
       SessionManager::SourceObserverType::add_source,
       std::bind(&MDNSServer::add_service, this, std::placeholders::_2,
-                std::placeholders::_3));
+                std::placeholders::_3),
+      "mdns_server");
 
   session_manager_->add_source_observer(
       SessionManager::SourceObserverType::remove_source,
-      std::bind(&MDNSServer::remove_service, this, std::placeholders::_2));
+      std::bind(&MDNSServer::remove_service, this, std::placeholders::_2),
+      "mdns_server");
 
   running_ = true;
   return true;
@@ -341,6 +367,11 @@ bool MDNSServer::terminate() {
     /* remove base services */
     groups_.left.erase(node_id_);
     avahi_threaded_poll_stop(poll_.get());
+#endif
+#ifdef _USE_MDNS_BUILTIN_
+    /* the responder may still be used by the client */
+    responder_->remove_services();
+    responder_->terminate();
 #endif
   }
   return true;
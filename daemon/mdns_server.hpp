@@ -36,6 +36,9 @@
 #include "config.hpp"
 #include "session_manager.hpp"
 #include "utils.hpp"
+#ifdef _USE_MDNS_BUILTIN_
+#include "mdns_responder.hpp"
+#endif
 
 class MDNSServer {
  public:
@@ -85,6 +88,9 @@ class MDNSServer {
       nullptr, &avahi_client_free};
 
 #endif
+#ifdef _USE_MDNS_BUILTIN_
+  std::shared_ptr<MDNSResponder> responder_;
+#endif
 };
 
 #endif
@@ -7,9 +7,14 @@
 //
 
 #include <arpa/inet.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -55,7 +60,7 @@ static std::string get_system_hostname() {
 
 // Build NMOS label: "<hostname> ALSA <first>-<last>" using 1-indexed channel numbers.
 static std::string make_nmos_label(const std::vector<uint8_t>& map) {
-  std::string h = get_system_hostname();
+  static const std::string h = get_system_hostname();
   if (map.empty()) return h + " ALSA";
   return h + " ALSA " + std::to_string(map.front() + 1)
          + "-" + std::to_string(map.back() + 1);
@@ -80,6 +85,68 @@ static std::string make_version() {
   return std::to_string(secs) + ":" + std::to_string(nanos);
 }
 
+// IS-05 timestamps are TAI "<secs>:<nanos>", TAI is ahead of UTC by the
+// leap seconds.
+static constexpr int64_t tai_utc_offset_ns = 37'000'000'000LL;
+
+static int64_t steady_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t tai_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count() +
+         tai_utc_offset_ns;
+}
+
+static std::string make_tai_time(int64_t tai_ns) {
+  return std::to_string(tai_ns / 1'000'000'000LL) + ":" +
+         std::to_string(tai_ns % 1'000'000'000LL);
+}
+
+static bool parse_tai_time(const std::string& time, int64_t& ns) {
+  auto colon = time.find(':');
+  try {
+    int64_t s = std::stoll(time.substr(0, colon));
+    int64_t n = colon != std::string::npos
+                ? std::stoll(time.substr(colon + 1)) : 0;
+    ns = s * 1'000'000'000LL + n;
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+// steady_clock deadline of a scheduled activation, an absolute time in the
+// past activates as soon as possible.
+static int64_t make_activation_deadline(const std::string& mode,
+                                        const std::string& requested_time) {
+  auto now_ns = steady_now_ns();
+  int64_t requested_ns;
+  if (!parse_tai_time(requested_time, requested_ns))
+    return now_ns + 1'000'000'000LL;
+  if (mode == "activate_scheduled_relative")
+    return now_ns + std::max<int64_t>(requested_ns, 0);
+  return now_ns + std::max<int64_t>(requested_ns - tai_now_ns(), 0);
+}
+
+static void signal_fd(int fd) {
+  uint64_t one = 1;
+  if (::write(fd, &one, sizeof(one)) < 0) {
+    BOOST_LOG_TRIVIAL(error) << "NmosManager:: cannot wake up activation scheduler: "
+                             << strerror(errno);
+  }
+}
+
+static void drain_fd(int fd) {
+  uint64_t val;
+  if (::read(fd, &val, sizeof(val)) < 0 && errno != EAGAIN) {
+    BOOST_LOG_TRIVIAL(error) << "NmosManager:: activation scheduler read failed: "
+                             << strerror(errno);
+  }
+}
+
 static bool is_multicast(const std::string& addr) {
   struct in_addr a {};
   if (inet_pton(AF_INET, addr.c_str(), &a) == 1) {
@@ -174,34 +241,49 @@ bool NmosManager::init() {
 
   device_id_ = make_uuid5(node_id_, "device");
 
-  rebuild_device_json_locked();
   node_json_ = build_node_json();
 
   // Register session-manager observers
   session_manager_->add_ptp_status_observer(
       [this](const std::string& status) {
         return on_ptp_status_change(status);
-      });
+      },
+      "nmos_manager");
   session_manager_->add_source_observer(
       SessionManager::SourceObserverType::add_source,
-      [this](uint8_t id, const std::string& name, const std::string& sdp) {
+      [this](uint16_t id, const std::string& name, const std::string& sdp) {
         return on_source_added(id, name, sdp);
-      });
+      },
+      "nmos_manager");
   session_manager_->add_source_observer(
       SessionManager::SourceObserverType::remove_source,
-      [this](uint8_t id, const std::string& name, const std::string& sdp) {
+      [this](uint16_t id, const std::string& name, const std::string& sdp) {
         return on_source_removed(id, name, sdp);
-      });
+      },
+      "nmos_manager");
   session_manager_->add_sink_observer(
       SessionManager::SinkObserverType::add_sink,
-      [this](uint8_t id, const std::string& name) {
+      [this](uint16_t id, const std::string& name) {
         return on_sink_added(id, name);
-      });
+      },
+      "nmos_manager");
   session_manager_->add_sink_observer(
       SessionManager::SinkObserverType::remove_sink,
-      [this](uint8_t id, const std::string& name) {
+      [this](uint16_t id, const std::string& name) {
         return on_sink_removed(id, name);
-      });
+      },
+      "nmos_manager");
+
+  registry_ = std::make_unique<NmosRegistryClient>(
+      config_->get_nmos_registry_address(), config_->get_nmos_registry_port());
+
+  activation_timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  activation_event_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (activation_timer_fd_ < 0 || activation_event_fd_ < 0) {
+    BOOST_LOG_TRIVIAL(fatal) << "NmosManager:: cannot create activation timer: "
+                             << strerror(errno);
+    return false;
+  }
 
   running_ = true;
   setup_node_api();
@@ -210,15 +292,22 @@ bool NmosManager::init() {
   // Populate IS-04/IS-05 local state from existing session_manager snapshot
   // synchronously so the Node API serves correct responses from the first request,
   // independent of registry connectivity.
-  for (const auto& src : session_manager_->get_sources())
+  auto sources = session_manager_->get_sources();
+  for (const auto& src : *sources)
     register_source_local(src.id);
-  for (const auto& sink : session_manager_->get_sinks())
+  auto sinks = session_manager_->get_sinks();
+  for (const auto& sink : *sinks)
     register_sink_local(sink.id);
+  {
+    std::unique_lock lock(resources_mutex_);
+    update_device_json_locked();
+  }
 
   BOOST_LOG_TRIVIAL(info) << "NmosManager:: starting async server thread";
   svr_res_ = std::async(std::launch::async, &NmosManager::server_worker, this);
   BOOST_LOG_TRIVIAL(info) << "NmosManager:: starting async registration thread";
   reg_res_ = std::async(std::launch::async, &NmosManager::registration_worker, this);
+  act_res_ = std::async(std::launch::async, &NmosManager::activation_worker, this);
   BOOST_LOG_TRIVIAL(info) << "NmosManager::init() complete";
   return true;
 }
@@ -227,9 +316,16 @@ bool NmosManager::terminate() {
   if (running_) {
     running_ = false;
     events_cv_.notify_all();
+    signal_fd(activation_event_fd_);
     node_api_svr_.stop();
     if (svr_res_.valid()) svr_res_.get();
     if (reg_res_.valid()) reg_res_.get();
+    if (act_res_.valid()) act_res_.get();
+    BOOST_LOG_TRIVIAL(info) << "NmosManager:: activation stats " << activation_stats_json();
+  }
+  for (int* fd : {&activation_timer_fd_, &activation_event_fd_}) {
+    if (*fd >= 0) ::close(*fd);
+    *fd = -1;
   }
   return true;
 }
@@ -239,8 +335,13 @@ bool NmosManager::terminate() {
 // ---------------------------------------------------------------------------
 
 std::string NmosManager::make_resource_uuid(const std::string& type,
-                                             uint8_t id) const {
-  return make_uuid5(node_id_, type + "-" + std::to_string(id));
+                                             uint16_t id) const {
+  // SHA-1 name based UUIDs are deterministic, compute them once
+  std::lock_guard lock(uuids_mutex_);
+  auto [it, added] = uuids_.try_emplace({type, id});
+  if (added)
+    it->second = make_uuid5(node_id_, type + "-" + std::to_string(id));
+  return it->second;
 }
 
 // ---------------------------------------------------------------------------
@@ -290,7 +391,9 @@ std::string NmosManager::build_node_json() const {
   return ss.str();
 }
 
-void NmosManager::rebuild_device_json_locked() {
+bool NmosManager::update_device_json_locked() {
+  if (!device_dirty_) return false;
+  device_dirty_ = false;
   std::ostringstream ss;
   ss << "{"
      << "\n  \"id\": \"" << device_id_ << "\""
@@ -324,6 +427,7 @@ void NmosManager::rebuild_device_json_locked() {
      << "\n  }]"
      << "\n}";
   device_json_ = ss.str();
+  return true;
 }
 
 std::string NmosManager::build_source_json(const StreamSource& src,
@@ -380,7 +484,7 @@ std::string NmosManager::build_flow_json(const StreamSource& src,
 }
 
 std::string NmosManager::build_sender_json(const StreamSource& src,
-                                            uint8_t daemon_id,
+                                            uint16_t daemon_id,
                                             const std::string& flow_id,
                                             const std::string& sender_id,
                                             const std::string& active_receiver_id) const {
@@ -552,7 +656,7 @@ void NmosManager::setup_node_api() {
   node_api_svr_.Get(R"(/x-nmos/node/v1.3/senders/([^/]+)/sdp)",
     [this](const Request& req, Response& res) {
       std::string sender_uuid = req.matches[1];
-      uint8_t daemon_id = 0;
+      uint16_t daemon_id = 0;
       bool found = false;
       {
         std::shared_lock lock(resources_mutex_);
@@ -797,7 +901,7 @@ NmosManager::ReceiverTp NmosManager::build_receiver_tp_from_sdp(
 // --- PATCH body parsing ---
 
 // Merges a partial IS-05 PATCH body into the sender's staged state.
-bool NmosManager::patch_sender_staged(uint8_t daemon_id,
+bool NmosManager::patch_sender_staged(uint16_t daemon_id,
                                       const std::string& body,
                                       std::string& err,
                                       std::string& staged_json_out) {
@@ -847,44 +951,29 @@ bool NmosManager::patch_sender_staged(uint8_t daemon_id,
   // Capture staged JSON BEFORE activation fires observer events
   staged_json_out = staged_sender_json(senders_.at(daemon_id));
 
-  // Handle activation
+  // Handle activation, a new activation replaces the scheduled one
+  if (!pt.get_child_optional("activation")) return true;
+  cancel_activation(true, daemon_id);
+  auto generation = ++sr.act_generation;
   if (act.mode == "activate_immediate") {
-    act.activation_time = make_version();
+    act.activation_time = make_tai_time(tai_now_ns());
     // reset after copy to active
     lock.unlock();
-    apply_sender_activation(daemon_id);
+    apply_sender_activation(daemon_id, generation);
     // re-lock to reset staged activation
     lock.lock();
-    if (senders_.count(daemon_id))
-      senders_[daemon_id].staged_act = {};
+    auto sit = senders_.find(daemon_id);
+    if (sit != senders_.end() && sit->second.act_generation == generation)
+      sit->second.staged_act = {};
   } else if (act.mode == "activate_scheduled_relative" ||
              act.mode == "activate_scheduled_absolute") {
-    int64_t deadline = 0;
-    auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
-    if (act.mode == "activate_scheduled_relative" && !act.requested_time.empty()) {
-      // requested_time = "<secs>:<nanos>"
-      auto colon = act.requested_time.find(':');
-      try {
-        int64_t s = std::stoll(act.requested_time.substr(0, colon));
-        int64_t n = colon != std::string::npos
-                    ? std::stoll(act.requested_time.substr(colon + 1)) : 0;
-        deadline = now_ns + s * 1'000'000'000LL + n;
-      } catch (...) { deadline = now_ns + 1'000'000'000LL; }
-    } else {
-      // absolute: use TAI — approximate as system clock + 1s fallback
-      deadline = now_ns + 1'000'000'000LL;
-    }
-    act.deadline_ns = deadline;
-    {
-      std::lock_guard<std::mutex> pa_lock(pending_act_mutex_);
-      pending_activations_.push_back({true, daemon_id, deadline});
-    }
+    act.deadline_ns = make_activation_deadline(act.mode, act.requested_time);
+    schedule_activation({true, daemon_id, act.deadline_ns, generation});
   }
   return true;
 }
 
-bool NmosManager::patch_receiver_staged(uint8_t daemon_id,
+bool NmosManager::patch_receiver_staged(uint16_t daemon_id,
                                         const std::string& body,
                                         std::string& err,
                                         std::string& staged_json_out) {
@@ -932,34 +1021,21 @@ bool NmosManager::patch_receiver_staged(uint8_t daemon_id,
   // Capture staged JSON BEFORE activation fires observer events
   staged_json_out = staged_receiver_json(receivers_.at(daemon_id));
 
+  if (!pt.get_child_optional("activation")) return true;
+  cancel_activation(false, daemon_id);
+  auto generation = ++rr.act_generation;
   if (act.mode == "activate_immediate") {
-    act.activation_time = make_version();
+    act.activation_time = make_tai_time(tai_now_ns());
     lock.unlock();
-    apply_receiver_activation(daemon_id);
+    apply_receiver_activation(daemon_id, generation);
     lock.lock();
-    if (receivers_.count(daemon_id))
-      receivers_[daemon_id].staged_act = {};
+    auto rit = receivers_.find(daemon_id);
+    if (rit != receivers_.end() && rit->second.act_generation == generation)
+      rit->second.staged_act = {};
   } else if (act.mode == "activate_scheduled_relative" ||
              act.mode == "activate_scheduled_absolute") {
-    int64_t deadline = 0;
-    auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
-    if (act.mode == "activate_scheduled_relative" && !act.requested_time.empty()) {
-      auto colon = act.requested_time.find(':');
-      try {
-        int64_t s = std::stoll(act.requested_time.substr(0, colon));
-        int64_t n = colon != std::string::npos
-                    ? std::stoll(act.requested_time.substr(colon + 1)) : 0;
-        deadline = now_ns + s * 1'000'000'000LL + n;
-      } catch (...) { deadline = now_ns + 1'000'000'000LL; }
-    } else {
-      deadline = now_ns + 1'000'000'000LL;
-    }
-    act.deadline_ns = deadline;
-    {
-      std::lock_guard<std::mutex> pa_lock(pending_act_mutex_);
-      pending_activations_.push_back({false, daemon_id, deadline});
-    }
+    act.deadline_ns = make_activation_deadline(act.mode, act.requested_time);
+    schedule_activation({false, daemon_id, act.deadline_ns, generation});
   }
   return true;
 }
@@ -980,21 +1056,18 @@ void NmosManager::fetch_remote_sender_sdp(const std::string& sender_uuid,
   std::string manifest_href;
 
   {
-    Client cli(reg_host.c_str(), reg_port);
-    cli.set_connection_timeout(3);
-    cli.set_read_timeout(3);
-    const std::string path = "/x-nmos/query/v1.3/senders/" + sender_uuid;
-    auto res = cli.Get(path.c_str());
-    if (res && res->status == 200) {
+    auto res = registry_->send({NmosRegistryClient::Method::Get,
+                                "/x-nmos/query/v1.3/senders/" + sender_uuid});
+    if (res.status == 200) {
       // Extract manifest_href from the sender JSON
       // Simple string search to avoid pulling in a full JSON parser here
       const std::string key = "\"manifest_href\":\"";
-      auto pos = res->body.find(key);
+      auto pos = res.body.find(key);
       if (pos != std::string::npos) {
         pos += key.size();
-        auto end = res->body.find('"', pos);
+        auto end = res.body.find('"', pos);
         if (end != std::string::npos)
-          manifest_href = res->body.substr(pos, end - pos);
+          manifest_href = res.body.substr(pos, end - pos);
       }
     } else {
       BOOST_LOG_TRIVIAL(warning)
@@ -1046,10 +1119,12 @@ void NmosManager::fetch_remote_sender_sdp(const std::string& sender_uuid,
 
 // --- Activation execution ---
 
-void NmosManager::apply_sender_activation(uint8_t daemon_id) {
+bool NmosManager::apply_sender_activation(uint16_t daemon_id,
+                                          uint64_t generation) {
   std::unique_lock lock(resources_mutex_);
   auto it = senders_.find(daemon_id);
-  if (it == senders_.end()) return;
+  if (it == senders_.end() || it->second.act_generation != generation)
+    return false;
   SenderResources& sr = it->second;
 
   // Promote staged → active
@@ -1071,9 +1146,11 @@ void NmosManager::apply_sender_activation(uint8_t daemon_id) {
                                           sr2.sender_id, sr2.active_receiver_id);
     }
   }
+  return true;
 }
 
-void NmosManager::apply_receiver_activation(uint8_t daemon_id) {
+bool NmosManager::apply_receiver_activation(uint16_t daemon_id,
+                                            uint64_t generation) {
   // Snapshot staged state
   bool        master_enable;
   std::string sender_id;
@@ -1083,7 +1160,8 @@ void NmosManager::apply_receiver_activation(uint8_t daemon_id) {
   {
     std::shared_lock lock(resources_mutex_);
     auto it = receivers_.find(daemon_id);
-    if (it == receivers_.end()) return;
+    if (it == receivers_.end() || it->second.act_generation != generation)
+      return false;
     master_enable   = it->second.staged_master_enable;
     sender_id       = it->second.staged_sender_id;
     tp              = it->second.staged_tp;
@@ -1094,7 +1172,7 @@ void NmosManager::apply_receiver_activation(uint8_t daemon_id) {
   // Resolve SDP for remote sender connection
   std::string sdp;
   if (master_enable && !sender_id.empty()) {
-    uint8_t src_daemon_id = 0;
+    uint16_t src_daemon_id = 0;
     bool found_local = false;
     {
       std::shared_lock lock(resources_mutex_);
@@ -1118,17 +1196,19 @@ void NmosManager::apply_receiver_activation(uint8_t daemon_id) {
     BOOST_LOG_TRIVIAL(warning)
         << "NmosManager:: receiver " << +daemon_id
         << " activation rejected: SDP has no audio media section";
-    return;
+    return false;
   }
 
   // Promote staged → active BEFORE calling add_sink.
   // add_sink fires remove+add observers which cause register_sink to run in the
   // registration_worker thread. We set preserved_active_sender_ids_ so that
   // register_sink can restore the IS-05 active sender across that cycle.
+  // The SDP fetch ran unlocked, so drop the snapshot if it was superseded.
   {
     std::unique_lock lock(resources_mutex_);
     auto it = receivers_.find(daemon_id);
-    if (it == receivers_.end()) return;
+    if (it == receivers_.end() || it->second.act_generation != generation)
+      return false;
     ReceiverResources& rr = it->second;
     rr.active_master_enable = master_enable;
     rr.active_sender_id     = master_enable ? sender_id : "";
@@ -1168,51 +1248,152 @@ void NmosManager::apply_receiver_activation(uint8_t daemon_id) {
           sink, it->second.receiver_id, it->second.active_sender_id);
     }
   }
+  return true;
 }
 
-// Process scheduled activations — called from registration_worker loop.
-void NmosManager::process_scheduled_activations() {
-  auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-      std::chrono::steady_clock::now().time_since_epoch()).count();
+// --- Activation scheduler ---
 
-  std::vector<PendingActivation> due;
+void NmosManager::schedule_activation(const PendingActivation& pa) {
   {
     std::lock_guard<std::mutex> lock(pending_act_mutex_);
-    auto part = std::stable_partition(
-        pending_activations_.begin(), pending_activations_.end(),
-        [now_ns](const PendingActivation& pa) { return pa.deadline_ns > now_ns; });
-    due.assign(part, pending_activations_.end());
-    pending_activations_.erase(part, pending_activations_.end());
+    pending_activations_.emplace(pa.deadline_ns, pa);
   }
+  // wake up the scheduler to re-arm the timer
+  signal_fd(activation_event_fd_);
+}
 
-  for (const auto& pa : due) {
-    // Fill activation_time in staged before promoting
-    {
-      std::unique_lock lock(resources_mutex_);
-      if (pa.is_sender) {
-        auto it = senders_.find(pa.daemon_id);
-        if (it != senders_.end())
-          it->second.staged_act.activation_time = make_version();
-      } else {
-        auto it = receivers_.find(pa.daemon_id);
-        if (it != receivers_.end())
-          it->second.staged_act.activation_time = make_version();
-      }
+void NmosManager::cancel_activation(bool is_sender, uint16_t daemon_id) {
+  std::lock_guard<std::mutex> lock(pending_act_mutex_);
+  for (auto it = pending_activations_.begin(); it != pending_activations_.end();) {
+    if (it->second.is_sender == is_sender && it->second.daemon_id == daemon_id)
+      it = pending_activations_.erase(it);
+    else
+      ++it;
+  }
+}
+
+// Arm the timer to the earliest deadline, steady_clock is CLOCK_MONOTONIC.
+// Called with pending_act_mutex_ held.
+void NmosManager::arm_activation_timer_locked() {
+  itimerspec spec{};
+  if (!pending_activations_.empty()) {
+    // a zero it_value disarms the timer, so fire 1 ns after the epoch at least
+    int64_t deadline = std::max<int64_t>(pending_activations_.begin()->first, 1);
+    spec.it_value.tv_sec  = deadline / 1'000'000'000LL;
+    spec.it_value.tv_nsec = deadline % 1'000'000'000LL;
+  }
+  if (timerfd_settime(activation_timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+    BOOST_LOG_TRIVIAL(error) << "NmosManager:: cannot arm activation timer: "
+                             << strerror(errno);
+  }
+}
+
+void NmosManager::run_activation(const PendingActivation& pa, int64_t error_ns) {
+  // activation_time reports the time the activation was actually applied
+  std::string activation_time = make_tai_time(tai_now_ns());
+  // The staged activation belongs to pa only while its generation matches,
+  // a PATCH may have replaced or cancelled it after the worker popped pa.
+  auto staged_act_locked = [&]() -> Is05Activation* {
+    if (pa.is_sender) {
+      auto it = senders_.find(pa.daemon_id);
+      if (it != senders_.end() && it->second.act_generation == pa.generation)
+        return &it->second.staged_act;
+    } else {
+      auto it = receivers_.find(pa.daemon_id);
+      if (it != receivers_.end() && it->second.act_generation == pa.generation)
+        return &it->second.staged_act;
     }
-    if (pa.is_sender) apply_sender_activation(pa.daemon_id);
-    else              apply_receiver_activation(pa.daemon_id);
-    // Reset staged activation
-    {
-      std::unique_lock lock(resources_mutex_);
-      if (pa.is_sender) {
-        auto it = senders_.find(pa.daemon_id);
-        if (it != senders_.end()) it->second.staged_act = {};
-      } else {
-        auto it = receivers_.find(pa.daemon_id);
-        if (it != receivers_.end()) it->second.staged_act = {};
+    return nullptr;
+  };
+  {
+    std::unique_lock lock(resources_mutex_);
+    auto act = staged_act_locked();
+    if (act == nullptr) {
+      BOOST_LOG_TRIVIAL(debug) << "NmosManager:: IS-05 "
+                               << (pa.is_sender ? "sender " : "receiver ")
+                               << +pa.daemon_id << " activation superseded";
+      return;
+    }
+    act->activation_time = activation_time;
+  }
+  // the apply functions check the generation again under their own lock
+  bool applied = pa.is_sender
+                     ? apply_sender_activation(pa.daemon_id, pa.generation)
+                     : apply_receiver_activation(pa.daemon_id, pa.generation);
+  // Reset staged activation unless a PATCH replaced it meanwhile
+  {
+    std::unique_lock lock(resources_mutex_);
+    if (auto act = staged_act_locked()) *act = {};
+  }
+  if (!applied) {
+    BOOST_LOG_TRIVIAL(debug) << "NmosManager:: IS-05 "
+                             << (pa.is_sender ? "sender " : "receiver ")
+                             << +pa.daemon_id << " activation not applied";
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(pending_act_mutex_);
+    auto& st = activation_stats_;
+    st.count++;
+    st.last_error_ns = error_ns;
+    st.max_error_ns = std::max(st.max_error_ns, error_ns);
+    st.total_error_ns += error_ns;
+  }
+  BOOST_LOG_TRIVIAL(info) << "NmosManager:: IS-05 " << (pa.is_sender ? "sender " : "receiver ")
+                          << +pa.daemon_id << " activated at " << activation_time
+                          << ", " << error_ns / 1000 << " us after the requested time";
+}
+
+// Runs the scheduled activations at their deadline, independently of the
+// registration I/O.
+bool NmosManager::activation_worker() {
+  pollfd fds[2] = {{activation_timer_fd_, POLLIN, 0},
+                   {activation_event_fd_, POLLIN, 0}};
+  while (running_) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      BOOST_LOG_TRIVIAL(fatal) << "NmosManager:: activation scheduler poll failed: "
+                               << strerror(errno);
+      return false;
+    }
+    if (fds[0].revents & POLLIN) drain_fd(activation_timer_fd_);
+    if (fds[1].revents & POLLIN) drain_fd(activation_event_fd_);
+
+    // Run the due activations in deadline order, then re-arm the timer
+    while (running_) {
+      PendingActivation pa;
+      int64_t now_ns;
+      {
+        std::lock_guard<std::mutex> lock(pending_act_mutex_);
+        now_ns = steady_now_ns();
+        if (pending_activations_.empty() ||
+            pending_activations_.begin()->first > now_ns) {
+          arm_activation_timer_locked();
+          break;
+        }
+        pa = pending_activations_.begin()->second;
+        pending_activations_.erase(pending_activations_.begin());
       }
+      run_activation(pa, now_ns - pa.deadline_ns);
     }
   }
+  BOOST_LOG_TRIVIAL(info) << "NmosManager:: activation scheduler stopped";
+  return true;
+}
+
+std::string NmosManager::activation_stats_json() const {
+  std::lock_guard<std::mutex> lock(pending_act_mutex_);
+  const auto& st = activation_stats_;
+  std::ostringstream ss;
+  ss << "{"
+     << "\n  \"activations\": " << st.count
+     << ",\n  \"pending\": " << pending_activations_.size()
+     << ",\n  \"last_error_ns\": " << st.last_error_ns
+     << ",\n  \"max_error_ns\": " << st.max_error_ns
+     << ",\n  \"mean_error_ns\": "
+     << (st.count ? st.total_error_ns / int64_t(st.count) : 0)
+     << "\n}";
+  return ss.str();
 }
 
 // --- IS-05 HTTP routes ---
@@ -1315,7 +1496,7 @@ void NmosManager::setup_connection_api() {
   node_api_svr_.Patch(R"(/x-nmos/connection/v1\.1/single/senders/([^/]+)/staged)",
     [this](const Request& req, Response& res) {
       std::string uuid = req.matches[1];
-      uint8_t daemon_id = 0;
+      uint16_t daemon_id = 0;
       bool found = false;
       {
         std::shared_lock lock(resources_mutex_);
@@ -1346,7 +1527,7 @@ void NmosManager::setup_connection_api() {
   node_api_svr_.Get(R"(/x-nmos/connection/v1\.1/single/senders/([^/]+)/transportfile/?)",
     [this](const Request& req, Response& res) {
       std::string uuid = req.matches[1];
-      uint8_t daemon_id = 0;
+      uint16_t daemon_id = 0;
       bool found = false, enabled = false;
       {
         std::shared_lock lock(resources_mutex_);
@@ -1432,7 +1613,7 @@ void NmosManager::setup_connection_api() {
   node_api_svr_.Patch(R"(/x-nmos/connection/v1\.1/single/receivers/([^/]+)/staged)",
     [this](const Request& req, Response& res) {
       std::string uuid = req.matches[1];
-      uint8_t daemon_id = 0;
+      uint16_t daemon_id = 0;
       bool found = false;
       {
         std::shared_lock lock(resources_mutex_);
@@ -1510,7 +1691,7 @@ void NmosManager::setup_connection_api() {
         pt_ns::write_json(params_ss, item.get_child("params"));
       } catch (...) { params_ss.str("{}"); }
 
-      uint8_t daemon_id = 0;
+      uint16_t daemon_id = 0;
       bool found = false;
       {
         std::shared_lock lock(resources_mutex_);
@@ -1553,6 +1734,12 @@ void NmosManager::setup_connection_api() {
     [bulk_handler](const Request& req, Response& res) {
       bulk_handler(req, res, false);
     });
+
+  // Achieved activation time error of the scheduled activations (not IS-05)
+  node_api_svr_.Get("/x-aes67/activations",
+    [this](const Request&, Response& res) {
+      conn_ok(res, activation_stats_json());
+    });
 }
 
 bool NmosManager::server_worker() {
@@ -1567,70 +1754,80 @@ bool NmosManager::server_worker() {
 // Registration client helpers
 // ---------------------------------------------------------------------------
 
-bool NmosManager::register_resource(const std::string& type,
-                                     const std::string& data_json) {
-  Client cli(config_->get_nmos_registry_address(),
-                      config_->get_nmos_registry_port());
-  cli.set_connection_timeout(5, 0);
-  cli.set_read_timeout(10, 0);
-
-  std::string body = "{\"type\": \"" + type + "\", \"data\": " + data_json + "}";
-  auto res = cli.Post("/x-nmos/registration/v1.3/resource", body, "application/json");
-  if (!res) {
+static NmosRegistryClient::Request registration_request(
+    const std::string& type, const std::string& data_json) {
+  return {NmosRegistryClient::Method::Post, "/x-nmos/registration/v1.3/resource",
+          "{\"type\": \"" + type + "\", \"data\": " + data_json + "}"};
+}
+
+static bool check_registration(const std::string& type,
+                               const NmosRegistryClient::Response& res) {
+  if (!res.status) {
     BOOST_LOG_TRIVIAL(error) << "NmosManager:: register " << type
                              << " failed (no response)";
     return false;
   }
-  if (res->status != 200 && res->status != 201) {
+  if (res.status != 200 && res.status != 201) {
     BOOST_LOG_TRIVIAL(error) << "NmosManager:: register " << type
-                             << " returned HTTP " << res->status;
+                             << " returned HTTP " << res.status;
     return false;
   }
   BOOST_LOG_TRIVIAL(debug) << "NmosManager:: registered " << type;
   return true;
 }
 
+bool NmosManager::register_resource(const std::string& type,
+                                     const std::string& data_json) {
+  return check_registration(
+      type, registry_->send(registration_request(type, data_json)));
+}
+
+bool NmosManager::register_resources(
+    const std::vector<std::pair<std::string, std::string>>& resources) {
+  std::vector<NmosRegistryClient::Request> reqs;
+  reqs.reserve(resources.size());
+  for (const auto& [type, json] : resources)
+    reqs.push_back(registration_request(type, json));
+  auto res = registry_->send_all(reqs);
+  bool ok = true;
+  for (size_t i = 0; i < res.size(); ++i)
+    ok &= check_registration(resources[i].first, res[i]);
+  return ok;
+}
+
 bool NmosManager::unregister_resource(const std::string& type,
                                        const std::string& id) {
-  Client cli(config_->get_nmos_registry_address(),
-                      config_->get_nmos_registry_port());
-  cli.set_connection_timeout(5, 0);
-  cli.set_read_timeout(10, 0);
-
-  std::string path = "/x-nmos/registration/v1.3/resource/" + type + "s/" + id;
-  auto res = cli.Delete(path.c_str());
-  if (!res) {
+  auto res = registry_->send(
+      {NmosRegistryClient::Method::Delete,
+       "/x-nmos/registration/v1.3/resource/" + type + "s/" + id});
+  if (!res.status) {
     BOOST_LOG_TRIVIAL(warning) << "NmosManager:: unregister " << type << " " << id
                                << " failed (no response)";
     return false;
   }
-  if (res->status != 204) {
+  if (res.status != 204) {
     BOOST_LOG_TRIVIAL(warning) << "NmosManager:: unregister " << type
-                               << " returned HTTP " << res->status;
+                               << " returned HTTP " << res.status;
     return false;
   }
   return true;
 }
 
 bool NmosManager::heartbeat() {
-  Client cli(config_->get_nmos_registry_address(),
-                      config_->get_nmos_registry_port());
-  cli.set_connection_timeout(5, 0);
-  cli.set_read_timeout(10, 0);
-
-  std::string path = "/x-nmos/registration/v1.3/health/nodes/" + node_id_;
-  auto res = cli.Post(path.c_str(), "", "application/json");
-  if (!res) {
+  auto res = registry_->send(
+      {NmosRegistryClient::Method::Post,
+       "/x-nmos/registration/v1.3/health/nodes/" + node_id_});
+  if (!res.status) {
     BOOST_LOG_TRIVIAL(warning) << "NmosManager:: heartbeat failed (no response)";
     return false;
   }
-  if (res->status == 404) {
+  if (res.status == 404) {
     BOOST_LOG_TRIVIAL(warning) << "NmosManager:: node expired from registry, re-registering";
     return full_registration();
   }
-  if (res->status != 200) {
+  if (res.status != 200) {
     BOOST_LOG_TRIVIAL(warning) << "NmosManager:: heartbeat returned HTTP "
-                               << res->status;
+                               << res.status;
     return false;
   }
   return true;
@@ -1649,73 +1846,73 @@ bool NmosManager::register_node() {
   return true;
 }
 
-bool NmosManager::register_source_local(uint8_t id) {
+bool NmosManager::register_source_local(uint16_t id) {
   StreamSource src;
   if (auto ec = session_manager_->get_source(id, src); ec) {
     BOOST_LOG_TRIVIAL(error) << "NmosManager:: get_source(" << +id
                              << ") failed: " << ec.message();
     return false;
   }
+  SenderParams params;
+  params.map                = src.map;
+  params.samples_per_packet = src.max_samples_per_packet;
+  params.sample_rate        = config_->get_sample_rate();
+  params.codec              = src.codec;
+  params.address            = src.address;
+  params.enabled            = src.enabled;
   std::string source_id = make_resource_uuid("source", id);
   std::string flow_id   = make_resource_uuid("flow",   id);
   std::string sender_id = make_resource_uuid("sender", id);
-  SenderTp tp = build_sender_tp(src);
   std::unique_lock lock(resources_mutex_);
-  SenderResources& sr   = senders_[id];
-  sr.source_id          = source_id;
-  sr.flow_id            = flow_id;
-  sr.sender_id          = sender_id;
-  sr.source_json        = build_source_json(src, source_id);
-  sr.flow_json          = build_flow_json(src, source_id, flow_id);
-  sr.sender_json        = build_sender_json(src, id, flow_id, sender_id, "");
-  sr.staged_master_enable = src.enabled;
-  sr.staged_tp            = tp;
-  sr.active_master_enable = src.enabled;
-  sr.active_tp            = tp;
-  rebuild_device_json_locked();
-  return true;
-}
-
-bool NmosManager::register_source(uint8_t id) {
-  if (!register_source_local(id)) return false;
-  std::string src_json, fl_json, snd_json, dev_json;
-  {
-    std::shared_lock lock(resources_mutex_);
-    auto it = senders_.find(id);
-    if (it == senders_.end()) return false;
-    src_json = it->second.source_json;
-    fl_json  = it->second.flow_json;
-    snd_json = it->second.sender_json;
-    dev_json = device_json_;
+  auto [it, added] = senders_.try_emplace(id);
+  SenderResources& sr = it->second;
+  const SenderParams& old = sr.params;
+  // The JSON of a resource is rebuilt, and gets a new version, only when
+  // the params it is built from change.
+  bool format_changed = added || old.map != params.map ||
+                        old.samples_per_packet != params.samples_per_packet ||
+                        old.sample_rate != params.sample_rate;
+  bool flow_changed   = format_changed || old.codec != params.codec;
+  bool sender_changed = format_changed || old.address != params.address ||
+                        old.enabled != params.enabled;
+  if (added) {
+    sr.source_id = source_id;
+    sr.flow_id   = flow_id;
+    sr.sender_id = sender_id;
+    device_dirty_ = true;
   }
-  // Best-effort registry push — failures are logged but not fatal.
-  register_resource("source", src_json);
-  register_resource("flow",   fl_json);
-  register_resource("sender", snd_json);
-  register_resource("device", dev_json);
+  if (format_changed) {
+    sr.source_json  = build_source_json(src, source_id);
+    sr.source_dirty = true;
+  }
+  if (flow_changed) {
+    sr.flow_json  = build_flow_json(src, source_id, flow_id);
+    sr.flow_dirty = true;
+  }
+  if (sender_changed) {
+    sr.sender_json = build_sender_json(src, id, flow_id, sender_id,
+                                       sr.active_receiver_id);
+    sr.sender_dirty = true;
+    SenderTp tp = build_sender_tp(src);
+    sr.staged_master_enable = src.enabled;
+    sr.staged_tp            = tp;
+    sr.active_master_enable = src.enabled;
+    sr.active_tp            = tp;
+  }
+  sr.params = std::move(params);
   return true;
 }
 
-bool NmosManager::unregister_source(uint8_t id) {
-  SenderResources sr;
-  std::string dev_json;
-  {
-    std::unique_lock lock(resources_mutex_);
-    auto it = senders_.find(id);
-    if (it == senders_.end()) return true;
-    sr = it->second;
-    senders_.erase(it);
-    rebuild_device_json_locked();
-    dev_json = device_json_;
-  }
-  register_resource("device", dev_json);
-  unregister_resource("sender", sr.sender_id);
-  unregister_resource("flow",   sr.flow_id);
-  unregister_resource("source", sr.source_id);
-  return true;
+void NmosManager::unregister_source_local(
+    uint16_t id, std::map<uint16_t, SenderResources>& removed) {
+  std::unique_lock lock(resources_mutex_);
+  auto it = senders_.find(id);
+  if (it == senders_.end()) return;
+  removed[id] = std::move(it->second);
+  senders_.erase(it);
 }
 
-bool NmosManager::register_sink_local(uint8_t id) {
+bool NmosManager::register_sink_local(uint16_t id) {
   StreamSink sink;
   if (auto ec = session_manager_->get_sink(id, sink); ec) {
     BOOST_LOG_TRIVIAL(error) << "NmosManager:: get_sink(" << +id
@@ -1729,86 +1926,168 @@ bool NmosManager::register_sink_local(uint8_t id) {
     tp = build_receiver_tp_from_sdp(sink.sdp);
   bool connected = sink.use_sdp && !sink.sdp.empty();
   std::unique_lock lock(resources_mutex_);
-  ReceiverResources& rr   = receivers_[id];
-  rr.receiver_id          = receiver_id;
-  rr.receiver_json        = build_receiver_json(sink, receiver_id, "");
+  auto [it, added] = receivers_.try_emplace(id);
+  ReceiverResources& rr   = it->second;
+  bool changed            = added || rr.map != sink.map;
   rr.staged_master_enable = connected;
   rr.staged_tp            = tp;
   rr.active_master_enable = connected;
   rr.active_tp            = tp;
+  if (added) {
+    rr.receiver_id = receiver_id;
+    device_dirty_  = true;
+  }
   // Restore IS-05 active sender preserved through a remove+add cycle
   auto pres = preserved_active_sender_ids_.find(id);
   if (pres != preserved_active_sender_ids_.end()) {
+    changed |= rr.active_sender_id != pres->second;
     rr.active_sender_id  = pres->second;
     preserved_active_sender_ids_.erase(pres);
-    rr.receiver_json = build_receiver_json(sink, receiver_id, rr.active_sender_id);
   }
-  rebuild_device_json_locked();
+  if (changed) {
+    rr.map            = sink.map;
+    rr.receiver_json  = build_receiver_json(sink, receiver_id, rr.active_sender_id);
+    rr.receiver_dirty = true;
+  }
   return true;
 }
 
-bool NmosManager::register_sink(uint8_t id) {
-  if (!register_sink_local(id)) return false;
-  std::string rcv_json, dev_json;
-  {
-    std::shared_lock lock(resources_mutex_);
-    auto it = receivers_.find(id);
-    if (it == receivers_.end()) return false;
-    rcv_json = it->second.receiver_json;
-    dev_json = device_json_;
-  }
-  // Best-effort registry push.
-  register_resource("receiver", rcv_json);
-  register_resource("device", dev_json);
-  return true;
+void NmosManager::unregister_sink_local(
+    uint16_t id, std::map<uint16_t, ReceiverResources>& removed) {
+  std::unique_lock lock(resources_mutex_);
+  auto it = receivers_.find(id);
+  if (it == receivers_.end()) return;
+  removed[id] = std::move(it->second);
+  receivers_.erase(it);
+}
+
+void NmosManager::process_events(const std::vector<Event>& events) {
+  bool node_changed = false;
+  std::map<uint16_t, SenderResources>   removed_senders;
+  std::map<uint16_t, ReceiverResources> removed_receivers;
+  for (const auto& ev : events) {
+    switch (ev.type) {
+      case EventType::PtpStatusChange: node_changed = true; break;
+      case EventType::SourceAdded:
+        if (auto node = removed_senders.extract(ev.id)) {
+          std::unique_lock lock(resources_mutex_);
+          senders_.insert(std::move(node));
+        }
+        register_source_local(ev.id);
+        break;
+      case EventType::SourceRemoved:
+        unregister_source_local(ev.id, removed_senders);
+        break;
+      case EventType::SinkAdded:
+        if (auto node = removed_receivers.extract(ev.id)) {
+          std::unique_lock lock(resources_mutex_);
+          receivers_.insert(std::move(node));
+        }
+        register_sink_local(ev.id);
+        break;
+      case EventType::SinkRemoved:
+        unregister_sink_local(ev.id, removed_receivers);
+        break;
+    }
+  }
+  if (node_changed) register_node();
+  sync_registry(removed_senders, removed_receivers);
 }
 
-bool NmosManager::unregister_sink(uint8_t id) {
-  ReceiverResources rr;
-  std::string dev_json;
+bool NmosManager::sync_registry(
+    const std::map<uint16_t, SenderResources>& removed_senders,
+    const std::map<uint16_t, ReceiverResources>& removed_receivers) {
+  // Collect the changed resources under lock, then push to registry outside
+  // the lock so PATCH requests are not blocked during slow network I/O.
+  using Resources = std::vector<std::pair<std::string, std::string>>;
+  Resources srcs, flows, endpoints, devices;
+  Resources to_remove;  // type, id in unregistration order
   {
     std::unique_lock lock(resources_mutex_);
-    auto it = receivers_.find(id);
-    if (it == receivers_.end()) return true;
-    rr = it->second;
-    receivers_.erase(it);
-    rebuild_device_json_locked();
-    dev_json = device_json_;
-  }
-  register_resource("device", dev_json);
-  unregister_resource("receiver", rr.receiver_id);
-  return true;
+    for (auto& [id, sr] : senders_) {
+      if (sr.source_dirty) srcs.emplace_back("source", sr.source_json);
+      if (sr.flow_dirty)   flows.emplace_back("flow", sr.flow_json);
+      if (sr.sender_dirty) endpoints.emplace_back("sender", sr.sender_json);
+      sr.source_dirty = sr.flow_dirty = sr.sender_dirty = false;
+    }
+    for (auto& [id, rr] : receivers_) {
+      if (rr.receiver_dirty)
+        endpoints.emplace_back("receiver", rr.receiver_json);
+      rr.receiver_dirty = false;
+    }
+    for (const auto& [id, sr] : removed_senders) {
+      to_remove.emplace_back("sender", sr.sender_id);
+      to_remove.emplace_back("flow",   sr.flow_id);
+      to_remove.emplace_back("source", sr.source_id);
+      device_dirty_ = true;
+    }
+    for (const auto& [id, rr] : removed_receivers) {
+      to_remove.emplace_back("receiver", rr.receiver_id);
+      device_dirty_ = true;
+    }
+    // The device is re-rendered once for the whole batch
+    if (update_device_json_locked())
+      devices.emplace_back("device", device_json_);
+  }
+
+  // Best-effort registry push — failures are logged but not fatal.
+  bool ok = true;
+  for (const auto* level : {&srcs, &flows, &endpoints, &devices})
+    ok &= register_resources(*level);
+  for (const auto& [type, id] : to_remove)
+    ok &= unregister_resource(type, id);
+  return ok;
 }
 
 bool NmosManager::full_registration() {
   // Re-sync local state in case any resources were added between init()'s
   // pre-population and now (e.g., loaded from status file asynchronously).
-  for (const auto& src : session_manager_->get_sources())
+  auto sources = session_manager_->get_sources();
+  for (const auto& src : *sources)
     register_source_local(src.id);
-  for (const auto& sink : session_manager_->get_sinks())
+  auto sinks = session_manager_->get_sinks();
+  for (const auto& sink : *sinks)
     register_sink_local(sink.id);
 
-  // Collect all JSON strings under shared lock, then push to registry outside
+  // Collect all JSON strings under lock, then push to registry outside
   // the lock so PATCH requests are not blocked during slow network I/O.
-  std::vector<std::pair<std::string, std::string>> to_push;
-  to_push.emplace_back("node", node_json_);
+  // Resources are grouped by level: a resource is registered only after the
+  // resource it references, resources of the same level are independent and
+  // are sent in parallel.
+  using Resources = std::vector<std::pair<std::string, std::string>>;
+  Resources nodes, devices, srcs, flows, endpoints;
+  nodes.emplace_back("node", node_json_);
   {
-    std::shared_lock lock(resources_mutex_);
-    to_push.emplace_back("device", device_json_);
-    for (const auto& [id, sr] : senders_) {
-      to_push.emplace_back("source", sr.source_json);
-      to_push.emplace_back("flow",   sr.flow_json);
-      to_push.emplace_back("sender", sr.sender_json);
+    std::unique_lock lock(resources_mutex_);
+    update_device_json_locked();
+    devices.emplace_back("device", device_json_);
+    for (auto& [id, sr] : senders_) {
+      srcs.emplace_back("source", sr.source_json);
+      flows.emplace_back("flow", sr.flow_json);
+      endpoints.emplace_back("sender", sr.sender_json);
+      sr.source_dirty = sr.flow_dirty = sr.sender_dirty = false;
+    }
+    for (auto& [id, rr] : receivers_) {
+      endpoints.emplace_back("receiver", rr.receiver_json);
+      rr.receiver_dirty = false;
     }
-    for (const auto& [id, rr] : receivers_)
-      to_push.emplace_back("receiver", rr.receiver_json);
   }
 
   BOOST_LOG_TRIVIAL(info) << "NmosManager:: registering with registry at "
                           << config_->get_nmos_registry_address() << ":"
                           << config_->get_nmos_registry_port();
-  for (const auto& [type, json] : to_push)
-    register_resource(type, json);
+  auto start = std::chrono::steady_clock::now();
+  bool ok = true;
+  size_t count = 0;
+  for (const auto* level : {&nodes, &devices, &srcs, &flows, &endpoints}) {
+    ok &= register_resources(*level);
+    count += level->size();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+  BOOST_LOG_TRIVIAL(info) << "NmosManager:: registered " << count
+                          << " resources in " << elapsed.count() << " ms"
+                          << (ok ? "" : " with errors");
 
   return true;
 }
@@ -1827,7 +2106,7 @@ bool NmosManager::on_ptp_status_change(const std::string& status) {
   return true;
 }
 
-bool NmosManager::on_source_added(uint8_t id, const std::string& /*name*/,
+bool NmosManager::on_source_added(uint16_t id, const std::string& /*name*/,
                                    const std::string& /*sdp*/) {
   if (!running_) return true;
   {
@@ -1838,7 +2117,7 @@ bool NmosManager::on_source_added(uint8_t id, const std::string& /*name*/,
   return true;
 }
 
-bool NmosManager::on_source_removed(uint8_t id, const std::string& /*name*/,
+bool NmosManager::on_source_removed(uint16_t id, const std::string& /*name*/,
                                      const std::string& /*sdp*/) {
   if (!running_) return true;
   {
@@ -1849,7 +2128,7 @@ bool NmosManager::on_source_removed(uint8_t id, const std::string& /*name*/,
   return true;
 }
 
-bool NmosManager::on_sink_added(uint8_t id, const std::string& /*name*/) {
+bool NmosManager::on_sink_added(uint16_t id, const std::string& /*name*/) {
   if (!running_) return true;
   {
     std::unique_lock lock(events_mutex_);
@@ -1859,7 +2138,7 @@ bool NmosManager::on_sink_added(uint8_t id, const std::string& /*name*/) {
   return true;
 }
 
-bool NmosManager::on_sink_removed(uint8_t id, const std::string& /*name*/) {
+bool NmosManager::on_sink_removed(uint16_t id, const std::string& /*name*/) {
   if (!running_) return true;
   {
     std::unique_lock lock(events_mutex_);
@@ -1883,31 +2162,23 @@ bool NmosManager::registration_worker() {
   auto next_hb = clock::now() + std::chrono::seconds(5);
 
   while (running_) {
-    // Drain pending events (wait up to 1 s for the next one)
+    // Drain pending events (wait up to 1 s for the next one) and apply
+    // them as a single batch
+    std::vector<Event> events;
     {
       std::unique_lock lock(events_mutex_);
       events_cv_.wait_for(lock, std::chrono::seconds(1),
                           [this] { return !pending_events_.empty() || !running_; });
+      if (!pending_events_.empty())
+        events_cv_.wait_for(lock, event_batch_window,
+                            [this] { return !running_; });
 
       while (!pending_events_.empty()) {
-        Event ev = pending_events_.front();
+        events.push_back(pending_events_.front());
         pending_events_.pop();
-        lock.unlock();
-
-        switch (ev.type) {
-          case EventType::PtpStatusChange: register_node(); break;
-          case EventType::SourceAdded:   register_source(ev.id);   break;
-          case EventType::SourceRemoved: unregister_source(ev.id); break;
-          case EventType::SinkAdded:     register_sink(ev.id);     break;
-          case EventType::SinkRemoved:   unregister_sink(ev.id);   break;
-        }
-
-        lock.lock();
       }
     }
-
-    // Process any scheduled IS-05 activations that have come due
-    process_scheduled_activations();
+    if (!events.empty()) process_events(events);
 
     // Heartbeat when due
     if (running_ && clock::now() >= next_hb) {
@@ -1918,6 +2189,7 @@ bool NmosManager::registration_worker() {
 
   // Unregister node on graceful shutdown (registry will GC the rest)
   unregister_resource("node", node_id_);
+  registry_->close();
   BOOST_LOG_TRIVIAL(info) << "NmosManager:: registration worker stopped";
   return true;
 }
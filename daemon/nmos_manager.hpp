@@ -9,6 +9,7 @@
 #define _NMOS_MANAGER_HPP_
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <future>
 #include <map>
@@ -21,6 +22,7 @@
 #include <httplib.h>
 
 #include "config.hpp"
+#include "nmos_registry_client.hpp"
 #include "session_manager.hpp"
 
 class NmosManager {
@@ -63,14 +65,30 @@ class NmosManager {
     bool        rtp_enabled{false};
   };
 
+  // Source params the sender, source and flow JSON are built from
+  struct SenderParams {
+    std::vector<uint8_t> map;
+    uint32_t    samples_per_packet{0};
+    uint32_t    sample_rate{0};
+    std::string codec;
+    std::string address;
+    bool        enabled{false};
+  };
+
   struct SenderResources {
     // IS-04
     std::string source_id, flow_id, sender_id;
     std::string source_json, flow_json, sender_json;
+    SenderParams params;
+    // JSON changed since it was last pushed to the registry
+    bool source_dirty{true}, flow_dirty{true}, sender_dirty{true};
     // IS-05 staged
     bool        staged_master_enable{true};
     std::string staged_receiver_id; // "" = null
     Is05Activation staged_act;
+    // bumped by every activation PATCH, a pending activation of an older
+    // generation was replaced or cancelled
+    uint64_t    act_generation{0};
     SenderTp    staged_tp;
     // IS-05 active (copy of staged after activation)
     bool        active_master_enable{true};
@@ -83,10 +101,14 @@ class NmosManager {
     // IS-04
     std::string receiver_id;
     std::string receiver_json;
+    std::vector<uint8_t> map;
+    // JSON changed since it was last pushed to the registry
+    bool receiver_dirty{true};
     // IS-05 staged
     bool        staged_master_enable{false};
     std::string staged_sender_id;   // "" = null
     Is05Activation staged_act;
+    uint64_t    act_generation{0}; // see SenderResources
     ReceiverTp  staged_tp;
     // IS-05 active
     bool        active_master_enable{false};
@@ -98,12 +120,25 @@ class NmosManager {
   // Scheduled activation awaiting its deadline
   struct PendingActivation {
     bool    is_sender;
-    uint8_t daemon_id;
+    uint16_t daemon_id;
     int64_t deadline_ns;
+    uint64_t generation;
+  };
+
+  // Achieved time error of the scheduled activations, the delay from the
+  // deadline to the time the activation was applied
+  struct ActivationStats {
+    uint64_t count{0};
+    int64_t  last_error_ns{0};
+    int64_t  max_error_ns{0};
+    int64_t  total_error_ns{0};
   };
 
   enum class EventType { SourceAdded, SourceRemoved, SinkAdded, SinkRemoved, PtpStatusChange };
-  struct Event { EventType type; uint8_t id; };
+  struct Event { EventType type; uint16_t id; };
+  // An update posts a remove and an add, the events arriving within this
+  // window are applied as one batch
+  static constexpr auto event_batch_window = std::chrono::milliseconds(10);
 
   explicit NmosManager(std::shared_ptr<SessionManager> session_manager,
                        std::shared_ptr<Config> config)
@@ -111,9 +146,11 @@ class NmosManager {
 
   // ---- IS-04 ----
   void setup_node_api();
-  void rebuild_device_json_locked();
+  // Re-render device_json_ if a sender or receiver was added or removed,
+  // returns true if it was re-rendered.
+  bool update_device_json_locked();
 
-  std::string make_resource_uuid(const std::string& type, uint8_t id) const;
+  std::string make_resource_uuid(const std::string& type, uint16_t id) const;
   std::string build_node_json() const;
   std::string build_source_json(const StreamSource& src,
                                 const std::string& source_id) const;
@@ -121,7 +158,7 @@ class NmosManager {
                               const std::string& source_id,
                               const std::string& flow_id) const;
   std::string build_sender_json(const StreamSource& src,
-                                uint8_t daemon_id,
+                                uint16_t daemon_id,
                                 const std::string& flow_id,
                                 const std::string& sender_id,
                                 const std::string& active_receiver_id) const;
@@ -146,45 +183,66 @@ class NmosManager {
   // PATCH body parsing; returns false + error message on bad input.
   // staged_json_out receives the staged state JSON to return to the caller
   // (captured before activation fires observer events that may erase the entry).
-  bool patch_sender_staged(uint8_t daemon_id,
+  bool patch_sender_staged(uint16_t daemon_id,
                            const std::string& body,
                            std::string& error_out,
                            std::string& staged_json_out);
-  bool patch_receiver_staged(uint8_t daemon_id,
+  bool patch_receiver_staged(uint16_t daemon_id,
                              const std::string& body,
                              std::string& error_out,
                              std::string& staged_json_out);
 
   // Immediate: apply staged → active, call session_manager if needed.
   // Must be called WITHOUT resources_mutex_ held (it acquires it internally).
-  void apply_sender_activation(uint8_t daemon_id);
-  void apply_receiver_activation(uint8_t daemon_id);
+  // The staged state is applied only while its activation generation matches,
+  // returns false if a PATCH replaced or cancelled the activation meanwhile.
+  bool apply_sender_activation(uint16_t daemon_id, uint64_t generation);
+  bool apply_receiver_activation(uint16_t daemon_id, uint64_t generation);
 
   // Fetch SDP for a remote sender via IS-04 registry + manifest_href.
   void fetch_remote_sender_sdp(const std::string& sender_uuid, std::string& sdp);
 
-  void process_scheduled_activations();
+  // Scheduled activations, run by activation_worker at their deadline.
+  // A new activation of a sender or receiver replaces the scheduled one.
+  void schedule_activation(const PendingActivation& pa);
+  void cancel_activation(bool is_sender, uint16_t daemon_id);
+  void arm_activation_timer_locked();
+  void run_activation(const PendingActivation& pa, int64_t error_ns);
+  bool activation_worker();
+  std::string activation_stats_json() const;
 
   // ---- Registration ----
   bool register_resource(const std::string& type, const std::string& data_json);
+  // Register independent resources in parallel over the pooled connections.
+  bool register_resources(
+      const std::vector<std::pair<std::string, std::string>>& resources);
   bool unregister_resource(const std::string& type, const std::string& id);
   bool heartbeat();
 
   bool full_registration();
   bool register_node();
   // Update senders_[id] / receivers_[id] from session_manager (no network I/O).
-  bool register_source_local(uint8_t id);
-  bool register_sink_local(uint8_t id);
-  bool register_source(uint8_t id);
-  bool unregister_source(uint8_t id);
-  bool register_sink(uint8_t id);
-  bool unregister_sink(uint8_t id);
+  // Only the JSON of the resources whose params changed is rebuilt.
+  bool register_source_local(uint16_t id);
+  bool register_sink_local(uint16_t id);
+  // Remove senders_[id] / receivers_[id], the removed resources are moved
+  // to removed so they can be unregistered from the registry.
+  void unregister_source_local(uint16_t id,
+                               std::map<uint16_t, SenderResources>& removed);
+  void unregister_sink_local(uint16_t id,
+                             std::map<uint16_t, ReceiverResources>& removed);
+  // Apply a batch of session manager events, then push the changed
+  // resources and the device to the registry once. A resource removed and
+  // added back in the same batch keeps its JSON unless its params changed.
+  void process_events(const std::vector<Event>& events);
+  bool sync_registry(const std::map<uint16_t, SenderResources>& removed_senders,
+                     const std::map<uint16_t, ReceiverResources>& removed_receivers);
 
   bool on_ptp_status_change(const std::string& status);
-  bool on_source_added(uint8_t id, const std::string& name, const std::string& sdp);
-  bool on_source_removed(uint8_t id, const std::string& name, const std::string& sdp);
-  bool on_sink_added(uint8_t id, const std::string& name);
-  bool on_sink_removed(uint8_t id, const std::string& name);
+  bool on_source_added(uint16_t id, const std::string& name, const std::string& sdp);
+  bool on_source_removed(uint16_t id, const std::string& name, const std::string& sdp);
+  bool on_sink_added(uint16_t id, const std::string& name);
+  bool on_sink_removed(uint16_t id, const std::string& name);
 
   bool registration_worker();
   bool server_worker();
@@ -198,21 +256,34 @@ class NmosManager {
   std::string node_json_;
 
   mutable std::shared_mutex       resources_mutex_;
-  std::map<uint8_t, SenderResources>   senders_;
-  std::map<uint8_t, ReceiverResources> receivers_;
+  std::map<uint16_t, SenderResources>   senders_;
+  std::map<uint16_t, ReceiverResources> receivers_;
   std::string device_json_;
+  bool        device_dirty_{true};  // guarded by resources_mutex_
+
+  // UUIDs of the resources, the UUID of a resource never changes
+  mutable std::mutex uuids_mutex_;
+  mutable std::map<std::pair<std::string, uint16_t>, std::string> uuids_;
 
+  // Activations by deadline_ns, the timer is armed to the earliest one
   mutable std::mutex              pending_act_mutex_;
-  std::vector<PendingActivation>  pending_activations_;
+  std::multimap<int64_t, PendingActivation> pending_activations_;
+  ActivationStats                 activation_stats_;  // guarded by pending_act_mutex_
+  int                             activation_timer_fd_{-1};
+  int                             activation_event_fd_{-1};
 
   // IS-05 active-sender preservation across unregister/register cycles
   // (session_manager::add_sink triggers remove+add observers for existing sinks)
-  std::map<uint8_t, std::string>  preserved_active_sender_ids_; // guarded by resources_mutex_
+  std::map<uint16_t, std::string>  preserved_active_sender_ids_; // guarded by resources_mutex_
+
+  // Keep-alive connections to the registry, shared by all the registry calls
+  std::unique_ptr<NmosRegistryClient> registry_;
 
   httplib::Server      node_api_svr_;
   std::atomic_bool     running_{false};
   std::future<bool>    reg_res_;
   std::future<bool>    svr_res_;
+  std::future<bool>    act_res_;
 
   std::mutex                  events_mutex_;
   std::condition_variable     events_cv_;
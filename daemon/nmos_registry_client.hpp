@@ -0,0 +1,150 @@
+//
+//  nmos_registry_client.hpp
+//
+//  Keep-alive connection pool for the IS-04 Registration and Query APIs.
+//  Requests reuse idle registry connections instead of paying the TCP setup
+//  on every call; independent requests run in parallel on up to
+//  connections_max connections.
+//
+
+#ifndef _NMOS_REGISTRY_CLIENT_HPP_
+#define _NMOS_REGISTRY_CLIENT_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <httplib.h>
+
+class NmosRegistryClient {
+ public:
+  static constexpr size_t connections_max = 4;
+  static constexpr time_t connection_timeout = 5;  // sec
+  static constexpr time_t read_timeout = 10;       // sec
+
+  enum class Method { Get, Post, Delete };
+
+  struct Request {
+    Method      method;
+    std::string path;
+    std::string body;  // POST only, application/json
+  };
+
+  struct Response {
+    int         status{0};  // 0 = no response
+    std::string body;
+  };
+
+  NmosRegistryClient(const std::string& host, uint16_t port,
+                     size_t connections = connections_max)
+      : host_(host),
+        port_(port),
+        connections_(std::max<size_t>(connections, 1)) {}
+  NmosRegistryClient(const NmosRegistryClient&) = delete;
+  NmosRegistryClient& operator=(const NmosRegistryClient&) = delete;
+
+  // Send a request on an idle connection (or a new one if none is idle).
+  Response send(const Request& req) {
+    bool reused = false;
+    auto cli = acquire(reused);
+    auto res = perform(*cli, req);
+    // The registry may have closed an idle keep-alive connection: retry once,
+    // httplib reconnects after the failure.
+    if (!res && reused) res = perform(*cli, req);
+    Response out;
+    if (res) {
+      out.status = res->status;
+      out.body = std::move(res->body);
+    }
+    release(std::move(cli), bool(res));
+    return out;
+  }
+
+  // Send independent requests in parallel on up to connections_max
+  // connections, responses are returned in the order of the requests.
+  std::vector<Response> send_all(const std::vector<Request>& reqs) {
+    std::vector<Response> out(reqs.size());
+    size_t workers = std::min(connections_, reqs.size());
+    if (workers <= 1) {
+      for (size_t i = 0; i < reqs.size(); ++i) out[i] = send(reqs[i]);
+      return out;
+    }
+    std::atomic<size_t> next{0};
+    auto worker = [this, &reqs, &out, &next] {
+      for (size_t i = next++; i < reqs.size(); i = next++)
+        out[i] = send(reqs[i]);
+    };
+    std::vector<std::future<void>> res;
+    for (size_t i = 1; i < workers; ++i)
+      res.emplace_back(std::async(std::launch::async, worker));
+    worker();
+    for (auto& r : res) r.get();
+    return out;
+  }
+
+  // Close the idle connections.
+  void close() {
+    std::lock_guard lock(mutex_);
+    open_ -= idle_.size();
+    idle_.clear();
+  }
+
+ private:
+  std::unique_ptr<httplib::Client> acquire(bool& reused) {
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [this] { return !idle_.empty() || open_ < connections_; });
+    if (!idle_.empty()) {
+      auto cli = std::move(idle_.back());
+      idle_.pop_back();
+      reused = true;
+      return cli;
+    }
+    ++open_;
+    lock.unlock();
+    auto cli = std::make_unique<httplib::Client>(host_, port_);
+    cli->set_keep_alive(true);
+    cli->set_connection_timeout(connection_timeout, 0);
+    cli->set_read_timeout(read_timeout, 0);
+    reused = false;
+    return cli;
+  }
+
+  // Failed connections are dropped, the next request opens a new one.
+  void release(std::unique_ptr<httplib::Client> cli, bool ok) {
+    {
+      std::lock_guard lock(mutex_);
+      if (ok)
+        idle_.push_back(std::move(cli));
+      else
+        --open_;
+    }
+    cv_.notify_one();
+  }
+
+  static httplib::Result perform(httplib::Client& cli, const Request& req) {
+    switch (req.method) {
+      case Method::Post:
+        return cli.Post(req.path.c_str(), req.body, "application/json");
+      case Method::Delete:
+        return cli.Delete(req.path.c_str());
+      default:
+        return cli.Get(req.path.c_str());
+    }
+  }
+
+  const std::string host_;
+  const uint16_t    port_;
+  const size_t      connections_;
+
+  std::mutex                                    mutex_;
+  std::condition_variable                       cv_;
+  std::vector<std::unique_ptr<httplib::Client>> idle_;
+  size_t                                        open_{0};
+};
+
+#endif
@@ -0,0 +1,258 @@
+//
+//  observer_queue.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _OBSERVER_QUEUE_HPP_
+#define _OBSERVER_QUEUE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "log.hpp"
+
+/*
+ * Delivers observer notifications from a small pool of dispatch threads.
+ * Every observer gets its own FIFO strand: the events of a strand are
+ * dispatched one at a time in the order they are posted, while the strands
+ * run concurrently, so a slow observer only delays itself.
+ * State transitions (a stream added or removed) are never discarded.
+ * A state event (a stream update or status) replaces the pending event of
+ * the same key if nothing else was posted for that key meanwhile, so a slow
+ * observer gets the latest state instead of a growing backlog.
+ */
+class ObserverQueue {
+ public:
+  using Event = std::function<void()>;
+  using Strand = size_t;
+  /* stream the event refers to, see Type */
+  using Key = uint32_t;
+  enum class Type { transition, state };
+
+  constexpr static size_t threads_num = 4;
+  /* strand depth that triggers a warning */
+  constexpr static size_t strand_depth_warning = 1024;
+  /* callback duration that triggers a warning */
+  constexpr static uint32_t slow_callback_ms = 100;
+
+  struct Stats {
+    std::string name;
+    uint64_t posted{0};
+    uint64_t dispatched{0};
+    uint64_t coalesced{0};       /* state events replaced while pending */
+    uint64_t dropped{0};         /* events posted once stopped */
+    size_t depth{0};
+    size_t max_depth{0};
+    uint64_t max_wait_us{0};     /* max time spent in the queue */
+    uint64_t max_dispatch_us{0}; /* max time spent in a callback */
+  };
+
+  explicit ObserverQueue(const std::string& name) : name_(name){};
+  ObserverQueue(const ObserverQueue&) = delete;
+  ObserverQueue& operator=(const ObserverQueue&) = delete;
+  ~ObserverQueue() { terminate(); }
+
+  bool init() {
+    if (!running_) {
+      running_ = true;
+      for (size_t i = 0; i < threads_num; i++) {
+        res_.emplace_back(
+            std::async(std::launch::async, &ObserverQueue::worker, this));
+      }
+    }
+    return true;
+  }
+
+  /* dispatch pending events and stop the dispatch threads, the events
+   * posted afterwards are dropped */
+  bool terminate() {
+    if (running_) {
+      {
+        std::lock_guard lock(mutex_);
+        running_ = false;
+      }
+      cv_.notify_all();
+      bool ret = true;
+      for (auto& res : res_) {
+        ret = res.get() && ret;
+      }
+      res_.clear();
+      for (const auto& stats : get_stats()) {
+        BOOST_LOG_TRIVIAL(info)
+            << name_ << ":: observer " << stats.name << " dispatched "
+            << stats.dispatched << " events, coalesced " << stats.coalesced
+            << ", dropped " << stats.dropped
+            << ", max depth " << stats.max_depth << ", max wait "
+            << stats.max_wait_us << " usecs, max callback "
+            << stats.max_dispatch_us << " usecs";
+      }
+      return ret;
+    }
+    return true;
+  }
+
+  /* return the strand of the observer, created at the first call */
+  Strand get_strand(const std::string& name) {
+    std::lock_guard lock(mutex_);
+    for (Strand strand = 0; strand < strands_.size(); strand++) {
+      if (strands_[strand].stats.name == name) {
+        return strand;
+      }
+    }
+    strands_.emplace_back();
+    strands_.back().stats.name = name;
+    return strands_.size() - 1;
+  }
+
+  void post(Strand strand,
+            Event&& event,
+            Key key,
+            Type type = Type::transition) {
+    {
+      std::lock_guard lock(mutex_);
+      auto& s = strands_[strand];
+      if (!running_) {
+        s.stats.dropped++;
+        BOOST_LOG_TRIVIAL(debug) << name_ << ":: observer " << s.stats.name
+                                 << " stopped, event dropped";
+        return;
+      }
+      s.stats.posted++;
+      if (type == Type::state) {
+        // the last pending event of the key, a transition keeps its place
+        auto it = std::find_if(s.events.rbegin(), s.events.rend(),
+                               [key](const auto& e) { return e.key == key; });
+        if (it != s.events.rend() && it->type == Type::state) {
+          it->event = std::move(event);
+          s.stats.coalesced++;
+          return;
+        }
+      }
+      s.events.push_back(
+          {std::move(event), key, type, std::chrono::steady_clock::now()});
+      s.stats.depth = s.events.size();
+      if (s.stats.depth > s.stats.max_depth) {
+        s.stats.max_depth = s.stats.depth;
+      }
+      if (s.stats.depth > strand_depth_warning && !s.backlog) {
+        s.backlog = true;
+        BOOST_LOG_TRIVIAL(warning)
+            << name_ << ":: observer " << s.stats.name << " not keeping up, "
+            << s.stats.depth << " events pending";
+      }
+      if (s.scheduled) {
+        // already waiting for or running on a dispatch thread
+        return;
+      }
+      s.scheduled = true;
+      ready_.push_back(strand);
+    }
+    cv_.notify_one();
+  }
+
+  std::vector<Stats> get_stats() const {
+    std::lock_guard lock(mutex_);
+    std::vector<Stats> stats;
+    for (const auto& s : strands_) {
+      stats.push_back(s.stats);
+    }
+    return stats;
+  }
+
+ private:
+  struct PendingEvent {
+    Event event;
+    Key key;
+    Type type;
+    std::chrono::steady_clock::time_point timepoint;
+  };
+
+  struct StrandState {
+    std::deque<PendingEvent> events;
+    bool scheduled{false}; /* in ready_ or running */
+    bool backlog{false};   /* depth warning logged */
+    Stats stats;
+  };
+
+  bool worker() {
+    using namespace std::chrono;
+    std::unique_lock lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this]() { return !running_ || !ready_.empty(); });
+      if (ready_.empty()) {
+        // stopped and nothing left to dispatch
+        break;
+      }
+      // one event per turn, the other strands get their share
+      auto strand = ready_.front();
+      ready_.pop_front();
+      auto [event, key, type, timepoint] =
+          std::move(strands_[strand].events.front());
+      strands_[strand].events.pop_front();
+      strands_[strand].stats.depth = strands_[strand].events.size();
+      lock.unlock();
+
+      auto start = steady_clock::now();
+      event();
+      auto end = steady_clock::now();
+
+      lock.lock();
+      // strands_ may have grown meanwhile, the reference is taken again
+      auto& s = strands_[strand];
+      s.stats.dispatched++;
+      s.stats.max_wait_us = std::max<uint64_t>(
+          s.stats.max_wait_us,
+          duration_cast<microseconds>(start - timepoint).count());
+      auto dispatch_us = duration_cast<microseconds>(end - start).count();
+      s.stats.max_dispatch_us =
+          std::max<uint64_t>(s.stats.max_dispatch_us, dispatch_us);
+      if (dispatch_us > slow_callback_ms * 1000) {
+        BOOST_LOG_TRIVIAL(warning)
+            << name_ << ":: slow observer " << s.stats.name
+            << " callback took " << dispatch_us / 1000 << " msecs";
+      }
+      if (s.events.empty()) {
+        s.scheduled = false;
+        s.backlog = false;
+      } else {
+        ready_.push_back(strand);
+        cv_.notify_one();
+      }
+    }
+    return true;
+  }
+
+  std::string name_;
+  std::vector<std::future<bool> > res_;
+  std::atomic_bool running_{false};
+
+  /* a deque keeps the strands in place while new ones are added */
+  std::deque<StrandState> strands_;
+  std::deque<Strand> ready_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+#endif
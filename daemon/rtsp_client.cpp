@@ -26,6 +26,7 @@
 #include <iostream>
 #include <istream>
 #include <map>
+#include <sstream>
 #include <ostream>
 #include <string>
 
@@ -87,59 +88,41 @@ RtspResponse read_response(tcp::iostream& s, uint16_t max_length) {
   return res;
 }
 
-struct RtspActiveClientRemover {
-  RtspActiveClientRemover() = delete;
-  RtspActiveClientRemover(ip::tcp::iostream* s,
-                          const std::string& name,
-                          const std::string& domain,
-                          bool wait_for_updates)
-      : stream_(s),
-        name_(name),
-        domain_(domain),
-        wait_for_updates_(wait_for_updates) {
-    if (stream_ != nullptr && wait_for_updates_) {
-      std::lock_guard<std::mutex> lock{RtspClient::g_mutex};
-      RtspClient::g_active_clients[{name_, domain_}] = stream_;
-    }
-  }
-  ~RtspActiveClientRemover() {
-    if (stream_ != nullptr && wait_for_updates_) {
-      std::lock_guard<std::mutex> lock{RtspClient::g_mutex};
-      auto it = RtspClient::g_active_clients.find({name_, domain_});
-      if (it != RtspClient::g_active_clients.end() && it->second == stream_) {
-        RtspClient::g_active_clients.erase(it);
-      }
-    }
-  }
-
-  RtspActiveClientRemover(const RtspActiveClientRemover&) = delete;
-  RtspActiveClientRemover& operator=(const RtspActiveClientRemover&) = delete;
+static void log_error_url(const std::string& msg,
+                          const std::string& dst_address,
+                          const std::string& port,
+                          const std::string& path) {
+  BOOST_LOG_TRIVIAL(error) << "rtsp_client:: " << msg << " rtsp://"
+                           << dst_address << ":" << port << path;
+}
 
- private:
-  ip::tcp::iostream* stream_{nullptr};
-  const std::string& name_;
-  const std::string& domain_;
-  bool wait_for_updates_{false};
-};
+RtspSource RtspClient::make_source(const std::string& address,
+                                   const std::string& port,
+                                   std::string&& sdp) {
+  RtspSource rtsp_source;
+  std::stringstream ss;
+  ss << "rtsp:" << std::hex
+     << crc16(reinterpret_cast<const uint8_t*>(sdp.c_str()), sdp.length());
+  rtsp_source.id = ss.str();
+  rtsp_source.source = "mDNS";
+  rtsp_source.address = address;
+  rtsp_source.port = port;
+  rtsp_source.sdp = std::move(sdp);
+  return rtsp_source;
+}
 
-std::pair<bool, RtspSource> RtspClient::process(
-    const RtspClient::Observer& callback,
-    const std::string& name,
-    const std::string& domain,
-    const std::string& path,
-    const std::string& dst_address,
-    const std::string& port,
-    bool wait_for_updates) {
+std::pair<bool, RtspSource> RtspClient::describe(const std::string& path,
+                                                 const std::string& dst_address,
+                                                 const std::string& port) {
   RtspSource rtsp_source;
   ip::tcp::iostream s;
-  RtspActiveClientRemover clientRemover(&s, name, domain, wait_for_updates);
   try {
     BOOST_LOG_TRIVIAL(debug) << "rtsp_client:: connecting to " << "rtsp://"
                              << dst_address << ":" << port << path;
 #if BOOST_VERSION < 106600
-    s.expires_from_now(boost::posix_time::seconds(5));
+    s.expires_from_now(boost::posix_time::seconds(client_timeout));
 #else
-    s.expires_after(boost::asio::chrono::seconds(5));
+    s.expires_after(boost::asio::chrono::seconds(client_timeout));
 #endif
     s.connect(dst_address, port.length() ? port : dft_port);
     if (!s || s.error()) {
@@ -168,156 +151,455 @@ std::pair<bool, RtspSource> RtspClient::process(
     std::getline(s, request);
 
     if (!s || s.error() || rtsp_version.substr(0, 5) != "RTSP/") {
-      BOOST_LOG_TRIVIAL(error)
-          << "rtsp_client:: invalid response from " << "rtsp://" << dst_address
-          << ":" << port << path;
+      log_error_url("invalid response from", dst_address, port, path);
       return {false, rtsp_source};
     }
 
     if (status_code != 200) {
-      BOOST_LOG_TRIVIAL(error)
-          << "rtsp_client:: response with status code " << status_code
-          << " from " << "rtsp://" << dst_address << ":" << port << path;
+      log_error_url("response with status code " + std::to_string(status_code) +
+                        " from",
+                    dst_address, port, path);
       return {false, rtsp_source};
     }
 
-    bool is_announce = false;
-    bool is_describe = true;
-    std::string announced_name;
-    do {
-      auto res = read_response(s, max_body_length);
-      if (is_describe && res.cseq != cseq) {
-        BOOST_LOG_TRIVIAL(error)
-            << "rtsp_client:: invalid response sequence " << res.cseq
-            << " from rtsp://" << dst_address << ":" << port << path;
-        return {false, rtsp_source};
-      }
+    auto res = read_response(s, max_body_length);
+    if (res.cseq != cseq) {
+      log_error_url("invalid response sequence " + std::to_string(res.cseq) +
+                        " from",
+                    dst_address, port, path);
+      return {false, rtsp_source};
+    }
 
-      if (!res.content_type.empty() &&
-          res.content_type.rfind("application/sdp", 0) == std::string::npos) {
-        BOOST_LOG_TRIVIAL(error)
-            << "rtsp_client:: unsupported content-type " << res.content_type
-            << " from " << "rtsp://" << dst_address << ":" << port << path;
-        if (is_describe) {
-          return {false, rtsp_source};
-        }
-      } else {
-        std::stringstream ss;
-        ss << "rtsp:" << std::hex
-           << crc16(reinterpret_cast<const uint8_t*>(res.body.c_str()),
-                    res.body.length());
-        rtsp_source.id = ss.str();
-        rtsp_source.source = "mDNS";
-        rtsp_source.address = dst_address;
-        rtsp_source.sdp = std::move(res.body);
-
-        if (is_announce) {
-          s << "RTSP/1.0 200 OK\r\n";
-          s << "CSeq: " << res.cseq << "\r\n";
-          s << "\r\n";
-        } else if (!is_describe) {
-          s << "RTSP/1.0 405 Method Not Allowed\r\n";
-          s << "CSeq: " << res.cseq << "\r\n";
-          s << "\r\n";
-        }
+    if (!res.content_type.empty() &&
+        res.content_type.rfind("application/sdp", 0) == std::string::npos) {
+      log_error_url("unsupported content-type " + res.content_type + " from",
+                    dst_address, port, path);
+      return {false, rtsp_source};
+    }
+    rtsp_source = make_source(dst_address, port.length() ? port : dft_port,
+                              std::move(res.body));
+    BOOST_LOG_TRIVIAL(info) << "rtsp_client:: completed " << "rtsp://"
+                            << dst_address << ":" << port << path;
+  } catch (std::exception& e) {
+    BOOST_LOG_TRIVIAL(warning)
+        << "rtsp_client:: error with " << "rtsp://" << dst_address << ":"
+        << port << path << ": " << e.what();
+    return {false, rtsp_source};
+  }
 
-        BOOST_LOG_TRIVIAL(info) << "rtsp_client:: completed " << "rtsp://"
-                                << dst_address << ":" << port << path;
+  return {true, rtsp_source};
+}
 
-        if (is_announce || is_describe) {
-          if (is_announce && announced_name.empty()) {
-            /* if no name from URL we try from SDP file */
-            announced_name = sdp_get_subject(rtsp_source.sdp);
-          }
-          callback(announced_name.empty() ? name : announced_name, domain,
-                   rtsp_source);
-        }
-      }
+RtspClientSession::RtspClientSession(RtspClientEngine& engine,
+                                     const std::string& name,
+                                     const std::string& domain,
+                                     const std::string& path,
+                                     const std::string& address,
+                                     const std::string& port)
+    : engine_(engine),
+      name_(name),
+      domain_(domain),
+      path_(path),
+      address_(address),
+      port_(port.length() ? port : RtspClient::dft_port),
+      socket_(engine.io_service_),
+      timer_(engine.io_service_),
+      buffer_(RtspClient::max_body_length * 2) {
+  engine_.sessions_num_++;
+}
+
+RtspClientSession::~RtspClientSession() {
+  engine_.sessions_num_--;
+  BOOST_LOG_TRIVIAL(debug) << "rtsp_client:: session end " << get_url();
+}
+
+std::string RtspClientSession::get_url() const {
+  return "rtsp://" + address_ + ":" + port_ + path_;
+}
+
+void RtspClientSession::start() {
+  BOOST_LOG_TRIVIAL(debug) << "rtsp_client:: connecting to " << get_url();
+  /* the engine DESCRIBE slot is released by end_describe() */
+  describing_ = true;
+  boost::system::error_code ec;
+  uint16_t port = 0;
+  try {
+    port = std::stoi(port_);
+  } catch (...) {
+  }
+#if BOOST_VERSION < 108700
+  auto address = ip::address::from_string(address_, ec);
+#else
+  auto address = ip::make_address(address_, ec);
+#endif
+  if (ec || !port) {
+    log_error_url("invalid address", address_, port_, path_);
+    close("invalid address");
+    return;
+  }
 
-      if (wait_for_updates) {
+  /* the connect and DESCRIBE must complete within the client timeout */
 #if BOOST_VERSION < 106600
-        s.expires_from_now(boost::posix_time::hours(24 * 365 * 10));
+  timer_.expires_from_now(std::chrono::seconds(RtspClient::client_timeout));
 #else
-        s.expires_after(boost::asio::chrono::hours(24 * 365 * 10));
+  timer_.expires_after(std::chrono::seconds(RtspClient::client_timeout));
 #endif
-        /* we start waiting for updates */
-        do {
-          std::getline(s, request);
-        } while (request.empty() && !s.error() && is_active(name, domain));
-        if (s.error() || !is_active(name, domain)) {
-          BOOST_LOG_TRIVIAL(info)
-              << "rtsp_client:: end: " << s.error().message();
-          break;
+  auto self(shared_from_this());
+  timer_.async_wait([self](const boost::system::error_code& ec) {
+    if (!ec && self->describing_) {
+      BOOST_LOG_TRIVIAL(warning)
+          << "rtsp_client:: timeout with " << self->get_url();
+      self->close("timeout");
+    }
+  });
+  socket_.async_connect(
+      ip::tcp::endpoint(address, port),
+      [self](const boost::system::error_code& ec) {
+        if (self->stopped_) {
+          return;
         }
-        BOOST_LOG_TRIVIAL(info) << "rtsp_client:: received " << request;
-        boost::trim(request);
-        is_describe = is_announce = false;
-        announced_name = "";
-        std::vector<std::string> fields;
-        split(fields, request, boost::is_any_of(" "));
-        if (fields.size() >= 2 && fields[0] == "ANNOUNCE") {
-          auto const res = parse_url(fields[1]);
-          if (std::get<0>(res)) {
-            /* if we find a valid announced source name we use it
-             * otherwise we try from SDP file or we use the mDNS name */
-            const auto& lpath = std::get<4>(res);
-            if (path.rfind("/by-name/") != std::string::npos) {
-              announced_name = lpath.substr(9);
-              BOOST_LOG_TRIVIAL(debug)
-                  << "rtsp_client:: found announced name " << announced_name;
+        if (ec) {
+          BOOST_LOG_TRIVIAL(warning) << "rtsp_client:: unable to connect to "
+                                     << self->address_ << ":" << self->port_;
+          self->close(ec.message());
+          return;
+        }
+        self->send_describe();
+      });
+}
+
+void RtspClientSession::send_describe() {
+  cseq_ = RtspClient::g_seq_number++;
+  std::stringstream ss;
+  ss << "DESCRIBE rtsp://" << address_ << ":" << port_
+     << httplib::detail::encode_url(path_) << " RTSP/1.0\r\n"
+     << "CSeq: " << cseq_ << "\r\n"
+     << "User-Agent: aes67-daemon\r\n"
+     << "Accept: application/sdp\r\n\r\n";
+  request_ = ss.str();
+  auto self(shared_from_this());
+  boost::asio::async_write(
+      socket_, boost::asio::buffer(request_),
+      [self](const boost::system::error_code& ec, std::size_t) {
+        if (self->stopped_) {
+          return;
+        }
+        if (ec) {
+          self->close(ec.message());
+          return;
+        }
+        self->read_message();
+      });
+}
+
+void RtspClientSession::read_message() {
+  auto self(shared_from_this());
+  boost::asio::async_read_until(
+      socket_, buffer_, "\r\n\r\n",
+      [self](const boost::system::error_code& ec, std::size_t) {
+        if (self->stopped_) {
+          return;
+        }
+        if (ec) {
+          self->close(ec.message());
+          return;
+        }
+        /*
+         RTSP/1.0 200 OK                ANNOUNCE rtsp://... RTSP/1.0
+         CSeq: 312                      CSeq: 13
+         Content-Type: application/sdp  Content-Type: application/sdp
+         Content-Length: 376            Content-Length: 376
+
+        */
+        std::istream is(&self->buffer_);
+        auto& msg = self->msg_;
+        msg = Message{};
+        std::string header;
+        std::getline(is, msg.start_line);
+        boost::trim(msg.start_line);
+        if (msg.start_line.empty()) {
+          // empty line preceding the message
+          self->read_message();
+          return;
+        }
+        try {
+          while (std::getline(is, header) && header != "" && header != "\r") {
+            to_lower(header);
+            trim(header);
+            if (header.rfind("cseq:", 0) != std::string::npos) {
+              msg.cseq = std::stoi(header.substr(5));
+            } else if (header.rfind("content-type:", 0) != std::string::npos) {
+              msg.content_type = header.substr(13);
+              trim(msg.content_type);
+            } else if (header.rfind("content-length:", 0) !=
+                       std::string::npos) {
+              msg.content_length = std::stoi(header.substr(15));
             }
           }
-          is_announce = true;
+        } catch (...) {
+          BOOST_LOG_TRIVIAL(error) << "rtsp_client:: invalid header, "
+                                   << "cannot perform number conversion";
+          self->close("invalid header");
+          return;
         }
-      }
-    } while (wait_for_updates && is_active(name, domain));
-  } catch (std::exception& e) {
-    BOOST_LOG_TRIVIAL(warning)
-        << "rtsp_client:: error with " << "rtsp://" << dst_address << ":"
-        << port << path << ": " << e.what();
+        if (msg.content_length >= RtspClient::max_body_length) {
+          BOOST_LOG_TRIVIAL(error)
+              << "rtsp_client:: body too long from " << self->get_url();
+          self->close("body too long");
+          return;
+        }
+        self->read_body();
+      });
+}
+
+void RtspClientSession::read_body() {
+  if (buffer_.size() >= msg_.content_length) {
+    msg_.body.resize(msg_.content_length);
+    std::istream is(&buffer_);
+    is.read(msg_.body.data(), msg_.content_length);
+    BOOST_LOG_TRIVIAL(debug) << "rtsp_client:: body " << msg_.body;
+    process_message();
+    return;
   }
+  auto self(shared_from_this());
+  boost::asio::async_read(
+      socket_, buffer_,
+      boost::asio::transfer_exactly(msg_.content_length - buffer_.size()),
+      [self](const boost::system::error_code& ec, std::size_t) {
+        if (self->stopped_) {
+          return;
+        }
+        if (ec) {
+          self->close(ec.message());
+          return;
+        }
+        self->read_body();
+      });
+}
 
-  return {true, rtsp_source};
+void RtspClientSession::process_message() {
+  bool is_sdp =
+      msg_.content_type.empty() ||
+      msg_.content_type.rfind("application/sdp", 0) != std::string::npos;
+  std::vector<std::string> fields;
+  split(fields, msg_.start_line, boost::is_any_of(" "));
+
+  if (describing_) {
+    if (fields.size() < 2 || fields[0].substr(0, 5) != "RTSP/") {
+      log_error_url("invalid response from", address_, port_, path_);
+      close("invalid response");
+      return;
+    }
+    if (fields[1] != "200") {
+      log_error_url("response with status code " + fields[1] + " from",
+                    address_, port_, path_);
+      close("DESCRIBE failed");
+      return;
+    }
+    if (msg_.cseq != cseq_) {
+      log_error_url("invalid response sequence " + std::to_string(msg_.cseq) +
+                        " from",
+                    address_, port_, path_);
+      close("invalid response sequence");
+      return;
+    }
+    if (!is_sdp) {
+      log_error_url("unsupported content-type " + msg_.content_type + " from",
+                    address_, port_, path_);
+      close("unsupported content-type");
+      return;
+    }
+    end_describe();
+    BOOST_LOG_TRIVIAL(info) << "rtsp_client:: completed " << get_url();
+    engine_.on_source(name_, domain_,
+                      RtspClient::make_source(address_, port_, std::move(msg_.body)));
+    /* we start waiting for updates */
+    read_message();
+    return;
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "rtsp_client:: received " << msg_.start_line;
+  if (fields.size() < 2 || fields[0] != "ANNOUNCE") {
+    send_reply(405, "Method Not Allowed");
+    return;
+  }
+  if (!is_sdp) {
+    BOOST_LOG_TRIVIAL(error)
+        << "rtsp_client:: unsupported content-type " << msg_.content_type
+        << " from " << get_url();
+    send_reply(415, "Unsupported Media Type");
+    return;
+  }
+  /* if we find a valid announced source name we use it
+   * otherwise we try from SDP file or we use the mDNS name */
+  std::string announced_name;
+  auto const res = parse_url(fields[1]);
+  if (std::get<0>(res)) {
+    const auto& lpath = std::get<4>(res);
+    if (lpath.rfind("/by-name/", 0) != std::string::npos) {
+      announced_name = lpath.substr(9);
+      BOOST_LOG_TRIVIAL(debug)
+          << "rtsp_client:: found announced name " << announced_name;
+    }
+  }
+  auto source = RtspClient::make_source(address_, port_, std::move(msg_.body));
+  if (announced_name.empty()) {
+    announced_name = sdp_get_subject(source.sdp);
+  }
+  send_reply(200, "OK");
+  engine_.on_source(announced_name.empty() ? name_ : announced_name, domain_,
+                    source);
 }
 
-void RtspClient::stop(const std::string& name, const std::string& domain) {
-  std::lock_guard<std::mutex> lock{g_mutex};
-  auto it = g_active_clients.find({name, domain});
-  if (it != g_active_clients.end()) {
-    BOOST_LOG_TRIVIAL(info)
-        << "rtsp_client:: stopping client " << name << " " << domain;
-#if BOOST_VERSION < 106600
-    it->second->close();
-#else
-    it->second->socket().shutdown(tcp::socket::shutdown_both);
-#endif
-    g_active_clients.erase(it);
+void RtspClientSession::send_reply(int status_code,
+                                   const std::string& description) {
+  std::stringstream ss;
+  ss << "RTSP/1.0 " << status_code << " " << description << "\r\n"
+     << "CSeq: " << msg_.cseq << "\r\n\r\n";
+  request_ = ss.str();
+  auto self(shared_from_this());
+  boost::asio::async_write(
+      socket_, boost::asio::buffer(request_),
+      [self](const boost::system::error_code& ec, std::size_t) {
+        if (self->stopped_) {
+          return;
+        }
+        if (ec) {
+          self->close(ec.message());
+          return;
+        }
+        self->read_message();
+      });
+}
+
+void RtspClientSession::end_describe() {
+  if (describing_) {
+    describing_ = false;
+    timer_.cancel();
+    engine_.on_describe_done();
   }
 }
 
-bool RtspClient::is_active(const std::string& name, const std::string& domain) {
-  std::lock_guard<std::mutex> lock{g_mutex};
-  return g_active_clients.find({name, domain}) != g_active_clients.end();
+void RtspClientSession::stop() {
+  if (!stopped_) {
+    stopped_ = true;
+    end_describe();
+    boost::system::error_code ec;
+    socket_.shutdown(ip::tcp::socket::shutdown_both, ec);
+    socket_.close(ec);
+  }
+}
+
+void RtspClientSession::close(const std::string& reason) {
+  if (!stopped_) {
+    BOOST_LOG_TRIVIAL(info) << "rtsp_client:: end " << get_url() << ": "
+                            << reason;
+    stop();
+    engine_.on_session_end(name_, domain_, this);
+  }
 }
 
-void RtspClient::stop_all() {
-  std::lock_guard<std::mutex> lock{g_mutex};
-  auto it = g_active_clients.begin();
-  while (it != g_active_clients.end()) {
-    BOOST_LOG_TRIVIAL(info) << "rtsp_client:: stopping client "
-                            << it->first.first << " " << it->first.second;
+bool RtspClientEngine::init() {
+  if (!running_) {
 #if BOOST_VERSION < 106600
-    it->second->close();
+    io_service_.reset();
+    work_ = std::make_unique<boost::asio::io_service::work>(io_service_);
 #else
-    it->second->socket().shutdown(tcp::socket::shutdown_both);
+    io_service_.restart();
+    work_ = std::make_unique<boost::asio::executor_work_guard<
+        boost::asio::io_context::executor_type> >(
+        io_service_.get_executor());
 #endif
-    it = g_active_clients.erase(it);
+    /* all the sessions run on the same thread */
+    res_ = std::async(std::launch::async, [this]() { io_service_.run(); });
+    running_ = true;
   }
+  return true;
 }
 
-std::pair<bool, RtspSource> RtspClient::describe(const std::string& path,
-                                                 const std::string& dst_address,
-                                                 const std::string& port) {
-  return RtspClient::process({}, {}, {}, path, dst_address, port,
-                             false);
+bool RtspClientEngine::terminate() {
+  if (running_) {
+    running_ = false;
+    boost::asio::post(io_service_, [this]() {
+      BOOST_LOG_TRIVIAL(info) << "rtsp_client:: stopping " << sessions_.size()
+                              << " clients";
+      for (auto& [key, session] : sessions_) {
+        session->stop();
+      }
+      sessions_.clear();
+      describe_queue_.clear();
+    });
+    /* run returns when the pending handlers are completed */
+    work_.reset();
+    res_.get();
+  }
+  return true;
+}
+
+void RtspClientEngine::start(const std::string& name,
+                             const std::string& domain,
+                             const std::string& path,
+                             const std::string& address,
+                             const std::string& port) {
+  boost::asio::post(io_service_, [=]() {
+    if (!running_) {
+      return;
+    }
+    auto it = sessions_.find({name, domain});
+    if (it != sessions_.end()) {
+      it->second->stop();
+    }
+    auto session = std::make_shared<RtspClientSession>(*this, name, domain,
+                                                       path, address, port);
+    sessions_[{name, domain}] = session;
+    describe_queue_.push_back(session);
+    start_describes();
+  });
+}
+
+void RtspClientEngine::stop(const std::string& name,
+                            const std::string& domain) {
+  boost::asio::post(io_service_, [=]() {
+    auto it = sessions_.find({name, domain});
+    if (it != sessions_.end()) {
+      BOOST_LOG_TRIVIAL(info)
+          << "rtsp_client:: stopping client " << name << " " << domain;
+      it->second->stop();
+      sessions_.erase(it);
+    }
+  });
+}
+
+void RtspClientEngine::start_describes() {
+  while (describe_pending_ < describe_max && !describe_queue_.empty()) {
+    auto session = describe_queue_.front().lock();
+    describe_queue_.pop_front();
+    if (session != nullptr) {
+      describe_pending_++;
+      session->start();
+    }
+  }
+}
+
+void RtspClientEngine::on_describe_done() {
+  describe_pending_--;
+  /* the next sessions start from a new handler, the caller is in progress */
+  boost::asio::post(io_service_, [this]() { start_describes(); });
+}
+
+void RtspClientEngine::on_session_end(const std::string& name,
+                                      const std::string& domain,
+                                      const RtspClientSession* session) {
+  auto it = sessions_.find({name, domain});
+  if (it != sessions_.end() && it->second.get() == session) {
+    sessions_.erase(it);
+  }
+}
+
+void RtspClientEngine::on_source(const std::string& name,
+                                 const std::string& domain,
+                                 const RtspSource& source) {
+  if (callback_) {
+    callback_(name, domain, source);
+  }
 }
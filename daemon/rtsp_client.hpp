@@ -20,14 +20,20 @@
 #ifndef _RTSP_CLIENT_HPP_
 #define _RTSP_CLIENT_HPP_
 
-#include <boost/asio/ip/tcp.hpp>
-#include <mutex>
+#include <boost/asio.hpp>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 
 struct RtspSource {
   std::string id;
   std::string source;
   std::string address;
+  std::string port;
   std::string sdp;
 };
 
@@ -41,26 +47,138 @@ class RtspClient {
                                       const std::string& domain,
                                       const RtspSource& source)>;
 
-  static std::pair<bool, RtspSource> process(const Observer& callback,
-                                             const std::string& name,
-                                             const std::string& domain,
-                                             const std::string& path,
-                                             const std::string& dst_address,
-                                             const std::string& port = dft_port,
-                                             bool wait_for_updates = true);
-
-  static bool is_active(const std::string& name, const std::string& domain);
-  static void stop(const std::string& name, const std::string& domain);
-  static void stop_all();
+  /* blocking DESCRIBE, see RtspClientEngine for the sessions kept open */
   static std::pair<bool, RtspSource> describe(const std::string& path,
                                               const std::string& dst_address,
                                               const std::string& port);
-  inline static std::map<
-      std::pair<std::string /*name*/, std::string /*domain*/>,
-      boost::asio::ip::tcp::iostream* /*stream*/>
-      g_active_clients;
+  static RtspSource make_source(const std::string& address,
+                                const std::string& port,
+                                std::string&& sdp);
+
   inline static std::atomic<uint16_t> g_seq_number{0};
-  inline static std::mutex g_mutex;
+};
+
+class RtspClientEngine;
+
+/*
+ * RTSP client session running on the RtspClientEngine io_context.
+ * The session describes the source and keeps the connection open to receive
+ * the ANNOUNCE updates, the observer is called for every SDP received.
+ */
+class RtspClientSession
+    : public std::enable_shared_from_this<RtspClientSession> {
+ public:
+  RtspClientSession(RtspClientEngine& engine,
+                    const std::string& name,
+                    const std::string& domain,
+                    const std::string& path,
+                    const std::string& address,
+                    const std::string& port);
+  virtual ~RtspClientSession();
+
+  /* connect and send the DESCRIBE */
+  void start();
+  void stop();
+
+ private:
+  struct Message {
+    std::string start_line;
+    int32_t cseq{-1};
+    std::string content_type;
+    uint64_t content_length{0};
+    std::string body;
+  };
+
+  void send_describe();
+  void read_message();
+  void read_body();
+  void process_message();
+  void send_reply(int status_code, const std::string& description);
+  void end_describe();
+  void close(const std::string& reason);
+  std::string get_url() const;
+
+  RtspClientEngine& engine_;
+  std::string name_;
+  std::string domain_;
+  std::string path_;
+  std::string address_;
+  std::string port_;
+  boost::asio::ip::tcp::socket socket_;
+  boost::asio::steady_timer timer_;
+  boost::asio::streambuf buffer_;
+  std::string request_;
+  Message msg_;
+  uint16_t cseq_{0};
+  bool describing_{false};
+  bool stopped_{false};
+};
+
+/*
+ * Asynchronous RTSP client engine used for the sources discovered via mDNS.
+ * All the sessions are multiplexed on a single io_context thread and at most
+ * describe_max DESCRIBE requests are in progress at the same time, the other
+ * sessions wait in a FIFO queue before connecting.
+ */
+class RtspClientEngine {
+ public:
+  constexpr static size_t describe_max = 16;
+
+  explicit RtspClientEngine(const RtspClient::Observer& callback)
+      : callback_(callback){};
+  RtspClientEngine(const RtspClientEngine&) = delete;
+  RtspClientEngine& operator=(const RtspClientEngine&) = delete;
+  ~RtspClientEngine() { terminate(); }
+
+  bool init();
+  /* stop all the sessions and the io_context thread */
+  bool terminate();
+
+  /* start a session replacing the previous one with the same name, domain */
+  void start(const std::string& name,
+             const std::string& domain,
+             const std::string& path,
+             const std::string& address,
+             const std::string& port);
+  void stop(const std::string& name, const std::string& domain);
+  size_t get_sessions_num() const { return sessions_num_; }
+
+ private:
+  friend class RtspClientSession;
+
+  /* called on the io_context thread */
+  void on_describe_done();
+  void on_session_end(const std::string& name,
+                      const std::string& domain,
+                      const RtspClientSession* session);
+  void on_source(const std::string& name,
+                 const std::string& domain,
+                 const RtspSource& source);
+  void start_describes();
+
+#if BOOST_VERSION < 108700
+  boost::asio::io_service io_service_;
+#else
+  boost::asio::io_context io_service_;
+#endif
+#if BOOST_VERSION < 106600
+  std::unique_ptr<boost::asio::io_service::work> work_;
+#else
+  std::unique_ptr<boost::asio::executor_work_guard<
+      boost::asio::io_context::executor_type> >
+      work_;
+#endif
+  std::future<void> res_;
+  std::atomic_bool running_{false};
+  RtspClient::Observer callback_;
+
+  /* accessed on the io_context thread only */
+  std::map<std::pair<std::string /*name*/, std::string /*domain*/>,
+           std::shared_ptr<RtspClientSession> >
+      sessions_;
+  std::deque<std::weak_ptr<RtspClientSession> > describe_queue_;
+  size_t describe_pending_{0};
+  std::atomic<size_t> sessions_num_{0};
 };
 
 #endif
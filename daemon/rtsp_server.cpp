@@ -20,20 +20,148 @@
 
 using boost::asio::ip::tcp;
 
-bool RtspServer::update_source(uint8_t id,
+RtspResponseCache::Entry RtspResponseCache::build(const std::string& sdp) {
+  std::string response;
+  response.reserve(sdp.length() + 64);
+  response.append("Content-Length: ")
+      .append(std::to_string(sdp.length()))
+      .append("\r\nContent-Type: application/sdp\r\n\r\n")
+      .append(sdp);
+  return std::make_shared<const std::string>(std::move(response));
+}
+
+RtspResponseCache::Entry RtspResponseCache::get(uint16_t id) {
+  uint64_t version;
+  {
+    std::shared_lock<std::shared_mutex> lock{mutex_};
+    auto it = entries_.find(id);
+    if (it != entries_.end()) {
+      return it->second;
+    }
+    version = version_;
+  }
+
+  /* not cached yet, generate the SDP from the session manager */
+  std::string sdp;
+  if (session_manager_->get_source_sdp(id, sdp)) {
+    return nullptr;
+  }
+  auto entry = build(sdp);
+  std::unique_lock<std::shared_mutex> lock{mutex_};
+  /* do not cache if the source was updated or removed in the meantime */
+  if (version == version_) {
+    entries_.emplace(id, entry);
+  }
+  return entry;
+}
+
+void RtspResponseCache::update(uint16_t id, const std::string& sdp) {
+  auto entry = build(sdp);
+  std::unique_lock<std::shared_mutex> lock{mutex_};
+  entries_[id] = entry;
+  version_++;
+}
+
+void RtspResponseCache::remove(uint16_t id) {
+  std::unique_lock<std::shared_mutex> lock{mutex_};
+  entries_.erase(id);
+  version_++;
+}
+
+bool RtspServer::update_source(uint16_t id,
                                const std::string& name,
                                const std::string& sdp) {
-  bool ret = false;
   BOOST_LOG_TRIVIAL(debug) << "rtsp_server:: added source " << name;
+  cache_.update(id, sdp);
   std::lock_guard<std::mutex> lock{mutex_};
-  for (unsigned int i = 0; i < sessions_.size(); i++) {
-    auto session = sessions_[i].lock();
-    if (session != nullptr) {
-      ret |= session->announce(id, name, sdp, config_->get_ip_addr_str(),
-                               config_->get_rtsp_port());
+  if (subscribers_.find(id) == subscribers_.end()) {
+    /* no session described this source */
+    return true;
+  }
+  /* coalesce the updates received within the window,
+   * the ANNOUNCE will carry the latest SDP */
+  pending_announces_[id] = name;
+  if (!announce_scheduled_) {
+    announce_scheduled_ = true;
+    announce_timer_.expires_after(milliseconds(announce_coalesce_msecs));
+    announce_timer_.async_wait([this](const boost::system::error_code& ec) {
+      if (!ec) {
+        send_announces();
+      }
+    });
+  }
+  return true;
+}
+
+bool RtspServer::remove_source(uint16_t id,
+                               const std::string& name,
+                               const std::string& /* sdp */) {
+  BOOST_LOG_TRIVIAL(debug) << "rtsp_server:: removed source " << name;
+  cache_.remove(id);
+  return true;
+}
+
+void RtspServer::subscribe(uint16_t id,
+                           const std::shared_ptr<RtspSession>& session) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  auto& subscribers = subscribers_[id];
+  /* drop the sessions that ended */
+  subscribers.erase(
+      std::remove_if(subscribers.begin(), subscribers.end(),
+                     [](const auto& s) { return s.expired(); }),
+      subscribers.end());
+  subscribers.push_back(session);
+}
+
+void RtspServer::send_announces() {
+  std::unordered_map<uint16_t, std::string> pending;
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    pending.swap(pending_announces_);
+    announce_scheduled_ = false;
+  }
+
+  for (const auto& [id, name] : pending) {
+    auto body = cache_.get(id);
+    if (body == nullptr) {
+      /* source removed in the meantime */
+      continue;
+    }
+    /* request line and headers preceding the CSeq are built once and
+     * shared by all the subscribed sessions */
+    std::string path(std::string("/by-name/") + config_->get_node_id() + " " +
+                     name);
+    auto prefix = std::make_shared<const std::string>(
+        "ANNOUNCE rtsp://" + config_->get_ip_addr_str() + ":" +
+        std::to_string(config_->get_rtsp_port()) +
+        httplib::detail::encode_url(path) +
+        " RTSP/1.0\r\n"
+        "User-Agent: aes67-daemon\r\n"
+        "connection: Keep-Alive\r\n");
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto it = subscribers_.find(id);
+    if (it == subscribers_.end()) {
+      continue;
+    }
+    auto& subscribers = it->second;
+    size_t count = 0;
+    for (auto s = subscribers.begin(); s != subscribers.end();) {
+      auto session = s->lock();
+      if (session == nullptr) {
+        s = subscribers.erase(s);
+        continue;
+      }
+      session->announce(prefix, body);
+      count++;
+      s++;
+    }
+    BOOST_LOG_TRIVIAL(info) << "rtsp_server:: ANNOUNCE for source " << name
+                            << " sent to " << count << " sessions";
+    if (subscribers.empty()) {
+      subscribers_.erase(it);
     }
   }
-  return ret;
 }
 
 void RtspServer::accept() {
@@ -45,7 +173,7 @@ void RtspServer::accept() {
       for (; i < sessions_.size(); i++) {
         if (sessions_[i].use_count() == 0) {
           auto session = std::make_shared<RtspSession>(
-              config_, session_manager_, std::move(socket_));
+              config_, session_manager_, *this, std::move(socket_));
           sessions_[i] = session;
           sessions_start_point_[i] = steady_clock::now();
           session->start();
@@ -64,35 +192,16 @@ void RtspServer::accept() {
   });
 }
 
-bool RtspSession::announce(uint8_t id,
-                           const std::string& name,
-                           const std::string& sdp,
-                           const std::string& address,
-                           uint16_t port) {
-  /* if a describe request is currently not beeing process
-   * and the specified source id has been described on this session send update
-   */
-  if (cseq_ < 0 && source_ids_.find(id) != source_ids_.end()) {
-    std::string path(std::string("/by-name/") + config_->get_node_id() + " " +
-                     name);
-    std::stringstream ss;
-    ss << "ANNOUNCE rtsp://" << address << ":" << std::to_string(port)
-       << httplib::detail::encode_url(path) << " RTSP/1.0\r\n"
-       << "User-Agent: aes67-daemon\r\n"
-       << "connection: Keep-Alive" << "\r\n"
-       << "CSeq: " << announce_cseq_++ << "\r\n"
-       << "Content-Length: " << sdp.length() << "\r\n"
-       << "Content-Type: application/sdp\r\n"
-       << "\r\n"
-       << sdp;
-
-    BOOST_LOG_TRIVIAL(info) << "rtsp_server:: " << "ANNOUNCE for source "
-                            << name << " sent to " << socket_.remote_endpoint();
-
-    send_response(ss.str());
-    return true;
-  }
-  return false;
+void RtspSession::announce(RtspResponseCache::Entry prefix,
+                           RtspResponseCache::Entry body) {
+  auto self(shared_from_this());
+  boost::asio::post(strand_, [this, self, prefix, body]() {
+    boost::system::error_code ec;
+    BOOST_LOG_TRIVIAL(debug)
+        << "rtsp_server:: ANNOUNCE sent to " << socket_.remote_endpoint(ec);
+    send_response("CSeq: " + std::to_string(announce_cseq_++) + "\r\n", body,
+                  prefix);
+  });
 }
 
 bool RtspSession::process_request() {
@@ -170,33 +279,30 @@ void RtspSession::build_response(const std::string& url) {
   }
   const auto& path = std::get<4>(res);
   auto base_path = std::string("/by-name/") + config_->get_node_id() + " ";
-  uint8_t id = SessionManager::stream_id_max + 1;
+  uint16_t id = SessionManager::stream_id_max + 1;
   if (path.rfind(base_path) != std::string::npos) {
     /* extract the source name from path and retrive the id */
     id = session_manager_->get_source_id(path.substr(base_path.length()));
   } else if (path.rfind("/by-id/") != std::string::npos) {
     try {
-      id = (uint8_t)stoi(path.substr(7));
+      id = (uint16_t)stoi(path.substr(7));
     } catch (...) {
       id = SessionManager::stream_id_max + 1;
       ;
     }
   }
   if (id != (SessionManager::stream_id_max + 1)) {
-    std::string sdp;
-    if (!session_manager_->get_source_sdp(id, sdp)) {
-      std::stringstream ss;
-      ss << "RTSP/1.0 200 OK\r\n"
-         << "CSeq: " << cseq_ << "\r\n"
-         << "Content-Length: " << sdp.length() << "\r\n"
-         << "Content-Type: application/sdp\r\n"
-         << "\r\n"
-         << sdp;
+    auto body = server_.get_describe_response(id);
+    if (body != nullptr) {
       BOOST_LOG_TRIVIAL(info)
           << "rtsp_server:: " << request_ << " response 200 to "
           << socket_.remote_endpoint();
-      send_response(ss.str());
-      source_ids_.insert(id);
+      send_response(
+          "RTSP/1.0 200 OK\r\nCSeq: " + std::to_string(cseq_) + "\r\n",
+          std::move(body));
+      if (source_ids_.insert(id).second) {
+        server_.subscribe(id, shared_from_this());
+      }
       return;
     }
   }
@@ -211,21 +317,24 @@ void RtspSession::read_request() {
   } else {
     socket_.async_read_some(
         boost::asio::buffer(data_ + length_, max_length - length_),
-        [this, self](boost::system::error_code ec, std::size_t length) {
-          if (!ec) {
-            BOOST_LOG_TRIVIAL(debug) << "rtsp_server:: received " << length
-                                     << " from " << socket_.remote_endpoint();
-            length_ += length;
-            while (length_ && process_request()) {
-              /* step to the next request */
-              std::memmove(data_, data_ + consumed_, length_ - consumed_);
-              length_ -= consumed_;
-              cseq_ = -1;
-            }
-            /* read more data */
-            read_request();
-          }
-        });
+        boost::asio::bind_executor(
+            strand_,
+            [this, self](boost::system::error_code ec, std::size_t length) {
+              if (!ec) {
+                BOOST_LOG_TRIVIAL(debug)
+                    << "rtsp_server:: received " << length << " from "
+                    << socket_.remote_endpoint();
+                length_ += length;
+                while (length_ && process_request()) {
+                  /* step to the next request */
+                  std::memmove(data_, data_ + consumed_, length_ - consumed_);
+                  length_ -= consumed_;
+                  cseq_ = -1;
+                }
+                /* read more data */
+                read_request();
+              }
+            }));
   }
 }
 
@@ -242,22 +351,47 @@ void RtspSession::send_error(int status_code, const std::string& description) {
   send_response(ss.str());
 }
 
-void RtspSession::send_response(const std::string& response) {
+void RtspSession::send_response(std::string head,
+                                RtspResponseCache::Entry body,
+                                RtspResponseCache::Entry prefix) {
+  /* queue the message, the buffers must stay valid until the write completes
+   * and a single write can be outstanding on the socket */
+  write_queue_.push_back({std::move(prefix), std::move(head), std::move(body)});
+  if (write_queue_.size() == 1) {
+    write_next();
+  }
+}
+
+void RtspSession::write_next() {
   auto self(shared_from_this());
+  const auto& msg = write_queue_.front();
+  std::array<boost::asio::const_buffer, 3> buffers{
+      msg.prefix ? boost::asio::buffer(*msg.prefix)
+                 : boost::asio::const_buffer(),
+      boost::asio::buffer(msg.head),
+      msg.body ? boost::asio::buffer(*msg.body) : boost::asio::const_buffer()};
   boost::asio::async_write(
-      socket_, boost::asio::buffer(response.c_str(), response.length()),
-      [self](boost::system::error_code ec, std::size_t /*length*/) {
-        if (!ec) {
-          // we accept multiple requests within timeout
-          // stop();
-        }
-      });
+      socket_, buffers,
+      boost::asio::bind_executor(
+          strand_,
+          [this, self](boost::system::error_code ec, std::size_t /*length*/) {
+            if (ec) {
+              write_queue_.clear();
+              return;
+            }
+            write_queue_.pop_front();
+            // we accept multiple requests within timeout
+            if (!write_queue_.empty()) {
+              write_next();
+            }
+          }));
 }
 
 void RtspSession::start() {
   BOOST_LOG_TRIVIAL(debug) << "rtsp_server:: starting session with "
                            << socket_.remote_endpoint();
-  read_request();
+  auto self(shared_from_this());
+  boost::asio::post(strand_, [this, self]() { read_request(); });
 }
 
 void RtspSession::stop() {
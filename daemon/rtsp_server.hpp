@@ -19,11 +19,15 @@
 #define _RTSP_SERVER_HPP_
 
 #include <boost/algorithm/string.hpp>
+#include <array>
 #include <boost/asio.hpp>
 #include <chrono>
 #include <cstdlib>
+#include <deque>
 #include <iostream>
 #include <memory>
+#include <shared_mutex>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -34,6 +38,34 @@ using namespace std::chrono;
 using boost::asio::ip::tcp;
 using second_t = duration<double, std::ratio<1> >;
 
+/* cache of the DESCRIBE responses, one per source.
+ * Each entry holds the response headers following the CSeq and the SDP, it is
+ * built once when a source is added or updated and shared by all the sessions.
+ */
+class RtspResponseCache {
+ public:
+  using Entry = std::shared_ptr<const std::string>;
+
+  explicit RtspResponseCache(std::shared_ptr<SessionManager> session_manager)
+      : session_manager_(session_manager) {}
+
+  /* return the DESCRIBE response for the source id or nullptr if not found */
+  Entry get(uint16_t id);
+  void update(uint16_t id, const std::string& sdp);
+  void remove(uint16_t id);
+
+ private:
+  static Entry build(const std::string& sdp);
+
+  std::shared_ptr<SessionManager> session_manager_;
+  std::shared_mutex mutex_;
+  std::unordered_map<uint16_t, Entry> entries_;
+  /* incremented at every update, used to discard stale entries on a miss */
+  uint64_t version_{0};
+};
+
+class RtspServer;
+
 class RtspSession : public std::enable_shared_from_this<RtspSession> {
  public:
   constexpr static uint16_t max_length = 4096;       // byte
@@ -41,10 +73,13 @@ class RtspSession : public std::enable_shared_from_this<RtspSession> {
 
   RtspSession(std::shared_ptr<Config> config,
               std::shared_ptr<SessionManager> session_manager,
+              RtspServer& server,
               tcp::socket socket)
       : config_(config),
         session_manager_(session_manager),
-        socket_(std::move(socket)) {}
+        server_(server),
+        socket_(std::move(socket)),
+        strand_(socket_.get_executor()) {}
 
   virtual ~RtspSession() {
     BOOST_LOG_TRIVIAL(debug) << "rtsp_server:: session end";
@@ -53,41 +88,57 @@ class RtspSession : public std::enable_shared_from_this<RtspSession> {
   void start();
   void stop();
 
-  bool announce(uint8_t source_id,
-                const std::string& name,
-                const std::string& sdp,
-                const std::string& address,
-                uint16_t port);
+  /* send an ANNOUNCE built from the shared request line and body,
+   * only the CSeq is specific to the session */
+  void announce(RtspResponseCache::Entry prefix, RtspResponseCache::Entry body);
 
  private:
+  /* a message is sent as an optional shared prefix, a per request head
+   * and an optional shared body */
+  struct Message {
+    RtspResponseCache::Entry prefix;
+    std::string head;
+    RtspResponseCache::Entry body;
+  };
+
   bool process_request();
   void build_response(const std::string& url);
   void read_request();
   void send_error(int status_code, const std::string& description);
-  void send_response(const std::string& response);
+  void send_response(std::string head,
+                     RtspResponseCache::Entry body = nullptr,
+                     RtspResponseCache::Entry prefix = nullptr);
+  void write_next();
   std::shared_ptr<Config> config_;
   std::shared_ptr<SessionManager> session_manager_;
+  RtspServer& server_;
   tcp::socket socket_;
+  /* all the session handlers are serialized on the strand */
+  boost::asio::strand<tcp::socket::executor_type> strand_;
+  std::deque<Message> write_queue_;
   char data_[max_length + 1];
   std::string request_;
   size_t length_{0};
   int32_t cseq_{-1};
   size_t consumed_{0};
   int32_t announce_cseq_{0};
-  /* set with the ids described on this session */
-  std::unordered_set<uint8_t> source_ids_;
+  /* set with the ids described on this session, used to subscribe once */
+  std::unordered_set<uint16_t> source_ids_;
 };
 
 class RtspServer {
  public:
-  constexpr static uint8_t session_num_max{(SessionManager::stream_id_max + 1) *
-                                           2};
+  constexpr static uint16_t session_num_max{
+      (SessionManager::stream_id_max + 1) * 2};
+  /* updates of a source within this window are sent with a single ANNOUNCE */
+  constexpr static uint16_t announce_coalesce_msecs = 100;
 
   RtspServer() = delete;
   explicit RtspServer(std::shared_ptr<SessionManager> session_manager,
                       std::shared_ptr<Config> config)
       : session_manager_(session_manager),
         config_(config),
+        cache_(session_manager),
         acceptor_(io_service_,
                   tcp::endpoint(
 #if BOOST_VERSION < 108700
@@ -100,8 +151,11 @@ class RtspServer {
   }
   bool init() {
     accept();
-    /* start rtsp server on a separate thread */
-    res_ = std::async([this]() { io_service_.run(); });
+    /* start rtsp server on a pool of threads */
+    for (uint8_t i = 0; i < config_->get_rtsp_threads(); i++) {
+      res_.emplace_back(
+          std::async(std::launch::async, [this]() { io_service_.run(); }));
+    }
 
     session_manager_->add_source_observer(
         SessionManager::SourceObserverType::add_source,
@@ -113,22 +167,43 @@ class RtspServer {
         std::bind(&RtspServer::update_source, this, std::placeholders::_1,
                   std::placeholders::_2, std::placeholders::_3));
 
+    session_manager_->add_source_observer(
+        SessionManager::SourceObserverType::remove_source,
+        std::bind(&RtspServer::remove_source, this, std::placeholders::_1,
+                  std::placeholders::_2, std::placeholders::_3));
+
     return true;
   }
 
   bool terminate() {
     BOOST_LOG_TRIVIAL(info) << "rtsp_server: stopping ... ";
     io_service_.stop();
-    res_.get();
+    for (auto& res : res_) {
+      res.get();
+    }
+    res_.clear();
     return true;
   }
 
+  /* return the pre-built DESCRIBE response for the source id */
+  RtspResponseCache::Entry get_describe_response(uint16_t id) {
+    return cache_.get(id);
+  }
+  /* subscribe the session to the ANNOUNCE updates of the source id */
+  void subscribe(uint16_t id, const std::shared_ptr<RtspSession>& session);
+
  private:
-  /* a source was updated */
-  bool update_source(uint8_t id,
+  /* a source was added or updated */
+  bool update_source(uint16_t id,
+                     const std::string& name,
+                     const std::string& sdp);
+  /* a source was removed */
+  bool remove_source(uint16_t id,
                      const std::string& name,
                      const std::string& sdp);
   void accept();
+  /* send the pending ANNOUNCEs to the subscribed sessions */
+  void send_announces();
 
   std::mutex mutex_;
 #if BOOST_VERSION < 108700
@@ -138,11 +213,19 @@ class RtspServer {
 #endif
   std::shared_ptr<SessionManager> session_manager_;
   std::shared_ptr<Config> config_;
+  RtspResponseCache cache_;
   std::vector<std::weak_ptr<RtspSession> > sessions_{session_num_max};
   std::vector<time_point<steady_clock> > sessions_start_point_{session_num_max};
+  /* source id to the sessions that described it */
+  std::unordered_map<uint16_t, std::vector<std::weak_ptr<RtspSession> > >
+      subscribers_;
+  /* source id to name of the sources with an ANNOUNCE pending */
+  std::unordered_map<uint16_t, std::string> pending_announces_;
+  boost::asio::steady_timer announce_timer_{io_service_};
+  bool announce_scheduled_{false};
   tcp::acceptor acceptor_;
   tcp::socket socket_{io_service_};
-  std::future<void> res_;
+  std::vector<std::future<void> > res_;
 };
 
 #endif
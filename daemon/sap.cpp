@@ -17,11 +17,11 @@
 //  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
-#include <boost/bind/bind.hpp>
+#include <poll.h>
+#include <zlib.h>
 
 #include "sap.hpp"
 
-using namespace boost::placeholders;
 using namespace boost::asio;
 using namespace boost::asio::ip;
 
@@ -29,7 +29,6 @@ SAP::SAP(const std::string& sap_mcast_addr) : addr_(sap_mcast_addr) {
   socket_.open(boost::asio::ip::udp::v4());
   socket_.set_option(udp::socket::reuse_address(true));
   socket_.bind(listen_endpoint_);
-  check_deadline();
 }
 
 bool SAP::set_multicast_interface(const std::string& interface_ip) {
@@ -78,95 +77,222 @@ bool SAP::deletion(uint16_t msg_id_hash,
   return send(false, msg_id_hash, htonl(addr), sdp);
 }
 
-bool SAP::receive(bool& is_announce,
-                  uint16_t& msg_id_hash,
-                  uint32_t& addr,
-                  std::string& sdp,
-                  int tout_secs) {
-  // Set a deadline for the asynchronous operation
-  deadline_.expires_at(std::chrono::steady_clock::now() +
-                       std::chrono::seconds(tout_secs));
-
-  boost::system::error_code ec = boost::asio::error::would_block;
-  ip::udp::endpoint endpoint;
-  uint8_t buffer[max_length];
-  std::size_t length = 0;
-  // Start the asynchronous operation itself. The handle_receive function
-  // used as a callback will update the ec and length variables.
-  socket_.async_receive_from(
-      boost::asio::buffer(buffer), endpoint,
-      boost::bind(&SAP::handle_receive, _1, _2, &ec, &length));
-
-  // Block until the asynchronous operation has completed.
-  do {
-    io_service_.run_one();
-  } while (ec == boost::asio::error::would_block);
-
-  if (!ec && length > 4 && (buffer[0] == 0x20 || buffer[0] == 0x24)) {
-    // only accept SAP announce or delete v2 with IPv4
-    // no reserved, no compress, no encryption
-    // and content/type = application/sdp
-    is_announce = (buffer[0] == 0x20);
-    memcpy(&msg_id_hash, buffer + 2, sizeof(msg_id_hash));
-    memcpy(&addr, buffer + 4, sizeof(addr));
-    for (int i = 8; i < static_cast<int>(length) && buffer[i] != 0; i++) {
-      buffer[i] = std::tolower(buffer[i]);
+size_t SAP::receive(std::vector<Message>& messages, int tout_secs) {
+  if (rx_msgs_.empty()) {
+    /* absorb bursts of announcements */
+    boost::system::error_code ec;
+    socket_.set_option(socket_base::receive_buffer_size(rcvbuf_size), ec);
+    if (ec) {
+      BOOST_LOG_TRIVIAL(warning)
+          << "sap::receive_buffer_size option " << ec.message();
+    }
+    rx_buffers_.resize(max_batch * max_length);
+    rx_iovecs_.resize(max_batch);
+    rx_msgs_.resize(max_batch);
+    for (size_t i = 0; i < max_batch; i++) {
+      rx_iovecs_[i].iov_base = rx_buffers_.data() + i * max_length;
+      rx_iovecs_[i].iov_len = max_length;
+      memset(&rx_msgs_[i], 0, sizeof(rx_msgs_[i]));
+      rx_msgs_[i].msg_hdr.msg_iov = &rx_iovecs_[i];
+      rx_msgs_[i].msg_hdr.msg_iovlen = 1;
     }
-    if (!memcmp(buffer + 8, "application/sdp", 16)) {
-      sdp.assign(buffer + SAP::sap_header_len, buffer + length);
-      return true;
+    inflate_buffer_.resize(16 + max_sdp_length);
+  }
+
+  pollfd pfd{socket_.native_handle(), POLLIN, 0};
+  if (::poll(&pfd, 1, tout_secs * 1000) <= 0) {
+    return 0;
+  }
+
+  int num = ::recvmmsg(socket_.native_handle(), rx_msgs_.data(), max_batch,
+                       MSG_DONTWAIT, nullptr);
+  if (num <= 0) {
+    return 0;
+  }
+
+  if (messages.size() < max_batch) {
+    messages.resize(max_batch);
+  }
+  size_t count = 0;
+  for (int i = 0; i < num; i++) {
+    if (parse(rx_buffers_.data() + i * max_length, rx_msgs_[i].msg_len,
+              messages[count])) {
+      count++;
+    }
+  }
+  return count;
+}
+
+bool SAP::parse(uint8_t* buffer, size_t length, Message& message) {
+  // only accept SAP announce or delete v2 with IPv4
+  // no reserved, no encryption, optional compression
+  // and content/type = application/sdp
+  if (length <= 8 || (buffer[0] & 0xFA) != 0x20) {
+    return false;
+  }
+  size_t offset = 8 + buffer[1] * 4;  // skip authentication data
+  if (offset >= length) {
+    return false;
+  }
+  message.is_announce = !(buffer[0] & 0x04);
+  memcpy(&message.msg_id_hash, buffer + 2, sizeof(message.msg_id_hash));
+  memcpy(&message.addr, buffer + 4, sizeof(message.addr));
+
+  uint8_t* payload = buffer + offset;
+  size_t payload_length = length - offset;
+  if (buffer[0] & 0x01) {
+    // compressed payload
+    uLongf inflate_length = inflate_buffer_.size();
+    if (uncompress(inflate_buffer_.data(), &inflate_length, payload,
+                   payload_length) != Z_OK) {
+      BOOST_LOG_TRIVIAL(debug) << "sap:: cannot uncompress payload";
+      return false;
     }
+    payload = inflate_buffer_.data();
+    payload_length = inflate_length;
+  }
+
+  for (size_t i = 0; i < payload_length && payload[i] != 0; i++) {
+    payload[i] = std::tolower(payload[i]);
+  }
+  if (payload_length >= 16 && !memcmp(payload, "application/sdp", 16)) {
+    message.sdp.assign(payload + 16, payload + payload_length);
+    return true;
   }
 
   return false;
 }
 
-void SAP::handle_receive(const boost::system::error_code& ec,
-                         std::size_t length,
-                         boost::system::error_code* out_ec,
-                         std::size_t* out_length) {
-  *out_ec = ec;
-  *out_length = length;
+size_t SAP::build(bool is_announce,
+                  uint16_t msg_id_hash,
+                  uint32_t addr,
+                  const std::string& sdp,
+                  uint8_t* buffer) const {
+  buffer[0] = is_announce ? 0x20 : 0x24;
+  buffer[1] = 0;
+  memcpy(buffer + 2, &msg_id_hash, 2);
+  memcpy(buffer + 4, &addr, 4);
+
+  if (compression_ && sdp.length() <= max_sdp_length) {
+    std::vector<uint8_t> payload(16 + sdp.length());
+    memcpy(payload.data(), "application/sdp", 16); /* include trailing 0 */
+    memcpy(payload.data() + 16, sdp.c_str(), sdp.length());
+    uLongf length = max_length - 8;
+    if (compress(buffer + 8, &length, payload.data(), payload.size()) ==
+            Z_OK &&
+        length < payload.size()) {
+      buffer[0] |= 0x01;
+      return 8 + length;
+    }
+    // send uncompressed if it doesn't get smaller
+  }
+
+  if (sdp.length() > max_length - sap_header_len) {
+    return 0;
+  }
+  memcpy(buffer + 8, "application/sdp", 16); /* include trailing 0 */
+  memcpy(buffer + sap_header_len, sdp.c_str(), sdp.length());
+  return sap_header_len + sdp.length();
 }
 
-void SAP::check_deadline() {
-#if BOOST_VERSION < 106600
-  if (deadline_.expires_at() <= std::chrono::steady_clock::now()) {
-#else
-  if (deadline_.expiry() <= std::chrono::steady_clock::now()) {
-#endif
-    // cancel receive operation
-    socket_.cancel();
-    deadline_.expires_at(boost::asio::steady_timer::time_point::max());
-    // BOOST_LOG_TRIVIAL(debug) << "SAP:: timeout expired when receiving";
+void SAP::update_stats(size_t packets, size_t bytes) {
+  using namespace std::chrono;
+  auto now = steady_clock::now();
+  if (stats_.packets_sent > 0) {
+    uint64_t gap = duration_cast<microseconds>(now - last_send_).count();
+    stats_.min_gap_us = gaps_num_ ? std::min(stats_.min_gap_us, gap) : gap;
+    stats_.max_gap_us = std::max(stats_.max_gap_us, gap);
+    gaps_sum_us_ += gap;
+    gaps_num_++;
+  }
+  if (packets > 1) {
+    /* packets of the same batch are sent back to back */
+    stats_.min_gap_us = 0;
+    gaps_num_ += packets - 1;
   }
+  if (gaps_num_ > 0) {
+    stats_.avg_gap_us = gaps_sum_us_ / gaps_num_;
+  }
+  last_send_ = now;
+  stats_.packets_sent += packets;
+  stats_.bytes_sent += bytes;
+}
 
-  deadline_.async_wait(boost::bind(&SAP::check_deadline, this));
+SAP::Stats SAP::get_stats(bool reset) {
+  auto stats = stats_;
+  if (reset) {
+    stats_ = Stats{};
+    gaps_num_ = 0;
+    gaps_sum_us_ = 0;
+  }
+  return stats;
 }
 
 bool SAP::send(bool is_announce,
                uint16_t msg_id_hash,
                uint32_t addr,
                const std::string& sdp) {
-  if (sdp.length() > max_length - sap_header_len) {
+  uint8_t buffer[max_length];
+  auto length = build(is_announce, msg_id_hash, addr, sdp, buffer);
+  if (!length) {
     BOOST_LOG_TRIVIAL(error) << "sap:: SDP is too long";
     return false;
   }
-  uint8_t buffer[max_length];
-
-  buffer[0] = is_announce ? 0x20 : 0x24;
-  buffer[1] = 0;
-  memcpy(buffer + 2, &msg_id_hash, 2);
-  memcpy(buffer + 4, &addr, 4);
-  memcpy(buffer + 8, "application/sdp", 16); /* include trailing 0 */
-  memcpy(buffer + sap_header_len, sdp.c_str(), sdp.length());
 
   try {
-    socket_.send_to(boost::asio::buffer(buffer, sap_header_len + sdp.length()),
-                    remote_endpoint_);
+    socket_.send_to(boost::asio::buffer(buffer, length), remote_endpoint_);
   } catch (...) {
     BOOST_LOG_TRIVIAL(error) << "sap::send_to failed";
     return false;
   }
+  update_stats(1, length);
   return true;
 }
+
+size_t SAP::send(const std::vector<Message>& messages) {
+  std::vector<uint8_t> buffer(messages.size() * max_length);
+  std::vector<iovec> iovecs(messages.size());
+  std::vector<mmsghdr> msgs(messages.size());
+  size_t num = 0;
+  size_t skipped = 0;
+  for (const auto& message : messages) {
+    auto data = buffer.data() + num * max_length;
+    iovecs[num].iov_base = data;
+    iovecs[num].iov_len = build(message.is_announce, message.msg_id_hash,
+                                message.addr, message.sdp, data);
+    if (!iovecs[num].iov_len) {
+      skipped++;
+      continue;
+    }
+    memset(&msgs[num], 0, sizeof(msgs[num]));
+    msgs[num].msg_hdr.msg_name = remote_endpoint_.data();
+    msgs[num].msg_hdr.msg_namelen = remote_endpoint_.size();
+    msgs[num].msg_hdr.msg_iov = &iovecs[num];
+    msgs[num].msg_hdr.msg_iovlen = 1;
+    num++;
+  }
+  if (skipped > 0) {
+    BOOST_LOG_TRIVIAL(error) << "sap:: skipped " << skipped << " of "
+                             << messages.size() << " messages, SDP is too long";
+  }
+
+  size_t sent = 0;
+  while (sent < num) {
+    int ret = ::sendmmsg(socket_.native_handle(), msgs.data() + sent,
+                         num - sent, 0);
+    if (ret < 0) {
+      BOOST_LOG_TRIVIAL(error) << "sap::sendmmsg failed " << strerror(errno)
+                               << ", " << num - sent << " messages not sent";
+      break;
+    }
+    sent += ret;
+  }
+  if (sent > 0) {
+    size_t bytes = 0;
+    for (size_t i = 0; i < sent; i++) {
+      bytes += iovecs[i].iov_len;
+    }
+    update_stats(sent, bytes);
+  }
+  return sent;
+}
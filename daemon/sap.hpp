@@ -20,42 +20,74 @@
 #ifndef _SAP_HPP_
 #define _SAP_HPP_
 
+#include <sys/socket.h>
 #include <boost/asio.hpp>
+#include <chrono>
+#include <vector>
 
 #include "log.hpp"
 
 using namespace boost::asio;
-using boost::asio::steady_timer;
 
 class SAP {
  public:
   constexpr static uint16_t port = 9875;
   constexpr static uint16_t max_deletions = 3;
-  constexpr static uint16_t bandwidth_limit = 4000;  // bits x xsec
   constexpr static uint16_t min_interval = 300;      // secs
   constexpr static uint16_t sap_header_len = 24;
   constexpr static uint16_t max_length = 4096;
+  /* max SDP length of a compressed message */
+  constexpr static uint16_t max_sdp_length = 16384;
+  /* max number of datagrams read by a single receive */
+  constexpr static uint16_t max_batch = 64;
+  constexpr static int rcvbuf_size = 1024 * 1024;  // bytes
+
+  /* addr is in network byte order */
+  struct Message {
+    bool is_announce{false};
+    uint16_t msg_id_hash{0};
+    uint32_t addr{0};
+    std::string sdp;
+  };
+
+  struct Stats {
+    uint64_t packets_sent{0};
+    uint64_t bytes_sent{0};
+    /* gap between consecutive packets sent */
+    uint64_t min_gap_us{0};
+    uint64_t max_gap_us{0};
+    uint64_t avg_gap_us{0};
+  };
 
   SAP() = delete;
   explicit SAP(const std::string& sap_mcast_addr);
 
   bool set_multicast_interface(const std::string& interface_ip);
+  /* compress the payload of the messages sent, see RFC 2974 */
+  void set_compression(bool enabled) { compression_ = enabled; }
   bool announcement(uint16_t msg_id_hash,
                     uint32_t addr,
                     const std::string& sdp);
   bool deletion(uint16_t msg_id_hash, uint32_t addr, const std::string& sdp);
-  bool receive(bool& is_announce,
-               uint16_t& msg_id_hash,
-               uint32_t& addr,
-               std::string& sdp,
-               int tout_secs = 1);
+  /* send all the messages using a single sendmmsg when possible,
+   * returns the number of messages sent, oversized messages are skipped */
+  size_t send(const std::vector<Message>& messages);
+  /* wait up to tout_secs for SAP messages and read all the datagrams
+   * available up to max_batch, returns the number of valid messages stored
+   * at the beginning of messages */
+  size_t receive(std::vector<Message>& messages, int tout_secs = 1);
+  /* statistics of the messages sent since the last reset */
+  Stats get_stats(bool reset = false);
 
  private:
-  static void handle_receive(const boost::system::error_code& ec,
-                             std::size_t length,
-                             boost::system::error_code* out_ec,
-                             std::size_t* out_length);
-  void check_deadline();
+  bool parse(uint8_t* buffer, size_t length, Message& message);
+  /* returns the message length or 0 if it doesn't fit in max_length */
+  size_t build(bool is_announce,
+               uint16_t msg_id_hash,
+               uint32_t addr,
+               const std::string& sdp,
+               uint8_t* buffer) const;
+  void update_stats(size_t packets, size_t bytes);
   bool send(bool is_announce,
             uint16_t msg_id_hash,
             uint32_t addr,
@@ -81,7 +113,17 @@ class SAP {
 #else
       ip::udp::endpoint(ip::make_address("0.0.0.0"), port)};
 #endif
-  steady_timer deadline_{io_service_};
+  /* receive buffers, allocated on first receive */
+  std::vector<uint8_t> rx_buffers_;
+  std::vector<iovec> rx_iovecs_;
+  std::vector<mmsghdr> rx_msgs_;
+  std::vector<uint8_t> inflate_buffer_;
+  bool compression_{false};
+
+  Stats stats_;
+  uint64_t gaps_num_{0};
+  uint64_t gaps_sum_us_{0};
+  std::chrono::steady_clock::time_point last_send_;
 };
 
 #endif
@@ -0,0 +1,198 @@
+//
+//  sdp_fetcher.cpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/algorithm/string.hpp>
+
+#include "error_code.hpp"
+#include "log.hpp"
+#include "rtsp_client.hpp"
+#include "utils.hpp"
+#include "sdp_fetcher.hpp"
+
+using namespace std::chrono;
+
+static bool is_ready(const std::shared_future<SdpFetcher::Result>& res) {
+  return res.wait_for(seconds(0)) == std::future_status::ready;
+}
+
+SdpFetcher::~SdpFetcher() {
+  std::list<std::shared_future<Result> > pending;
+  {
+    std::lock_guard lock(mutex_);
+    for (const auto& [url, entry] : cache_) {
+      if (entry.pending.valid()) {
+        pending.push_back(entry.pending);
+      }
+    }
+  }
+  /* fetches in progress access the cache, wait for them */
+  for (const auto& res : pending) {
+    res.wait();
+  }
+}
+
+std::shared_future<SdpFetcher::Result> SdpFetcher::fetch(
+    const std::string& url) {
+  std::lock_guard lock(mutex_);
+  if (cache_.size() >= cache_entries_max && cache_.count(url) == 0) {
+    /* drop the completed entries */
+    for (auto it = cache_.begin(); it != cache_.end();) {
+      if (!it->second.pending.valid() || is_ready(it->second.pending)) {
+        it = cache_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  auto& entry = cache_[url];
+  if (entry.pending.valid()) {
+    if (!is_ready(entry.pending)) {
+      BOOST_LOG_TRIVIAL(debug)
+          << "sdp_fetcher:: joining fetch in progress for URL " << url;
+      return entry.pending;
+    }
+    if (entry.pending.get().first &&
+        steady_clock::now() - entry.timestamp < seconds(error_holdoff)) {
+      BOOST_LOG_TRIVIAL(debug)
+          << "sdp_fetcher:: URL " << url << " failed recently";
+      return entry.pending;
+    }
+  }
+
+  entry.pending =
+      std::async(std::launch::async, &SdpFetcher::fetch_, this, url).share();
+  return entry.pending;
+}
+
+SdpFetcher::Result SdpFetcher::fetch_(const std::string& url) {
+  auto start = steady_clock::now();
+  Result res;
+  auto const [ok, protocol, host, port, path] = parse_url(url);
+  if (!ok) {
+    BOOST_LOG_TRIVIAL(error) << "sdp_fetcher:: cannot parse URL " << url;
+    res.first = DaemonErrc::invalid_url;
+  } else if (boost::iequals(protocol, "http")) {
+    res = http_get_(url, host, !atoi(port.c_str()) ? 80 : atoi(port.c_str()),
+                    path);
+  } else if (boost::iequals(protocol, "rtsp")) {
+    res = rtsp_describe_(url, host, port, path);
+  } else {
+    BOOST_LOG_TRIVIAL(error)
+        << "sdp_fetcher:: unsupported protocol in URL " << url;
+    res.first = DaemonErrc::invalid_url;
+  }
+
+  std::lock_guard lock(mutex_);
+  cache_[url].timestamp = steady_clock::now();
+  BOOST_LOG_TRIVIAL(debug)
+      << "sdp_fetcher:: URL " << url << " fetched in "
+      << duration_cast<milliseconds>(steady_clock::now() - start).count()
+      << " msecs";
+  return res;
+}
+
+SdpFetcher::Result SdpFetcher::http_get_(const std::string& url,
+                                         const std::string& host,
+                                         int port,
+                                         const std::string& path) {
+  httplib::Headers headers;
+  {
+    std::lock_guard lock(mutex_);
+    const auto& entry = cache_[url];
+    if (!entry.etag.empty()) {
+      headers.emplace("If-None-Match", entry.etag);
+    } else if (!entry.last_modified.empty()) {
+      headers.emplace("If-Modified-Since", entry.last_modified);
+    }
+  }
+
+  auto cli = get_client_(host, port);
+  auto res = cli->Get(path.c_str(), headers);
+  if (!res) {
+    BOOST_LOG_TRIVIAL(error)
+        << "sdp_fetcher:: cannot retrieve SDP from URL " << url;
+    return {DaemonErrc::cannot_retrieve_sdp, {}};
+  }
+  release_client_(host, port, std::move(cli));
+
+  std::lock_guard lock(mutex_);
+  auto& entry = cache_[url];
+  if (res->status == 304 && !entry.sdp.empty()) {
+    BOOST_LOG_TRIVIAL(debug)
+        << "sdp_fetcher:: SDP from URL " << url << " not modified";
+    return {std::error_code{}, entry.sdp};
+  }
+  if (res->status != 200) {
+    BOOST_LOG_TRIVIAL(error)
+        << "sdp_fetcher:: cannot retrieve SDP from URL " << url
+        << " server reply " << res->status;
+    return {DaemonErrc::cannot_retrieve_sdp, {}};
+  }
+  entry.sdp = std::move(res->body);
+  entry.etag = res->get_header_value("ETag");
+  entry.last_modified = res->get_header_value("Last-Modified");
+  return {std::error_code{}, entry.sdp};
+}
+
+SdpFetcher::Result SdpFetcher::rtsp_describe_(const std::string& url,
+                                              const std::string& host,
+                                              const std::string& port,
+                                              const std::string& path) {
+  /* RTSP has no validators, the DESCRIBE is always performed */
+  auto res = RtspClient::describe(path, host, port);
+  if (!res.first) {
+    BOOST_LOG_TRIVIAL(error)
+        << "sdp_fetcher:: cannot retrieve SDP from URL " << url;
+    return {DaemonErrc::cannot_retrieve_sdp, {}};
+  }
+  std::lock_guard lock(mutex_);
+  cache_[url].sdp = res.second.sdp;
+  return {std::error_code{}, std::move(res.second.sdp)};
+}
+
+std::unique_ptr<httplib::Client> SdpFetcher::get_client_(
+    const std::string& host,
+    int port) {
+  {
+    std::lock_guard lock(mutex_);
+    auto& clients = idle_clients_[host + ":" + std::to_string(port)];
+    if (!clients.empty()) {
+      auto cli = std::move(clients.front());
+      clients.pop_front();
+      return cli;
+    }
+  }
+  auto cli = std::make_unique<httplib::Client>(host.c_str(), port);
+  cli->set_keep_alive(true);
+  cli->set_connection_timeout(connection_timeout);
+  cli->set_read_timeout(client_timeout);
+  cli->set_write_timeout(client_timeout);
+  return cli;
+}
+
+void SdpFetcher::release_client_(const std::string& host,
+                                 int port,
+                                 std::unique_ptr<httplib::Client> cli) {
+  std::lock_guard lock(mutex_);
+  auto& clients = idle_clients_[host + ":" + std::to_string(port)];
+  if (clients.size() < idle_clients_max) {
+    clients.push_back(std::move(cli));
+  }
+}
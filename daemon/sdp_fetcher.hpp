@@ -0,0 +1,90 @@
+//
+//  sdp_fetcher.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _SDP_FETCHER_HPP_
+#define _SDP_FETCHER_HPP_
+
+#include <httplib.h>
+
+#include <chrono>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+
+/*
+ * Retrieves sink SDP files from HTTP and RTSP URLs.
+ * Fetches run asynchronously and concurrent requests for the same URL share
+ * the same fetch. The last SDP of each URL is cached together with its HTTP
+ * validators so that unchanged files are revalidated with a conditional GET,
+ * HTTP connections are kept alive and reused across fetches.
+ */
+class SdpFetcher {
+ public:
+  constexpr static uint16_t connection_timeout = 3;  // sec
+  constexpr static uint16_t client_timeout = 10;     // sec
+  /* a failed URL is not fetched again before this delay */
+  constexpr static uint16_t error_holdoff = 5;  // sec
+  constexpr static size_t idle_clients_max = 4;  // per server
+  constexpr static size_t cache_entries_max = 1024;
+
+  using Result = std::pair<std::error_code, std::string /* sdp */>;
+
+  SdpFetcher() = default;
+  SdpFetcher(const SdpFetcher&) = delete;
+  SdpFetcher& operator=(const SdpFetcher&) = delete;
+  ~SdpFetcher();
+
+  std::shared_future<Result> fetch(const std::string& url);
+
+ private:
+  struct CacheEntry {
+    std::string sdp;
+    std::string etag;
+    std::string last_modified;
+    std::chrono::steady_clock::time_point timestamp;
+    std::shared_future<Result> pending;
+  };
+
+  Result fetch_(const std::string& url);
+  Result http_get_(const std::string& url,
+                   const std::string& host,
+                   int port,
+                   const std::string& path);
+  Result rtsp_describe_(const std::string& url,
+                        const std::string& host,
+                        const std::string& port,
+                        const std::string& path);
+  std::unique_ptr<httplib::Client> get_client_(const std::string& host,
+                                               int port);
+  void release_client_(const std::string& host,
+                       int port,
+                       std::unique_ptr<httplib::Client> cli);
+
+  std::mutex mutex_;
+  std::unordered_map<std::string /* url */, CacheEntry> cache_;
+  std::unordered_map<std::string /* host:port */,
+                     std::list<std::unique_ptr<httplib::Client> > >
+      idle_clients_;
+};
+
+#endif
@@ -347,7 +347,7 @@ std::shared_ptr<SessionManager> SessionManager::create(
   return ptr;
 }
 
-std::error_code SessionManager::get_source(uint8_t id,
+std::error_code SessionManager::get_source(uint16_t id,
                                            StreamSource& source) const {
   std::shared_lock sources_lock(sources_mutex_);
   auto const it = sources_.find(id);
@@ -361,7 +361,8 @@ std::error_code SessionManager::get_source(uint8_t id,
   return std::error_code{};
 }
 
-std::error_code SessionManager::get_sink(uint8_t id, StreamSink& sink) const {
+std::error_code SessionManager::get_sink(uint16_t id,
+                                         StreamSink& sink) const {
   std::shared_lock sinks_lock(sinks_mutex_);
   auto const it = sinks_.find(id);
   if (it == sinks_.end()) {
@@ -374,25 +375,36 @@ std::error_code SessionManager::get_sink(uint8_t id, StreamSink& sink) const {
   return std::error_code{};
 }
 
-std::list<StreamSink> SessionManager::get_sinks() const {
-  std::shared_lock sinks_lock(sinks_mutex_);
-  std::list<StreamSink> sinks_list;
+SessionManager::SinksSnapshot SessionManager::get_sinks() const {
+  return std::atomic_load(&sinks_snapshot_);
+}
+
+SessionManager::SourcesSnapshot SessionManager::get_sources() const {
+  return std::atomic_load(&sources_snapshot_);
+}
+
+void SessionManager::publish_sinks_() {
+  // sinks_mutex_ must be held in exclusive mode by the caller
+  auto sinks_list = std::make_shared<std::list<StreamSink> >();
   for (auto const& [id, info] : sinks_) {
-    sinks_list.emplace_back(get_sink_(id, info));
+    sinks_list->emplace_back(get_sink_(id, info));
   }
-  return sinks_list;
+  std::atomic_store(&sinks_snapshot_, SinksSnapshot(std::move(sinks_list)));
+  sinks_version_++;
 }
 
-std::list<StreamSource> SessionManager::get_sources() const {
-  std::shared_lock sources_lock(sources_mutex_);
-  std::list<StreamSource> sources_list;
+void SessionManager::publish_sources_() {
+  // sources_mutex_ must be held in exclusive mode by the caller
+  auto sources_list = std::make_shared<std::list<StreamSource> >();
   for (auto const& [id, info] : sources_) {
-    sources_list.emplace_back(get_source_(id, info));
+    sources_list->emplace_back(get_source_(id, info));
   }
-  return sources_list;
+  std::atomic_store(&sources_snapshot_,
+                    SourcesSnapshot(std::move(sources_list)));
+  sources_version_++;
 }
 
-StreamSource SessionManager::get_source_(uint8_t id,
+StreamSource SessionManager::get_source_(uint16_t id,
                                          const StreamInfo& info) const {
   return {id,
           info.enabled,
@@ -409,7 +421,8 @@ StreamSource SessionManager::get_source_(uint8_t id,
            info.stream[0].m_aui32Routing + info.stream[0].m_byNbOfChannels}};
 }
 
-StreamSink SessionManager::get_sink_(uint8_t id, const StreamInfo& info) const {
+StreamSink SessionManager::get_sink_(uint16_t id,
+                                     const StreamInfo& info) const {
   return {id,
           info.stream[0].m_cName,
           info.io,
@@ -451,6 +464,8 @@ bool SessionManager::load_status() {
   for (auto const& sink : sinks_list) {
     add_sink(sink);
   }
+  // check the sinks against the remote sources restored from cache
+  notify_sinks_update();
 
   return true;
 }
@@ -466,52 +481,105 @@ bool SessionManager::save_status() const {
                              << config_->get_status_file();
     return false;
   }
-  jsonstream << streams_to_json(get_sources(), get_sinks());
+  jsonstream << streams_to_json(*get_sources(), *get_sinks());
   BOOST_LOG_TRIVIAL(info) << "session_manager:: status file saved";
 
   return true;
 }
 
-uint8_t SessionManager::get_source_id(const std::string& name) const {
+uint16_t SessionManager::get_source_id(const std::string& name) const {
   const auto it = source_names_.find(name);
   return it != source_names_.end() ? it->second : (stream_id_max + 1);
 }
 
-void SessionManager::add_ptp_status_observer(const PtpStatusObserver& cb) {
-  ptp_status_observers_.push_back(cb);
+void SessionManager::add_ptp_status_observer(const PtpStatusObserver& cb,
+                                             const std::string& observer) {
+  ptp_status_observers_.emplace_back(cb,
+                                     observers_queue_.get_strand(observer));
+}
+
+void SessionManager::add_sink_status_observer(
+    const SinkStatusObserver& cb,
+    const SinkStatusActive& is_active,
+    const std::string& observer) {
+  sink_status_observers_.push_back(
+      {cb, is_active, observers_queue_.get_strand(observer)});
+}
+
+bool SessionManager::is_sink_status_active() const {
+  for (const auto& entry : sink_status_observers_) {
+    if (entry.is_active()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SessionManager::start_sink_status_poll() {
+  {
+    std::lock_guard worker_lock(worker_mutex_);
+    if (sink_status_scheduled_) {
+      return;
+    }
+    schedule_timer(WorkerTimer::sink_status_poll, steady_clock::now());
+  }
+  worker_cv_.notify_one();
 }
 
+/* observer event keys, the sources and the sinks use their own range */
+static ObserverQueue::Key source_key(uint16_t id) {
+  return id;
+}
+
+static ObserverQueue::Key sink_key(uint16_t id) {
+  return 0x10000 + id;
+}
+
+constexpr static ObserverQueue::Key ptp_status_key = 0x20000;
+
 void SessionManager::add_source_observer(SourceObserverType type,
-                                         const SourceObserver& cb) {
+                                         const SourceObserver& cb,
+                                         const std::string& observer) {
+  auto strand = observers_queue_.get_strand(observer);
   switch (type) {
     case SourceObserverType::add_source:
-      add_source_observers_.push_back(cb);
+      add_source_observers_.emplace_back(cb, strand);
       break;
     case SourceObserverType::remove_source:
-      remove_source_observers_.push_back(cb);
+      remove_source_observers_.emplace_back(cb, strand);
       break;
     case SourceObserverType::update_source:
-      update_source_observers_.push_back(cb);
+      update_source_observers_.emplace_back(cb, strand);
       break;
   }
 }
 
 void SessionManager::add_sink_observer(SinkObserverType type,
-                                       const SinkObserver& cb) {
+                                       const SinkObserver& cb,
+                                       const std::string& observer) {
+  auto strand = observers_queue_.get_strand(observer);
   switch (type) {
     case SinkObserverType::add_sink:
-      add_sink_observers_.push_back(cb);
+      add_sink_observers_.emplace_back(cb, strand);
       break;
     case SinkObserverType::remove_sink:
-      remove_sink_observers_.push_back(cb);
+      remove_sink_observers_.emplace_back(cb, strand);
       break;
   }
 }
 
 void SessionManager::on_add_source(const StreamSource& source,
                                    const StreamInfo& info) {
-  for (const auto& cb : add_source_observers_) {
-    cb(source.id, source.name, get_source_sdp_(source.id, info));
+  if (!add_source_observers_.empty()) {
+    auto sdp = get_source_sdp_(source.id, info);
+    for (const auto& [cb, strand] : add_source_observers_) {
+      observers_queue_.post(
+          strand,
+          [&cb = cb, id = source.id, name = source.name, sdp]() {
+            cb(id, name, sdp);
+          },
+          source_key(source.id));
+    }
   }
   if (IN_MULTICAST(info.stream[0].m_ui32DestIP)) {
     igmp_[0].join(config_->get_ip_addr_str(),
@@ -526,8 +594,13 @@ void SessionManager::on_add_source(const StreamSource& source,
 }
 
 void SessionManager::on_remove_source(const StreamInfo& info) {
-  for (const auto& cb : remove_source_observers_) {
-    cb((uint8_t)info.stream[0].m_uiId, info.stream[0].m_cName, {});
+  for (const auto& [cb, strand] : remove_source_observers_) {
+    observers_queue_.post(strand,
+                          [&cb = cb, id = (uint16_t)info.stream[0].m_uiId,
+                           name = std::string(info.stream[0].m_cName)]() {
+                            cb(id, name, {});
+                          },
+                          source_key(info.stream[0].m_uiId));
   }
   if (IN_MULTICAST(info.stream[0].m_ui32DestIP)) {
     igmp_[0].leave(config_->get_ip_addr_str(),
@@ -665,6 +738,7 @@ std::error_code SessionManager::add_source(const StreamSource& source) {
       if (it != sources_.end()) {
         /* update operation failed */
         sources_.erase(source.id);
+        publish_sources_();
       }
       return ret;
     }
@@ -703,6 +777,7 @@ std::error_code SessionManager::add_source(const StreamSource& source) {
           if (it != sources_.end()) {
             /* update operation failed */
             sources_.erase(source.id);
+            publish_sources_();
           }
           return ret;
         }
@@ -714,9 +789,14 @@ std::error_code SessionManager::add_source(const StreamSource& source) {
 
   // update source map
   sources_[source.id] = info;
+  publish_sources_();
   BOOST_LOG_TRIVIAL(info) << "session_manager:: added source "
                           << std::to_string(source.id) << " " << info.handle[0]
                           << "," << info.handle[1];
+  if (info.enabled) {
+    // make sure the SAP announcements are running
+    schedule_sap_announcement();
+  }
   return ret;
 }
 
@@ -859,20 +939,23 @@ std::error_code SessionManager::remove_source(uint32_t id) {
   }
   if (!ret) {
     sources_.erase(id);
+    publish_sources_();
   }
 
   return ret;
 }
 
-uint8_t SessionManager::get_sink_id(const std::string& name) const {
+uint16_t SessionManager::get_sink_id(const std::string& name) const {
   const auto it = sink_names_.find(name);
   return it != sink_names_.end() ? it->second : (stream_id_max + 1);
 }
 
 void SessionManager::on_add_sink(const StreamSink& sink,
                                  const StreamInfo& info) {
-  for (const auto& cb : add_sink_observers_) {
-    cb(sink.id, sink.name);
+  for (const auto& [cb, strand] : add_sink_observers_) {
+    observers_queue_.post(
+        strand, [&cb = cb, id = sink.id, name = sink.name]() { cb(id, name); },
+        sink_key(sink.id));
   }
   if (IN_MULTICAST(info.stream[0].m_ui32DestIP)) {
     igmp_[0].join(config_->get_ip_addr_str(),
@@ -887,8 +970,13 @@ void SessionManager::on_add_sink(const StreamSink& sink,
 }
 
 void SessionManager::on_remove_sink(const StreamInfo& info) {
-  for (const auto& cb : remove_sink_observers_) {
-    cb((uint8_t)info.stream[0].m_uiId, info.stream[0].m_cName);
+  for (const auto& [cb, strand] : remove_sink_observers_) {
+    observers_queue_.post(strand,
+                          [&cb = cb, id = (uint16_t)info.stream[0].m_uiId,
+                           name = std::string(info.stream[0].m_cName)]() {
+                            cb(id, name);
+                          },
+                          sink_key(info.stream[0].m_uiId));
   }
   if (IN_MULTICAST(info.stream[0].m_ui32DestIP)) {
     igmp_[0].leave(config_->get_ip_addr_str(),
@@ -902,6 +990,65 @@ void SessionManager::on_remove_sink(const StreamInfo& info) {
   sink_names_.erase(info.stream[0].m_cName);
 }
 
+uint64_t SessionManager::next_sink_seq(uint16_t id) {
+  std::lock_guard lock(sink_fetches_mutex_);
+  return ++sink_seqs_[id];
+}
+
+void SessionManager::add_sink_when_fetched(
+    const StreamSink& sink,
+    const std::shared_future<SdpFetcher::Result>& fetch,
+    uint64_t seq) {
+  BOOST_LOG_TRIVIAL(info) << "session_manager:: sink "
+                          << std::to_string(sink.id) << " SDP fetch from URL "
+                          << sink.source << " in progress";
+  std::lock_guard lock(sink_fetches_mutex_);
+  sink_fetches_.remove_if([](const std::future<void>& res) {
+    return res.wait_for(seconds(0)) == std::future_status::ready;
+  });
+  sink_fetches_.emplace_back(std::async(
+      std::launch::async, [this, sink, fetch, seq]() {
+        auto [err, sdp] = fetch.get();
+        {
+          std::lock_guard lock(sink_fetches_mutex_);
+          if (!running_ || sink_seqs_[sink.id] != seq) {
+            BOOST_LOG_TRIVIAL(debug)
+                << "session_manager:: sink " << std::to_string(sink.id)
+                << " SDP fetch superseded";
+            return;
+          }
+        }
+        if (err) {
+          BOOST_LOG_TRIVIAL(error)
+              << "session_manager:: cannot add sink "
+              << std::to_string(sink.id) << " : " << err.message();
+          return;
+        }
+        StreamSink fetched(sink);
+        fetched.use_sdp = true;
+        fetched.sdp = sdp;
+        auto ret = add_sink(fetched);
+        if (ret) {
+          BOOST_LOG_TRIVIAL(error)
+              << "session_manager:: cannot add sink "
+              << std::to_string(sink.id) << " : " << ret.message();
+        } else {
+          save_status();
+        }
+      }));
+}
+
+void SessionManager::wait_sink_fetches() {
+  std::list<std::future<void> > fetches;
+  {
+    std::lock_guard lock(sink_fetches_mutex_);
+    fetches.swap(sink_fetches_);
+  }
+  for (auto& res : fetches) {
+    res.wait();
+  }
+}
+
 std::error_code SessionManager::add_sink(const StreamSink& sink) {
   if (sink.id > stream_id_max) {
     BOOST_LOG_TRIVIAL(error) << "session_manager:: sink id "
@@ -926,46 +1073,21 @@ std::error_code SessionManager::add_sink(const StreamSink& sink) {
   info.ignore_refclk_gmid = sink.ignore_refclk_gmid;
   info.io = sink.io;
 
+  auto seq = next_sink_seq(sink.id);
   if (!sink.use_sdp) {
-    auto const [ok, protocol, host, port, path] = parse_url(sink.source);
-    if (!ok) {
-      BOOST_LOG_TRIVIAL(error)
-          << "session_manager:: cannot parse URL " << sink.source;
-      return DaemonErrc::invalid_url;
+    /* the fetch runs in the SDP fetcher, concurrent requests for the same URL
+     * share it and unchanged files are served from the fetcher cache.
+     * A slow fetch does not hold the caller, the sink is added when the
+     * fetch completes */
+    auto fetch = sdp_fetcher_.fetch(sink.source);
+    if (fetch.wait_for(milliseconds(sink_fetch_wait_ms)) !=
+        std::future_status::ready) {
+      add_sink_when_fetched(sink, fetch, seq);
+      return DaemonErrc::sink_sdp_pending;
     }
-
-    std::string sdp;
-    if (boost::iequals(protocol, "http")) {
-      httplib::Client cli(host.c_str(),
-                          !atoi(port.c_str()) ? 80 : atoi(port.c_str()));
-      cli.set_connection_timeout(10);
-      cli.set_read_timeout(10);
-      cli.set_write_timeout(10);
-      auto res = cli.Get(path.c_str());
-      if (!res) {
-        BOOST_LOG_TRIVIAL(error)
-            << "session_manager:: annot retrieve SDP from URL " << sink.source;
-        return DaemonErrc::cannot_retrieve_sdp;
-      }
-      if (res->status != 200) {
-        BOOST_LOG_TRIVIAL(error)
-            << "session_manager:: cannot retrieve SDP from URL " << sink.source
-            << " server reply " << res->status;
-        return DaemonErrc::cannot_retrieve_sdp;
-      }
-      sdp = std::move(res->body);
-    } else if (boost::iequals(protocol, "rtsp")) {
-      auto res = RtspClient::describe(path, host, port);
-      if (!res.first) {
-        BOOST_LOG_TRIVIAL(error)
-            << "session_manager:: cannot retrieve SDP from URL " << sink.source;
-        return DaemonErrc::cannot_retrieve_sdp;
-      }
-      sdp = std::move(res.second.sdp);
-    } else {
-      BOOST_LOG_TRIVIAL(error)
-          << "session_manager:: unsupported protocol in URL " << sink.source;
-      return DaemonErrc::invalid_url;
+    auto [err, sdp] = fetch.get();
+    if (err) {
+      return err;
     }
 
     BOOST_LOG_TRIVIAL(info)
@@ -1019,34 +1141,35 @@ std::error_code SessionManager::add_sink(const StreamSink& sink) {
     }
   }
 
-  std::unique_lock sinks_lock(sinks_mutex_);
-  auto const it = sinks_.find(sink.id);
-  if (it != sinks_.end()) {
+  /* sink updates are serialized, the driver is programmed without holding
+   * the sinks lock and the result is published afterwards */
+  std::lock_guard update_lock(sinks_update_mutex_);
+  std::optional<StreamInfo> previous;
+  {
+    std::shared_lock sinks_lock(sinks_mutex_);
+    auto const it = sinks_.find(sink.id);
+    if (it != sinks_.end()) {
+      previous = (*it).second;
+    } else if (sink_names_.find(sink.name) != sink_names_.end()) {
+      BOOST_LOG_TRIVIAL(error)
+          << "session_manager:: sink name " << sink.name << " is in use";
+      return DaemonErrc::stream_name_in_use;
+    }
+  }
+
+  if (previous) {
     BOOST_LOG_TRIVIAL(info)
         << "session_manager:: sink id " << std::to_string(sink.id)
         << " is in use, updating";
     // remove previous stream
-    (void)driver_->remove_rtp_stream((*it).second.handle[0]);
-    if ((*it).second.st20227_enabled) {
-      (void)driver_->remove_rtp_stream((*it).second.handle[1]);
+    (void)driver_->remove_rtp_stream(previous->handle[0]);
+    if (previous->st20227_enabled) {
+      (void)driver_->remove_rtp_stream(previous->handle[1]);
     }
-    on_remove_sink((*it).second);
-  } else if (sink_names_.find(sink.name) != sink_names_.end()) {
-    BOOST_LOG_TRIVIAL(error)
-        << "session_manager:: sink name " << sink.name << " is in use";
-    return DaemonErrc::stream_name_in_use;
   }
 
   auto ret = driver_->add_rtp_stream(info.stream[0], info.handle[0]);
-  if (ret) {
-    if (it != sinks_.end()) {
-      /* update operation failed */
-      sinks_.erase(sink.id);
-    }
-    return ret;
-  }
-
-  if (config_->get_interface_name(1).length() > 0) {
+  if (!ret && config_->get_interface_name(1).length() > 0) {
     auto [ip_addr, ip_str] = get_interface_ip(config_->get_interface_name(1));
     if (!ip_str.empty()) {
       if (!info.st20227_enabled) {
@@ -1067,22 +1190,32 @@ std::error_code SessionManager::add_sink(const StreamSink& sink) {
       }
       ret = driver_->add_rtp_stream(info.stream[1], info.handle[1]);
       if (ret) {
-        (void)driver_->remove_rtp_stream((*it).second.handle[0]);
-        if (it != sinks_.end()) {
-          /* update operation failed */
-          sinks_.erase(sink.id);
-        }
-        return ret;
+        (void)driver_->remove_rtp_stream(info.handle[0]);
+      } else {
+        info.st20227_enabled = true;
       }
-      info.st20227_enabled = true;
     }
   } else {
     info.st20227_enabled = false;
   }
+
+  std::unique_lock sinks_lock(sinks_mutex_);
+  if (previous) {
+    on_remove_sink(*previous);
+  }
+  if (ret) {
+    if (previous) {
+      /* update operation failed */
+      sinks_.erase(sink.id);
+      publish_sinks_();
+    }
+    return ret;
+  }
   on_add_sink(sink, info);
 
   // update sinks map
   sinks_[sink.id] = info;
+  publish_sinks_();
   BOOST_LOG_TRIVIAL(info) << "session_manager:: added sink "
                           << std::to_string(sink.id) << " " << info.handle[0]
                           << "," << info.handle[1];
@@ -1095,28 +1228,85 @@ std::error_code SessionManager::remove_sink(uint32_t id) {
                              << std::to_string(id) << " is not valid";
     return DaemonErrc::stream_id_in_use;
   }
+  // a pending SDP fetch of the sink is superseded
+  next_sink_seq(id);
 
-  std::unique_lock sinks_lock(sinks_mutex_);
-  auto const it = sinks_.find(id);
-  if (it == sinks_.end()) {
-    BOOST_LOG_TRIVIAL(error)
-        << "session_manager:: sink " << std::to_string(id) << " not in use";
-    return DaemonErrc::stream_id_not_in_use;
+  std::lock_guard update_lock(sinks_update_mutex_);
+  StreamInfo info;
+  {
+    std::shared_lock sinks_lock(sinks_mutex_);
+    auto const it = sinks_.find(id);
+    if (it == sinks_.end()) {
+      BOOST_LOG_TRIVIAL(error)
+          << "session_manager:: sink " << std::to_string(id) << " not in use";
+      return DaemonErrc::stream_id_not_in_use;
+    }
+    info = (*it).second;
   }
 
-  const auto& info = (*it).second;
   auto ret = driver_->remove_rtp_stream(info.handle[0]);
   if (!ret && info.st20227_enabled) {
     ret = driver_->remove_rtp_stream(info.handle[1]);
   }
   if (!ret) {
+    std::unique_lock sinks_lock(sinks_mutex_);
     on_remove_sink(info);
     sinks_.erase(id);
+    publish_sinks_();
   }
 
   return ret;
 }
 
+static void set_sink_status(const TRTP_stream_status& status,
+                            SinkStreamStatus& sink_status) {
+  sink_status.is_rtp_seq_id_error = status.u.flags & 0x01;
+  sink_status.is_rtp_ssrc_error = status.u.flags & 0x02;
+  sink_status.is_rtp_payload_type_error = status.u.flags & 0x04;
+  sink_status.is_rtp_sac_error = status.u.flags & 0x08;
+  sink_status.is_receiving_rtp_packet = status.u.flags & 0x10;
+  sink_status.is_muted = status.u.flags & 0x20;
+  sink_status.is_some_muted = status.u.flags & 0x40;
+  sink_status.is_all_muted = status.u.flags & 0x80;
+  sink_status.min_time = status.sink_min_time;
+}
+
+void SessionManager::poll_sinks_status() {
+  std::list<std::pair<uint16_t, SinkStreamStatus> > changed;
+  {
+    std::shared_lock sinks_lock(sinks_mutex_);
+    for (auto it = sinks_status_flags_.begin();
+         it != sinks_status_flags_.end();) {
+      // forget the removed sinks
+      it = sinks_.find(it->first) != sinks_.end()
+               ? std::next(it)
+               : sinks_status_flags_.erase(it);
+    }
+    for (const auto& [id, info] : sinks_) {
+      TRTP_stream_status status;
+      if (driver_->get_rtp_stream_status(info.handle[0], status)) {
+        continue;
+      }
+      auto [it, inserted] = sinks_status_flags_.try_emplace(id, 0);
+      if (inserted || it->second != status.u.flags) {
+        it->second = status.u.flags;
+        SinkStreamStatus sink_status;
+        set_sink_status(status, sink_status);
+        changed.emplace_back(id, sink_status);
+      }
+    }
+  }
+  for (const auto& [id, sink_status] : changed) {
+    for (const auto& entry : sink_status_observers_) {
+      observers_queue_.post(entry.strand,
+                            [&cb = entry.cb, id = id, sink_status]() {
+                              (void)cb(id, sink_status);
+                            },
+                            sink_key(id), ObserverQueue::Type::state);
+    }
+  }
+}
+
 std::error_code SessionManager::get_sink_status(
     uint32_t id,
     SinkStreamStatus& sink_status) const {
@@ -1138,15 +1328,7 @@ std::error_code SessionManager::get_sink_status(
   const auto& info = (*it).second;
   auto ret = driver_->get_rtp_stream_status(info.handle[0], status);
   if (!ret) {
-    sink_status.is_rtp_seq_id_error = status.u.flags & 0x01;
-    sink_status.is_rtp_ssrc_error = status.u.flags & 0x02;
-    sink_status.is_rtp_payload_type_error = status.u.flags & 0x04;
-    sink_status.is_rtp_sac_error = status.u.flags & 0x08;
-    sink_status.is_receiving_rtp_packet = status.u.flags & 0x10;
-    sink_status.is_muted = status.u.flags & 0x20;
-    sink_status.is_some_muted = status.u.flags & 0x40;
-    sink_status.is_all_muted = status.u.flags & 0x80;
-    sink_status.min_time = status.sink_min_time;
+    set_sink_status(status, sink_status);
   }
 
   return ret;
@@ -1173,6 +1355,7 @@ std::error_code SessionManager::set_ptp_config(const PTPConfig& config) {
   if (!ret) {
     std::unique_lock ptp_lock(ptp_mutex_);
     ptp_config_ = config;
+    ptp_config_version_++;
   }
   return ret;
 }
@@ -1187,10 +1370,17 @@ void SessionManager::get_ptp_status(PTPStatus& status) const {
   status = ptp_status_;
 }
 
-size_t SessionManager::process_sap() {
+size_t SessionManager::process_sap(std::vector<SAP::Message>& messages) {
+  // new and changed sources are announced first
+  std::vector<SAP::Message> urgent_messages;
   size_t sdp_len_sum = 0;
   // set to contain sources currently announced
   std::set<uint32_t> active_sources;
+  // set to contain the SAP message hashes in use
+  std::set<uint16_t> msg_hashes;
+  for (auto const& [msg_id_hash, info] : announced_sources_) {
+    msg_hashes.insert(static_cast<uint16_t>(msg_id_hash));
+  }
 
   // announce all active sources
   std::shared_lock sources_lock(sources_mutex_);
@@ -1201,8 +1391,23 @@ size_t SessionManager::process_sap() {
       // compute source 16bit crc
       uint16_t msg_crc =
           crc16(reinterpret_cast<const uint8_t*>(sdp.c_str()), sdp.length());
-      // compute source hash
-      uint32_t msg_id_hash = (static_cast<uint32_t>(id) << 16) + msg_crc;
+      // compute source message hash
+      uint16_t msg_hash;
+      auto it = sources_msg_hash_.find(id);
+      if (it != sources_msg_hash_.end() && it->second.first == msg_crc) {
+        // SDP not changed, keep current hash
+        msg_hash = it->second.second;
+      } else {
+        // SDP changed, use the crc unless already used by another session
+        msg_hash = msg_crc;
+        while (msg_hash == 0 || msg_hashes.count(msg_hash)) {
+          msg_hash++;
+        }
+        sources_msg_hash_[id] = {msg_crc, msg_hash};
+      }
+      msg_hashes.insert(msg_hash);
+      uint32_t msg_id_hash = (static_cast<uint32_t>(id) << 16) + msg_hash;
+      bool is_new = announced_sources_.count(msg_id_hash) == 0;
       // add/update this source in the announced sources
       announced_sources_[msg_id_hash] = {info.stream[0].m_ui32RTCPSrcIP,
                                          info.session_id, info.session_version};
@@ -1210,10 +1415,12 @@ size_t SessionManager::process_sap() {
       active_sources.insert(msg_id_hash);
       // remove this source from deleted sources (if present)
       deleted_sources_count_.erase(msg_id_hash);
-      // send announcement for this source
-      sap_.announcement(msg_crc, info.stream[0].m_ui32RTCPSrcIP, sdp);
       // update amount of byte sent
       sdp_len_sum += sdp.length();
+      // queue announcement for this source
+      (is_new ? urgent_messages : messages)
+          .push_back({true, msg_hash, htonl(info.stream[0].m_ui32RTCPSrcIP),
+                      std::move(sdp)});
     }
   }
 
@@ -1227,12 +1434,12 @@ size_t SessionManager::process_sap() {
       // retrieve deleted source SDP
       std::string sdp = get_removed_source_sdp_(msg_id_hash >> 16, src_addr,
                                                 session_id, session_version);
-      // send deletion for this source
-      sap_.deletion(static_cast<uint16_t>(msg_id_hash), src_addr, sdp);
       // update amount of byte sent
       sdp_len_sum += sdp.length();
-      // increase count
-      deleted_sources_count_[msg_id_hash]++;
+      // queue deletion for this source, the first one is sent immediately
+      (deleted_sources_count_[msg_id_hash]++ ? messages : urgent_messages)
+          .push_back({false, static_cast<uint16_t>(msg_id_hash),
+                      htonl(src_addr), std::move(sdp)});
     }
   }
 
@@ -1249,9 +1456,143 @@ size_t SessionManager::process_sap() {
     return false;
   });
 
+  // forget the message hash of the sources no longer announced
+  for (auto it = sources_msg_hash_.begin(); it != sources_msg_hash_.end();) {
+    uint32_t msg_id_hash =
+        (static_cast<uint32_t>(it->first) << 16) + it->second.second;
+    if (active_sources.find(msg_id_hash) == active_sources.end()) {
+      it = sources_msg_hash_.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  messages.insert(messages.begin(),
+                  std::make_move_iterator(urgent_messages.begin()),
+                  std::make_move_iterator(urgent_messages.end()));
   return sdp_len_sum;
 }
 
+int SessionManager::schedule_sap_messages(std::vector<SAP::Message>& messages,
+                                          size_t sdp_len_sum,
+                                          int sap_interval) {
+  // log the statistics of the previous announcements
+  auto stats = sap_.get_stats(true);
+  if (stats.packets_sent > 0) {
+    BOOST_LOG_TRIVIAL(info)
+        << "session_manager:: SAP sent " << stats.packets_sent
+        << " packets, " << stats.bytes_sent << " bytes, packet gap min "
+        << stats.min_gap_us << " avg " << stats.avg_gap_us << " max "
+        << stats.max_gap_us << " usecs";
+  }
+  if (!sap_queue_.empty()) {
+    BOOST_LOG_TRIVIAL(warning)
+        << "session_manager:: SAP " << sap_queue_.size()
+        << " messages of the previous round not sent";
+  }
+
+  // messages not sent yet are replaced by the new ones
+  sap_queue_.clear();
+  // the config never holds a zero limit, the guard keeps the math safe
+  uint32_t bandwidth_limit = std::max(config_->get_sap_bandwidth_limit(),
+                                      Config::sap_bandwidth_limit_min);
+  // bytes that can be sent in a time slice to stay in the bandwidth budget
+  sap_slice_budget_ = std::max<size_t>(
+      size_t(bandwidth_limit) * sap_slice_ms / 8000, 1);
+  bool overrun = false;
+  if (!messages.empty()) {
+    // the round takes longer than the interval if the budget is too small
+    size_t bytes_sum = sdp_len_sum + messages.size() * SAP::sap_header_len;
+    int round_secs = (bytes_sum * 8 + bandwidth_limit - 1) / bandwidth_limit;
+    if (round_secs > sap_interval) {
+      BOOST_LOG_TRIVIAL(warning)
+          << "session_manager:: SAP " << bytes_sum << " bytes exceed the "
+          << bandwidth_limit << " bits per sec budget, round extended from "
+          << sap_interval << " to " << round_secs << " secs";
+      sap_interval = round_secs;
+      overrun = true;
+    }
+  }
+
+  {
+    std::lock_guard stats_lock(sap_stats_mutex_);
+    sap_stats_.interval = sap_interval;
+    sap_stats_.bandwidth_limit = bandwidth_limit;
+    sap_stats_.slice_budget = sap_slice_budget_;
+    sap_stats_.packets_sent += stats.packets_sent;
+    sap_stats_.bytes_sent += stats.bytes_sent;
+    if (stats.packets_sent > 0) {
+      sap_stats_.last_round = stats;
+    }
+    if (!messages.empty()) {
+      sap_stats_.rounds++;
+    }
+    if (overrun) {
+      sap_stats_.overruns++;
+    }
+  }
+
+  if (messages.empty()) {
+    return sap_interval;
+  }
+  // spread the messages evenly across the interval
+  auto now = steady_clock::now();
+  auto gap = duration_cast<microseconds>(seconds(sap_interval)) /
+             messages.size();
+  for (size_t i = 0; i < messages.size(); i++) {
+    sap_queue_.emplace_back(now + gap * i, std::move(messages[i]));
+  }
+
+  std::lock_guard worker_lock(worker_mutex_);
+  schedule_timer(WorkerTimer::sap_send, now);
+  return sap_interval;
+}
+
+void SessionManager::send_sap_messages() {
+  sap_.set_compression(config_->get_sap_compression());
+  auto now = steady_clock::now();
+  if (now >= sap_slice_end_) {
+    // refill the credit of the time slices elapsed, after an idle period
+    // up to a max size message can be sent at once
+    auto slices = 1 + (now - sap_slice_end_) / milliseconds(sap_slice_ms);
+    int64_t budget = sap_slice_budget_;
+    sap_credit_ = std::min<int64_t>(sap_credit_ + slices * budget,
+                                    std::max<int64_t>(budget, SAP::max_length));
+    sap_slice_end_ = now + milliseconds(sap_slice_ms);
+  }
+  // send the messages due while there is credit, several of them are
+  // sent together
+  std::vector<SAP::Message> messages;
+  while (!sap_queue_.empty() && sap_queue_.front().first <= now &&
+         sap_credit_ > 0) {
+    auto& message = sap_queue_.front().second;
+    sap_credit_ -= message.sdp.length() + SAP::sap_header_len;
+    messages.push_back(std::move(message));
+    sap_queue_.pop_front();
+  }
+  if (!messages.empty()) {
+    sap_.send(messages);
+  }
+
+  if (!sap_queue_.empty()) {
+    auto next = sap_queue_.front().first;
+    if (next <= now) {
+      // budget exhausted, wait for the time slice that refills the credit
+      int64_t budget = sap_slice_budget_;
+      auto slices = sap_credit_ < 0 ? -sap_credit_ / budget : 0;
+      next = sap_slice_end_ + milliseconds(sap_slice_ms) * slices;
+    }
+    std::lock_guard worker_lock(worker_mutex_);
+    schedule_timer(WorkerTimer::sap_send, next);
+  }
+}
+
+SAPStats SessionManager::get_sap_stats() const {
+  std::lock_guard stats_lock(sap_stats_mutex_);
+  return sap_stats_;
+}
+
+using namespace std::chrono;
 std::list<StreamSink> SessionManager::get_updated_sinks(
     const std::list<RemoteSource>& sources_list) {
   std::list<StreamSink> sinks_list;
@@ -1261,16 +1602,16 @@ std::list<StreamSink> SessionManager::get_updated_sinks(
     StreamSink sink{get_sink_(id, info)};
     for (auto& source : sources_list) {
       // if no remote source origin specified, skip
-      if (source.origin.session_id == "")
+      const auto& origin = source.sdp->origin;
+      if (origin.session_id == "")
         continue;
 
       // search for the largest corresponding remote source version
-      if (sinks_[sink.id].origin == source.origin && sink.sdp != source.sdp &&
-          sinks_[sink.id].origin.session_version <
-              source.origin.session_version &&
-          newVersion < source.origin.session_version) {
-        newVersion = source.origin.session_version;
-        sink.sdp = source.sdp;
+      if (info.origin == origin && sink.sdp != source.sdp->text &&
+          info.origin.session_version < origin.session_version &&
+          newVersion < origin.session_version) {
+        newVersion = origin.session_version;
+        sink.sdp = source.sdp->text;
       }
     }
 
@@ -1284,31 +1625,86 @@ std::list<StreamSink> SessionManager::get_updated_sinks(
   return sinks_list;
 }
 
-void SessionManager::update_sinks() {
+void SessionManager::update_sinks(
+    steady_clock::time_point change_timepoint) {
   if (config_->get_auto_sinks_update()) {
-    uint32_t last_update = browser_->get_last_update_ts();
-    // check remote sources only if an update arrived
-    if (last_update && last_sink_update_ != last_update) {
-      BOOST_LOG_TRIVIAL(debug) << "Updating sinks ...";
-      std::list<RemoteSource> remote_sources = browser_->get_remote_sources();
-      auto sinks_list = get_updated_sinks(remote_sources);
-      for (auto& sink : sinks_list) {
-        // Re-add sink with new SDP, since the sink.id is the same there will be
-        // an update
-        add_sink(sink);
-      }
-      last_sink_update_ = last_update;
+    BOOST_LOG_TRIVIAL(debug) << "Updating sinks ...";
+    auto remote_sources = browser_->get_remote_sources();
+    auto sinks_list = get_updated_sinks(*remote_sources);
+    for (auto& sink : sinks_list) {
+      // Re-add sink with new SDP, since the sink.id is the same there will be
+      // an update
+      add_sink(sink);
+      BOOST_LOG_TRIVIAL(info)
+          << "session_manager:: sink " << std::to_string(sink.id)
+          << " updated in "
+          << duration_cast<microseconds>(steady_clock::now() - change_timepoint)
+                 .count()
+          << " usecs from remote source change";
     }
   }
 }
 
+void SessionManager::notify_sinks_update() {
+  {
+    std::lock_guard worker_lock(worker_mutex_);
+    if (!sinks_update_pending_) {
+      sinks_update_pending_ = true;
+      sinks_update_timepoint_ = steady_clock::now();
+    }
+  }
+  worker_cv_.notify_one();
+}
+
+void SessionManager::schedule_timer(WorkerTimer timer,
+                                    steady_clock::time_point timepoint) {
+  // worker_mutex_ must be held by the caller
+  if (timer == WorkerTimer::sap_send) {
+    // only the earliest sap_send is kept
+    if (timepoint >= sap_send_timepoint_) {
+      return;
+    }
+    sap_send_timepoint_ = timepoint;
+  }
+  if (timers_.empty() || timepoint < timers_.top().first) {
+    // new earliest timer, the worker has to recompute its deadline
+    timers_changed_ = true;
+  }
+  timers_.emplace(timepoint, timer);
+  if (timer == WorkerTimer::sap_announce) {
+    sap_scheduled_ = true;
+  } else if (timer == WorkerTimer::sink_status_poll) {
+    sink_status_scheduled_ = true;
+  }
+}
+
+void SessionManager::schedule_sap_announcement() {
+  {
+    std::lock_guard worker_lock(worker_mutex_);
+    if (sap_scheduled_) {
+      // already scheduled, next announcements will include new sources
+      return;
+    }
+    schedule_timer(WorkerTimer::sap_announce, steady_clock::now());
+  }
+  worker_cv_.notify_one();
+}
+
 void SessionManager::on_update_sources() {
   // trigger sources SDP file update
   sources_mutex_.lock();
   for (auto& [id, info] : sources_) {
-    for (const auto& cb : update_source_observers_) {
-      info.session_version++;
-      cb(id, info.stream[0].m_cName, get_source_sdp_(id, info));
+    if (update_source_observers_.empty()) {
+      break;
+    }
+    info.session_version++;
+    auto sdp = get_source_sdp_(id, info);
+    for (const auto& [cb, strand] : update_source_observers_) {
+      observers_queue_.post(strand,
+                            [&cb = cb, id = id,
+                             name = std::string(info.stream[0].m_cName),
+                             sdp]() { cb(id, name, sdp); },
+                            source_key(id), ObserverQueue::Type::state);
     }
   }
   sources_mutex_.unlock();
@@ -1321,8 +1717,9 @@ void SessionManager::on_ptp_status_changed(const std::string& status) const {
     (void)driver_->set_sample_rate(driver_->get_current_sample_rate());
   }
 
-  for (const auto& cb : ptp_status_observers_) {
-    (void)cb(status);
+  for (const auto& [cb, strand] : ptp_status_observers_) {
+    observers_queue_.post(strand, [&cb = cb, status]() { (void)cb(status); },
+                          ptp_status_key, ObserverQueue::Type::state);
   }
 
   static std::string g_ptp_status;
@@ -1347,16 +1744,11 @@ void SessionManager::on_ptp_status_changed(const std::string& status) const {
   }
 }
 
-using namespace std::chrono;
-using second_t = duration<double, std::ratio<1> >;
-
 bool SessionManager::worker() {
   TPTPConfig ptp_config;
   TPTPStatus ptp_status;
-  auto sap_timepoint = steady_clock::now();
-  auto ptp_timepoint = steady_clock::now();
   int sap_interval = 1;
-  int ptp_interval = 0;
+  int ptp_interval = 10;
   uint32_t sample_rate = driver_->get_current_sample_rate();
 
   sap_.set_multicast_interface(config_->get_ip_addr_str());
@@ -1368,104 +1760,205 @@ bool SessionManager::worker() {
     igmp_[1].join(ip_str, ptp_primary_mcast_addr);
   }
 
+  {
+    // PTP status is retrieved immediately, SAP announcements start after 1 sec
+    std::lock_guard worker_lock(worker_mutex_);
+    schedule_timer(WorkerTimer::ptp_poll, steady_clock::now());
+    schedule_timer(WorkerTimer::sap_announce,
+                   steady_clock::now() + seconds(sap_interval));
+  }
+
   while (running_) {
-    // check if it's time to update the PTP status
-    if ((duration_cast<second_t>(steady_clock::now() - ptp_timepoint).count()) >
-        ptp_interval) {
-      ptp_timepoint = steady_clock::now();
-      if (driver_->get_ptp_config(ptp_config) ||
-          driver_->get_ptp_status(ptp_status)) {
-        BOOST_LOG_TRIVIAL(error)
-            << "session_manager:: failed to retrieve PTP clock info";
-        // return false;
+    std::list<WorkerTimer> expired_timers;
+    bool sinks_update = false;
+    steady_clock::time_point sinks_update_timepoint;
+    {
+      std::unique_lock worker_lock(worker_mutex_);
+      auto wake_up = [this]() {
+        return !running_ || sinks_update_pending_ || timers_changed_;
+      };
+      // the deadline below already accounts for the timers scheduled so far
+      timers_changed_ = false;
+      if (timers_.empty()) {
+        // nothing is due, sleep until woken up
+        worker_cv_.wait(worker_lock, wake_up);
       } else {
-        char ptp_clock_id[24];
-        const uint8_t* pui64GMID =
-            reinterpret_cast<uint8_t*>(&ptp_status.ui64GMID);
-        snprintf(ptp_clock_id, sizeof(ptp_clock_id),
-                 "%02X-%02X-%02X-%02X-%02X-%02X-%02X-%02X", pui64GMID[0],
-                 pui64GMID[1], pui64GMID[2], pui64GMID[3], pui64GMID[4],
-                 pui64GMID[5], pui64GMID[6], pui64GMID[7]);
-
-        bool ptp_changed_gmid = false;
-        std::string ptp_status_changed_to;
-        // update PTP clock status
-        ptp_mutex_.lock();
-        // update status
-        if (ptp_status_.gmid != ptp_clock_id) {
-          ptp_status_.gmid = ptp_clock_id;
-          ptp_changed_gmid = true;
-        }
-        ptp_status_.jitter = ptp_status.i32ClockJitter;
-        std::string new_ptp_status;
-        switch (ptp_status.nPTPLockStatus) {
-          case PTPLS_UNLOCKED:
-            new_ptp_status = "unlocked";
-            break;
-          case PTPLS_LOCKING:
-            new_ptp_status = "locking";
-            break;
-          case PTPLS_LOCKED:
-            new_ptp_status = "locked";
-            break;
+        worker_cv_.wait_until(worker_lock, timers_.top().first, wake_up);
+      }
+      if (!running_) {
+        break;
+      }
+      // an earlier timer was scheduled meanwhile, it is collected below if
+      // already due, otherwise the next wait uses the new deadline
+      timers_changed_ = false;
+      // collect all the expired timers
+      auto now = steady_clock::now();
+      while (!timers_.empty() && timers_.top().first <= now) {
+        auto [timepoint, timer] = timers_.top();
+        timers_.pop();
+        if (timer == WorkerTimer::sap_announce) {
+          sap_scheduled_ = false;
+        } else if (timer == WorkerTimer::sink_status_poll) {
+          sink_status_scheduled_ = false;
+        } else if (timer == WorkerTimer::sap_send) {
+          if (timepoint != sap_send_timepoint_) {
+            // superseded by an earlier sap_send
+            continue;
+          }
+          sap_send_timepoint_ = steady_clock::time_point::max();
         }
+        expired_timers.push_back(timer);
+      }
+      sinks_update = sinks_update_pending_;
+      sinks_update_timepoint = sinks_update_timepoint_;
+      sinks_update_pending_ = false;
+    }
 
-        if (ptp_status_.status != new_ptp_status) {
-          BOOST_LOG_TRIVIAL(info)
-              << "session_manager:: new PTP clock status " << new_ptp_status;
-          ptp_status_.status = new_ptp_status;
-          ptp_status_changed_to = new_ptp_status;
-        }
-        // end update PTP clock status
-        ptp_mutex_.unlock();
+    for (auto timer : expired_timers) {
+      switch (timer) {
+        case WorkerTimer::ptp_poll:
+          // time to update the PTP status
+          if (driver_->get_ptp_config(ptp_config) ||
+              driver_->get_ptp_status(ptp_status)) {
+            BOOST_LOG_TRIVIAL(error)
+                << "session_manager:: failed to retrieve PTP clock info";
+            // return false;
+          } else {
+            char ptp_clock_id[24];
+            const uint8_t* pui64GMID =
+                reinterpret_cast<uint8_t*>(&ptp_status.ui64GMID);
+            snprintf(ptp_clock_id, sizeof(ptp_clock_id),
+                     "%02X-%02X-%02X-%02X-%02X-%02X-%02X-%02X", pui64GMID[0],
+                     pui64GMID[1], pui64GMID[2], pui64GMID[3], pui64GMID[4],
+                     pui64GMID[5], pui64GMID[6], pui64GMID[7]);
+
+            bool ptp_changed_gmid = false;
+            std::string ptp_status_changed_to;
+            // update PTP clock status
+            ptp_mutex_.lock();
+            // update status
+            if (ptp_status_.gmid != ptp_clock_id) {
+              ptp_status_.gmid = ptp_clock_id;
+              ptp_changed_gmid = true;
+            }
+            ptp_status_.jitter = ptp_status.i32ClockJitter;
+            std::string new_ptp_status;
+            switch (ptp_status.nPTPLockStatus) {
+              case PTPLS_UNLOCKED:
+                new_ptp_status = "unlocked";
+                break;
+              case PTPLS_LOCKING:
+                new_ptp_status = "locking";
+                break;
+              case PTPLS_LOCKED:
+                new_ptp_status = "locked";
+                break;
+            }
 
-        if (!ptp_status_changed_to.empty()) {
-          on_ptp_status_changed(ptp_status_changed_to);
-        }
+            if (ptp_status_.status != new_ptp_status) {
+              BOOST_LOG_TRIVIAL(info)
+                  << "session_manager:: new PTP clock status "
+                  << new_ptp_status;
+              ptp_status_.status = new_ptp_status;
+              ptp_status_changed_to = new_ptp_status;
+            }
+            // end update PTP clock status
+            ptp_mutex_.unlock();
+
+            if (!ptp_status_changed_to.empty()) {
+              on_ptp_status_changed(ptp_status_changed_to);
+            }
+
+            if (ptp_changed_gmid ||
+                sample_rate != driver_->get_current_sample_rate()) {
+              /* master clock id changed or sample rate changed
+               * we need to update all the sources */
+              if (sample_rate != driver_->get_current_sample_rate()) {
+                sample_rate = driver_->get_current_sample_rate();
+                // set driver sample rate
+                (void)driver_->set_sample_rate(sample_rate);
+              }
+              on_update_sources();
+            }
+          }
+          {
+            std::lock_guard worker_lock(worker_mutex_);
+            schedule_timer(WorkerTimer::ptp_poll,
+                           steady_clock::now() + seconds(ptp_interval));
+          }
+          break;
+
+        case WorkerTimer::sap_announce: {
+          // time to send sap announcements
+          std::vector<SAP::Message> messages;
+          auto sdp_len_sum = process_sap(messages);
 
-        if (ptp_changed_gmid ||
-            sample_rate != driver_->get_current_sample_rate()) {
-          /* master clock id changed or sample rate changed
-           * we need to update all the sources */
-          if (sample_rate != driver_->get_current_sample_rate()) {
-            sample_rate = driver_->get_current_sample_rate();
-            // set driver sample rate
-            (void)driver_->set_sample_rate(sample_rate);
+          if (announced_sources_.empty()) {
+            // nothing to announce or delete, wait for a new source
+            schedule_sap_messages(messages, sdp_len_sum, 1);
+            BOOST_LOG_TRIVIAL(debug)
+                << "session_manager:: no SAP announcements scheduled";
+            break;
           }
-          on_update_sources();
-        }
-      }
-      ptp_interval = 10;
-    }
 
-    // check if it's time to send sap announcements
-    if ((duration_cast<second_t>(steady_clock::now() - sap_timepoint).count()) >
-        sap_interval) {
-      sap_timepoint = steady_clock::now();
+          if (config_->get_sap_interval()) {
+            // if announcement interval specified in configuration
+            sap_interval = config_->get_sap_interval();
+          } else {
+            // compute next announcement interval
+            sap_interval = std::max(
+                static_cast<size_t>(SAP::min_interval),
+                sdp_len_sum * 8 /
+                    std::max(config_->get_sap_bandwidth_limit(),
+                             Config::sap_bandwidth_limit_min));
+            sap_interval +=
+                (std::rand() % (sap_interval * 2 / 3)) - (sap_interval / 3);
+          }
+          // the interval is extended if the round exceeds the budget
+          sap_interval =
+              schedule_sap_messages(messages, sdp_len_sum, sap_interval);
+
+          std::lock_guard worker_lock(worker_mutex_);
+          if (!sap_scheduled_) {
+            schedule_timer(WorkerTimer::sap_announce,
+                           steady_clock::now() + seconds(sap_interval));
+            BOOST_LOG_TRIVIAL(info)
+                << "session_manager:: next SAP announcements in "
+                << sap_interval << " secs";
+          }
+        } break;
 
-      auto sdp_len_sum = process_sap();
+        case WorkerTimer::sap_send:
+          send_sap_messages();
+          break;
 
-      if (config_->get_sap_interval()) {
-        // if announcement interval specified in configuration
-        sap_interval = config_->get_sap_interval();
-      } else {
-        // compute next announcement interval
-        sap_interval = std::max(static_cast<size_t>(SAP::min_interval),
-                                sdp_len_sum * 8 / SAP::bandwidth_limit);
-        sap_interval +=
-            (std::rand() % (sap_interval * 2 / 3)) - (sap_interval / 3);
+        case WorkerTimer::sink_status_poll:
+          if (!is_sink_status_active()) {
+            // no active observers, restarted by start_sink_status_poll()
+            BOOST_LOG_TRIVIAL(debug)
+                << "session_manager:: sinks status poll stopped";
+            break;
+          }
+          poll_sinks_status();
+          {
+            std::lock_guard worker_lock(worker_mutex_);
+            if (!sink_status_scheduled_) {
+              schedule_timer(WorkerTimer::sink_status_poll,
+                             steady_clock::now() +
+                                 milliseconds(sink_status_interval_ms));
+            }
+          }
+          break;
       }
-
-      BOOST_LOG_TRIVIAL(info) << "session_manager:: next SAP announcements in "
-                              << sap_interval << " secs";
     }
 
-    update_sinks();
-
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    if (sinks_update) {
+      update_sinks(sinks_update_timepoint);
+    }
   }
 
   // at end, send deletion for all announced sources
+  std::vector<SAP::Message> messages;
   for (auto const& [msg_id_hash, info] : announced_sources_) {
     auto src_addr = std::get<0>(info);
     auto session_id = std::get<1>(info);
@@ -1473,8 +1966,11 @@ bool SessionManager::worker() {
     // retrieve deleted source SDP
     std::string sdp = get_removed_source_sdp_(msg_id_hash >> 16, src_addr,
                                               session_id, session_version);
-    // send deletion for this source
-    sap_.deletion(static_cast<uint16_t>(msg_id_hash), src_addr, sdp);
+    messages.push_back({false, static_cast<uint16_t>(msg_id_hash),
+                        htonl(src_addr), std::move(sdp)});
+  }
+  if (!messages.empty()) {
+    sap_.send(messages);
   }
 
   // leave PTP multicast addresses
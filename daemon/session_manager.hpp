@@ -20,9 +20,14 @@
 #ifndef _SESSION_MANAGER_HPP_
 #define _SESSION_MANAGER_HPP_
 
+#include <condition_variable>
+#include <deque>
 #include <future>
 #include <list>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <queue>
 #include <shared_mutex>
 #include <thread>
 #include <chrono>
@@ -31,12 +36,15 @@
 #include "driver_interface.hpp"
 #include "browser.hpp"
 #include "igmp.hpp"
+#include "observer_queue.hpp"
 #include "sap.hpp"
+#include "sdp_fetcher.hpp"
+#include "stream_table.hpp"
 
 constexpr static uint8_t media_max = 2;
 
 struct StreamSource {
-  uint8_t id{0};
+  uint16_t id{0};
   bool enabled{false};
   std::string name;
   std::string io;
@@ -51,7 +59,7 @@ struct StreamSource {
 };
 
 struct StreamSink {
-  uint8_t id;
+  uint16_t id;
   std::string name;
   std::string io;
   bool use_sdp{false};
@@ -85,6 +93,17 @@ struct PTPStatus {
   int32_t jitter{0};
 };
 
+struct SAPStats {
+  uint32_t interval{0};        /* secs, interval of the current round */
+  uint32_t bandwidth_limit{0}; /* bits per sec */
+  size_t slice_budget{0};      /* bytes per time slice */
+  uint64_t rounds{0};
+  uint64_t overruns{0}; /* rounds extended to stay in the budget */
+  uint64_t packets_sent{0};
+  uint64_t bytes_sent{0};
+  SAP::Stats last_round; /* messages sent in the previous round */
+};
+
 struct StreamInfo {
   TRTP_stream_info stream[media_max];
   uint64_t handle[media_max]{0};
@@ -103,7 +122,7 @@ struct StreamInfo {
 
 class SessionManager {
  public:
-  constexpr static uint8_t stream_id_max = 63;
+  constexpr static uint16_t stream_id_max = 511;
 
   static std::shared_ptr<SessionManager> create(
       std::shared_ptr<DriverManager> driver,
@@ -121,6 +140,8 @@ class SessionManager {
       g_session_version = std::chrono::system_clock::now().time_since_epoch() /
                           std::chrono::seconds(1);
       // to have an increasing session versions between restarts
+      observers_queue_.init();
+      browser_->add_update_observer([this]() { notify_sinks_update(); });
       res_ = std::async(std::launch::async, &SessionManager::worker, this);
     }
     return true;
@@ -128,71 +149,146 @@ class SessionManager {
 
   bool terminate() {
     if (running_) {
-      running_ = false;
+      {
+        std::lock_guard worker_lock(worker_mutex_);
+        running_ = false;
+      }
+      worker_cv_.notify_one();
       auto ret = res_.get();
-      for (const auto& source : get_sources()) {
+      wait_sink_fetches();
+      auto sources = get_sources();
+      for (const auto& source : *sources) {
         remove_source(source.id);
       }
-      for (const auto& sink : get_sinks()) {
+      auto sinks = get_sinks();
+      for (const auto& sink : *sinks) {
         remove_sink(sink.id);
       }
+      // stop the observers if not done yet with stop_observers(), the
+      // removals above are not notified once stopped
+      observers_queue_.terminate();
       return ret;
     }
     return true;
   }
 
+  /* immutable snapshots, rebuilt when the sources or sinks change */
+  using SourcesSnapshot = std::shared_ptr<const std::list<StreamSource> >;
+  using SinksSnapshot = std::shared_ptr<const std::list<StreamSink> >;
+
   std::error_code add_source(const StreamSource& source);
-  std::error_code get_source(uint8_t id, StreamSource& source) const;
-  std::list<StreamSource> get_sources() const;
+  std::error_code get_source(uint16_t id, StreamSource& source) const;
+  SourcesSnapshot get_sources() const;
+  /* incremented after every new sources snapshot, read it before the
+   * snapshot to get a snapshot at least as recent as the version */
+  uint64_t get_sources_version() const { return sources_version_; }
   std::error_code get_source_sdp(uint32_t id, std::string& sdp) const;
   std::error_code remove_source(uint32_t id);
-  uint8_t get_source_id(const std::string& name) const;
+  uint16_t get_source_id(const std::string& name) const;
 
+  /* observers are notified asynchronously, the callbacks registered with
+   * the same observer name are invoked in order, one at a time */
   enum class SourceObserverType { add_source, remove_source, update_source };
   using SourceObserver = std::function<
-      bool(uint8_t id, const std::string& name, const std::string& sdp)>;
-  void add_source_observer(SourceObserverType type, const SourceObserver& cb);
+      bool(uint16_t id, const std::string& name, const std::string& sdp)>;
+  void add_source_observer(SourceObserverType type,
+                           const SourceObserver& cb,
+                           const std::string& observer);
 
   enum class SinkObserverType { add_sink, remove_sink };
-  using SinkObserver = std::function<bool(uint8_t id, const std::string& name)>;
-  void add_sink_observer(SinkObserverType type, const SinkObserver& cb);
+  using SinkObserver =
+      std::function<bool(uint16_t id, const std::string& name)>;
+  void add_sink_observer(SinkObserverType type,
+                         const SinkObserver& cb,
+                         const std::string& observer);
 
   using PtpStatusObserver = std::function<bool(const std::string& status)>;
-  void add_ptp_status_observer(const PtpStatusObserver& cb);
+  void add_ptp_status_observer(const PtpStatusObserver& cb,
+                               const std::string& observer);
+
+  /* called when the flags of a sink status change, the sinks status is
+   * polled only while one of the observers is active, an observer becoming
+   * active calls start_sink_status_poll() */
+  using SinkStatusObserver =
+      std::function<bool(uint16_t id, const SinkStreamStatus& status)>;
+  using SinkStatusActive = std::function<bool()>;
+  void add_sink_status_observer(const SinkStatusObserver& cb,
+                                const SinkStatusActive& is_active,
+                                const std::string& observer);
+  void start_sink_status_poll();
+
+  /* deliver the pending notifications and stop notifying the observers,
+   * called before the observers are terminated */
+  bool stop_observers() { return observers_queue_.terminate(); }
+  std::vector<ObserverQueue::Stats> get_observers_stats() const {
+    return observers_queue_.get_stats();
+  }
 
   std::error_code add_sink(const StreamSink& sink);
-  std::error_code get_sink(uint8_t id, StreamSink& sink) const;
-  std::list<StreamSink> get_sinks() const;
+  std::error_code get_sink(uint16_t id, StreamSink& sink) const;
+  SinksSnapshot get_sinks() const;
+  uint64_t get_sinks_version() const { return sinks_version_; }
   std::error_code get_sink_status(uint32_t id, SinkStreamStatus& status) const;
   std::error_code remove_sink(uint32_t id);
-  uint8_t get_sink_id(const std::string& name) const;
+  uint16_t get_sink_id(const std::string& name) const;
 
   std::error_code set_ptp_config(const PTPConfig& config);
   std::error_code set_driver_config(std::string_view name,
                                     uint32_t value) const;
   void get_ptp_config(PTPConfig& config) const;
+  uint64_t get_ptp_config_version() const { return ptp_config_version_; }
   void get_ptp_status(PTPStatus& status) const;
 
   bool load_status();
   bool save_status() const;
 
-  size_t process_sap();
+  size_t process_sap(std::vector<SAP::Message>& messages);
+  SAPStats get_sap_stats() const;
 
  protected:
+  /* worker timers, a timer is re-armed by its own handler */
+  enum class WorkerTimer {
+    ptp_poll,
+    sap_announce,
+    sap_send,
+    sink_status_poll
+  };
+
+  /* SAP messages are sent in time slices of this duration */
+  constexpr static uint16_t sap_slice_ms = 100;
+
+  /* interval of the sinks status poll */
+  constexpr static uint16_t sink_status_interval_ms = 500;
+
   constexpr static const char ptp_primary_mcast_addr[] = "224.0.1.129";
   constexpr static const char ptp_pdelay_mcast_addr[] = "224.0.1.107";
 
   std::list<StreamSink> get_updated_sinks(
       const std::list<RemoteSource>& sources_list);
-  void update_sinks();
+  void update_sinks(std::chrono::steady_clock::time_point change_timepoint);
+  void notify_sinks_update();
+  void schedule_timer(WorkerTimer timer,
+                      std::chrono::steady_clock::time_point timepoint);
+  void schedule_sap_announcement();
+  int schedule_sap_messages(std::vector<SAP::Message>& messages,
+                            size_t sdp_len_sum,
+                            int sap_interval);
+  void send_sap_messages();
 
   void on_add_source(const StreamSource& source, const StreamInfo& info);
   void on_remove_source(const StreamInfo& info);
 
   void on_add_sink(const StreamSink& sink, const StreamInfo& info);
+  uint64_t next_sink_seq(uint16_t id);
+  void add_sink_when_fetched(const StreamSink& sink,
+                             const std::shared_future<SdpFetcher::Result>& fetch,
+                             uint64_t seq);
+  void wait_sink_fetches();
   void on_remove_sink(const StreamInfo& info);
 
   void on_ptp_status_changed(const std::string& status) const;
+  void poll_sinks_status();
+  bool is_sink_status_active() const;
 
   void on_update_sources();
 
@@ -201,8 +297,10 @@ class SessionManager {
                                       uint32_t session_id,
                                       uint32_t session_version) const;
   std::string get_source_sdp_(uint32_t id, const StreamInfo& info) const;
-  StreamSource get_source_(uint8_t id, const StreamInfo& info) const;
-  StreamSink get_sink_(uint8_t id, const StreamInfo& info) const;
+  StreamSource get_source_(uint16_t id, const StreamInfo& info) const;
+  StreamSink get_sink_(uint16_t id, const StreamInfo& info) const;
+  void publish_sources_();
+  void publish_sinks_();
 
   bool sink_is_still_valid(const std::string sdp,
                            const std::list<RemoteSource> sources_list) const;
@@ -226,16 +324,32 @@ class SessionManager {
   std::atomic_bool running_{false};
 
   /* current sources */
-  std::map<uint8_t /* id */, StreamInfo> sources_;
-  std::map<std::string, uint8_t /* id */> source_names_;
+  StreamTable<StreamInfo, stream_id_max + 1> sources_;
+  std::map<std::string, uint16_t /* id */> source_names_;
   mutable std::shared_mutex sources_mutex_;
+  SourcesSnapshot sources_snapshot_{
+      std::make_shared<const std::list<StreamSource> >()};
+  std::atomic<uint64_t> sources_version_{0};
 
   /* current sinks */
-  std::map<uint8_t /* id */, StreamInfo> sinks_;
-  std::map<std::string, uint8_t /* id */> sink_names_;
+  StreamTable<StreamInfo, stream_id_max + 1> sinks_;
+  std::map<std::string, uint16_t /* id */> sink_names_;
   mutable std::shared_mutex sinks_mutex_;
-
-  /* current announced sources */
+  SinksSnapshot sinks_snapshot_{
+      std::make_shared<const std::list<StreamSink> >()};
+  std::atomic<uint64_t> sinks_version_{0};
+  /* serializes sink updates performed outside of sinks_mutex_ */
+  std::mutex sinks_update_mutex_;
+  SdpFetcher sdp_fetcher_;
+  /* max time a sink update waits for its SDP fetch before the sink is added
+   * from the fetch completion */
+  constexpr static uint16_t sink_fetch_wait_ms = 500;
+  /* a newer update or a removal of a sink supersedes its pending fetch */
+  std::mutex sink_fetches_mutex_;
+  std::map<uint16_t /* id */, uint64_t /* seq */> sink_seqs_;
+  std::list<std::future<void> > sink_fetches_;
+
+  /* current announced sources, msg_id_hash is (id << 16) + SAP hash */
   std::map<uint32_t /* msg_id_hash */,
            std::tuple<uint32_t /* src_addr */,
                       uint32_t /* session_id */,
@@ -246,21 +360,69 @@ class SessionManager {
   std::unordered_map<uint32_t /* msg_id_hash */, int /* count */>
       deleted_sources_count_;
 
+  /* SAP message hash assigned to each announced source, the hash is derived
+   * from the SDP CRC and kept unique across the announced sources */
+  std::unordered_map<uint16_t /* id */,
+                     std::pair<uint16_t /* SDP crc */, uint16_t /* hash */> >
+      sources_msg_hash_;
+
   PTPConfig ptp_config_;
   PTPStatus ptp_status_;
   mutable std::shared_mutex ptp_mutex_;
-
-  std::list<SourceObserver> add_source_observers_;
-  std::list<SourceObserver> remove_source_observers_;
-  std::list<SourceObserver> update_source_observers_;
-  std::list<PtpStatusObserver> ptp_status_observers_;
-  std::list<SinkObserver> add_sink_observers_;
-  std::list<SinkObserver> remove_sink_observers_;
-  std::list<SinkObserver> update_sink_observers_;
+  std::atomic<uint64_t> ptp_config_version_{0};
+
+  template <typename Observer>
+  using observers_t = std::list<std::pair<Observer, ObserverQueue::Strand> >;
+  observers_t<SourceObserver> add_source_observers_;
+  observers_t<SourceObserver> remove_source_observers_;
+  observers_t<SourceObserver> update_source_observers_;
+  observers_t<PtpStatusObserver> ptp_status_observers_;
+  observers_t<SinkObserver> add_sink_observers_;
+  observers_t<SinkObserver> remove_sink_observers_;
+  struct SinkStatusEntry {
+    SinkStatusObserver cb;
+    SinkStatusActive is_active;
+    ObserverQueue::Strand strand;
+  };
+  std::list<SinkStatusEntry> sink_status_observers_;
+  /* observers are notified asynchronously from this queue, each observer
+   * on its own strand */
+  mutable ObserverQueue observers_queue_{"session_manager"};
 
   SAP sap_{config_->get_sap_mcast_addr()};
   IGMP igmp_[2];
-  uint32_t last_sink_update_{0};
+
+  /* SAP messages waiting to be sent, accessed by the worker only */
+  std::deque<std::pair<std::chrono::steady_clock::time_point, SAP::Message> >
+      sap_queue_;
+  size_t sap_slice_budget_{0}; /* bytes */
+  /* bytes that can be sent, refilled with the budget at every time slice
+   * and negative when a message larger than the credit was sent */
+  int64_t sap_credit_{0};
+  std::chrono::steady_clock::time_point sap_slice_end_;
+  SAPStats sap_stats_;
+  mutable std::mutex sap_stats_mutex_;
+
+  /* last driver status flags of the sinks, accessed by the worker only */
+  std::map<uint16_t /* id */, uint32_t /* flags */> sinks_status_flags_;
+
+  /* worker timer queue and wake-up channel */
+  using worker_timer_t =
+      std::pair<std::chrono::steady_clock::time_point, WorkerTimer>;
+  std::priority_queue<worker_timer_t,
+                      std::vector<worker_timer_t>,
+                      std::greater<worker_timer_t> >
+      timers_;
+  bool sap_scheduled_{false};
+  bool sink_status_scheduled_{false};
+  std::chrono::steady_clock::time_point sap_send_timepoint_{
+      std::chrono::steady_clock::time_point::max()};
+  bool sinks_update_pending_{false};
+  /* set when a timer earlier than the current deadline is scheduled */
+  bool timers_changed_{false};
+  std::chrono::steady_clock::time_point sinks_update_timepoint_;
+  std::mutex worker_mutex_;
+  std::condition_variable worker_cv_;
 
   /* used to handle session versioning */
   inline static std::atomic<uint32_t> g_session_version{0};
@@ -0,0 +1,118 @@
+//
+//  stream_table.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _STREAM_TABLE_HPP_
+#define _STREAM_TABLE_HPP_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Flat table of streams indexed by stream id.
+ * Lookups are a direct slot access and iteration visits the used slots in
+ * increasing id order, the interface is the subset of std::map in use.
+ */
+template <typename T, size_t N>
+class StreamTable {
+ public:
+  using key_type = uint16_t;
+  using value_type = std::pair<const key_type, T>;
+
+  template <bool Const>
+  class iterator_ {
+   public:
+    using reference =
+        std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+    iterator_(const std::unique_ptr<value_type>* slots, size_t idx)
+        : slots_(slots), idx_(idx) {
+      skip();
+    }
+    /* iterator to const_iterator conversion */
+    template <bool C, typename = std::enable_if_t<Const && !C> >
+    iterator_(const iterator_<C>& it) : slots_(it.slots_), idx_(it.idx_) {}
+
+    reference operator*() const { return *slots_[idx_]; }
+    pointer operator->() const { return slots_[idx_].get(); }
+    iterator_& operator++() {
+      ++idx_;
+      skip();
+      return *this;
+    }
+    bool operator==(const iterator_& rhs) const { return idx_ == rhs.idx_; }
+    bool operator!=(const iterator_& rhs) const { return idx_ != rhs.idx_; }
+
+   private:
+    friend class iterator_<!Const>;
+
+    void skip() {
+      while (idx_ < N && !slots_[idx_]) {
+        ++idx_;
+      }
+    }
+
+    const std::unique_ptr<value_type>* slots_;
+    size_t idx_;
+  };
+  using iterator = iterator_<false>;
+  using const_iterator = iterator_<true>;
+
+  iterator begin() { return {slots_.data(), 0}; }
+  iterator end() { return {slots_.data(), N}; }
+  const_iterator begin() const { return {slots_.data(), 0}; }
+  const_iterator end() const { return {slots_.data(), N}; }
+
+  iterator find(key_type id) {
+    return (id < N && slots_[id]) ? iterator(slots_.data(), id) : end();
+  }
+  const_iterator find(key_type id) const {
+    return (id < N && slots_[id]) ? const_iterator(slots_.data(), id) : end();
+  }
+
+  /* id must be lower than N */
+  T& operator[](key_type id) {
+    if (!slots_[id]) {
+      slots_[id] = std::make_unique<value_type>(id, T{});
+      ++size_;
+    }
+    return slots_[id]->second;
+  }
+
+  size_t erase(key_type id) {
+    if (id < N && slots_[id]) {
+      slots_[id].reset();
+      --size_;
+      return 1;
+    }
+    return 0;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  std::array<std::unique_ptr<value_type>, N> slots_;
+  size_t size_{0};
+};
+
+#endif
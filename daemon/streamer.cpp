@@ -36,13 +36,16 @@ std::shared_ptr<Streamer> Streamer::create(
 bool Streamer::init() {
   BOOST_LOG_TRIVIAL(info) << "Streamer: init";
   session_manager_->add_ptp_status_observer(
-      std::bind(&Streamer::on_ptp_status_change, this, std::placeholders::_1));
+      std::bind(&Streamer::on_ptp_status_change, this, std::placeholders::_1),
+      "streamer");
   session_manager_->add_sink_observer(
       SessionManager::SinkObserverType::add_sink,
-      std::bind(&Streamer::on_sink_add, this, std::placeholders::_1));
+      std::bind(&Streamer::on_sink_add, this, std::placeholders::_1),
+      "streamer");
   session_manager_->add_sink_observer(
       SessionManager::SinkObserverType::remove_sink,
-      std::bind(&Streamer::on_sink_remove, this, std::placeholders::_1));
+      std::bind(&Streamer::on_sink_remove, this, std::placeholders::_1),
+      "streamer");
 
   running_ = false;
 
@@ -53,11 +56,11 @@ bool Streamer::init() {
   return true;
 }
 
-bool Streamer::on_sink_add(uint8_t id) {
+bool Streamer::on_sink_add(uint16_t id) {
   return true;
 }
 
-bool Streamer::on_sink_remove(uint8_t id) {
+bool Streamer::on_sink_remove(uint16_t id) {
   if (faac_[id]) {
     std::unique_lock faac_lock(faac_mutex_[id]);
 #if defined(FAAC_VERSION_MAJOR)
@@ -320,7 +323,8 @@ bool Streamer::start_capture() {
 void Streamer::open_files(uint8_t files_id) {
   BOOST_LOG_TRIVIAL(debug) << "streamer: opening files with id "
                            << std::to_string(files_id) << " ...";
-  for (const auto& sink : session_manager_->get_sinks()) {
+  auto sinks = session_manager_->get_sinks();
+  for (const auto& sink : *sinks) {
     tmp_streams_[sink.id].str("");
     std::unique_lock faac_lock(faac_mutex_[sink.id]);
     if (!faac_[sink.id]) {
@@ -332,7 +336,8 @@ void Streamer::open_files(uint8_t files_id) {
 void Streamer::save_files(uint8_t files_id) {
   auto sample_size = bytes_per_frame_ / channels_;
 
-  for (const auto& sink : session_manager_->get_sinks()) {
+  auto sinks = session_manager_->get_sinks();
+  for (const auto& sink : *sinks) {
     total_sink_samples_[sink.id] += chunk_samples_;
     for (size_t offset = 0; offset < chunk_samples_; offset++) {
       for (uint16_t ch : sink.map) {
@@ -446,7 +451,8 @@ void Streamer::close_files(uint8_t files_id) {
   uint16_t sample_size = bytes_per_frame_ / channels_;
 
   std::list<std::future<bool> > ress;
-  for (const auto& sink : session_manager_->get_sinks()) {
+  auto sinks = session_manager_->get_sinks();
+  for (const auto& sink : *sinks) {
     ress.emplace_back(std::async(std::launch::async, [=]() {
       uint32_t out_len = 0;
       {
@@ -536,7 +542,8 @@ bool Streamer::stop_capture() {
   BOOST_LOG_TRIVIAL(info) << "streamer: stopping audio capture ... ";
   running_ = false;
   bool ret = res_.get();
-  for (const auto& sink : session_manager_->get_sinks()) {
+  auto sinks = session_manager_->get_sinks();
+  for (const auto& sink : *sinks) {
     if (faac_[sink.id]) {
 #if defined(FAAC_VERSION_MAJOR)
       faac_status st = faac_encoder_close(&faac_[sink.id]);
@@ -40,7 +40,7 @@ struct StreamerInfo {
 };
 
 struct StreamerLiveInfo {
-  uint8_t sink_id{0};
+  uint16_t sink_id{0};
   uint8_t file_id{0};
   uint8_t unwriteble{0};
 };
@@ -86,8 +86,8 @@ class Streamer {
   ssize_t pcm_read(uint8_t* data, size_t rcount);
 
   bool on_ptp_status_change(const std::string& status);
-  bool on_sink_add(uint8_t id);
-  bool on_sink_remove(uint8_t id);
+  bool on_sink_add(uint16_t id);
+  bool on_sink_remove(uint16_t id);
   bool start_capture();
   bool stop_capture();
   bool setup_codec(const StreamSink& sink);
@@ -103,30 +103,30 @@ class Streamer {
   uint8_t files_num_{8};
   uint8_t player_buffer_files_num_{1};
   size_t buffer_samples_{0};
-  std::unordered_map<uint8_t, size_t> total_sink_samples_;
+  std::unordered_map<uint16_t, size_t> total_sink_samples_;
   uint32_t buffer_offset_{0};
-  std::unordered_map<uint8_t, std::shared_mutex> streams_mutex_;
-  std::unordered_map<uint8_t, std::stringstream> tmp_streams_;
-  std::map<std::pair<uint8_t, uint8_t>, std::stringstream> output_streams_;
+  std::unordered_map<uint16_t, std::shared_mutex> streams_mutex_;
+  std::unordered_map<uint16_t, std::stringstream> tmp_streams_;
+  std::map<std::pair<uint16_t, uint8_t>, std::stringstream> output_streams_;
   std::unordered_map<uint8_t, uint32_t> output_ids_;
   uint32_t file_counter_{0};
   std::atomic<uint8_t> file_id_{0};
   std::unique_ptr<uint8_t[]> buffer_;
-  std::unordered_map<uint8_t, std::unique_ptr<uint8_t[]> > out_buffer_;
-  std::unordered_map<uint8_t, uint32_t> out_buffer_size_{0};
+  std::unordered_map<uint16_t, std::unique_ptr<uint8_t[]> > out_buffer_;
+  std::unordered_map<uint16_t, uint32_t> out_buffer_size_{0};
   uint8_t channels_{8};
   uint32_t rate_{0};
   std::future<bool> res_;
   snd_pcm_t* capture_handle_;
   std::atomic_bool running_{false};
 #if defined(FAAC_VERSION_MAJOR)
-  std::unordered_map<uint8_t, faac_encoder*> faac_;
+  std::unordered_map<uint16_t, faac_encoder*> faac_;
 #else
-  std::unordered_map<uint8_t, faacEncHandle> faac_;
+  std::unordered_map<uint16_t, faacEncHandle> faac_;
 #endif
-  std::unordered_map<uint8_t, uint32_t> codec_in_samples_;
-  std::unordered_map<uint8_t, uint32_t> codec_out_buffer_size_;
-  std::unordered_map<uint8_t, std::mutex> faac_mutex_;
+  std::unordered_map<uint16_t, uint32_t> codec_in_samples_;
+  std::unordered_map<uint16_t, uint32_t> codec_out_buffer_size_;
+  std::unordered_map<uint16_t, std::mutex> faac_mutex_;
   std::map<std::pair<std::string, int>, StreamerLiveInfo> liveInfos_;
 };
 
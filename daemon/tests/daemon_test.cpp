@@ -37,7 +37,16 @@ namespace process = boost::process::v1;
 #include <boost/property_tree/ptree.hpp>
 #include <boost/algorithm/string/replace.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <map>
+#include <mutex>
 #include <set>
+#include <thread>
+#include <zlib.h>
 
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE DaemonTest
@@ -49,11 +58,32 @@ namespace process = boost::process::v1;
 
 constexpr static const char g_daemon_address[] = "127.0.0.1";
 constexpr static uint16_t g_daemon_port = 9999;
+constexpr static uint16_t g_daemon_rtsp_port = 9997;
+constexpr static const char g_daemon_unix_socket[] =
+    "/tmp/aes67-daemon-test.sock";
 constexpr static const char g_sap_address[] = "224.2.127.254";
 constexpr static uint16_t g_sap_port = 9875;
 constexpr static uint16_t g_udp_size = 1024;
 constexpr static uint16_t g_sap_header_len = 24;
+constexpr static const char g_sdp_dup[] =
+    "v=0\no=- 1 0 IN IP4 10.0.0.12\ns=ALSA (on ubuntu)_dup\n"
+    "i=2 channels: Left, Right\nc=IN IP4 239.2.0.12/15\nt=0 0\n"
+    "a=group:DUP primary secondary\na=clock-domain:PTPv2 0\n"
+    "m=audio 6004 RTP/AVP 98\nc=IN IP4 239.2.0.12/15\n"
+    "a=rtpmap:98 L24/48000/2\na=sync-time:0\na=framecount:48\n"
+    "a=ptime:1\na=maxptime:1\na=mediaclk:direct=0\n"
+    "a=ts-refclk:ptp=IEEE1588-2008:00-0C-29-FF-FE-0E-90-C8:0\n"
+    "a=source-filter: incl IN IP4 239.2.0.12 10.0.0.12\n"
+    "a=recvonly\na=mid:primary\n"
+    "m=audio 6004 RTP/AVP 98\nc=IN IP4 239.3.0.12/15\n"
+    "a=rtpmap:98 L24/48000/2\na=sync-time:0\na=framecount:48\n"
+    "a=ptime:1\na=maxptime:1\na=mediaclk:direct=0\n"
+    "a=ts-refclk:ptp=IEEE1588-2008:00-0C-29-FF-FE-0E-90-C8:0\n"
+    "a=source-filter: incl IN IP4 239.3.0.12 10.0.1.12\n"
+    "a=recvonly\na=mid:secondary\n";
 constexpr static uint16_t g_stream_num_max = 64;
+constexpr static uint16_t g_stream_id_max = 511;
+constexpr static uint16_t g_stream_scale_num = 512;
 
 using namespace process;
 using namespace boost::asio::ip;
@@ -73,6 +103,7 @@ struct DaemonInstance {
       std::this_thread::sleep_for(std::chrono::seconds(1));
     }
     BOOST_REQUIRE(daemon_.running());
+    daemon_pid = daemon_.native_handle();
     ok = true;
   }
 
@@ -88,6 +119,7 @@ struct DaemonInstance {
   }
 
   static bool is_ok() { return ok; }
+  static pid_t get_pid() { return daemon_pid; }
 
  private:
   child daemon_{
@@ -96,12 +128,62 @@ struct DaemonInstance {
 #endif
       "../aes67-daemon",       "-c", "daemon.conf", "-p", "9999"};
   inline static bool ok{false};
+  inline static pid_t daemon_pid{0};
 };
 
+/* field of the daemon /proc status file */
+static long get_daemon_status(const std::string& field) {
+  std::ifstream status("/proc/" + std::to_string(DaemonInstance::get_pid()) +
+                       "/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind(field + ":", 0) == 0) {
+      return std::atol(line.c_str() + field.length() + 1);
+    }
+  }
+  return 0;
+}
+
+/* daemon resident memory in KB */
+static long get_daemon_rss() {
+  return get_daemon_status("VmRSS");
+}
+
+/* the ETag prefix of the daemon replies changes with every (re)start */
+static std::string get_daemon_instance() {
+  httplib::Client http(g_daemon_address, g_daemon_port);
+  auto res = http.Get("/api/config");
+  if (!res || res->status != 200) {
+    return "";
+  }
+  auto etag = res->get_header_value("ETag");
+  return etag.substr(0, etag.rfind('-'));
+}
+
+/* apply a config change that restarts the daemon and wait for it */
+static bool set_config_restart(const std::string& json) {
+  auto instance = get_daemon_instance();
+  httplib::Client http(g_daemon_address, g_daemon_port);
+  auto res = http.Post("/api/config", json, "application/json");
+  if (!res || res->status != 200) {
+    return false;
+  }
+  int retry = 300;
+  while (retry--) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto current = get_daemon_instance();
+    if (!current.empty() && current != instance) {
+      return true;
+    }
+  }
+  return false;
+}
+
 BOOST_TEST_GLOBAL_FIXTURE(DaemonInstance);
 
 struct Client {
-  Client() {
+  explicit Client(uint16_t port = g_daemon_port)
+      : cli_(g_daemon_address, port) {
     socket_.open(listen_endpoint_.protocol());
     socket_.set_option(udp::socket::reuse_address(true));
     socket_.bind(listen_endpoint_);
@@ -139,6 +221,12 @@ struct Client {
     return (res->status == 200);
   }
 
+  bool set_config(const std::string& json) {
+    auto res = cli_.Post("/api/config", json, "application/json");
+    BOOST_REQUIRE_MESSAGE(res != nullptr, "server returned response");
+    return (res->status == 200);
+  }
+
   std::pair<bool, std::string> get_ptp_status() {
     auto res = cli_.Get("/api/ptp/status");
     BOOST_REQUIRE_MESSAGE(res != nullptr, "server returned response");
@@ -151,7 +239,7 @@ struct Client {
     return {res->status == 200, res->body};
   }
 
-  bool add_source(int id) {
+  bool add_source(int id, const std::string& codec = "L16") {
     std::string json = R"(
 {
   "enabled": true,
@@ -169,6 +257,7 @@ struct Client {
     )";
 
     boost::replace_first(json, "ALSA", "ALSA " + std::to_string(id));
+    boost::replace_first(json, "L16", codec);
     std::string url = std::string("/api/source/") + std::to_string(id);
     auto res = cli_.Put(url.c_str(), json, "application/json");
     BOOST_REQUIRE_MESSAGE(res != nullptr, "server returned response");
@@ -263,6 +352,17 @@ struct Client {
   }
 
   bool add_sink_url(int id) {
+    return add_sink_url(id, std::string("http://") + g_daemon_address + ":" +
+                                std::to_string(g_daemon_port) +
+                                "/api/source/sdp/" + std::to_string(id));
+  }
+
+  bool add_sink_url(int id, const std::string& source) {
+    return put_sink_url(id, source) == 200;
+  }
+
+  /* HTTP status of the sink update, 202 if the SDP fetch is pending */
+  int put_sink_url(int id, const std::string& source) {
     std::string json1 = R"(
 {
   "io": "Audio Device",
@@ -276,13 +376,11 @@ struct Client {
     std::string json =
         json1 +
         std::string("\"name\": \"ALSA " + std::to_string(id) + "\",\n") +
-        std::string("\"source\": \"http://") + g_daemon_address + ":" +
-        std::to_string(g_daemon_port) + std::string("/api/source/sdp/") +
-        std::to_string(id) + "\"\n}";
+        std::string("\"source\": \"") + source + "\"\n}";
     std::string url = std::string("/api/sink/") + std::to_string(id);
     auto res = cli_.Put(url.c_str(), json, "application/json");
     BOOST_REQUIRE_MESSAGE(res != nullptr, "server returned response");
-    return (res->status == 200);
+    return res->status;
   }
 
   bool remove_sink(int id) {
@@ -329,6 +427,30 @@ struct Client {
     }
   }
 
+  /* return the arrival time of the SAP announcements received in duration */
+  std::vector<std::chrono::steady_clock::time_point> sap_capture_announcements(
+      std::chrono::milliseconds duration) {
+    using namespace std::chrono;
+    char data[g_udp_size];
+    std::vector<steady_clock::time_point> timepoints;
+    socket_.non_blocking(true);
+    boost::system::error_code ec;
+    // discard the packets already queued
+    while (socket_.receive(boost::asio::buffer(data, g_udp_size), 0, ec) > 0) {
+    }
+    auto end = steady_clock::now() + duration;
+    while (steady_clock::now() < end) {
+      auto len = socket_.receive(boost::asio::buffer(data, g_udp_size), 0, ec);
+      if (ec) {
+        std::this_thread::sleep_for(microseconds(100));
+      } else if (len > g_sap_header_len && data[0] == 0x20) {
+        timepoints.push_back(steady_clock::now());
+      }
+    }
+    socket_.non_blocking(false);
+    return timepoints;
+  }
+
   bool sap_wait_deletion(int id, const std::string& sdp, int count = 1) {
     char data[g_udp_size];
     while (count-- > 0) {
@@ -346,6 +468,67 @@ struct Client {
     return true;
   }
 
+  void sap_send(bool is_announce,
+                uint16_t msg_id_hash,
+                const std::string& sdp,
+                bool compress = false) {
+    char data[g_udp_size];
+    size_t length = g_sap_header_len + sdp.length();
+    data[0] = is_announce ? 0x20 : 0x24;
+    data[1] = 0;
+    memcpy(data + 2, &msg_id_hash, 2);
+#if BOOST_VERSION < 108700
+    auto addr =
+        htonl(address::from_string(g_daemon_address).to_v4().to_ulong());
+#else
+    auto addr = htonl(make_address(g_daemon_address).to_v4().to_uint());
+#endif
+    memcpy(data + 4, &addr, 4);
+    memcpy(data + 8, "application/sdp", 16); /* include trailing 0 */
+    memcpy(data + g_sap_header_len, sdp.c_str(), sdp.length());
+    if (compress) {
+      std::string payload(data + 8, data + length);
+      uLongf compressed_length = g_udp_size - 8;
+      BOOST_REQUIRE(compress2(reinterpret_cast<Bytef*>(data + 8),
+                              &compressed_length,
+                              reinterpret_cast<const Bytef*>(payload.c_str()),
+                              payload.length(),
+                              Z_DEFAULT_COMPRESSION) == Z_OK);
+      data[0] |= 0x01;
+      length = 8 + compressed_length;
+    }
+    socket_.set_option(multicast::outbound_interface(
+#if BOOST_VERSION < 108700
+        address::from_string(g_daemon_address).to_v4()));
+    socket_.send_to(boost::asio::buffer(data, length),
+                    udp::endpoint(address::from_string(g_sap_address),
+                                  g_sap_port));
+#else
+        make_address(g_daemon_address).to_v4()));
+    socket_.send_to(boost::asio::buffer(data, length),
+                    udp::endpoint(make_address(g_sap_address), g_sap_port));
+#endif
+  }
+
+  bool wait_for_sink_sdp(int id, const std::string& sdp) {
+    boost::property_tree::ptree pt;
+    int retry = 1000;
+    while (retry--) {
+      auto json = get_sinks();
+      BOOST_REQUIRE_MESSAGE(json.first, "got sinks");
+      std::stringstream ss(json.second);
+      boost::property_tree::read_json(ss, pt);
+      BOOST_FOREACH (auto const& v, pt.get_child("sinks")) {
+        if (v.second.get<int>("id") == id &&
+            v.second.get<std::string>("sdp") == sdp) {
+          return true;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  }
+
   std::pair<bool, std::string> get_remote_sap_sources() {
     std::string url = std::string("/api/browse/sources/sap");
     auto res = cli_.Get(url.c_str());
@@ -353,6 +536,15 @@ struct Client {
     return {res->status == 200, res->body};
   }
 
+  std::pair<bool, std::string> get_remote_sap_sources_since(uint64_t seq,
+                                                           uint32_t wait = 0) {
+    std::string url = std::string("/api/browse/sources/sap?since=") +
+                      std::to_string(seq) + "&wait=" + std::to_string(wait);
+    auto res = cli_.Get(url.c_str());
+    BOOST_REQUIRE_MESSAGE(res != nullptr, "server returned response");
+    return {res->status == 200, res->body};
+  }
+
   std::pair<bool, std::string> get_remote_mdns_sources() {
     std::string url = std::string("/api/browse/sources/mdns");
     auto res = cli_.Get(url.c_str());
@@ -375,7 +567,7 @@ struct Client {
   }
 
  private:
-  httplib::Client cli_{g_daemon_address, g_daemon_port};
+  httplib::Client cli_;
 #if BOOST_VERSION < 108700
   io_service io_service_;
 #else
@@ -415,9 +607,13 @@ BOOST_AUTO_TEST_CASE(get_config) {
   auto ptp_domain = pt.get<int>("ptp_domain");
   auto ptp_dscp = pt.get<int>("ptp_dscp");
   auto sap_interval = pt.get<int>("sap_interval");
+  auto sap_compression = pt.get<bool>("sap_compression");
+  auto sap_bandwidth_limit = pt.get<int>("sap_bandwidth_limit");
+  auto rtsp_threads = pt.get<int>("rtsp_threads");
   auto syslog_proto = pt.get<std::string>("syslog_proto");
   auto syslog_server = pt.get<std::string>("syslog_server");
   auto status_file = pt.get<std::string>("status_file");
+  auto browser_cache_file = pt.get<std::string>("browser_cache_file");
   auto ptp_status_script = pt.get<std::string>("ptp_status_script");
   auto custom_node_id = pt.get<std::string>("custom_node_id");
   auto node_id = pt.get<std::string>("node_id");
@@ -437,6 +633,12 @@ BOOST_AUTO_TEST_CASE(get_config) {
   auto nmos_registry_port = pt.get<int>("nmos_registry_port");
   auto nmos_node_port = pt.get<int>("nmos_node_port");
   auto nmos_label = pt.get<std::string>("nmos_label");
+  auto http_unix_socket = pt.get<std::string>("http_unix_socket");
+  auto http_control_threads = pt.get<int>("http_control_threads");
+  auto http_control_queue = pt.get<int>("http_control_queue");
+  auto http_read_threads = pt.get<int>("http_read_threads");
+  auto http_read_queue = pt.get<int>("http_read_queue");
+  auto http_stream_threads = pt.get<int>("http_stream_threads");
   BOOST_CHECK_MESSAGE(http_port == 9999, "config as excepcted");
   // BOOST_CHECK_MESSAGE(log_severity == 5, "config as excepcted");
   BOOST_CHECK_MESSAGE(playout_delay == 0, "config as excepcted");
@@ -450,10 +652,14 @@ BOOST_AUTO_TEST_CASE(get_config) {
   BOOST_CHECK_MESSAGE(ptp_domain == 0, "config as excepcted");
   BOOST_CHECK_MESSAGE(ptp_dscp == 46, "config as excepcted");
   BOOST_CHECK_MESSAGE(sap_interval == 1, "config as excepcted");
+  BOOST_CHECK_MESSAGE(sap_compression == false, "config as excepcted");
+  BOOST_CHECK_MESSAGE(sap_bandwidth_limit == 1000000, "config as excepcted");
+  BOOST_CHECK_MESSAGE(rtsp_threads == 2, "config as excepcted");
   BOOST_CHECK_MESSAGE(syslog_proto == "none", "config as excepcted");
   BOOST_CHECK_MESSAGE(syslog_server == "255.255.255.254:1234",
                       "config as excepcted");
   BOOST_CHECK_MESSAGE(status_file == "", "config as excepcted");
+  BOOST_CHECK_MESSAGE(browser_cache_file == "", "config as excepcted");
   BOOST_CHECK_MESSAGE(interface_name == "lo", "config as excepcted");
   BOOST_CHECK_MESSAGE(mac_addr == "00:00:00:00:00:00", "config as excepcted");
   BOOST_CHECK_MESSAGE(ip_addr == "127.0.0.1", "config as excepcted");
@@ -461,7 +667,7 @@ BOOST_AUTO_TEST_CASE(get_config) {
   BOOST_CHECK_MESSAGE(node_id == "test node", "config as excepcted");
   BOOST_CHECK_MESSAGE(custom_node_id == "test node", "config as excepcted");
   BOOST_CHECK_MESSAGE(auto_sinks_update == true, "config as excepcted");
-#ifdef _USE_AVAHI_
+#if defined(_USE_AVAHI_) || defined(_USE_MDNS_BUILTIN_)
   BOOST_CHECK_MESSAGE(mdns_enabled == true, "config as excepcted");
 #else
   BOOST_CHECK_MESSAGE(mdns_enabled == false, "config as excepcted");
@@ -478,6 +684,152 @@ BOOST_AUTO_TEST_CASE(get_config) {
   BOOST_CHECK_MESSAGE(nmos_registry_port == 3410, "config as excepcted");
   BOOST_CHECK_MESSAGE(nmos_node_port == 3418, "config as excepcted");
   BOOST_CHECK_MESSAGE(nmos_label == "AES67 Daemon test", "config as excepcted");
+  BOOST_CHECK_MESSAGE(http_unix_socket == g_daemon_unix_socket,
+                      "config as excepcted");
+  BOOST_CHECK_MESSAGE(http_control_threads == 2, "config as excepcted");
+  BOOST_CHECK_MESSAGE(http_control_queue == 8, "config as excepcted");
+  BOOST_CHECK_MESSAGE(http_read_threads == 4, "config as excepcted");
+  BOOST_CHECK_MESSAGE(http_read_queue == 16, "config as excepcted");
+  BOOST_CHECK_MESSAGE(http_stream_threads == 16, "config as excepcted");
+}
+
+BOOST_AUTO_TEST_CASE(http_lanes) {
+  /* concurrent reads, the lane runs at most http_read_threads of them */
+  constexpr int clients = 8;
+  constexpr int requests = 20;
+  std::vector<std::future<int>> res;
+  for (int i = 0; i < clients; i++) {
+    res.emplace_back(std::async(std::launch::async, []() {
+      httplib::Client http(g_daemon_address, g_daemon_port);
+      int ok = 0;
+      for (int i = 0; i < requests; i++) {
+        auto res = http.Get("/api/sources");
+        if (res && res->status == 200) {
+          ok++;
+        } else {
+          BOOST_CHECK_MESSAGE(res && res->status == 503 &&
+                                  res->has_header("Retry-After"),
+                              "request shed");
+        }
+      }
+      return ok;
+    }));
+  }
+  int ok = 0;
+  for (auto& r : res) {
+    ok += r.get();
+  }
+  BOOST_TEST_MESSAGE("served " << ok << " of " << clients * requests
+                               << " concurrent reads");
+  BOOST_CHECK_MESSAGE(ok == clients * requests, "all the reads served");
+
+  httplib::Client http(g_daemon_address, g_daemon_port);
+  auto lanes = http.Get("/api/http/lanes");
+  BOOST_REQUIRE_MESSAGE(lanes && lanes->status == 200, "got lanes");
+  boost::property_tree::ptree pt;
+  std::stringstream ss(lanes->body);
+  boost::property_tree::read_json(ss, pt);
+  std::set<std::string> names;
+  for (auto const& v : pt.get_child("lanes")) {
+    auto name = v.second.get<std::string>("name");
+    auto workers = v.second.get<int>("workers");
+    auto max_running = v.second.get<int>("max_running");
+    names.insert(name);
+    BOOST_CHECK_MESSAGE(max_running <= workers, "lane " << name << " bounded");
+    if (name == "read") {
+      BOOST_CHECK_MESSAGE(workers == 4, "read lane workers");
+      BOOST_CHECK_MESSAGE(v.second.get<uint64_t>("admitted") >=
+                              uint64_t(clients * requests),
+                          "read requests admitted");
+    }
+  }
+  BOOST_CHECK_MESSAGE(names == std::set<std::string>({"control", "read",
+                                                      "stream"}),
+                      "lanes as expected");
+}
+
+BOOST_AUTO_TEST_CASE(http_lanes_control_saturated) {
+  using namespace std::chrono;
+  /* many keep-alive connections saturate the control lane */
+  constexpr int clients = 64;
+  std::atomic_bool running{true};
+  std::vector<std::future<std::pair<int, int>>> control;
+  for (int i = 0; i < clients; i++) {
+    control.emplace_back(std::async(std::launch::async, [&running]() {
+      httplib::Client http(g_daemon_address, g_daemon_port);
+      http.set_keep_alive(true);
+      int ok = 0, shed = 0;
+      while (running) {
+        auto res = http.Post("/api/ptp/config",
+                             "{ \"domain\": 0, \"dscp\": 46 }",
+                             "application/json");
+        if (res && res->status == 200) {
+          ok++;
+        } else if (res && res->status == 503) {
+          shed++;
+        }
+      }
+      return std::make_pair(ok, shed);
+    }));
+  }
+  std::this_thread::sleep_for(milliseconds(500));
+  /* the reads are served meanwhile */
+  constexpr int reads = 50;
+  int reads_ok = 0;
+  int64_t max_read_ms = 0;
+  for (int i = 0; i < reads; i++) {
+    httplib::Client http(g_daemon_address, g_daemon_port);
+    http.set_read_timeout(5);
+    auto start = steady_clock::now();
+    auto res = http.Get("/api/ptp/status");
+    max_read_ms = std::max<int64_t>(
+        max_read_ms,
+        duration_cast<milliseconds>(steady_clock::now() - start).count());
+    if (res && res->status == 200) {
+      reads_ok++;
+    }
+  }
+  running = false;
+  int control_ok = 0, control_shed = 0;
+  for (auto& c : control) {
+    auto [ok, shed] = c.get();
+    control_ok += ok;
+    control_shed += shed;
+  }
+  BOOST_TEST_MESSAGE("control requests served " << control_ok << " shed "
+                                                << control_shed
+                                                << ", max read latency "
+                                                << max_read_ms << " msecs");
+  BOOST_CHECK_MESSAGE(control_shed > 0, "control lane saturated");
+  BOOST_CHECK_MESSAGE(reads_ok == reads, "all the reads served");
+  BOOST_CHECK_MESSAGE(max_read_ms < 1000, "reads not blocked");
+}
+
+BOOST_AUTO_TEST_CASE(unix_socket_api) {
+  httplib::Client tcp(g_daemon_address, g_daemon_port);
+  httplib::Client local(g_daemon_unix_socket);
+  local.set_address_family(AF_UNIX);
+  auto res = local.Get("/api/version");
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got version via socket");
+  res = local.Get("/api/config");
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got config via socket");
+  auto tcp_res = tcp.Get("/api/config");
+  BOOST_REQUIRE_MESSAGE(tcp_res && tcp_res->status == 200, "got config");
+  BOOST_CHECK_MESSAGE(res->body == tcp_res->body, "same config");
+  /* compare the latency of the two transports */
+  constexpr int requests = 200;
+  for (auto cli : {&tcp, &local}) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; i++) {
+      res = cli->Get("/api/version");
+      BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got version");
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    BOOST_TEST_MESSAGE((cli == &tcp ? "tcp" : "unix socket")
+                       << ": avg " << elapsed / requests << " usecs");
+  }
 }
 
 BOOST_AUTO_TEST_CASE(get_ptp_status) {
@@ -528,18 +880,212 @@ BOOST_AUTO_TEST_CASE(set_ptp_config) {
   BOOST_REQUIRE_MESSAGE(res, "set default ptp config");
 }
 
+BOOST_AUTO_TEST_CASE(set_config_sap_bandwidth_limit) {
+  Client cli;
+  // a zero limit falls back to the RFC 2974 one as in the config file
+  BOOST_REQUIRE_MESSAGE(cli.set_config(R"({ "sap_bandwidth_limit": 0 })"),
+                        "set zero SAP bandwidth limit");
+  auto json = cli.get_config();
+  BOOST_REQUIRE_MESSAGE(json.first, "got new config");
+  boost::property_tree::ptree pt;
+  std::stringstream ss(json.second);
+  boost::property_tree::read_json(ss, pt);
+  BOOST_REQUIRE_MESSAGE(pt.get<int>("sap_bandwidth_limit") == 4000,
+                        "SAP bandwidth limit as excepcted");
+  // a SAP round runs with the new limit
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  auto sdp = cli.get_source_sdp(0);
+  BOOST_REQUIRE_MESSAGE(sdp.first, "got source sdp 0");
+  cli.sap_wait_announcement(0, sdp.second);
+  BOOST_REQUIRE_MESSAGE(cli.is_alive(), "daemon alive");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+  BOOST_REQUIRE_MESSAGE(
+      cli.set_config(R"({ "sap_bandwidth_limit": 1000000 })"),
+      "set default SAP bandwidth limit");
+}
+
 BOOST_AUTO_TEST_CASE(add_invalid_source) {
   Client cli;
-  BOOST_REQUIRE_MESSAGE(!cli.add_source(g_stream_num_max),
-                        "not added source " + std::to_string(g_stream_num_max));
+  BOOST_REQUIRE_MESSAGE(
+      !cli.add_source(g_stream_id_max + 1),
+      "not added source " + std::to_string(g_stream_id_max + 1));
   BOOST_REQUIRE_MESSAGE(!cli.add_source(-1), "not added source -1");
 }
 
+BOOST_AUTO_TEST_CASE(add_malformed_source) {
+  httplib::Client cli(g_daemon_address, g_daemon_port);
+  // the error reports the position of the invalid value
+  std::string json =
+      "{\"enabled\": true,\n \"name\": \"ALSA\",\n \"ttl\": 300}";
+  auto res = cli.Put("/api/source/0", json, "application/json");
+  BOOST_REQUIRE_MESSAGE(res && res->status == 400, "source not added");
+  BOOST_CHECK_MESSAGE(
+      res->body.find("line 3 column 9: number out of range") !=
+          std::string::npos,
+      "error position reported: " + res->body);
+  json = "{\"enabled\": true}";
+  res = cli.Put("/api/source/0", json, "application/json");
+  BOOST_REQUIRE_MESSAGE(res && res->status == 400, "source not added");
+  BOOST_CHECK_MESSAGE(res->body.find("missing member name") !=
+                          std::string::npos,
+                      "missing member reported: " + res->body);
+}
+
+BOOST_AUTO_TEST_CASE(conditional_get) {
+  Client cli;
+  httplib::Client http(g_daemon_address, g_daemon_port);
+  for (auto path : {"/api/sources", "/api/sinks", "/api/streams",
+                    "/api/config", "/api/ptp/config"}) {
+    auto res = http.Get(path);
+    BOOST_REQUIRE_MESSAGE(res && res->status == 200,
+                          std::string("got ") + path);
+    auto etag = res->get_header_value("ETag");
+    BOOST_REQUIRE_MESSAGE(!etag.empty(), std::string("ETag for ") + path);
+    res = http.Get(path, {{"If-None-Match", etag}});
+    BOOST_REQUIRE_MESSAGE(res && res->status == 304,
+                          std::string("not modified ") + path);
+    BOOST_CHECK_MESSAGE(res->body.empty(), std::string("no body ") + path);
+  }
+  auto res = http.Get("/api/sources");
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got sources");
+  auto etag = res->get_header_value("ETag");
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  res = http.Get("/api/sources", {{"If-None-Match", etag}});
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "sources modified");
+  BOOST_CHECK_MESSAGE(res->get_header_value("ETag") != etag, "new ETag");
+  BOOST_CHECK_MESSAGE(res->body.find("\"id\": 0") != std::string::npos,
+                      "source 0 returned");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+}
+
+BOOST_AUTO_TEST_CASE(conditional_get_remote_sources) {
+  httplib::Client http(g_daemon_address, g_daemon_port);
+  auto res = http.Get("/api/browse/sources/all");
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got remote sources");
+  auto etag = res->get_header_value("ETag");
+  BOOST_REQUIRE_MESSAGE(!etag.empty(), "ETag for remote sources");
+  // the ETag doesn't depend on the time, the reply reports its Age instead
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  res = http.Get("/api/browse/sources/all", {{"If-None-Match", etag}});
+  BOOST_REQUIRE_MESSAGE(res && res->status == 304,
+                        "remote sources not modified");
+  BOOST_REQUIRE_MESSAGE(res->has_header("Age"), "Age of remote sources");
+  BOOST_CHECK_MESSAGE(std::stoi(res->get_header_value("Age")) >= 1,
+                      "remote sources aged");
+}
+
+BOOST_AUTO_TEST_CASE(web_ui_assets) {
+  /* the test daemon serves the current directory */
+  std::ifstream fs("./CMakeLists.txt");
+  std::stringstream content;
+  content << fs.rdbuf();
+  httplib::Client http(g_daemon_address, g_daemon_port);
+  auto res = http.Get("/CMakeLists.txt");
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got file");
+  BOOST_CHECK_MESSAGE(res->body == content.str(), "file content");
+  BOOST_CHECK_MESSAGE(res->get_header_value("Cache-Control") == "no-cache",
+                      "file revalidated");
+  auto etag = res->get_header_value("ETag");
+  res = http.Get("/CMakeLists.txt", {{"Accept-Encoding", "gzip, br"}});
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got compressed file");
+  BOOST_CHECK_MESSAGE(res->get_header_value("Content-Encoding") == "gzip",
+                      "gzip variant");
+  BOOST_CHECK_MESSAGE(res->body.substr(0, 2) == "\x1f\x8b", "gzip body");
+  BOOST_CHECK_MESSAGE(res->body.length() < content.str().length(),
+                      "compressed body");
+  BOOST_CHECK_MESSAGE(res->get_header_value("ETag") != etag,
+                      "variant ETag");
+  res = http.Get("/CMakeLists.txt", {{"If-None-Match", etag}});
+  BOOST_REQUIRE_MESSAGE(res && res->status == 304, "file not modified");
+  res = http.Get("/not_found.js");
+  BOOST_REQUIRE_MESSAGE(res && res->status == 404, "file not found");
+}
+
+BOOST_AUTO_TEST_CASE(events_stream) {
+  Client cli;
+  /* read the event stream until an event of the type is received */
+  auto read_event = [](const httplib::Headers& headers,
+                       const std::string& type) {
+    return std::async(std::launch::async, [headers, type]() {
+      httplib::Client http(g_daemon_address, g_daemon_port);
+      http.set_read_timeout(20);
+      std::string stream;
+      http.Get("/api/events", headers, [&](const char* data, size_t len) {
+        stream.append(data, len);
+        return stream.find("event: " + type + "\n") == std::string::npos;
+      });
+      auto pos = stream.find("event: " + type + "\n");
+      if (pos == std::string::npos) {
+        return std::string();
+      }
+      auto begin = stream.rfind("id: ", pos);
+      auto end = stream.find("\n\n", pos);
+      return begin == std::string::npos || end == std::string::npos
+                 ? std::string()
+                 : stream.substr(begin, end - begin);
+    });
+  };
+  auto fut = read_event({}, "source");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  BOOST_REQUIRE_MESSAGE(
+      fut.wait_for(std::chrono::seconds(5)) == std::future_status::ready,
+      "source event received");
+  auto event = fut.get();
+  BOOST_TEST_MESSAGE(event);
+  BOOST_REQUIRE_MESSAGE(event.find("\"action\": \"add\"") != std::string::npos,
+                        "add source event");
+  auto id = event.substr(4, event.find('\n') - 4);
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+  /* resume after the add event, the remove event is sent immediately */
+  event = read_event({{"Last-Event-ID", id}}, "source").get();
+  BOOST_TEST_MESSAGE(event);
+  BOOST_CHECK_MESSAGE(
+      event.find("\"action\": \"remove\"") != std::string::npos,
+      "remove source event after resume");
+  /* unknown event id, the client is told to reload the state */
+  event = read_event({{"Last-Event-ID", "unknown-1"}}, "reset").get();
+  BOOST_CHECK_MESSAGE(!event.empty(), "reset event");
+}
+
+BOOST_AUTO_TEST_CASE(observers_stats) {
+  Client cli;
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+  httplib::Client http(g_daemon_address, g_daemon_port);
+  boost::property_tree::ptree pt;
+  bool found = false;
+  int retry = 100;
+  while (!found && retry--) {
+    auto res = http.Get("/api/observers");
+    BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got observers");
+    std::stringstream ss(res->body);
+    boost::property_tree::read_json(ss, pt);
+    for (auto const& v : pt.get_child("observers")) {
+      // the HTTP server observes the sources for the event stream
+      if (v.second.get<std::string>("name") == "http_server" &&
+          v.second.get<uint64_t>("dispatched") >= 2) {
+        found = true;
+        BOOST_CHECK_MESSAGE(v.second.get<uint64_t>("dropped") == 0,
+                            "no notifications dropped");
+        // add and remove are transitions, never coalesced
+        BOOST_CHECK_MESSAGE(v.second.get<uint64_t>("dispatched") +
+                                    v.second.get<uint64_t>("coalesced") +
+                                    v.second.get<uint64_t>("depth") >=
+                                v.second.get<uint64_t>("posted"),
+                            "notifications accounted");
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  BOOST_REQUIRE_MESSAGE(found, "http_server observer notified");
+}
+
 BOOST_AUTO_TEST_CASE(remove_invalid_source) {
   Client cli;
   BOOST_REQUIRE_MESSAGE(
-      !cli.remove_source(g_stream_num_max),
-      "not removed source " + std::to_string(g_stream_num_max));
+      !cli.remove_source(g_stream_id_max + 1),
+      "not removed source " + std::to_string(g_stream_id_max + 1));
   BOOST_REQUIRE_MESSAGE(!cli.remove_source(-1), "not removed source -1");
 }
 
@@ -579,6 +1125,29 @@ BOOST_AUTO_TEST_CASE(source_check_sap) {
   cli.sap_wait_deletion(0, sdp.second, 3);
 }
 
+BOOST_AUTO_TEST_CASE(source_check_sap_idle) {
+  using namespace std::chrono;
+  Client cli;
+  // let the pending deletions go, the SAP timer is then no longer armed
+  std::this_thread::sleep_for(seconds(4));
+  auto capture = std::async(std::launch::async, [&cli]() {
+    return cli.sap_capture_announcements(milliseconds(2000));
+  });
+  std::this_thread::sleep_for(milliseconds(200));
+  auto start = steady_clock::now();
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  auto timepoints = capture.get();
+  BOOST_REQUIRE_MESSAGE(!timepoints.empty(),
+                        "SAP announcement received in the capture window");
+  auto elapsed = duration_cast<milliseconds>(timepoints.front() - start);
+  BOOST_TEST_MESSAGE("first SAP announcement " +
+                     std::to_string(elapsed.count()) +
+                     " msecs after the source was added");
+  BOOST_CHECK_MESSAGE(elapsed < milliseconds(1000),
+                      "first SAP announcement sent immediately");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+}
+
 BOOST_AUTO_TEST_CASE(source_check_sap_browser) {
   Client cli;
   BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
@@ -605,7 +1174,7 @@ BOOST_AUTO_TEST_CASE(source_check_sap_browser) {
                         "no remote sap sources");
 }
 
-#ifdef _USE_AVAHI_
+#if defined(_USE_AVAHI_) || defined(_USE_MDNS_BUILTIN_)
 BOOST_AUTO_TEST_CASE(source_check_mdns_browser) {
   Client cli;
   BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
@@ -657,6 +1226,456 @@ BOOST_AUTO_TEST_CASE(source_check_mdns_browser_update) {
   BOOST_REQUIRE_MESSAGE(cli.wait_for_remote_mdns_sources(0),
                         "no remote mdns sources");
 }
+
+BOOST_AUTO_TEST_CASE(mdns_browser_discovery_latency) {
+  using namespace std::chrono;
+  constexpr int rounds = 5;
+  Client cli;
+  auto count_sources = [&cli]() {
+    auto json = cli.get_remote_mdns_sources();
+    BOOST_REQUIRE_MESSAGE(json.first, "got remote mdns sources");
+    boost::property_tree::ptree pt;
+    std::stringstream ss(json.second);
+    boost::property_tree::read_json(ss, pt);
+    return pt.get_child("remote_sources").size();
+  };
+  // time from the source add or remove to the browser update
+  auto wait_for = [&count_sources](size_t num) {
+    auto start = steady_clock::now();
+    while (count_sources() != num &&
+           steady_clock::now() - start < seconds(10)) {
+      std::this_thread::sleep_for(milliseconds(5));
+    }
+    return duration_cast<milliseconds>(steady_clock::now() - start).count();
+  };
+  int64_t add_max = 0, add_sum = 0, remove_max = 0, remove_sum = 0;
+  for (int i = 0; i < rounds; i++) {
+    BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+    auto add_msecs = wait_for(1);
+    BOOST_REQUIRE_MESSAGE(count_sources() == 1, "remote mdns source found");
+    BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+    auto remove_msecs = wait_for(0);
+    BOOST_REQUIRE_MESSAGE(count_sources() == 0, "no remote mdns sources");
+    add_sum += add_msecs;
+    add_max = std::max(add_max, add_msecs);
+    remove_sum += remove_msecs;
+    remove_max = std::max(remove_max, remove_msecs);
+  }
+#ifdef _USE_MDNS_BUILTIN_
+  std::string backend("built-in responder");
+#else
+  std::string backend("Avahi");
+#endif
+  BOOST_TEST_MESSAGE("mDNS discovery latency with " + backend + " avg " +
+                     std::to_string(add_sum / rounds) + " msecs max " +
+                     std::to_string(add_max) + " msecs, removal avg " +
+                     std::to_string(remove_sum / rounds) + " msecs max " +
+                     std::to_string(remove_max) + " msecs");
+}
+#endif
+
+#ifdef _USE_NMOS_
+constexpr static uint16_t g_nmos_daemon_port = 9996;
+constexpr static uint16_t g_nmos_node_port = 3418;
+constexpr static const char g_nmos_registry_address[] = "127.0.0.2";
+constexpr static uint16_t g_nmos_registry_port = 3410;
+constexpr static const char g_nmos_senders[] =
+    "/x-nmos/connection/v1.1/single/senders/";
+constexpr static const char g_nmos_receiver_1[] =
+    "00000000-0000-0000-0000-000000000001";
+constexpr static const char g_nmos_receiver_2[] =
+    "00000000-0000-0000-0000-000000000002";
+
+static boost::property_tree::ptree nmos_get(const std::string& url) {
+  httplib::Client http(g_daemon_address, g_nmos_node_port);
+  auto res = http.Get(url.c_str());
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got " + url);
+  boost::property_tree::ptree pt;
+  std::stringstream ss(res->body);
+  boost::property_tree::read_json(ss, pt);
+  return pt;
+}
+
+/* IS-05 id of the sender of the only source, "" if not registered */
+static std::string nmos_get_sender_id() {
+  httplib::Client http(g_daemon_address, g_nmos_node_port);
+  auto res = http.Get(g_nmos_senders);
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got IS-05 senders");
+  auto begin = res->body.find('"');
+  auto end = res->body.find("/\"", begin);
+  if (begin == std::string::npos || end == std::string::npos) {
+    return "";
+  }
+  return res->body.substr(begin + 1, end - begin - 1);
+}
+
+static std::string nmos_wait_sender() {
+  int retry = 100;
+  while (retry--) {
+    auto id = nmos_get_sender_id();
+    if (!id.empty()) {
+      return id;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return "";
+}
+
+static bool nmos_wait_no_sender() {
+  int retry = 100;
+  while (retry--) {
+    if (nmos_get_sender_id().empty()) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+static bool nmos_patch_sender(const std::string& id, const std::string& json) {
+  httplib::Client http(g_daemon_address, g_nmos_node_port);
+  std::string url = g_nmos_senders + id + "/staged";
+  auto res = http.Patch(url.c_str(), json, "application/json");
+  BOOST_REQUIRE_MESSAGE(res != nullptr, "server returned response");
+  return res->status == 200;
+}
+
+static std::string nmos_sender_activation(const std::string& receiver_id,
+                                          const std::string& mode,
+                                          const std::string& requested_time) {
+  return "{\"receiver_id\": \"" + receiver_id + "\", \"activation\": " +
+         "{\"mode\": \"" + mode + "\", \"requested_time\": \"" +
+         requested_time + "\"}}";
+}
+
+/* wait for the active receiver of the sender, the elapsed msecs or -1 */
+static int nmos_wait_sender_active(const std::string& id,
+                                   const std::string& receiver_id,
+                                   int timeout_msecs) {
+  auto start = std::chrono::steady_clock::now();
+  int elapsed = 0;
+  while (elapsed <= timeout_msecs) {
+    auto pt = nmos_get(g_nmos_senders + id + "/active");
+    if (pt.get<std::string>("receiver_id") == receiver_id) {
+      return elapsed;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  }
+  return -1;
+}
+
+/* IS-04 registry counting the resources registered by the daemon */
+struct NmosRegistry {
+  NmosRegistry() {
+    svr_.Post("/x-nmos/registration/v1.3/resource",
+              [](const httplib::Request& req, httplib::Response& res) {
+                boost::property_tree::ptree pt;
+                std::stringstream ss(req.body);
+                boost::property_tree::read_json(ss, pt);
+                std::lock_guard lock(mutex_);
+                registered_[pt.get<std::string>("type")]++;
+                res.status = 201;
+              });
+    svr_.Delete(R"(/x-nmos/registration/v1.3/resource/.*)",
+                [](const httplib::Request&, httplib::Response& res) {
+                  res.status = 204;
+                });
+    svr_.Post(R"(/x-nmos/registration/v1.3/health/nodes/.*)",
+              [](const httplib::Request&, httplib::Response& res) {
+                res.status = 200;
+              });
+    thread_ = std::thread([this]() {
+      svr_.listen(g_nmos_registry_address, g_nmos_registry_port);
+    });
+    int retry = 100;
+    while (!svr_.is_running() && retry--) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  ~NmosRegistry() {
+    svr_.stop();
+    thread_.join();
+  }
+
+  static void reset() {
+    std::lock_guard lock(mutex_);
+    registered_.clear();
+  }
+
+  static int registered(const std::string& type) {
+    std::lock_guard lock(mutex_);
+    return registered_[type];
+  }
+
+  /* wait for at least num registrations of type */
+  static bool wait_registered(const std::string& type, int num) {
+    int retry = 300;
+    while (registered(type) < num && retry--) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return registered(type) >= num;
+  }
+
+ private:
+  httplib::Server svr_;
+  std::thread thread_;
+  inline static std::mutex mutex_;
+  inline static std::map<std::string, int> registered_;
+};
+
+/* NMOS enabled daemon instance used by the NMOS test suite only */
+struct NmosDaemonInstance {
+  NmosDaemonInstance() {
+    BOOST_TEST_MESSAGE("Starting up NMOS test daemon instance ...");
+    int retry = 10;
+    while (retry-- && daemon_.running()) {
+      httplib::Client cli(g_daemon_address, g_nmos_daemon_port);
+      auto res = cli.Get("/");
+      if (res) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    BOOST_REQUIRE(daemon_.running());
+  }
+
+  ~NmosDaemonInstance() {
+    BOOST_TEST_MESSAGE("Tearing down NMOS test daemon instance...");
+    kill(daemon_.native_handle(), SIGTERM);
+    std::error_code ec;
+    daemon_.wait(ec);
+    BOOST_CHECK_MESSAGE(!daemon_.exit_code(), "NMOS daemon exited normally");
+  }
+
+ private:
+  NmosRegistry registry_;  // running before the daemon registers
+  child daemon_{"../aes67-daemon", "-c", "daemon_nmos.conf", "-p",
+                std::to_string(g_nmos_daemon_port)};
+};
+
+BOOST_AUTO_TEST_SUITE(nmos, *boost::unit_test::fixture<NmosDaemonInstance>())
+
+BOOST_AUTO_TEST_CASE(nmos_activation_relative) {
+  Client cli(g_nmos_daemon_port);
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  auto id = nmos_wait_sender();
+  BOOST_REQUIRE_MESSAGE(!id.empty(), "got IS-05 sender");
+  auto count = nmos_get("/x-aes67/activations").get<uint64_t>("activations");
+  BOOST_REQUIRE_MESSAGE(
+      nmos_patch_sender(id, nmos_sender_activation(
+                                g_nmos_receiver_1,
+                                "activate_scheduled_relative", "0:500000000")),
+      "scheduled relative activation");
+  BOOST_CHECK_MESSAGE(nmos_get(g_nmos_senders + id + "/active")
+                              .get<std::string>("receiver_id") !=
+                          g_nmos_receiver_1,
+                      "activation not applied before its time");
+  BOOST_CHECK_MESSAGE(
+      nmos_get("/x-aes67/activations").get<uint64_t>("pending") == 1,
+      "activation pending");
+  auto elapsed = nmos_wait_sender_active(id, g_nmos_receiver_1, 5000);
+  BOOST_REQUIRE_MESSAGE(elapsed >= 0, "relative activation applied");
+  BOOST_TEST_MESSAGE("relative activation applied after " +
+                     std::to_string(elapsed) + " msecs");
+  auto active = nmos_get(g_nmos_senders + id + "/active");
+  BOOST_CHECK_MESSAGE(active.get<std::string>("activation.mode") ==
+                          "activate_scheduled_relative",
+                      "active activation mode");
+  BOOST_CHECK_MESSAGE(active.get<std::string>("activation.activation_time") !=
+                          "null",
+                      "active activation time");
+  auto staged = nmos_get(g_nmos_senders + id + "/staged");
+  BOOST_CHECK_MESSAGE(staged.get<std::string>("activation.mode") == "null",
+                      "staged activation reset");
+  auto stats = nmos_get("/x-aes67/activations");
+  BOOST_CHECK_MESSAGE(stats.get<uint64_t>("activations") == count + 1,
+                      "activation counted");
+  BOOST_CHECK_MESSAGE(stats.get<uint64_t>("pending") == 0,
+                      "no activation pending");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+  BOOST_REQUIRE_MESSAGE(nmos_wait_no_sender(), "IS-05 sender removed");
+}
+
+BOOST_AUTO_TEST_CASE(nmos_activation_absolute_past) {
+  Client cli(g_nmos_daemon_port);
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  auto id = nmos_wait_sender();
+  BOOST_REQUIRE_MESSAGE(!id.empty(), "got IS-05 sender");
+  // a requested time in the past activates as soon as possible
+  BOOST_REQUIRE_MESSAGE(
+      nmos_patch_sender(id, nmos_sender_activation(
+                                g_nmos_receiver_1,
+                                "activate_scheduled_absolute", "1:0")),
+      "scheduled absolute activation");
+  auto elapsed = nmos_wait_sender_active(id, g_nmos_receiver_1, 1000);
+  BOOST_REQUIRE_MESSAGE(elapsed >= 0, "past absolute activation applied");
+  auto active = nmos_get(g_nmos_senders + id + "/active");
+  BOOST_CHECK_MESSAGE(active.get<std::string>("activation.mode") ==
+                          "activate_scheduled_absolute",
+                      "active activation mode");
+  BOOST_CHECK_MESSAGE(active.get<std::string>("activation.requested_time") ==
+                          "1:0",
+                      "active requested time");
+  BOOST_CHECK_MESSAGE(
+      nmos_get("/x-aes67/activations").get<uint64_t>("pending") == 0,
+      "no activation pending");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+  BOOST_REQUIRE_MESSAGE(nmos_wait_no_sender(), "IS-05 sender removed");
+}
+
+BOOST_AUTO_TEST_CASE(nmos_activation_replace) {
+  Client cli(g_nmos_daemon_port);
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  auto id = nmos_wait_sender();
+  BOOST_REQUIRE_MESSAGE(!id.empty(), "got IS-05 sender");
+  auto count = nmos_get("/x-aes67/activations").get<uint64_t>("activations");
+  BOOST_REQUIRE_MESSAGE(
+      nmos_patch_sender(
+          id, nmos_sender_activation(g_nmos_receiver_1,
+                                     "activate_scheduled_relative", "2:0")),
+      "scheduled relative activation");
+  // the second PATCH replaces the scheduled activation
+  BOOST_REQUIRE_MESSAGE(
+      nmos_patch_sender(id, nmos_sender_activation(
+                                g_nmos_receiver_2,
+                                "activate_scheduled_relative", "0:300000000")),
+      "replaced relative activation");
+  BOOST_CHECK_MESSAGE(
+      nmos_get("/x-aes67/activations").get<uint64_t>("pending") == 1,
+      "one activation pending");
+  BOOST_REQUIRE_MESSAGE(nmos_wait_sender_active(id, g_nmos_receiver_2, 3000) >= 0,
+                        "replacing activation applied");
+  // past the deadline of the replaced activation
+  std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+  BOOST_CHECK_MESSAGE(nmos_get(g_nmos_senders + id + "/active")
+                              .get<std::string>("receiver_id") ==
+                          g_nmos_receiver_2,
+                      "replaced activation not applied");
+  BOOST_CHECK_MESSAGE(nmos_get(g_nmos_senders + id + "/staged")
+                              .get<std::string>("activation.mode") == "null",
+                      "staged activation reset");
+  auto stats = nmos_get("/x-aes67/activations");
+  BOOST_CHECK_MESSAGE(stats.get<uint64_t>("activations") == count + 1,
+                      "one activation applied");
+  BOOST_CHECK_MESSAGE(stats.get<uint64_t>("pending") == 0,
+                      "no activation pending");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+  BOOST_REQUIRE_MESSAGE(nmos_wait_no_sender(), "IS-05 sender removed");
+}
+
+BOOST_AUTO_TEST_CASE(nmos_activation_cancel) {
+  Client cli(g_nmos_daemon_port);
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  auto id = nmos_wait_sender();
+  BOOST_REQUIRE_MESSAGE(!id.empty(), "got IS-05 sender");
+  auto count = nmos_get("/x-aes67/activations").get<uint64_t>("activations");
+  BOOST_REQUIRE_MESSAGE(
+      nmos_patch_sender(id, nmos_sender_activation(
+                                g_nmos_receiver_1,
+                                "activate_scheduled_relative", "0:500000000")),
+      "scheduled relative activation");
+  BOOST_REQUIRE_MESSAGE(
+      nmos_patch_sender(id, R"({"activation": {"mode": null}})"),
+      "cancelled activation");
+  BOOST_CHECK_MESSAGE(
+      nmos_get("/x-aes67/activations").get<uint64_t>("pending") == 0,
+      "no activation pending");
+  // past the deadline of the cancelled activation
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  BOOST_CHECK_MESSAGE(nmos_get(g_nmos_senders + id + "/active")
+                              .get<std::string>("receiver_id") !=
+                          g_nmos_receiver_1,
+                      "cancelled activation not applied");
+  BOOST_CHECK_MESSAGE(nmos_get(g_nmos_senders + id + "/staged")
+                              .get<std::string>("activation.mode") == "null",
+                      "staged activation cancelled");
+  BOOST_CHECK_MESSAGE(
+      nmos_get("/x-aes67/activations").get<uint64_t>("activations") == count,
+      "no activation applied");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+  BOOST_REQUIRE_MESSAGE(nmos_wait_no_sender(), "IS-05 sender removed");
+}
+
+/* versions of the IS-04 resources of type, by resource id */
+static std::map<std::string, std::string> nmos_versions(
+    const std::string& type) {
+  std::map<std::string, std::string> versions;
+  auto pt = nmos_get("/x-nmos/node/v1.3/" + type + "/");
+  BOOST_FOREACH (auto const& v, pt) {
+    versions[v.second.get<std::string>("id")] =
+        v.second.get<std::string>("version");
+  }
+  return versions;
+}
+
+/* number of resources with a version different from the previous one */
+static size_t nmos_changed(const std::map<std::string, std::string>& before,
+                           const std::map<std::string, std::string>& after) {
+  size_t changed = 0;
+  for (const auto& [id, version] : after) {
+    auto it = before.find(id);
+    if (it == before.end() || it->second != version) {
+      changed++;
+    }
+  }
+  return changed;
+}
+
+BOOST_AUTO_TEST_CASE(nmos_resource_versions) {
+  using namespace std::chrono;
+  Client cli(g_nmos_daemon_port);
+  NmosRegistry::reset();
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  BOOST_REQUIRE_MESSAGE(cli.add_source(1), "added source 1");
+  BOOST_REQUIRE_MESSAGE(NmosRegistry::wait_registered("sender", 2),
+                        "senders registered");
+  std::this_thread::sleep_for(milliseconds(500));
+  auto sources = nmos_versions("sources");
+  auto flows = nmos_versions("flows");
+  auto senders = nmos_versions("senders");
+  auto devices = nmos_versions("devices");
+  BOOST_REQUIRE_MESSAGE(senders.size() == 2, "two senders");
+
+  // the update removes and adds source 0 again, only the codec changes
+  NmosRegistry::reset();
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0, "L24"), "updated source 0");
+  BOOST_REQUIRE_MESSAGE(NmosRegistry::wait_registered("flow", 1),
+                        "flow registered");
+  std::this_thread::sleep_for(milliseconds(500));
+  BOOST_CHECK_MESSAGE(nmos_changed(flows, nmos_versions("flows")) == 1,
+                      "only the flow of source 0 changed");
+  BOOST_CHECK_MESSAGE(nmos_changed(sources, nmos_versions("sources")) == 0,
+                      "sources unchanged");
+  BOOST_CHECK_MESSAGE(nmos_changed(senders, nmos_versions("senders")) == 0,
+                      "senders unchanged");
+  BOOST_CHECK_MESSAGE(nmos_versions("devices") == devices, "device unchanged");
+  BOOST_CHECK_MESSAGE(NmosRegistry::registered("flow") == 1,
+                      "one flow registered");
+  BOOST_CHECK_MESSAGE(NmosRegistry::registered("source") == 0 &&
+                          NmosRegistry::registered("sender") == 0 &&
+                          NmosRegistry::registered("device") == 0,
+                      "nothing else registered");
+
+  // removing a sender re-renders and registers the device once
+  NmosRegistry::reset();
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(1), "removed source 1");
+  BOOST_REQUIRE_MESSAGE(NmosRegistry::wait_registered("device", 1),
+                        "device registered");
+  std::this_thread::sleep_for(milliseconds(500));
+  BOOST_CHECK_MESSAGE(nmos_versions("devices") != devices, "device changed");
+  BOOST_CHECK_MESSAGE(NmosRegistry::registered("device") == 1,
+                      "device registered once");
+  BOOST_CHECK_MESSAGE(nmos_versions("senders").size() == 1, "one sender");
+
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+  BOOST_REQUIRE_MESSAGE(nmos_wait_no_sender(), "IS-05 sender removed");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
 #endif
 
 BOOST_AUTO_TEST_CASE(sink_check_status) {
@@ -676,6 +1695,454 @@ BOOST_AUTO_TEST_CASE(sink_check_status) {
   BOOST_REQUIRE_MESSAGE(cli.remove_sink(0), "removed sink 0");
 }
 
+BOOST_AUTO_TEST_CASE(sink_check_sap_update) {
+  Client cli;
+  BOOST_REQUIRE_MESSAGE(cli.add_sink_sdp(0), "added sink 0");
+  auto json = cli.get_sinks();
+  BOOST_REQUIRE_MESSAGE(json.first, "got sinks");
+  boost::property_tree::ptree pt;
+  std::stringstream ss(json.second);
+  boost::property_tree::read_json(ss, pt);
+  auto sdp = pt.get_child("sinks").front().second.get<std::string>("sdp");
+  // announce a newer version of the sink source and wait for the update
+  boost::replace_first(sdp, "o=- 1 0 ", "o=- 1 1 ");
+  auto start = std::chrono::steady_clock::now();
+  cli.sap_send(true, 0x1234, sdp);
+  BOOST_REQUIRE_MESSAGE(cli.wait_for_sink_sdp(0, sdp), "sink 0 updated");
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  BOOST_TEST_MESSAGE("sink updated " + std::to_string(elapsed) +
+                     " msecs after SAP announcement");
+  cli.sap_send(false, 0x1234, sdp);
+  BOOST_REQUIRE_MESSAGE(cli.remove_sink(0), "removed sink 0");
+}
+
+BOOST_AUTO_TEST_CASE(sap_browser_compressed) {
+  Client cli;
+  const std::string sdp(g_sdp_dup);
+  auto find_source = [&cli, &sdp]() {
+    auto json = cli.get_remote_sap_sources();
+    BOOST_REQUIRE_MESSAGE(json.first, "got remote sap sources");
+    boost::property_tree::ptree pt;
+    std::stringstream ss(json.second);
+    boost::property_tree::read_json(ss, pt);
+    BOOST_FOREACH (auto const& v, pt.get_child("remote_sources")) {
+      if (v.second.get<std::string>("sdp") == sdp) {
+        return true;
+      }
+    }
+    return false;
+  };
+  cli.sap_send(true, 0x4321, sdp, true);
+  int retry = 50;
+  while (!find_source() && retry--) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  BOOST_REQUIRE_MESSAGE(find_source(), "compressed SAP source found");
+  cli.sap_send(false, 0x4321, sdp, true);
+  retry = 50;
+  while (find_source() && retry--) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  BOOST_REQUIRE_MESSAGE(!find_source(), "compressed SAP source removed");
+}
+
+BOOST_AUTO_TEST_CASE(sap_browser_delta) {
+  using namespace std::chrono;
+  Client cli;
+  const std::string sdp(g_sdp_dup);
+  auto parse = [](const std::string& json) {
+    boost::property_tree::ptree pt;
+    std::stringstream ss(json);
+    boost::property_tree::read_json(ss, pt);
+    return pt;
+  };
+  auto json = cli.get_remote_sap_sources_since(0);
+  BOOST_REQUIRE_MESSAGE(json.first, "got remote sap sources since 0");
+  auto seq = parse(json.second).get<uint64_t>("seq");
+
+  // long-poll returns as soon as the source is announced
+  auto start = steady_clock::now();
+  auto poll = std::async(std::launch::async, [seq]() {
+    Client cli;
+    return cli.get_remote_sap_sources_since(seq, 3);
+  });
+  std::this_thread::sleep_for(milliseconds(200));
+  cli.sap_send(true, 0x5678, sdp);
+  json = poll.get();
+  auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start);
+  BOOST_REQUIRE_MESSAGE(json.first, "got remote sap sources delta");
+  BOOST_REQUIRE_MESSAGE(elapsed < milliseconds(2000),
+                        "long-poll returned on change");
+  auto pt = parse(json.second);
+  BOOST_CHECK(!pt.get<bool>("full"));
+  BOOST_REQUIRE_MESSAGE(pt.get<uint64_t>("seq") > seq, "sequence increased");
+  std::string id;
+  BOOST_FOREACH (auto const& v, pt.get_child("remote_sources")) {
+    if (v.second.get<std::string>("sdp") == sdp) {
+      id = v.second.get<std::string>("id");
+    }
+  }
+  BOOST_REQUIRE_MESSAGE(!id.empty(), "announced source in delta");
+  seq = pt.get<uint64_t>("seq");
+
+  // a refresh is not a change
+  cli.sap_send(true, 0x5678, sdp);
+  json = cli.get_remote_sap_sources_since(seq, 1);
+  pt = parse(json.second);
+  BOOST_CHECK(pt.get_child("remote_sources").empty());
+
+  // deletion is reported in the removed list
+  cli.sap_send(false, 0x5678, sdp);
+  json = cli.get_remote_sap_sources_since(seq, 3);
+  pt = parse(json.second);
+  bool removed = false;
+  BOOST_FOREACH (auto const& v, pt.get_child("removed")) {
+    removed |= (v.second.get_value<std::string>() == id);
+  }
+  BOOST_REQUIRE_MESSAGE(removed, "removed source in delta");
+  BOOST_TEST_MESSAGE("long-poll returned after " +
+                     std::to_string(elapsed.count()) + " msecs");
+}
+
+BOOST_AUTO_TEST_CASE(browser_cache_restart) {
+  using namespace std::chrono;
+  const std::string cache_file("/tmp/aes67-daemon-test-cache.json");
+  const std::string sdp(g_sdp_dup);
+  std::remove(cache_file.c_str());
+  auto find_source = [&sdp](const std::string& json,
+                            boost::property_tree::ptree& source) {
+    boost::property_tree::ptree pt;
+    std::stringstream ss(json);
+    boost::property_tree::read_json(ss, pt);
+    BOOST_FOREACH (auto const& v, pt.get_child("remote_sources")) {
+      if (v.second.get<std::string>("sdp") == sdp) {
+        source = v.second;
+        return true;
+      }
+    }
+    return false;
+  };
+  BOOST_REQUIRE_MESSAGE(
+      set_config_restart("{ \"browser_cache_file\": \"" + cache_file + "\" }"),
+      "daemon restarted with browser cache");
+  Client cli;
+  boost::property_tree::ptree source;
+  int retry = 100;
+  bool found = false;
+  while (!found && retry--) {
+    cli.sap_send(true, 0x4321, sdp);
+    std::this_thread::sleep_for(milliseconds(100));
+    found = find_source(cli.get_remote_sap_sources().second, source);
+  }
+  BOOST_REQUIRE_MESSAGE(found, "remote SAP source announced");
+  BOOST_CHECK_MESSAGE(!source.get<bool>("stale"), "announced source not stale");
+  auto id = source.get<std::string>("id");
+
+  // the cache is saved at termination and loaded by the new instance
+  std::this_thread::sleep_for(seconds(2));
+  BOOST_REQUIRE_MESSAGE(set_config_restart(R"({ "rtsp_threads": 3 })"),
+                        "daemon restarted");
+  BOOST_REQUIRE_MESSAGE(find_source(cli.get_remote_sap_sources().second, source),
+                        "remote SAP source reloaded from cache");
+  BOOST_CHECK_MESSAGE(source.get<std::string>("id") == id, "same source id");
+  BOOST_CHECK_MESSAGE(source.get<bool>("stale"), "cached source stale");
+  // the age of the source is kept across the restart
+  BOOST_CHECK_MESSAGE(source.get<unsigned>("last_seen") >= 2,
+                      "cached source age restored");
+
+  // an announcement revalidates the cached source
+  cli.sap_send(true, 0x4321, sdp);
+  retry = 100;
+  bool revalidated = false;
+  while (!revalidated && retry--) {
+    std::this_thread::sleep_for(milliseconds(10));
+    revalidated = find_source(cli.get_remote_sap_sources().second, source) &&
+                  !source.get<bool>("stale");
+  }
+  BOOST_REQUIRE_MESSAGE(revalidated, "cached source revalidated");
+  BOOST_CHECK_MESSAGE(source.get<unsigned>("last_seen") < 2,
+                      "revalidated source seen now");
+
+  cli.sap_send(false, 0x4321, sdp);
+  BOOST_REQUIRE_MESSAGE(
+      set_config_restart(
+          R"({ "browser_cache_file": "", "rtsp_threads": 2 })"),
+      "daemon restarted without browser cache");
+  std::remove(cache_file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(sap_compression_benchmark) {
+  using namespace std::chrono;
+  constexpr int iterations = 10000;
+  std::string payload("application/sdp");
+  payload.push_back('\0');
+  payload += g_sdp_dup;
+  std::vector<Bytef> compressed(compressBound(payload.length()));
+  std::vector<Bytef> uncompressed(payload.length());
+  uLongf compressed_length = 0;
+
+  auto start = steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    compressed_length = compressed.size();
+    BOOST_REQUIRE(compress2(compressed.data(), &compressed_length,
+                            reinterpret_cast<const Bytef*>(payload.c_str()),
+                            payload.length(), Z_DEFAULT_COMPRESSION) == Z_OK);
+  }
+  auto compress_ns =
+      duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+  start = steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    uLongf length = uncompressed.size();
+    BOOST_REQUIRE(uncompress(uncompressed.data(), &length, compressed.data(),
+                             compressed_length) == Z_OK);
+  }
+  auto uncompress_ns =
+      duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+  BOOST_TEST_MESSAGE("SAP announcement " +
+                     std::to_string(8 + payload.length()) +
+                     " bytes, compressed " +
+                     std::to_string(8 + compressed_length) + " bytes");
+  BOOST_TEST_MESSAGE("compression " +
+                     std::to_string(compress_ns / iterations / 1000) +
+                     " usecs, decompression " +
+                     std::to_string(uncompress_ns / iterations / 1000) +
+                     " usecs per announcement");
+  BOOST_CHECK_MESSAGE(compressed_length < payload.length(),
+                      "compressed announcement is smaller");
+}
+
+BOOST_AUTO_TEST_CASE(sap_announcement_pacing) {
+  using namespace std::chrono;
+  Client cli;
+  for (int id = 0; id < g_stream_num_max; id++) {
+    BOOST_REQUIRE_MESSAGE(cli.add_source(id),
+                          std::string("added source ") + std::to_string(id));
+  }
+  // let the announcements of the new sources go, then capture a few intervals
+  std::this_thread::sleep_for(seconds(2));
+  auto timepoints = cli.sap_capture_announcements(milliseconds(3000));
+  BOOST_REQUIRE_MESSAGE(timepoints.size() >= g_stream_num_max,
+                        "received " + std::to_string(timepoints.size()) +
+                            " SAP announcements");
+  // max number of announcements received in a 10 msecs window
+  size_t max_burst = 0;
+  int64_t max_gap_us = 0;
+  for (size_t i = 0, j = 0; i < timepoints.size(); i++) {
+    while (timepoints[i] - timepoints[j] > milliseconds(10)) {
+      j++;
+    }
+    max_burst = std::max(max_burst, i - j + 1);
+    if (i > 0) {
+      max_gap_us = std::max<int64_t>(
+          max_gap_us,
+          duration_cast<microseconds>(timepoints[i] - timepoints[i - 1])
+              .count());
+    }
+  }
+  BOOST_TEST_MESSAGE("received " + std::to_string(timepoints.size()) +
+                     " SAP announcements, max " + std::to_string(max_burst) +
+                     " in 10 msecs, max gap " + std::to_string(max_gap_us) +
+                     " usecs");
+  BOOST_CHECK_MESSAGE(max_burst < g_stream_num_max / 4,
+                      "SAP announcements spread across the interval");
+  httplib::Client http(g_daemon_address, g_daemon_port);
+  auto res = http.Get("/api/sap/stats");
+  BOOST_REQUIRE_MESSAGE(res && res->status == 200, "got SAP stats");
+  boost::property_tree::ptree pt;
+  std::stringstream ss(res->body);
+  boost::property_tree::read_json(ss, pt);
+  BOOST_TEST_MESSAGE(res->body);
+  BOOST_CHECK_MESSAGE(pt.get<int>("slice_budget") == 1000000 / 80,
+                      "SAP slice budget");
+  BOOST_CHECK_MESSAGE(pt.get<int>("overruns") == 0, "SAP rounds in budget");
+  BOOST_CHECK_MESSAGE(pt.get<uint64_t>("last_round.packets_sent") >=
+                          g_stream_num_max,
+                      "SAP sources announced in a round");
+  // the bytes of a round fit the budget of the interval
+  BOOST_CHECK_MESSAGE(pt.get<uint64_t>("last_round.bytes_sent") * 8 <=
+                          pt.get<uint64_t>("bandwidth_limit") *
+                              pt.get<uint64_t>("interval"),
+                      "SAP round bytes in budget");
+  for (int id = 0; id < g_stream_num_max; id++) {
+    BOOST_REQUIRE_MESSAGE(cli.remove_source(id),
+                          std::string("removed source ") + std::to_string(id));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sap_browser_rx_rate) {
+  using namespace std::chrono;
+  constexpr int sessions = 2000;
+  constexpr int rounds = 5;
+  constexpr int packets_per_sec = 10000;
+  constexpr int burst = 100;
+  const std::string sdp(
+      "v=0\no=- 1 0 IN IP4 127.0.0.1\ns=bench \nc=IN IP4 239.3.0.1/15\n"
+      "t=0 0\nm=audio 5004 RTP/AVP 98\na=rtpmap:98 L24/48000/2\n");
+  auto session_sdp = [&sdp](int id) {
+    std::string res(sdp);
+    boost::replace_first(res, "bench ", "bench " + std::to_string(id));
+    return res;
+  };
+  auto count_sources = [](Client& cli) {
+    auto json = cli.get_remote_sap_sources();
+    BOOST_REQUIRE_MESSAGE(json.first, "got remote sap sources");
+    boost::property_tree::ptree pt;
+    std::stringstream ss(json.second);
+    boost::property_tree::read_json(ss, pt);
+    return pt.get_child("remote_sources").size();
+  };
+
+  Client cli;
+  /* announce all sessions, then refresh them, at packets_per_sec */
+  auto start = steady_clock::now();
+  auto next = start;
+  int sent = 0;
+  for (int round = 0; round < rounds; round++) {
+    for (int id = 0; id < sessions; id++) {
+      cli.sap_send(true, 0x8000 + id, session_sdp(id));
+      if (++sent % burst == 0) {
+        next += microseconds(1000000 * burst / packets_per_sec);
+        std::this_thread::sleep_until(next);
+      }
+    }
+  }
+  auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start);
+  BOOST_TEST_MESSAGE("sent " + std::to_string(sent) + " SAP packets in " +
+                     std::to_string(elapsed.count()) + " msecs, " +
+                     std::to_string(sent * 1000 / (elapsed.count() + 1)) +
+                     " packets/sec");
+
+  size_t found = 0;
+  int retry = 10;
+  while ((found = count_sources(cli)) < sessions && retry--) {
+    std::this_thread::sleep_for(milliseconds(500));
+  }
+  BOOST_CHECK_MESSAGE(found == sessions,
+                      "browser found " + std::to_string(found) + " of " +
+                          std::to_string(sessions) + " SAP sessions");
+
+  for (int count = 0; count < 3; count++) {
+    for (int id = 0; id < sessions; id++) {
+      cli.sap_send(false, 0x8000 + id, session_sdp(id));
+      if (id % burst == 0) {
+        std::this_thread::sleep_for(milliseconds(10));
+      }
+    }
+  }
+  retry = 10;
+  while (count_sources(cli) > 0 && retry--) {
+    std::this_thread::sleep_for(milliseconds(500));
+  }
+  BOOST_REQUIRE_MESSAGE(count_sources(cli) == 0, "no remote sap sources");
+}
+
+BOOST_AUTO_TEST_CASE(sap_browser_memory) {
+  using namespace std::chrono;
+  constexpr int sessions = 10000;
+  constexpr int burst = 100;
+  constexpr int reads = 20;
+  auto session_sdp = [](int id) {
+    std::string res(g_sdp_dup);
+    boost::replace_first(res, "_dup", "_dup " + std::to_string(id));
+    return res;
+  };
+  auto count_sources = [](Client& cli) {
+    auto json = cli.get_remote_sap_sources();
+    BOOST_REQUIRE_MESSAGE(json.first, "got remote sap sources");
+    boost::property_tree::ptree pt;
+    std::stringstream ss(json.second);
+    boost::property_tree::read_json(ss, pt);
+    return pt.get_child("remote_sources").size();
+  };
+
+  Client cli;
+  auto rss_start = get_daemon_rss();
+  for (int id = 0; id < sessions; id++) {
+    cli.sap_send(true, 0xA000 + id, session_sdp(id));
+    if (id % burst == 0) {
+      std::this_thread::sleep_for(milliseconds(10));
+    }
+  }
+  size_t found = 0;
+  int retry = 20;
+  while ((found = count_sources(cli)) < sessions && retry--) {
+    std::this_thread::sleep_for(milliseconds(500));
+  }
+  BOOST_CHECK_MESSAGE(found == sessions,
+                      "browser found " + std::to_string(found) + " of " +
+                          std::to_string(sessions) + " SAP sessions");
+  auto rss_peak = get_daemon_rss();
+
+  auto start = steady_clock::now();
+  size_t bytes = 0;
+  for (int count = 0; count < reads; count++) {
+    auto json = cli.get_remote_sap_sources();
+    BOOST_REQUIRE_MESSAGE(json.first, "got remote sap sources");
+    bytes += json.second.length();
+  }
+  auto elapsed = duration_cast<microseconds>(steady_clock::now() - start);
+  BOOST_TEST_MESSAGE("daemon RSS " + std::to_string(rss_start) + " KB, with " +
+                     std::to_string(found) + " SAP sessions " +
+                     std::to_string(rss_peak) + " KB, " +
+                     std::to_string((rss_peak - rss_start) * 1024 /
+                                    std::max<size_t>(found, 1)) +
+                     " bytes per session");
+  BOOST_TEST_MESSAGE("remote sources list of " +
+                     std::to_string(bytes / reads) + " bytes, avg " +
+                     std::to_string(elapsed.count() / reads) + " usecs");
+
+  for (int id = 0; id < sessions; id++) {
+    cli.sap_send(false, 0xA000 + id, session_sdp(id));
+    if (id % burst == 0) {
+      std::this_thread::sleep_for(milliseconds(10));
+    }
+  }
+  retry = 20;
+  while (count_sources(cli) > 0 && retry--) {
+    std::this_thread::sleep_for(milliseconds(500));
+  }
+  BOOST_REQUIRE_MESSAGE(count_sources(cli) == 0, "no remote sap sources");
+}
+
+BOOST_AUTO_TEST_CASE(sink_url_unreachable) {
+  using namespace std::chrono;
+  const std::string dead_url("http://10.255.255.1/sdp");
+  Client cli;
+  BOOST_REQUIRE_MESSAGE(cli.add_source(1), "added source 1");
+  /* the sink update is accepted while the URL fetch is pending */
+  auto start = steady_clock::now();
+  auto status = cli.put_sink_url(0, dead_url);
+  auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start);
+  BOOST_TEST_MESSAGE("sink update with unreachable URL returned " +
+                     std::to_string(status) + " in " +
+                     std::to_string(elapsed.count()) + " msecs");
+  BOOST_REQUIRE_MESSAGE(status != 200, "sink 0 with unreachable URL not added");
+  BOOST_CHECK_MESSAGE(elapsed < seconds(1), "sink update not blocked by fetch");
+  /* sinks can be read and added while the URL fetch is pending */
+  start = steady_clock::now();
+  BOOST_REQUIRE_MESSAGE(cli.get_sinks().first, "got sinks");
+  BOOST_REQUIRE_MESSAGE(cli.add_sink_url(1), "added sink 1");
+  elapsed = duration_cast<milliseconds>(steady_clock::now() - start);
+  BOOST_TEST_MESSAGE("sinks read and update during fetch took " +
+                     std::to_string(elapsed.count()) + " msecs");
+  BOOST_CHECK_MESSAGE(elapsed < seconds(1), "sinks not blocked by fetch");
+  /* past the connection timeout the failed fetch adds no sink */
+  std::this_thread::sleep_for(seconds(4));
+  BOOST_REQUIRE_MESSAGE(!cli.remove_sink(0), "sink 0 not added");
+  /* the failed URL is not fetched again right away */
+  start = steady_clock::now();
+  BOOST_REQUIRE_MESSAGE(cli.put_sink_url(0, dead_url) == 400,
+                        "sink 0 with unreachable URL failed again");
+  elapsed = duration_cast<milliseconds>(steady_clock::now() - start);
+  BOOST_CHECK_MESSAGE(elapsed < seconds(1), "failed URL reported from cache");
+  BOOST_REQUIRE_MESSAGE(cli.remove_sink(1), "removed sink 1");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(1), "removed source 1");
+}
+
 BOOST_AUTO_TEST_CASE(add_remove_all_sources) {
   Client cli;
   for (int id = 0; id < g_stream_num_max; id++) {
@@ -759,6 +2226,236 @@ BOOST_AUTO_TEST_CASE(add_remove_check_all) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(streams_serialization_throughput) {
+  using namespace std::chrono;
+  Client cli;
+  for (int id = 0; id < g_stream_num_max; id++) {
+    BOOST_REQUIRE_MESSAGE(cli.add_source(id),
+                          std::string("added source ") + std::to_string(id));
+    BOOST_REQUIRE_MESSAGE(cli.add_sink_sdp(id),
+                          std::string("added sink ") + std::to_string(id));
+  }
+  // largest payloads served by the daemon besides the browser table
+  auto measure = [](const std::string& name, auto get) {
+    int reads = 0;
+    size_t bytes = 0;
+    auto start = steady_clock::now();
+    auto elapsed = steady_clock::duration::zero();
+    do {
+      auto json = get();
+      BOOST_REQUIRE_MESSAGE(json.first, "got " + name);
+      bytes = json.second.length();
+      reads++;
+      elapsed = steady_clock::now() - start;
+    } while (elapsed < seconds(2));
+    auto usecs = duration_cast<microseconds>(elapsed).count();
+    BOOST_TEST_MESSAGE(name + " of " + std::to_string(bytes) + " bytes, " +
+                       std::to_string(reads * 1000000LL / usecs) +
+                       " reads/sec, avg " + std::to_string(usecs / reads) +
+                       " usecs");
+  };
+  measure("streams", [&cli]() { return cli.get_streams(); });
+  measure("sinks", [&cli]() { return cli.get_sinks(); });
+  measure("config", [&cli]() { return cli.get_config(); });
+
+  auto json = cli.get_streams();
+  boost::property_tree::ptree pt;
+  std::stringstream ss(json.second);
+  boost::property_tree::read_json(ss, pt);
+  BOOST_REQUIRE_MESSAGE(pt.get_child("sources").size() == g_stream_num_max &&
+                            pt.get_child("sinks").size() == g_stream_num_max,
+                        "streams serialized");
+  for (int id = 0; id < g_stream_num_max; id++) {
+    BOOST_REQUIRE_MESSAGE(cli.remove_source(id),
+                          std::string("removed source ") + std::to_string(id));
+    BOOST_REQUIRE_MESSAGE(cli.remove_sink(id),
+                          std::string("removed sink ") + std::to_string(id));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sources_read_throughput) {
+  Client cli;
+  std::atomic_bool stop{false};
+  // writer keeps adding and removing sources while the reader polls them
+  auto writer = std::async(std::launch::async, [&stop]() {
+    httplib::Client cli(g_daemon_address, g_daemon_port);
+    int writes = 0;
+    while (!stop) {
+      for (int id = 0; id < 8 && !stop; id++) {
+        std::string json =
+            R"({"enabled": true, "name": "ALSA W)" + std::to_string(id) +
+            R"(", "io": "Audio Device", "map": [ 0, 1 ],
+                "max_samples_per_packet": 48, "codec": "L16",
+                "address": "", "ttl": 15, "payload_type": 98, "dscp": 34,
+                "refclk_ptp_traceable": false})";
+        std::string url = std::string("/api/source/") + std::to_string(id);
+        auto res = cli.Put(url.c_str(), json, "application/json");
+        writes += (res && res->status == 200);
+        res = cli.Delete(url.c_str());
+        writes += (res && res->status == 200);
+      }
+    }
+    return writes;
+  });
+  int reads = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::steady_clock::duration::zero();
+  do {
+    auto json = cli.get_sources();
+    BOOST_REQUIRE_MESSAGE(json.first, "got sources");
+    reads++;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed < std::chrono::seconds(3));
+  stop = true;
+  auto writes = writer.get();
+  auto msecs =
+      std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+  BOOST_TEST_MESSAGE("sources read throughput " +
+                     std::to_string(reads * 1000 / msecs) + " reads/sec with " +
+                     std::to_string(writes * 1000 / msecs) + " writes/sec");
+  BOOST_REQUIRE_MESSAGE(writes > 0, "sources added and removed");
+}
+
+BOOST_AUTO_TEST_CASE(rtsp_describe_throughput) {
+  using namespace std::chrono;
+  constexpr int clients = 8;
+  Client cli;
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  std::atomic_bool stop{false};
+  // each client sends back to back DESCRIBE requests on a persistent session
+  auto describe = [&stop]() {
+    std::vector<int64_t> latencies;
+    boost::asio::ip::tcp::iostream s(g_daemon_address,
+                                     std::to_string(g_daemon_rtsp_port));
+    for (int cseq = 0; s && !stop; cseq++) {
+      auto start = steady_clock::now();
+      s << "DESCRIBE rtsp://" << g_daemon_address << ":" << g_daemon_rtsp_port
+        << "/by-id/0 RTSP/1.0\r\nCSeq: " << cseq << "\r\n\r\n"
+        << std::flush;
+      std::string line;
+      size_t length = 0;
+      bool ok = std::getline(s, line) && line.rfind("RTSP/1.0 200", 0) == 0;
+      while (std::getline(s, line) && line != "\r") {
+        if (line.rfind("Content-Length:", 0) == 0) {
+          length = std::stoul(line.substr(15));
+        }
+      }
+      std::string sdp(length, '\0');
+      s.read(sdp.data(), length);
+      if (!ok || sdp.find("m=audio") == std::string::npos) {
+        return std::vector<int64_t>{};
+      }
+      latencies.push_back(
+          duration_cast<microseconds>(steady_clock::now() - start).count());
+    }
+    return latencies;
+  };
+  std::vector<std::future<std::vector<int64_t> > > res;
+  for (int i = 0; i < clients; i++) {
+    res.emplace_back(std::async(std::launch::async, describe));
+  }
+  std::this_thread::sleep_for(seconds(3));
+  stop = true;
+  std::vector<int64_t> latencies;
+  for (auto& r : res) {
+    auto l = r.get();
+    BOOST_CHECK_MESSAGE(!l.empty(), "DESCRIBE responses received");
+    latencies.insert(latencies.end(), l.begin(), l.end());
+  }
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+  BOOST_REQUIRE_MESSAGE(!latencies.empty(), "DESCRIBE latencies measured");
+  std::sort(latencies.begin(), latencies.end());
+  BOOST_TEST_MESSAGE(
+      "RTSP DESCRIBE throughput " + std::to_string(latencies.size() / 3) +
+      " requests/sec with " + std::to_string(clients) + " clients, latency" +
+      " p50 " + std::to_string(latencies[latencies.size() / 2]) + " usecs" +
+      " p99 " + std::to_string(latencies[latencies.size() * 99 / 100]) +
+      " usecs max " + std::to_string(latencies.back()) + " usecs");
+}
+
+BOOST_AUTO_TEST_CASE(rtsp_announce_coalescing) {
+  using namespace std::chrono;
+  constexpr int updates = 5;
+  Client cli;
+  BOOST_REQUIRE_MESSAGE(cli.add_source(0), "added source 0");
+  boost::asio::ip::tcp::iostream s(g_daemon_address,
+                                   std::to_string(g_daemon_rtsp_port));
+  // read an RTSP message and return the first line
+  auto read_message = [&s]() {
+    std::string first, line;
+    size_t length = 0;
+    std::getline(s, first);
+    while (std::getline(s, line) && line != "\r") {
+      if (line.rfind("Content-Length:", 0) == 0) {
+        length = std::stoul(line.substr(15));
+      }
+    }
+    std::string body(length, '\0');
+    s.read(body.data(), length);
+    return s ? first : std::string();
+  };
+  s << "DESCRIBE rtsp://" << g_daemon_address << ":" << g_daemon_rtsp_port
+    << "/by-id/0 RTSP/1.0\r\nCSeq: 1\r\n\r\n"
+    << std::flush;
+  BOOST_REQUIRE_MESSAGE(read_message().rfind("RTSP/1.0 200", 0) == 0,
+                        "source 0 described");
+  // rapid successive updates of the described source
+  for (int i = 0; i < updates; i++) {
+    BOOST_REQUIRE_MESSAGE(cli.add_source(0), "updated source 0");
+  }
+  s.expires_after(seconds(2));
+  int announces = 0;
+  while (read_message().rfind("ANNOUNCE ", 0) == 0) {
+    announces++;
+  }
+  BOOST_TEST_MESSAGE(std::to_string(updates) + " source updates sent with " +
+                     std::to_string(announces) + " ANNOUNCE");
+  BOOST_CHECK_MESSAGE(announces > 0, "ANNOUNCE received");
+  BOOST_CHECK_MESSAGE(announces < updates, "updates coalesced");
+  BOOST_REQUIRE_MESSAGE(cli.remove_source(0), "removed source 0");
+}
+
+BOOST_AUTO_TEST_CASE(add_remove_check_scale) {
+  using namespace std::chrono;
+  Client cli;
+  auto rss_start = get_daemon_rss();
+  // run an operation on all the streams and return average and max latency
+  auto measure = [](const std::string& op, auto func) {
+    microseconds total{0}, max{0};
+    for (int id = 0; id < g_stream_scale_num; id++) {
+      auto start = steady_clock::now();
+      BOOST_REQUIRE_MESSAGE(func(id), op + " " + std::to_string(id));
+      auto elapsed = duration_cast<microseconds>(steady_clock::now() - start);
+      total += elapsed;
+      max = std::max(max, elapsed);
+    }
+    BOOST_TEST_MESSAGE(op + " " + std::to_string(g_stream_scale_num) +
+                       " streams, avg " +
+                       std::to_string(total.count() / g_stream_scale_num) +
+                       " usecs, max " + std::to_string(max.count()) + " usecs");
+  };
+  measure("added source", [&cli](int id) { return cli.add_source(id); });
+  measure("added sink", [&cli](int id) { return cli.add_sink_sdp(id); });
+  auto rss_peak = get_daemon_rss();
+  auto json = cli.get_streams();
+  BOOST_REQUIRE_MESSAGE(json.first, "got streams");
+  boost::property_tree::ptree pt;
+  std::stringstream ss(json.second);
+  boost::property_tree::read_json(ss, pt);
+  BOOST_REQUIRE_MESSAGE(
+      pt.get_child("sources").size() == g_stream_scale_num,
+      "returned " + std::to_string(g_stream_scale_num) + " sources");
+  BOOST_REQUIRE_MESSAGE(
+      pt.get_child("sinks").size() == g_stream_scale_num,
+      "returned " + std::to_string(g_stream_scale_num) + " sinks");
+  measure("removed source", [&cli](int id) { return cli.remove_source(id); });
+  measure("removed sink", [&cli](int id) { return cli.remove_sink(id); });
+  BOOST_TEST_MESSAGE("daemon RSS " + std::to_string(rss_start) + " KB, with " +
+                     std::to_string(g_stream_scale_num) + " sources and sinks " +
+                     std::to_string(rss_peak) + " KB, after removal " +
+                     std::to_string(get_daemon_rss()) + " KB");
+}
+
 BOOST_AUTO_TEST_CASE(add_remove_update_check_all) {
   Client cli;
   for (int id = 0; id < g_stream_num_max; id++) {
@@ -873,7 +2570,7 @@ BOOST_AUTO_TEST_CASE(add_remove_check_sap_browser_all) {
   }
 }
 
-#ifdef _USE_AVAHI_
+#if defined(_USE_AVAHI_) || defined(_USE_MDNS_BUILTIN_)
 BOOST_AUTO_TEST_CASE(add_remove_check_mdns_browser_all) {
   Client cli;
   for (int id = 0; id < g_stream_num_max; id++) {
@@ -952,4 +2649,54 @@ BOOST_AUTO_TEST_CASE(add_remove_check_mdns_browser_update_all) {
   BOOST_REQUIRE_MESSAGE(cli.wait_for_remote_mdns_sources(0),
                         "no remote mdns sources found");
 }
+
+BOOST_AUTO_TEST_CASE(mdns_browser_rtsp_scale) {
+  using namespace std::chrono;
+  Client cli;
+  auto count_sources = [&cli]() {
+    auto json = cli.get_remote_mdns_sources();
+    BOOST_REQUIRE_MESSAGE(json.first, "got remote mdns sources");
+    boost::property_tree::ptree pt;
+    std::stringstream ss(json.second);
+    boost::property_tree::read_json(ss, pt);
+    return pt.get_child("remote_sources").size();
+  };
+  auto threads_start = get_daemon_status("Threads");
+  auto rss_start = get_daemon_rss();
+  // the daemon RTSP server is the mock server of the discovered sources
+  auto start = steady_clock::now();
+  for (int id = 0; id < g_stream_scale_num; id++) {
+    BOOST_REQUIRE_MESSAGE(cli.add_source(id),
+                          std::string("added source ") + std::to_string(id));
+  }
+  size_t found = 0;
+  int retry = 60;
+  while ((found = count_sources()) < g_stream_scale_num && retry--) {
+    std::this_thread::sleep_for(milliseconds(500));
+  }
+  auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start);
+  auto threads_peak = get_daemon_status("Threads");
+  auto rss_peak = get_daemon_rss();
+  BOOST_TEST_MESSAGE("found " + std::to_string(found) + " mDNS sources in " +
+                     std::to_string(elapsed.count()) + " msecs");
+  BOOST_TEST_MESSAGE("daemon threads " + std::to_string(threads_start) +
+                     ", with " + std::to_string(found) + " RTSP clients " +
+                     std::to_string(threads_peak));
+  BOOST_TEST_MESSAGE("daemon RSS " + std::to_string(rss_start) + " KB, with " +
+                     std::to_string(found) + " RTSP clients " +
+                     std::to_string(rss_peak) + " KB");
+  BOOST_CHECK_MESSAGE(found == g_stream_scale_num,
+                      "all remote mdns sources found");
+  BOOST_CHECK_MESSAGE(threads_peak - threads_start < 16,
+                      "RTSP clients do not use a thread each");
+  for (int id = 0; id < g_stream_scale_num; id++) {
+    BOOST_REQUIRE_MESSAGE(cli.remove_source(id),
+                          std::string("removed source ") + std::to_string(id));
+  }
+  retry = 60;
+  while (count_sources() > 0 && retry--) {
+    std::this_thread::sleep_for(milliseconds(500));
+  }
+  BOOST_REQUIRE_MESSAGE(count_sources() == 0, "no remote mdns sources");
+}
 #endif
@@ -0,0 +1,274 @@
+//
+//  web_assets.cpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <zlib.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "log.hpp"
+#include "web_assets.hpp"
+
+namespace fs = boost::filesystem;
+
+static const std::map<std::string, std::pair<const char*, bool>>
+    content_types{
+        // extension, content type and whether it is compressible
+        {".html", {"text/html", true}},
+        {".htm", {"text/html", true}},
+        {".js", {"text/javascript", true}},
+        {".mjs", {"text/javascript", true}},
+        {".css", {"text/css", true}},
+        {".json", {"application/json", true}},
+        {".map", {"application/json", true}},
+        {".webmanifest", {"application/manifest+json", true}},
+        {".txt", {"text/plain", true}},
+        {".xml", {"application/xml", true}},
+        {".svg", {"image/svg+xml", true}},
+        {".wasm", {"application/wasm", true}},
+        {".png", {"image/png", false}},
+        {".gif", {"image/gif", false}},
+        {".jpg", {"image/jpeg", false}},
+        {".jpeg", {"image/jpeg", false}},
+        {".webp", {"image/webp", false}},
+        {".ico", {"image/x-icon", false}},
+        {".woff", {"font/woff", false}},
+        {".woff2", {"font/woff2", false}},
+        {".ttf", {"font/ttf", true}},
+    };
+
+static bool read_file(const fs::path& path, std::string& content) {
+  std::ifstream file(path.string(), std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  content = buffer.str();
+  return !file.bad();
+}
+
+static bool gzip_compress(const std::string& in, std::string& out) {
+  z_stream zs{};
+  // window bits 15 plus 16 for the gzip wrapper
+  if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  out.resize(deflateBound(&zs, in.size()));
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+  zs.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs.avail_out = out.size();
+  auto ret = deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  return ret == Z_STREAM_END;
+}
+
+/* bundlers name the assets as name-hash.ext or name.hash.ext */
+static bool is_hashed(const std::string& filename) {
+  auto stem = fs::path(filename).stem().string();
+  auto pos = stem.find_last_of("-.");
+  if (pos == std::string::npos || stem.length() - pos - 1 < 8) {
+    return false;
+  }
+  auto hash = stem.substr(pos + 1);
+  bool has_digit = false;
+  for (auto c : hash) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-') {
+      return false;
+    }
+    has_digit |= std::isdigit(static_cast<unsigned char>(c)) != 0;
+  }
+  return has_digit;
+}
+
+static std::string make_etag(const std::string& content) {
+  std::stringstream ss;
+  ss << "\"" << std::hex << std::hash<std::string>{}(content) << "-"
+     << content.size() << "\"";
+  return ss.str();
+}
+
+size_t WebAssets::load(const std::string& base_dir) {
+  assets_.clear();
+  fs::path base(base_dir);
+  boost::system::error_code ec;
+  if (!fs::is_directory(base, ec)) {
+    BOOST_LOG_TRIVIAL(warning) << "web_assets:: directory " << base_dir
+                               << " not found, web UI not available";
+    return 0;
+  }
+
+  std::map<std::string /* path */, fs::path> files;
+  for (fs::recursive_directory_iterator it(base, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    if (it->path().filename().string().front() == '.') {
+      // skip hidden files and directories
+      if (fs::is_directory(it->path(), ec)) {
+        it.no_push();
+      }
+      continue;
+    }
+    if (fs::is_regular_file(it->path(), ec)) {
+      files["/" + it->path().lexically_relative(base).generic_string()] =
+          it->path();
+    }
+  }
+  if (ec) {
+    BOOST_LOG_TRIVIAL(warning) << "web_assets:: cannot read directory "
+                               << base_dir << " : " << ec.message();
+  }
+
+  size_t size = 0;
+  size_t compressed = 0;
+  for (const auto& [path, file] : files) {
+    Encoding encoding = identity;
+    std::string asset_path = path;
+    auto ext = file.extension().string();
+    if ((ext == ".gz" || ext == ".br") &&
+        files.count(path.substr(0, path.length() - ext.length()))) {
+      // precompressed variant of an existing file
+      encoding = ext == ".gz" ? gzip : br;
+      asset_path.erase(asset_path.length() - ext.length());
+    }
+    auto file_size = fs::file_size(file, ec);
+    if (ec || file_size > file_size_max) {
+      BOOST_LOG_TRIVIAL(warning)
+          << "web_assets:: skipping file " << file.string() << " of "
+          << file_size << " bytes";
+      continue;
+    }
+    if (size + file_size > size_max) {
+      BOOST_LOG_TRIVIAL(warning) << "web_assets:: max size of " << size_max
+                                 << " bytes reached, skipping remaining files";
+      break;
+    }
+    std::string content;
+    if (!read_file(file, content)) {
+      BOOST_LOG_TRIVIAL(error)
+          << "web_assets:: cannot read file " << file.string();
+      continue;
+    }
+    size += content.size();
+    auto& asset = assets_[asset_path];
+    asset.body[encoding] = std::make_shared<const std::string>(
+        std::move(content));
+    if (encoding != identity) {
+      compressed++;
+    }
+  }
+
+  for (auto it = assets_.begin(); it != assets_.end();) {
+    auto& [path, asset] = *it;
+    if (!asset.body[identity]) {
+      // variant of a file that was skipped
+      it = assets_.erase(it);
+      continue;
+    }
+    auto const type_it =
+        content_types.find(boost::to_lower_copy(fs::path(path).extension()
+                                                    .string()));
+    bool compressible = false;
+    if (type_it != content_types.end()) {
+      asset.content_type = type_it->second.first;
+      compressible = type_it->second.second;
+    } else {
+      asset.content_type = "application/octet-stream";
+    }
+    asset.etag = make_etag(*asset.body[identity]);
+    asset.immutable = is_hashed(path);
+    std::string gz;
+    if (!asset.body[gzip] && compressible &&
+        asset.body[identity]->size() >= compress_size_min &&
+        size + asset.body[identity]->size() <= size_max &&
+        gzip_compress(*asset.body[identity], gz) &&
+        gz.size() < asset.body[identity]->size()) {
+      size += gz.size();
+      compressed++;
+      asset.body[gzip] = std::make_shared<const std::string>(std::move(gz));
+    }
+    ++it;
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "web_assets:: loaded " << assets_.size()
+                          << " files and " << compressed
+                          << " compressed variants, " << size << " bytes";
+  return assets_.size();
+}
+
+const WebAssets::Asset* WebAssets::find(const std::string& path) const {
+  auto const it = assets_.find(path);
+  return it != assets_.end() ? &it->second : nullptr;
+}
+
+/* check whether the coding is accepted with a non zero quality value */
+static bool is_accepted(const std::string& accept_encoding,
+                        const std::string& coding) {
+  std::vector<std::string> tokens;
+  boost::split(tokens, accept_encoding, boost::is_any_of(","));
+  for (const auto& token : tokens) {
+    auto pos = token.find(';');
+    auto name = boost::trim_copy(token.substr(0, pos));
+    if (!boost::iequals(name, coding) && name != "*") {
+      continue;
+    }
+    if (pos != std::string::npos) {
+      auto q = token.find("q=", pos);
+      if (q != std::string::npos &&
+          std::strtod(token.c_str() + q + 2, nullptr) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+WebAssets::Encoding WebAssets::select(const Asset& asset,
+                                      const std::string& accept_encoding) {
+  if (!accept_encoding.empty()) {
+    // brotli is preferred, it compresses better
+    for (auto encoding : {br, gzip}) {
+      if (asset.body[encoding] &&
+          is_accepted(accept_encoding, get_encoding_name(encoding))) {
+        return encoding;
+      }
+    }
+  }
+  return identity;
+}
+
+const char* WebAssets::get_encoding_name(Encoding encoding) {
+  switch (encoding) {
+    case gzip:
+      return "gzip";
+    case br:
+      return "br";
+    default:
+      return "identity";
+  }
+}
@@ -0,0 +1,64 @@
+//
+//  web_assets.hpp
+//
+//  Copyright (c) 2019 2020 Andrea Bondavalli. All rights reserved.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _WEB_ASSETS_HPP_
+#define _WEB_ASSETS_HPP_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Static files of the web UI, loaded in memory at startup.
+ * For every file the existing .gz and .br files are used as precompressed
+ * variants, if the .gz file is missing the gzip variant of the compressible
+ * files is created at load time.
+ */
+class WebAssets {
+ public:
+  constexpr static size_t size_max = 64 * 1024 * 1024;       // byte
+  constexpr static size_t file_size_max = 16 * 1024 * 1024;  // byte
+  constexpr static size_t compress_size_min = 256;           // byte
+
+  enum Encoding { identity = 0, gzip, br, encodings_num };
+
+  struct Asset {
+    std::string content_type;
+    /* strong ETag of the identity variant */
+    std::string etag;
+    /* hashed bundle, the content never changes for the same path */
+    bool immutable{false};
+    /* variants indexed by Encoding, nullptr if not available */
+    std::shared_ptr<const std::string> body[encodings_num];
+  };
+
+  /* load all the files under base_dir, returns the number of files */
+  size_t load(const std::string& base_dir);
+  /* return nullptr if the path is not found */
+  const Asset* find(const std::string& path) const;
+  /* best variant of the asset accepted by the Accept-Encoding header */
+  static Encoding select(const Asset& asset,
+                         const std::string& accept_encoding);
+  static const char* get_encoding_name(Encoding encoding);
+
+ private:
+  std::unordered_map<std::string /* path */, Asset> assets_;
+};
+
+#endif
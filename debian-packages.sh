@@ -11,6 +11,7 @@ sudo apt-get install -y git
 sudo apt-get install -y cmake
 # sudo apt-get install -y npm
 sudo apt-get install -y libboost-all-dev
+sudo apt-get install -y zlib1g-dev
 sudo apt-get install -y valgrind
 sudo apt-get install -y linux-sound-base
 sudo apt-get install -y alsa-base
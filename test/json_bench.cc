@@ -0,0 +1,201 @@
+//  json_bench.cc
+//
+//  Status file parsing benchmark.
+//  Generates a status file with the specified number of sources and sinks
+//  and parses it with boost property_tree, the parser previously used by
+//  the daemon, and with the daemon single pass JsonReader.
+//  For each parser it prints the average parse time and the number of heap
+//  allocations per parse.
+//
+//  Usage: json_bench [streams] [iterations]
+//  Example: ./json_bench 512 100
+//
+
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../daemon/json_reader.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+static size_t allocations{0};
+
+void* operator new(size_t size) {
+  allocations++;
+  if (void* p = malloc(size ? size : 1)) {
+    return p;
+  }
+  throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+struct Stream {
+  uint16_t id{0};
+  bool enabled{false};
+  string name;
+  string io;
+  string sdp;
+  uint32_t delay{0};
+  vector<uint8_t> map;
+};
+
+static string make_status(int streams) {
+  const string sdp(
+      "v=0\\no=- 1 0 IN IP4 192.168.1.10\\ns=ALSA (on ubuntu)_1\\n"
+      "c=IN IP4 239.1.0.1/15\\nt=0 0\\na=clock-domain:PTPv2 0\\n"
+      "m=audio 5004 RTP/AVP 98\\nc=IN IP4 239.1.0.1/15\\n"
+      "a=rtpmap:98 L24/48000/8\\na=sync-time:0\\na=framecount:48\\n"
+      "a=ptime:1\\na=mediaclk:direct=0\\n"
+      "a=ts-refclk:ptp=IEEE1588-2008:00-1D-C1-FF-FE-12-34-56:0\\n"
+      "a=recvonly\\n");
+  stringstream ss;
+  ss << "{\n  \"sources\": [";
+  for (int id = 0; id < streams; id++) {
+    ss << (id ? ", " : "") << "\n  {\n    \"id\": " << id
+       << ",\n    \"enabled\": true"
+       << ",\n    \"name\": \"ALSA Source " << id << "\""
+       << ",\n    \"io\": \"Audio Device\""
+       << ",\n    \"max_samples_per_packet\": 48"
+       << ",\n    \"codec\": \"L24\""
+       << ",\n    \"address\": \"\""
+       << ",\n    \"ttl\": 15"
+       << ",\n    \"payload_type\": 98"
+       << ",\n    \"dscp\": 34"
+       << ",\n    \"refclk_ptp_traceable\": false"
+       << ",\n    \"map\": [ 0, 1, 2, 3, 4, 5, 6, 7 ]\n  }";
+  }
+  ss << "  ],\n  \"sinks\": [";
+  for (int id = 0; id < streams; id++) {
+    ss << (id ? ", " : "") << "\n  {\n    \"id\": " << id
+       << ",\n    \"name\": \"ALSA Sink " << id << "\""
+       << ",\n    \"io\": \"Audio Device\""
+       << ",\n    \"use_sdp\": true"
+       << ",\n    \"source\": \"\""
+       << ",\n    \"sdp\": \"" << sdp << "\""
+       << ",\n    \"delay\": 576"
+       << ",\n    \"ignore_refclk_gmid\": false"
+       << ",\n    \"map\": [ 0, 1, 2, 3, 4, 5, 6, 7 ]\n  }";
+  }
+  ss << "  ]\n}\n";
+  return ss.str();
+}
+
+static size_t parse_ptree(const string& json) {
+  boost::property_tree::ptree pt;
+  stringstream ss(json);
+  boost::property_tree::read_json(ss, pt);
+  list<Stream> streams;
+  for (auto const& v : pt.get_child("sources")) {
+    Stream source;
+    source.id = v.second.get<uint16_t>("id");
+    source.enabled = v.second.get<bool>("enabled");
+    source.name = v.second.get<string>("name");
+    source.io = v.second.get<string>("io");
+    for (auto const& vm : v.second.get_child("map")) {
+      source.map.emplace_back(stoi(vm.second.data()));
+    }
+    streams.emplace_back(move(source));
+  }
+  for (auto const& v : pt.get_child("sinks")) {
+    Stream sink;
+    sink.id = v.second.get<uint16_t>("id");
+    sink.name = v.second.get<string>("name");
+    sink.io = v.second.get<string>("io");
+    sink.sdp = v.second.get<string>("sdp");
+    sink.delay = v.second.get<uint32_t>("delay");
+    for (auto const& vm : v.second.get_child("map")) {
+      sink.map.emplace_back(stoi(vm.second.data()));
+    }
+    streams.emplace_back(move(sink));
+  }
+  return streams.size();
+}
+
+static size_t parse_reader(const string& json) {
+  list<Stream> streams;
+  JsonReader jr(json);
+  auto parse_stream = [&jr, &streams]() {
+    Stream stream;
+    jr.object([&jr, &stream](string_view key) {
+      if (key == "id") {
+        stream.id = jr.get_int<uint16_t>();
+      } else if (key == "enabled") {
+        stream.enabled = jr.get_bool();
+      } else if (key == "name") {
+        stream.name = jr.get_string();
+      } else if (key == "io") {
+        stream.io = jr.get_string();
+      } else if (key == "sdp") {
+        stream.sdp = jr.get_string();
+      } else if (key == "delay") {
+        stream.delay = jr.get_int<uint32_t>();
+      } else if (key == "map") {
+        jr.array([&jr, &stream]() {
+          stream.map.emplace_back(jr.get_int<uint8_t>());
+        });
+      } else {
+        jr.skip();
+      }
+    });
+    streams.emplace_back(move(stream));
+  };
+  jr.object([&jr, &parse_stream](string_view key) {
+    if (key == "sources" || key == "sinks") {
+      jr.array(parse_stream);
+    } else {
+      jr.skip();
+    }
+  });
+  jr.end();
+  return streams.size();
+}
+
+template <typename F>
+static void run(const string& name,
+                const string& json,
+                int iterations,
+                F parse) {
+  size_t streams = 0;
+  allocations = 0;
+  auto start = steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    streams = parse(json);
+  }
+  auto elapsed = duration_cast<microseconds>(steady_clock::now() - start);
+  cout << name << ": " << streams << " streams, avg "
+       << elapsed.count() / iterations << " usecs, "
+       << allocations / iterations << " allocations per parse" << endl;
+}
+
+int main(int argc, char* argv[]) {
+  int streams = argc > 1 ? atoi(argv[1]) : 512;
+  int iterations = argc > 2 ? atoi(argv[2]) : 100;
+  if (streams <= 0 || iterations <= 0) {
+    cerr << "Usage: " << argv[0] << " [streams] [iterations]" << endl;
+    exit(1);
+  }
+  // the streams are split evenly between sources and sinks
+  auto json = make_status(streams / 2);
+  cout << "status file of " << json.length() << " bytes" << endl;
+  run("property_tree", json, iterations, parse_ptree);
+  run("JsonReader", json, iterations, parse_reader);
+  return 0;
+}
@@ -0,0 +1,151 @@
+//  nmos_registry_bench.cc
+//
+//  NMOS full registration benchmark.
+//  Starts a local mock IS-04 registry that answers every request after the
+//  specified latency and registers a node, a device, the specified number of
+//  senders (with their sources and flows) and receivers with:
+//  - a new HTTP connection per resource, as the daemon previously did
+//  - the daemon keep-alive NmosRegistryClient, one level at a time
+//  For each client it prints the registration time and the number of TCP
+//  connections opened to the registry.
+//
+//  Usage: nmos_registry_bench [senders] [receivers] [latency_ms]
+//  Example: ./nmos_registry_bench 64 64 1
+//
+
+#include <httplib.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../daemon/nmos_registry_client.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+using Resources = vector<pair<string, string>>;
+
+static const string resource_path = "/x-nmos/registration/v1.3/resource";
+static const int registry_port = 3499;
+
+static mutex connections_mutex;
+static set<int> connections;
+
+static string make_json(const string& type, int id) {
+  // roughly the size of the resources registered by the daemon
+  return "{\"id\": \"" + type + "-" + to_string(id) +
+         "\", \"version\": \"1:0\", \"label\": \"" + type + " " +
+         to_string(id) + "\", \"description\": \"" + string(512, 'x') +
+         "\", \"tags\": {}}";
+}
+
+static string make_body(const pair<string, string>& resource) {
+  return "{\"type\": \"" + resource.first + "\", \"data\": " +
+         resource.second + "}";
+}
+
+static int register_new_connections(const vector<Resources>& levels) {
+  int errors = 0;
+  for (const auto& level : levels) {
+    for (const auto& resource : level) {
+      httplib::Client cli("127.0.0.1", registry_port);
+      auto res = cli.Post(resource_path.c_str(), make_body(resource),
+                          "application/json");
+      if (!res || res->status != 201) {
+        errors++;
+      }
+    }
+  }
+  return errors;
+}
+
+static int register_pooled(const vector<Resources>& levels) {
+  NmosRegistryClient registry("127.0.0.1", registry_port);
+  int errors = 0;
+  for (const auto& level : levels) {
+    vector<NmosRegistryClient::Request> reqs;
+    for (const auto& resource : level) {
+      reqs.push_back({NmosRegistryClient::Method::Post, resource_path,
+                      make_body(resource)});
+    }
+    for (const auto& res : registry.send_all(reqs)) {
+      if (res.status != 201) {
+        errors++;
+      }
+    }
+  }
+  return errors;
+}
+
+template <typename F>
+static void run(const string& name, const vector<Resources>& levels, F reg) {
+  {
+    lock_guard lock(connections_mutex);
+    connections.clear();
+  }
+  auto start = steady_clock::now();
+  int errors = reg(levels);
+  auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start);
+  lock_guard lock(connections_mutex);
+  cout << name << ": " << elapsed.count() << " msecs, "
+       << connections.size() << " connections, " << errors << " errors"
+       << endl;
+}
+
+int main(int argc, char* argv[]) {
+  int senders = argc > 1 ? atoi(argv[1]) : 64;
+  int receivers = argc > 2 ? atoi(argv[2]) : 64;
+  int latency = argc > 3 ? atoi(argv[3]) : 1;
+  if (senders < 0 || receivers < 0 || latency < 0) {
+    cerr << "Usage: " << argv[0] << " [senders] [receivers] [latency_ms]"
+         << endl;
+    exit(1);
+  }
+
+  httplib::Server registry;
+  registry.Post(resource_path.c_str(), [latency](const httplib::Request& req,
+                                                 httplib::Response& res) {
+    {
+      lock_guard lock(connections_mutex);
+      connections.insert(req.remote_port);
+    }
+    this_thread::sleep_for(milliseconds(latency));
+    res.status = 201;
+    res.set_content(req.body, "application/json");
+  });
+  auto listener = thread([&registry]() {
+    registry.listen("127.0.0.1", registry_port);
+  });
+  while (!registry.is_running()) {
+    this_thread::sleep_for(milliseconds(10));
+  }
+
+  // a resource is registered after the resource it references
+  vector<Resources> levels(5);
+  levels[0].emplace_back("node", make_json("node", 0));
+  levels[1].emplace_back("device", make_json("device", 0));
+  for (int id = 0; id < senders; id++) {
+    levels[2].emplace_back("source", make_json("source", id));
+    levels[3].emplace_back("flow", make_json("flow", id));
+    levels[4].emplace_back("sender", make_json("sender", id));
+  }
+  for (int id = 0; id < receivers; id++) {
+    levels[4].emplace_back("receiver", make_json("receiver", id));
+  }
+  cout << 2 + 3 * senders + receivers << " resources, " << latency
+       << " msecs registry latency" << endl;
+
+  run("new connection per request", levels, register_new_connections);
+  run("NmosRegistryClient", levels, register_pooled);
+
+  registry.stop();
+  listener.join();
+  return 0;
+}
@@ -0,0 +1,179 @@
+//  rtsp_load.cc
+//
+//  RTSP DESCRIBE load test for the daemon RTSP server.
+//  Opens the specified number of persistent connections and sends DESCRIBE
+//  requests back to back on each of them for the specified duration.
+//  At the end it prints the requests per second and the latency percentiles.
+//
+//  Usage: rtsp_load address port path [connections] [duration_secs]
+//  Example: ./rtsp_load 127.0.0.1 8854 /by-id/0 32 10
+//
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static atomic<bool> running{true};
+static atomic<uint64_t> errors{0};
+
+static int connect_to(const string& address, int port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  int flag = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 ||
+      connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static bool send_all(int fd, const string& data) {
+  size_t sent = 0;
+  while (sent < data.length()) {
+    auto ret = send(fd, data.c_str() + sent, data.length() - sent, 0);
+    if (ret <= 0) {
+      return false;
+    }
+    sent += ret;
+  }
+  return true;
+}
+
+/* read a full RTSP message (headers and body), return the status code
+ * for a response or 0 for a request sent by the server (ANNOUNCE) */
+static int read_message(int fd, string& buffer) {
+  char data[4096];
+  size_t end;
+  while ((end = buffer.find("\r\n\r\n")) == string::npos) {
+    auto ret = recv(fd, data, sizeof(data), 0);
+    if (ret <= 0) {
+      return -1;
+    }
+    buffer.append(data, ret);
+  }
+  size_t length = 0;
+  auto pos = buffer.find("Content-Length:");
+  if (pos != string::npos && pos < end) {
+    length = strtoul(buffer.c_str() + pos + 15, nullptr, 10);
+  }
+  while (buffer.length() < end + 4 + length) {
+    auto ret = recv(fd, data, sizeof(data), 0);
+    if (ret <= 0) {
+      return -1;
+    }
+    buffer.append(data, ret);
+  }
+  int status = 0;
+  if (buffer.rfind("RTSP/1.0 ", 0) == 0) {
+    status = atoi(buffer.c_str() + 9);
+  }
+  buffer.erase(0, end + 4 + length);
+  return status;
+}
+
+static void run(const string& address,
+                int port,
+                const string& path,
+                vector<uint32_t>& latencies) {
+  int fd = connect_to(address, port);
+  if (fd < 0) {
+    errors++;
+    return;
+  }
+  string buffer;
+  string url = "rtsp://" + address + ":" + to_string(port) + path;
+  for (uint32_t cseq = 1; running; cseq++) {
+    string request = "DESCRIBE " + url + " RTSP/1.0\r\nCSeq: " +
+                     to_string(cseq) + "\r\nAccept: application/sdp\r\n\r\n";
+    auto start = steady_clock::now();
+    if (!send_all(fd, request)) {
+      errors++;
+      break;
+    }
+    int status;
+    /* skip the ANNOUNCE requests sent by the server */
+    while ((status = read_message(fd, buffer)) == 0) {
+    }
+    if (status != 200) {
+      errors++;
+      if (status < 0) {
+        break;
+      }
+      continue;
+    }
+    latencies.push_back(
+        duration_cast<microseconds>(steady_clock::now() - start).count());
+  }
+  close(fd);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 4) {
+    cerr << "Usage: " << argv[0]
+         << " address port path [connections] [duration_secs]" << endl;
+    exit(1);
+  }
+  string address(argv[1]);
+  int port = atoi(argv[2]);
+  string path(argv[3]);
+  int connections = argc > 4 ? atoi(argv[4]) : 16;
+  int duration_secs = argc > 5 ? atoi(argv[5]) : 10;
+  if (connections <= 0 || duration_secs <= 0) {
+    cerr << "Invalid connections or duration" << endl;
+    exit(1);
+  }
+
+  vector<vector<uint32_t> > latencies(connections);
+  vector<thread> threads;
+  auto start = steady_clock::now();
+  for (int i = 0; i < connections; i++) {
+    threads.emplace_back(run, address, port, path, ref(latencies[i]));
+  }
+  this_thread::sleep_for(seconds(duration_secs));
+  running = false;
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto elapsed = duration_cast<duration<double> >(steady_clock::now() - start);
+
+  vector<uint32_t> all;
+  for (const auto& l : latencies) {
+    all.insert(all.end(), l.begin(), l.end());
+  }
+  if (all.empty()) {
+    cerr << "No responses received, errors " << errors << endl;
+    exit(1);
+  }
+  sort(all.begin(), all.end());
+  auto percentile = [&all](double p) {
+    return all[min(all.size() - 1, size_t(all.size() * p))];
+  };
+  cout << "connections: " << connections << endl;
+  cout << "requests: " << all.size() << " errors: " << errors << endl;
+  cout << "requests/sec: " << size_t(all.size() / elapsed.count()) << endl;
+  cout << "latency usecs p50: " << percentile(0.5)
+       << " p99: " << percentile(0.99) << " p999: " << percentile(0.999)
+       << " max: " << all.back() << endl;
+  return errors ? 2 : 0;
+}
@@ -56,6 +56,7 @@ class Config extends Component {
       ptpDscp: '',
       sapInterval: '',
       sapIntervalErr: false,
+      sapCompression: false,
       mdnsEnabled: false,
       streamerEnabled: false,
       streamerChannels: 0,
@@ -122,6 +123,7 @@ class Config extends Component {
             ptpDscp: data.ptp_dscp,
             sapMcastAddr: data.sap_mcast_addr,
             sapInterval: data.sap_interval,
+            sapCompression: data.sap_compression,
             mdnsEnabled: data.mdns_enabled,
             streamerEnabled: data.streamer_enabled,
             streamerChannels: data.streamer_channels,
@@ -189,6 +191,7 @@ class Config extends Component {
       this.state.maxTicFrameSize,
       this.state.sapMcastAddr,
       this.state.sapInterval,
+      this.state.sapCompression,
       this.state.mdnsEnabled,
       this.state.customNodeId,
       this.state.autoSinksUpdate,
@@ -321,6 +324,10 @@ class Config extends Component {
             <th align="left"> <label>SAP interval (sec)</label> </th>
             <th align="left"> <input type='number' min='0' max='255'  className='input-number' value={this.state.sapInterval} onChange={e => this.setState({sapInterval: e.target.value, sapIntervalErr: !e.currentTarget.checkValidity()})} required/> </th>
           </tr>
+          <tr height="35">
+            <th align="left"> <label>SAP compression</label> </th>
+            <th align="left"> <input type="checkbox" onChange={e => this.setState({sapCompression: e.target.checked})} checked={this.state.sapCompression ? true : false}/> </th>
+          </tr>
           <tr height="35">
             <th align="left"> <label>mDNS enabled</label> </th>
             <th align="left"> <input type="checkbox" onChange={e => this.setState({mdnsEnabled: e.target.checked})} checked={this.state.mdnsEnabled ? true : false}/> </th>
@@ -132,9 +132,14 @@ class RemoteSources extends Component {
   fetchRemoteSources() {
     this.setState({isLoading: true});
     RestAPI.getRemoteSources()
-      .then(response => response.json())
+      .then(response => {
+        // last_seen is relative to the time the daemon generated the reply
+        const age = parseInt(response.headers.get('Age')) || 0;
+        return response.json().then(data => data.remote_sources.map(
+          source => ({ ...source, last_seen: source.last_seen + age })));
+      })
       .then(
-        data => this.setState( { sources: data.remote_sources, isLoading: false }))
+        sources => this.setState( { sources: sources, isLoading: false }))
       .catch(err => this.setState( { isLoading: false } ));
   }
 
@@ -84,7 +84,7 @@ export default class RestAPI {
     });
   }
 
-  static setConfig(log_severity, syslog_proto, syslog_server, rtp_mcast_base, rtp_mcast_base_sec, rtp_port, rtp_port_sec, rtsp_port, playout_delay, tic_frame_size_at_1fs, sample_rate, max_tic_frame_size, sap_mcast_addr, sap_interval, mdns_enabled, custom_node_id, auto_sinks_update, streamer_enabled, streamer_channels, streamer_files_num, streamer_file_duration, streamer_player_buffer_files_num, nmos_enabled, nmos_registry_address, nmos_registry_port, nmos_node_port) {
+  static setConfig(log_severity, syslog_proto, syslog_server, rtp_mcast_base, rtp_mcast_base_sec, rtp_port, rtp_port_sec, rtsp_port, playout_delay, tic_frame_size_at_1fs, sample_rate, max_tic_frame_size, sap_mcast_addr, sap_interval, sap_compression, mdns_enabled, custom_node_id, auto_sinks_update, streamer_enabled, streamer_channels, streamer_files_num, streamer_file_duration, streamer_player_buffer_files_num, nmos_enabled, nmos_registry_address, nmos_registry_port, nmos_node_port) {
     return this.doFetch(config, {
       body: JSON.stringify({
         log_severity: parseInt(log_severity, 10),
@@ -101,6 +101,7 @@ export default class RestAPI {
         max_tic_frame_size: parseInt(max_tic_frame_size, 10),
         sap_mcast_addr: sap_mcast_addr,
         sap_interval: parseInt(sap_interval, 10),
+        sap_compression: sap_compression,
         custom_node_id: custom_node_id,
         mdns_enabled: mdns_enabled,
         auto_sinks_update: auto_sinks_update,
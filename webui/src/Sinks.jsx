@@ -134,7 +134,7 @@ class SinkList extends Component {
          &nbsp;
         <span className='pointer-area' onClick={this.handleReloadClick}> <img width='30' height='30' src='/reload.png' alt=''/> </span>
          &nbsp;&nbsp;
-        {this.props.sinks.length < 64 ?
+        {this.props.sinks.length < 512 ?
 	  <span className='pointer-area' onClick={this.handleAddClick}> <img width='30' height='30' src='/plus.png' alt=''/> </span>
           : undefined}
       </div>
@@ -209,7 +209,7 @@ class Sinks extends Component {
   onAddClick() {
     let id;
     /* find first free id */
-    for (id = 0; id < 63; id++) {
+    for (id = 0; id < 511; id++) {
       if (this.state.sinks[id] === undefined ||
           this.state.sinks[id].id !== id) {
         break;
@@ -234,7 +234,7 @@ class SourceEdit extends Component {
           <table><tbody>
             <tr>
               <th align="left"> <font color='grey'>ID</font> </th>
-              <th align="left"> <input type='number' min='0' max='63' className='input-number' value={this.state.id} onChange={e => this.setState({id: e.target.value})} disabled required/> </th>
+              <th align="left"> <input type='number' min='0' max='511' className='input-number' value={this.state.id} onChange={e => this.setState({id: e.target.value})} disabled required/> </th>
             </tr>
             <tr height="35">
               <th align="left"> <label>Enabled</label> </th>
@@ -122,7 +122,7 @@ class SourceList extends Component {
          &nbsp;
         <span className='pointer-area' onClick={this.handleReloadClick}> <img width='30' height='30' src='/reload.png' alt=''/> </span>
          &nbsp;&nbsp;
-        {this.props.sources.length < 64 ?
+        {this.props.sources.length < 512 ?
 	  <span className='pointer-area' onClick={this.handleAddClick}> <img width='30' height='30' src='/plus.png' alt=''/> </span>
           : undefined}
       </div>
@@ -223,7 +223,7 @@ class Sources extends Component {
   onAddClick() {
     let id;
     /* find first free id */
-    for (id = 0; id < 63; id++) {
+    for (id = 0; id < 511; id++) {
       if (this.state.sources[id] === undefined ||
           this.state.sources[id].id !== id) {
         break;